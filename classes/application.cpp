@@ -40,6 +40,7 @@ namespace Lemur
 	Application::~Application()
 	{
 		mainWindow->close();
+		delete hotReload;
 		delete resManager;
 		delete mainWindow;
 	}
@@ -50,7 +51,22 @@ namespace Lemur
 		resManager = new ResourceManager();
 		mainWindow = new MainWindow(1280, 720, "OpenDraft");
 		mainWindow->resourceManager = resManager;
+
+		// Asynchronous imports finish on worker threads, wake the event loop to upload them
+		resManager->setWakeUpCallback([this]() { mainWindow->postWakeUp(); });
+
+#ifndef NDEBUG
+		// Watch layout and resource files, applying edits while the application runs
+		hotReload = new HotReload();
+		hotReload->setWakeUpCallback([this]() { mainWindow->postWakeUp(); });
+		mainWindow->hotReload = hotReload;
+#endif
+
 		mainWindow->initialise();
+
+		if (hotReload != nullptr)
+			hotReload->watchResources(resManager);
+
 		running = true;
 	}
 
@@ -70,10 +86,24 @@ namespace Lemur
 			return;
 		}
 
+		Profiler::beginFrame();
+
+		if (hotReload != nullptr)
+			hotReload->update(mainWindow->getContext());
+
 		mainWindow->triggerEventsChain();
+		Profiler::endPhase(Profiler::Phase::Events);
+
 		mainWindow->resetContext();
+		Profiler::endPhase(Profiler::Phase::Reset);
+
 		mainWindow->onFrame();
+		Profiler::endPhase(Profiler::Phase::Frame);
+
 		mainWindow->endFrame();
+		Profiler::endPhase(Profiler::Phase::End);
+
+		Profiler::endFrame();
 	}
 
 	// Get the main window instance
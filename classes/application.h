@@ -22,6 +22,8 @@
 #include "core.h"					// Include Core Utilities
 #include "window_main.h"			// Include Main Window Class
 #include "resource_manager.h"		// Include Resource Manager
+#include "profiler.h"				// Include Frame Profiler
+#include "hot_reload.h"				// Include Hot Reload
 
 
 namespace Lemur
@@ -44,6 +46,7 @@ namespace Lemur
 		bool running = false;					// Flag to indicate if the application is still running
 		MainWindow* mainWindow = nullptr;		// Pointer to the main window
 		ResourceManager* resManager;			// Pointer to the resource manager
+		HotReload* hotReload = nullptr;			// Reloads edited files, null in release builds
 			
 
 	public:
@@ -16,6 +16,7 @@
 
 
 #include "button.h"
+#include "text_styles.h"
 
 namespace Lemur
 {
@@ -44,6 +45,16 @@ namespace Lemur
 		fontSize = 14;
 	}
 
+	void* Button::operator new(size_t aSize)
+	{
+		return ComponentArena::allocate<Button>(aSize);
+	}
+
+	void Button::operator delete(void* aPointer, size_t aSize)
+	{
+		ComponentArena::deallocate<Button>(aPointer, aSize);
+	}
+
 	void Button::setBackgroundImage(Image* aImage)
 	{
 		backgroundImage = aImage;
@@ -60,13 +71,9 @@ namespace Lemur
 		int w = static_cast<int>(size.x);
 		int h = static_cast<int>(size.y);
 
-		Draw::TextStyle buttonTextStyle =
-		{
-			fontSize,
-			"sans",
-			foreColour,
-			Align(Align::CENTRE | Align::MIDDLE)
-		};
+		Draw::TextStyle buttonTextStyle = TextStyles::get(TextStyles::Id::Button);
+		buttonTextStyle.size = fontSize;
+		buttonTextStyle.colour = foreColour;
 
 		Draw::RoundedRect(aContext, x, y, w, h, 1, backColour);
 		Draw::Text(aContext, x, y, w, h, &buttonTextStyle, text.c_str());
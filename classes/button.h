@@ -43,6 +43,10 @@ namespace Lemur
 
 		Button(const int aX = 0, const int aY = 0, const int aWidth = 150, const int aHeight = 30, const std::string aText = "Button");
 
+		// Allocated from this class's own arena pool
+		static void* operator new(size_t aSize);
+		static void operator delete(void* aPointer, size_t aSize);
+
 		/**
 			* \brief Sets the background image of the button. 
 			* \param aImage (Image*) The image to set as the background.
@@ -15,7 +15,9 @@
 
 
 
+#include <algorithm>
 #include "Component.h"
+#include "profiler.h"
 
 
 namespace Lemur
@@ -33,11 +35,26 @@ namespace Lemur
 		if (aContext == nullptr)
 			return;
 
-		// Update size based on any anchors that are enabled
-		updateSizeForAnchors();
+		Profiler::Scope scope(name.c_str(), "component");
+
+		// Composite an up to date layer instead of drawing the subtree
+		if (layered)
+		{
+			int layerImage = LayerCache::getImage(this);
+			if (layerImage != 0)
+			{
+				Image image(static_cast<int>(size.x), static_cast<int>(size.y), 1.0f, nullptr, layerImage);
+				Draw::ResourceImage(aContext, location.x, location.y, Math::ceil(size.x), Math::ceil(size.y), &image);
+				dirty = false;
+				return;
+			}
+		}
 
 		// Invoke onFrame
 		onFrame(aContext);
+
+		// Component is now up to date on screen
+		dirty = false;
 	}
 
 
@@ -47,53 +64,118 @@ namespace Lemur
 
 	void Component::setLocation(int aX, int aY)
 	{
+		if (location.x == aX && location.y == aY)
+			return;
+
+		// Damage both the old and new area
+		invalidate();
 		location.x = static_cast<double>(aX);
 		location.y = static_cast<double>(aY);
+		updateScreenRect();
+		invalidate();
 	}
 
 	void Component::setLocation(double aX, double aY)
 	{
+		if (location.x == aX && location.y == aY)
+			return;
+
+		// Damage both the old and new area
+		invalidate();
 		location.x = aX;
 		location.y = aY;
+		updateScreenRect();
+		invalidate();
 	}
 
 	void Component::setLocation(Vector2 aPoint)
 	{
+		if (location.x == aPoint.x && location.y == aPoint.y)
+			return;
+
+		// Damage both the old and new area
+		invalidate();
 		location.x = aPoint.x;
 		location.y = aPoint.y;
+		updateScreenRect();
+		invalidate();
 	}
 
 	void Component::setText(std::string aText)
 	{
+		if (text == aText)
+			return;
+
 		text = aText;
+		invalidate();
 	}
 
 	void Component::setSize(int aWidth, int aHeight)
 	{
+		if (size.x == aWidth && size.y == aHeight)
+			return;
+
+		// Damage both the old and new area
+		invalidate();
 		size.x = static_cast<float>(aWidth);
 		size.y = static_cast<float>(aHeight);
+		updateScreenSize();
+		invalidate();
+		sizeChanged();
 	}
 
 	void Component::setSize(double aWidth, double aHeight)
 	{
+		if (size.x == static_cast<float>(aWidth) && size.y == static_cast<float>(aHeight))
+			return;
+
+		// Damage both the old and new area
+		invalidate();
 		size.x = static_cast<float>(aWidth);
 		size.y = static_cast<float>(aHeight);
+		updateScreenSize();
+		invalidate();
+		sizeChanged();
 	}
 		
 	void Component::setSize(Vector2 aSize)
 	{
+		if (size.x == aSize.x && size.y == aSize.y)
+			return;
+
+		// Damage both the old and new area
+		invalidate();
 		size.x = aSize.x;
 		size.y = aSize.y;
+		updateScreenSize();
+		invalidate();
+		sizeChanged();
 	}
 
 	void Component::setWidth(int aWidth)
 	{
+		if (size.x == aWidth)
+			return;
+
+		// Damage both the old and new area
+		invalidate();
 		size.x = static_cast<float>(aWidth);
+		updateScreenSize();
+		invalidate();
+		sizeChanged();
 	}
 
 	void Component::setHeight(int aHeight)
 	{
+		if (size.y == aHeight)
+			return;
+
+		// Damage both the old and new area
+		invalidate();
 		size.y = static_cast<float>(aHeight);
+		updateScreenSize();
+		invalidate();
+		sizeChanged();
 	}
 
 	void Component::setName(std::string aName)
@@ -101,6 +183,50 @@ namespace Lemur
 		name = aName;
 	}
 
+	void Component::setBackColour(Colour aColour)
+	{
+		if (backColour == aColour)
+			return;
+
+		backColour = aColour;
+		invalidate();
+	}
+
+	void Component::setForeColour(Colour aColour)
+	{
+		if (foreColour == aColour)
+			return;
+
+		foreColour = aColour;
+		invalidate();
+	}
+
+	// Move the component within its parent's draw order
+	void Component::setZOrder(int aZOrder)
+	{
+		if (zOrder == aZOrder)
+			return;
+
+		if (parent != nullptr)
+			parent->removeDrawOrder(this);
+
+		zOrder = aZOrder;
+
+		if (parent != nullptr)
+			parent->insertDrawOrder(this);
+
+		invalidate();
+	}
+
+	void Component::setStroke(Colour aColour)
+	{
+		if (stroke == aColour)
+			return;
+
+		stroke = aColour;
+		invalidate();
+	}
+
 	Vector2 Component::Component::getLocation() const
 	{
 		return location;
@@ -141,6 +267,11 @@ namespace Lemur
 		return active;
 	}
 
+	int Component::getZOrder() const
+	{
+		return zOrder;
+	}
+
 	Component* Component::getParent() const
 	{
 		return parent;
@@ -148,16 +279,53 @@ namespace Lemur
 
 	Vector2 Component::getOffset() const
 	{
-		Vector2 result;
+		return Vector2(screenRect.x, screenRect.y);
+	}
+
+	Rect Component::getScreenRect() const
+	{
+		return screenRect;
+	}
+
+	// The component has moved within its parent
+	void Component::updateScreenRect()
+	{
+		refreshScreenRect();
+
+		// Parent's hit test grid holds this component's old bounds
+		if (parent != nullptr)
+			parent->hitGrid.invalidate();
+	}
 
+	// Recalculate the cached screen bounds from the parent's, then push the change down to all children
+	void Component::refreshScreenRect()
+	{
 		if (parent != nullptr)
 		{
-			Vector2 parentOffset = parent->getOffset();
-			result.x = parentOffset.x + location.x;
-			result.y = parentOffset.y + location.y;
+			screenRect.x = parent->screenRect.x + location.x;
+			screenRect.y = parent->screenRect.y + location.y;
+		}
+		else
+		{
+			screenRect.x = 0;
+			screenRect.y = 0;
 		}
 
-		return result;
+		screenRect.width = size.x;
+		screenRect.height = size.y;
+
+		for (std::shared_ptr<Component>& control : childComponents)
+			control->refreshScreenRect();
+	}
+
+	// Size does not move children, only the cached size needs updating
+	void Component::updateScreenSize()
+	{
+		screenRect.width = size.x;
+		screenRect.height = size.y;
+
+		if (parent != nullptr)
+			parent->hitGrid.invalidate();
 	}
 
 
@@ -223,7 +391,8 @@ namespace Lemur
 		// If turning AnchorBottom on, get the current space between the bottom of the Component and the bottom of the parent
 		if (aAnchor)
 			updateAnchor(direction);
-		
+
+		invalidateLayout();
 	}
 
 	void Component::updateAnchor(Anchor::Direction direction)
@@ -253,14 +422,16 @@ namespace Lemur
 
 	void Component::updateSizeForAnchors()
 	{
+		Vector2 lastLocation = location;
+
 		// Update horizontal size based on anchor points
 		// Anchor top=0, right=1, bottom=2, left=3
 
 		// If left and right anchors are enabled
 		if (anchor[3].enabled && anchor[1].enabled)
 		{
-			// Calculate new width
-			size.x = parent->getSize().x - anchor[3].offset - anchor[1].offset - location.x;
+			// Calculate new width, keeping the left edge in place
+			size.x = parent->getSize().x - anchor[1].offset - location.x;
 		}
 
 		// If right anchor is enabled
@@ -273,8 +444,8 @@ namespace Lemur
 		// If top and bottom anchors are enabled
 		if (anchor[0].enabled && anchor[2].enabled)
 		{
-			// Calculate new height
-			size.y = parent->getSize().y - anchor[0].offset - anchor[2].offset - location.y;
+			// Calculate new height, keeping the top edge in place
+			size.y = parent->getSize().y - anchor[2].offset - location.y;
 		}
 
 		// If bottom anchor is enabled
@@ -283,6 +454,12 @@ namespace Lemur
 			// Calculate new location, pinning the bottom side
 			location.y = parent->getSize().y - anchor[2].offset - size.y;
 		}
+
+		// Keep cached screen bounds in step with the anchored geometry
+		if (location.x != lastLocation.x || location.y != lastLocation.y)
+			updateScreenRect();
+		else
+			updateScreenSize();
 	}
 
 	//
@@ -291,29 +468,127 @@ namespace Lemur
 
 	void Component::addChildControl(Component* aChild)
 	{
+		std::shared_ptr<Component> child;
+
 		// Check if the Component already has a parent
 		if (aChild->parent != nullptr)
 		{
-			// Remove child from the parent
+			// Remove child from the parent, keeping ownership
 			for (int i = 0; i < aChild->parent->childComponents.size(); i++)
 			{
 				if (aChild->parent->childComponents[i].get() == aChild)
 				{
-					aChild->parent->childComponents.erase(aChild->parent->childComponents.begin() + i);
+					child = aChild->parent->childComponents[i];
+					aChild->parent->detachChild(i);
 					break;
 				}
 			}
 		}
 
+		// The control block is allocated from the arena alongside the components
+		if (child == nullptr)
+			child = std::shared_ptr<Component>(aChild, std::default_delete<Component>(), ArenaAllocator<Component>());
+
 		// Set the parent of the child to this Component
 		aChild->parent = this;
-		childComponents.push_back(std::shared_ptr<Component>(aChild));
+		childComponents.push_back(child);
+		insertDrawOrder(aChild);
+		adjustFrameEventCount(aChild->frameEventCount);
+
+		aChild->updateScreenRect();
+
+		aChild->invalidate();
+		invalidateLayout();
+	}
+
+	// Remove a child from this component's lists, releasing this component's ownership of it
+	void Component::detachChild(int aIndex)
+	{
+		Component* child = childComponents[aIndex].get();
+
+		// Drop any event routing references to the child
+		for (int i = 0; i < static_cast<int>(engagedChildren.size()); i++)
+		{
+			if (engagedChildren[i] == child)
+			{
+				engagedChildren.erase(engagedChildren.begin() + i);
+				break;
+			}
+		}
+
+		releaseFocus(child);
+		removeDrawOrder(child);
+		adjustFrameEventCount(-child->frameEventCount);
+		hitGrid.invalidate();
+
+		// Damage the area the child covered
+		child->invalidate();
+		child->parent = nullptr;
+
+		childComponents.erase(childComponents.begin() + aIndex);
+		invalidateLayout();
+	}
+
+	// Insert a child after all children with an equal or lower zOrder, keeping insertion order within a zOrder
+	void Component::insertDrawOrder(Component* aChild)
+	{
+		std::vector<Component*>::iterator position = std::upper_bound(drawOrder.begin(), drawOrder.end(), aChild->zOrder,
+			[](int aZOrder, const Component* aOther) { return aZOrder < aOther->zOrder; });
+
+		drawOrder.insert(position, aChild);
+	}
+
+	void Component::removeDrawOrder(Component* aChild)
+	{
+		std::vector<Component*>::iterator position = std::find(drawOrder.begin(), drawOrder.end(), aChild);
+		if (position != drawOrder.end())
+			drawOrder.erase(position);
+	}
+
+	void Component::removeChildControl(Component* aChild)
+	{
+		int index = getChildIndex(aChild);
+		if (index != -1)
+			detachChild(index);
+	}
+
+	int Component::getChildIndex(const Component* aChild) const
+	{
+		for (int i = 0; i < static_cast<int>(childComponents.size()); i++)
+			if (childComponents[i].get() == aChild)
+				return i;
+
+		return -1;
+	}
+
+	void Component::setChildIndex(Component* aChild, int aIndex)
+	{
+		int index = getChildIndex(aChild);
+		if (index == -1)
+			return;
+
+		aIndex = std::clamp(aIndex, 0, static_cast<int>(childComponents.size()) - 1);
+		if (index == aIndex)
+			return;
+
+		std::shared_ptr<Component> child = childComponents[index];
+		childComponents.erase(childComponents.begin() + index);
+		childComponents.insert(childComponents.begin() + aIndex, child);
+
+		// Children with equal z-order draw in child order
+		drawOrder.clear();
+		for (std::shared_ptr<Component>& control : childComponents)
+			insertDrawOrder(control.get());
+
+		hitGrid.invalidate();
+		aChild->invalidate();
+		invalidateLayout();
 	}
 
 	Component* Component::getChildByName(std::string name)
 	{
 		// Search through childComponents vector and get by name
-		for (std::shared_ptr<Component> control : childComponents)
+		for (std::shared_ptr<Component>& control : childComponents)
 		{
 			if (control->name == name)
 				return control.get();
@@ -336,11 +611,19 @@ namespace Lemur
 
 	void Component::processEvents(InputMap* aInput)
 	{
+		Profiler::Scope scope(name.c_str(), "events");
+
+		// Record mouse state so transitions can be redrawn
+		bool lastMouseOver = mouseOver;
+		bool lastMousePressDown = mousePressDown;
+		bool lastMousePressUp = mousePressUp;
+		bool lastActive = active;
+
 		// Get mouse position from input
 		int mousePosX = static_cast<int>(aInput->mouse.position.x);
 		int mousePosY = static_cast<int>(aInput->mouse.position.y);
 
-		// Calculate object boundaries
+		// Calculate object boundaries from the cached screen location
 		Vector2 offset = getOffset();
 
 		// Calculate object boundaries
@@ -410,33 +693,284 @@ namespace Lemur
 		if(!mouseOver && aInput->mouse.leftButton.isPressUp())
 			active = false;
 
+		// Redraw on any change in mouse state
+		if (mouseOver != lastMouseOver || mousePressDown != lastMousePressDown || mousePressUp != lastMousePressUp || active != lastActive)
+			invalidate();
+
 
 		// Process child Components
-		for (std::shared_ptr<Component> control : childComponents)
-			control->processEvents(aInput);
+		processChildEvents(aInput);
 
 		actionEvents(aInput);
 	}
 
+	// Process only the children whose state can change: those under the mouse, those holding
+	// mouse state from the last frame, and those receiving frame events
+	void Component::processChildEvents(InputMap* aInput)
+	{
+		if (childComponents.empty())
+			return;
+
+		unsigned int pass = ++eventPassCounter;
+		eventTargets.clear();
+
+		// Queue a child once per pass
+		auto queue = [&](Component* aChild) {
+			if (aChild->eventPass == pass)
+				return;
+
+			aChild->eventPass = pass;
+			eventTargets.push_back(aChild);
+		};
+
+		// Children under the mouse
+		if (mouseOver)
+		{
+			if (hitGrid.isDirty())
+				hitGrid.build(childComponents);
+
+			Component* const* candidates = nullptr;
+			int count = hitGrid.query(
+				static_cast<float>(aInput->mouse.position.x - screenRect.x),
+				static_cast<float>(aInput->mouse.position.y - screenRect.y),
+				&candidates);
+
+			for (int i = 0; i < count; i++)
+				queue(candidates[i]);
+		}
+
+		// Children with mouse state from the last frame, so they see it end
+		for (Component* control : engagedChildren)
+			queue(control);
+
+		// Children receiving frame events
+		int ownFrameEvents = receivesFrameEvents ? 1 : 0;
+		if (frameEventCount > ownFrameEvents)
+		{
+			for (std::shared_ptr<Component>& control : childComponents)
+				if (control->frameEventCount > 0)
+					queue(control.get());
+		}
+
+		// Process children, remembering those which still hold mouse state
+		engagedChildren.clear();
+		for (Component* control : eventTargets)
+		{
+			control->processEvents(aInput);
+
+			if (control->hasMouseState())
+				engagedChildren.push_back(control);
+		}
+	}
+
+	bool Component::hasMouseState() const
+	{
+		return mouseOver || mousePressDown || mousePressUp || active;
+	}
+
+	void Component::setReceivesFrameEvents(bool aReceive)
+	{
+		if (receivesFrameEvents == aReceive)
+			return;
+
+		receivesFrameEvents = aReceive;
+		adjustFrameEventCount(aReceive ? 1 : -1);
+	}
+
+	// Update frame event counts for this component and all its ancestors
+	void Component::adjustFrameEventCount(int aDelta)
+	{
+		for (Component* control = this; control != nullptr; control = control->parent)
+			control->frameEventCount += aDelta;
+	}
+
+
+	// Current event pass
+	unsigned int Component::eventPassCounter = 0;
+
 
 	//
-	// Drawing
+	// Keyboard focus
 	//
 
-	// Draw child Components
-	void Component::drawChildComponents(NVGcontext* aContext)
+	void Component::focus()
+	{
+		requestFocus(this);
+	}
+
+	bool Component::hasFocus() const
+	{
+		return focused;
+	}
+
+	void Component::focusChanged(bool)
+	{
+		// To be overridden by components taking keyboard input
+	}
+
+	void Component::keyboardEvent(const InputEvent&)
+	{
+		// To be overridden by components taking keyboard input
+	}
+
+	// Forward focus changes to the parent, the root window holds the focused component
+	void Component::requestFocus(Component* aComponent)
+	{
+		if (parent != nullptr)
+			parent->requestFocus(aComponent);
+	}
+
+	void Component::releaseFocus(Component* aSubtree)
+	{
+		if (parent != nullptr)
+			parent->releaseFocus(aSubtree);
+	}
+
+
+	//
+	// Invalidation
+	//
+
+	// Screen space clip for the current draw pass
+	Rect Component::drawClip;
+
+	// Release the component's layer, if it has one
+	Component::~Component()
+	{
+		if (layered)
+			LayerCache::remove(this);
+	}
+
+	void* Component::operator new(size_t aSize)
+	{
+		return ComponentArena::allocate(aSize);
+	}
+
+	void Component::operator delete(void* aPointer, size_t aSize)
+	{
+		ComponentArena::deallocate(aPointer, aSize);
+	}
+
+	void Component::setLayered(bool aLayered)
+	{
+		if (layered == aLayered)
+			return;
+
+		layered = aLayered;
+
+		if (layered)
+			LayerCache::add(this);
+		else
+			LayerCache::remove(this);
+
+		invalidate();
+	}
+
+	bool Component::isLayered() const
 	{
-		// Draw child Components in order of draw priority
-		std::vector<std::shared_ptr<Component>> drawStack;
-		for (std::shared_ptr<Component> control : childComponents)
-			drawStack.push_back(control);
+		return layered;
+	}
 
+	void Component::renderLayer(NVGcontext* aContext)
+	{
+		// Draw at the layer's origin, with the whole layer as the draw clip
+		Rect frameClip = drawClip;
+		drawClip = screenRect;
 
-		// Sort child Components by draw 'zOrder'
-		std::sort(drawStack.begin(), drawStack.end(), [](const std::shared_ptr<Component>& a, const std::shared_ptr<Component>& b) {
-			return a->zOrder < b->zOrder;
-		});
+		Draw::Translate(aContext, -location.x, -location.y);
+		onFrame(aContext);
+		Draw::Flush(aContext);
+
+		drawClip = frameClip;
+	}
+
+	// Mark the component's screen area as needing to be redrawn
+	void Component::invalidate()
+	{
+		dirty = true;
+		invalidateRect(getScreenRect());
+	}
+
+	bool Component::isDirty() const
+	{
+		return dirty;
+	}
+
+	// Forward damage to the parent, the root window accumulates it
+	void Component::invalidateRect(const Rect& aRect)
+	{
+		// Damage within a layered subtree means its layer has to be rendered again
+		if (layered)
+			LayerCache::invalidate(this);
 
+		if (parent != nullptr)
+			parent->invalidateRect(aRect);
+	}
+
+	void Component::setContainerLayout(const ContainerLayout& aLayout)
+	{
+		containerLayout = aLayout;
+		invalidateLayout();
+	}
+
+	const ContainerLayout& Component::getContainerLayout() const
+	{
+		return containerLayout;
+	}
+
+	void Component::setFlex(float aFlex)
+	{
+		if (flex == aFlex)
+			return;
+
+		flex = aFlex;
+		invalidateLayout();
+	}
+
+	float Component::getFlex() const
+	{
+		return flex;
+	}
+
+	void Component::invalidateLayout()
+	{
+		scheduleLayout();
+	}
+
+	// Forward layout requests to the parent, the root window runs the pass
+	void Component::scheduleLayout()
+	{
+		if (parent != nullptr)
+			parent->scheduleLayout();
+	}
+
+	void Component::sizeChanged()
+	{
+		// Anchored or contained children depend on this size, and container siblings on each other's
+		if (!childComponents.empty() || (parent != nullptr && parent->containerLayout.type != ContainerLayout::Type::None))
+			invalidateLayout();
+	}
+
+	void Component::requestWakeUp(double aTime)
+	{
+		scheduleWakeUp(aTime);
+	}
+
+	// Forward wake up requests to the parent, the root window keeps the earliest
+	void Component::scheduleWakeUp(double aTime)
+	{
+		if (parent != nullptr)
+			parent->scheduleWakeUp(aTime);
+	}
+
+
+	//
+	// Drawing
+	//
+
+	// Draw child Components
+	void Component::drawChildComponents(NVGcontext* aContext)
+	{
 		// Set scissor rectangle to the size of the this component
 		drawBounds[0] = location.x;
 		drawBounds[1] = location.y;
@@ -461,21 +995,34 @@ namespace Lemur
 		}
 
 
+		// Screen offset of this component, used to clip children against the damaged area
+		Vector2 offset = getOffset();
+
+		// Children change the scissor, keep the caller's for anything it draws after them
+		Draw::Save(aContext);
+
 		// Translate by location
 		Draw::Translate(aContext, location.x, location.y);
 
-		// Update child UI Components
-		for (std::shared_ptr<Component> control : drawStack)
+		// Update child UI Components in order of draw priority
+		for (Component* control : drawOrder)
 		{
+			// Skip children that lie entirely outside the damaged area
+			if (!control->screenRect.intersects(drawClip))
+				continue;
+
 			// Set draw boundary to the size of the this component
-			nvgScissor(aContext, drawBounds[0]-location.x, drawBounds[1]-location.y, drawBounds[2], drawBounds[3]);
+			Draw::Scissor(aContext, drawBounds[0]-location.x, drawBounds[1]-location.y, drawBounds[2], drawBounds[3]);
+
+			// Clip to the damaged area
+			Draw::IntersectScissor(aContext, drawClip.x - offset.x, drawClip.y - offset.y, drawClip.width, drawClip.height);
 			
 			// Invoke onFrame for the child component
 			control->invokeOnFrame(aContext);
 		}
 
-		// Translate back
-		Draw::Translate(aContext, -location.x, -location.y);
+		// Restore the caller's translation and scissor
+		Draw::Restore(aContext);
 
 	}
 
@@ -20,6 +20,11 @@
 #include "draw.h"
 #include "core.h"
 #include "input.h"
+#include "input_queue.h"
+#include "hit_grid.h"
+#include "layer_cache.h"
+#include "component_arena.h"
+#include "layout.h"
 #include <nanovg.h>
 
 namespace Lemur
@@ -43,6 +48,9 @@ namespace Lemur
 
 	class Component
 	{
+		friend class LayoutEngine;
+		friend class Window;
+
 	protected:
 		// Mouse state
 		bool mouseOver = false;
@@ -55,18 +63,73 @@ namespace Lemur
 		Anchor anchor[4] = { Anchor(), Anchor(), Anchor(), Anchor() };
 
 		// Parent-child relationship
-		Component* parent;											// Parent container control for the control.
+		Component* parent = nullptr;								// Parent container control for the control.
 		std::vector<std::shared_ptr<Component>> childComponents;	// Child Components
+		std::vector<Component*> drawOrder;							// Child Components sorted by zOrder, kept in step with childComponents
+
+		// Event routing
+		HitGrid hitGrid;											// Spatial index of child bounds for hit testing
+		std::vector<Component*> engagedChildren;					// Children holding mouse state from the last frame
+		std::vector<Component*> eventTargets;						// Children to process this frame
+		unsigned int eventPass = 0;									// Last event pass this component was queued in
+		static unsigned int eventPassCounter;						// Current event pass
+		bool receivesFrameEvents = false;							// Call actionEvents every frame, not just on mouse changes
+		int frameEventCount = 0;									// Components in this subtree receiving frame events
+		bool focused = false;										// Receives keyboard events, set by the root window
 
 		// Component properties
 		Vector2 location = { 0,0 };			// Location of Component
 		Vector2 size = { 50,50 };			// Size of Component
 
 		// Event Handling
-		bool active;						// Control is active or inactive.
+		bool active = false;				// Control is active or inactive.
+
+		// Draw order
+		int zOrder = 0;						// Z-order of the control within its container.
 
 		// Rendering properties
 		float drawBounds[4] = { 0,0,0,0 };	// Bounds of the control for rendering.
+		Rect screenRect = { 0,0,50,50 };	// Cached screen space bounds, kept in step with location and size.
+		bool dirty = true;					// Component needs to be redrawn.
+		bool layered = false;				// Subtree is cached in an offscreen layer.
+
+		// Layout properties
+		ContainerLayout containerLayout;	// How children are positioned
+		float flex = 0;						// Share of the free space in a row or column container, 0 keeps the size
+
+		// Screen space clip for the current draw pass, set by the root window
+		static Rect drawClip;
+
+		// Mark a screen space rect as needing to be redrawn, forwarded up to the root
+		virtual void invalidateRect(const Rect& aRect);
+
+		// Schedule the event loop to wake at a time (glfwGetTime), forwarded up to the root
+		virtual void scheduleWakeUp(double aTime);
+
+		// Schedule a layout pass before the next frame, forwarded up to the root
+		virtual void scheduleLayout();
+
+		// Move keyboard focus to a component, or take it from a subtree being removed, forwarded up to the root
+		virtual void requestFocus(Component* aComponent);
+		virtual void releaseFocus(Component* aSubtree);
+
+		// Request layout after a size change that children or siblings depend on
+		void sizeChanged();
+
+		// Update cached screen bounds
+		void updateScreenRect();
+		void updateScreenSize();
+		void refreshScreenRect();
+
+		// Event routing helpers
+		bool hasMouseState() const;
+		void adjustFrameEventCount(int aDelta);
+		void detachChild(int aIndex);
+
+		// Draw order helpers
+		void insertDrawOrder(Component* aChild);
+		void removeDrawOrder(Component* aChild);
+		void processChildEvents(InputMap* aInput);
 
 	public:
 
@@ -84,7 +147,6 @@ namespace Lemur
 		bool enabled = true;				// Control is enabled or disabled.
 		bool show;							// Visible or hidden.
 		int tabIndex;						// Tab order of the control within its container.
-		int zOrder = 0;						// Z-order of the control within its container.
 
 		// Text properties
 		std::string text;					// Text associated with the control.
@@ -93,7 +155,11 @@ namespace Lemur
 		ResourceManager* resourceManager;	// Pointer to injected resource manager.
 
 		// Destructor
-		virtual ~Component() = default;		// Default destructor
+		virtual ~Component();
+
+		// Components are allocated from the component arena, sized by their dynamic type on delete
+		static void* operator new(size_t aSize);
+		static void operator delete(void* aPointer, size_t aSize);
 
 		// Virtual Functions
 		virtual void onFrame(NVGcontext* aContext) = 0;
@@ -110,7 +176,12 @@ namespace Lemur
 		void setWidth(int aWidth);
 		void setHeight(int aHeight);
 		void setName(std::string aName);
+		void setBackColour(Colour aColour);
+		void setForeColour(Colour aColour);
+		void setStroke(Colour aColour);
+		void setZOrder(int aZOrder);
 		Vector2 getOffset() const;
+		Rect getScreenRect() const;
 
 		// Getters
 		std::string getText();
@@ -121,6 +192,7 @@ namespace Lemur
 		int getWidth() const;
 		int getHeight() const;
 		bool isActive() const;
+		int getZOrder() const;
 		Component* getParent() const;
 
 		// Mouse Events
@@ -140,12 +212,51 @@ namespace Lemur
 		virtual void addChildControl(Component* aChild);
 		Component* getChildByName(std::string name);
 
+		// Remove a child, deleting it unless it is still referenced elsewhere
+		void removeChildControl(Component* aChild);
+
+		// Position of a child among its siblings, which orders row, column and grid layouts. -1 if not a child.
+		int getChildIndex(const Component* aChild) const;
+		void setChildIndex(Component* aChild, int aIndex);
+
 		// Event Handling
 		virtual void processEvents(InputMap* aInput) final;
+		void setReceivesFrameEvents(bool aReceive);
 		virtual void actionEvents(InputMap* aInput) = 0;
 
+		// Keyboard focus. Key and character events go to the focused component, in the order received.
+		void focus();
+		bool hasFocus() const;
+		virtual void focusChanged(bool aFocused);
+		virtual void keyboardEvent(const InputEvent& aEvent);
+
+		// Invalidation
+		void invalidate();
+		bool isDirty() const;
+
+		// Request the event loop to run again at a time (glfwGetTime). Requests last for one frame,
+		// so animating components should request again from actionEvents each frame.
+		void requestWakeUp(double aTime);
+
+		// Layout
+		void setContainerLayout(const ContainerLayout& aLayout);
+		const ContainerLayout& getContainerLayout() const;
+		void setFlex(float aFlex);
+		float getFlex() const;
+
+		// Lay the tree out again before the next frame. Geometry set directly is kept until then.
+		void invalidateLayout();
+
 		// Drawing
 		void drawChildComponents(NVGcontext* aContext);
+
+		// Cache this component and its children in an offscreen layer, drawn as one image until
+		// something in the subtree is invalidated. Suited to large, mostly static panels.
+		void setLayered(bool aLayered);
+		bool isLayered() const;
+
+		// Draw the subtree into the current layer framebuffer, called by LayerCache
+		void renderLayer(NVGcontext* aContext);
 	};
 
 } // namespace Lemur
@@ -0,0 +1,171 @@
+#ifndef LEMUR_COMPONENT_ARENA_CPP
+#define LEMUR_COMPONENT_ARENA_CPP
+
+/**************************************************************************************
+* Lemur:        Component Arena Class                                                 *
+*-------------------------------------------------------------------------------------*
+* Filename:     ComponentArena.cpp                                                    *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Slab allocator for components. Widget classes declaring their own operators       *
+*   have a pool each, so they are packed into large chunks with others of their       *
+*   kind rather than scattered across the heap. Other objects share pools by size.    *
+*   Freed blocks are reused by the next allocation from the same pool.                *
+***************************************************************************************/
+
+
+
+#include <new>
+#include "component_arena.h"
+
+
+namespace Lemur
+{
+	ComponentArena::Pool ComponentArena::pools[ComponentArena::POOL_COUNT] = {};
+	ComponentArena::Pool* ComponentArena::typedPools = nullptr;
+	size_t ComponentArena::heapBlocks = 0;
+
+	void ComponentArena::grow(Pool& aPool, size_t aBlockSize)
+	{
+		// At least one block, however large
+		size_t chunkSize = CHUNK_SIZE;
+		if (chunkSize < sizeof(Chunk) + aBlockSize)
+			chunkSize = sizeof(Chunk) + aBlockSize;
+
+		Chunk* chunk = static_cast<Chunk*>(::operator new(chunkSize));
+		chunk->next = aPool.chunks;
+		chunk->size = chunkSize;
+		aPool.chunks = chunk;
+		aPool.chunkCount++;
+
+		// Blocks are handed out in address order, so objects created together sit together
+		aPool.next = reinterpret_cast<char*>(chunk) + sizeof(Chunk);
+		aPool.end = reinterpret_cast<char*>(chunk) + chunkSize;
+	}
+
+	void* ComponentArena::allocateFrom(Pool& aPool, size_t aBlockSize)
+	{
+		void* block;
+		if (aPool.freeList != nullptr)
+		{
+			block = aPool.freeList;
+			aPool.freeList = aPool.freeList->next;
+		}
+		else
+		{
+			if (aPool.next == nullptr || aPool.next + aBlockSize > aPool.end)
+				grow(aPool, aBlockSize);
+
+			block = aPool.next;
+			aPool.next += aBlockSize;
+		}
+
+		aPool.liveBlocks++;
+		return block;
+	}
+
+	void ComponentArena::deallocateTo(Pool& aPool, void* aPointer)
+	{
+		FreeBlock* block = static_cast<FreeBlock*>(aPointer);
+		block->next = aPool.freeList;
+		aPool.freeList = block;
+		aPool.liveBlocks--;
+	}
+
+	void* ComponentArena::allocate(size_t aSize)
+	{
+		if (aSize == 0)
+			aSize = 1;
+
+#ifdef LEMUR_NO_ARENA
+		heapBlocks++;
+		return ::operator new(aSize);
+#else
+		if (aSize > MAX_POOLED_SIZE)
+		{
+			heapBlocks++;
+			return ::operator new(aSize);
+		}
+
+		size_t index = (aSize - 1) / GRANULARITY;
+		return allocateFrom(pools[index], (index + 1) * GRANULARITY);
+#endif
+	}
+
+	void ComponentArena::deallocate(void* aPointer, size_t aSize)
+	{
+		if (aPointer == nullptr)
+			return;
+
+		if (aSize == 0)
+			aSize = 1;
+
+#ifndef LEMUR_NO_ARENA
+		if (aSize <= MAX_POOLED_SIZE)
+		{
+			deallocateTo(pools[(aSize - 1) / GRANULARITY], aPointer);
+			return;
+		}
+#endif
+
+		heapBlocks--;
+		::operator delete(aPointer);
+	}
+
+	ComponentArena::Stats ComponentArena::getStats()
+	{
+		Stats stats;
+		stats.heapBlocks = heapBlocks;
+
+		auto add = [&stats](const Pool& aPool)
+		{
+			stats.liveBlocks += aPool.liveBlocks;
+			stats.chunks += aPool.chunkCount;
+
+			for (Chunk* chunk = aPool.chunks; chunk != nullptr; chunk = chunk->next)
+				stats.reservedBytes += chunk->size;
+		};
+
+		for (const Pool& pool : pools)
+			add(pool);
+
+		for (Pool* pool = typedPools; pool != nullptr; pool = pool->nextTyped)
+			add(*pool);
+
+		return stats;
+	}
+
+	void ComponentArena::release(Pool& aPool)
+	{
+		if (aPool.liveBlocks != 0)
+			return;
+
+		while (aPool.chunks != nullptr)
+		{
+			Chunk* next = aPool.chunks->next;
+			::operator delete(aPool.chunks);
+			aPool.chunks = next;
+		}
+
+		// Class pools stay registered
+		aPool.freeList = nullptr;
+		aPool.next = nullptr;
+		aPool.end = nullptr;
+		aPool.chunkCount = 0;
+	}
+
+	void ComponentArena::trim()
+	{
+		for (Pool& pool : pools)
+			release(pool);
+
+		for (Pool* pool = typedPools; pool != nullptr; pool = pool->nextTyped)
+			release(*pool);
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_COMPONENT_ARENA_CPP
@@ -0,0 +1,189 @@
+#ifndef LEMUR_COMPONENT_ARENA_H
+#define LEMUR_COMPONENT_ARENA_H
+
+/**************************************************************************************
+* Lemur:        Component Arena Class                                                 *
+*-------------------------------------------------------------------------------------*
+* Filename:     ComponentArena.h                                                      *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Slab allocator for components. Widget classes declaring their own operators       *
+*   have a pool each, so they are packed into large chunks with others of their       *
+*   kind rather than scattered across the heap. Other objects share pools by size.    *
+*   Freed blocks are reused by the next allocation from the same pool.                *
+*                                                                                     *
+* Notes:                                                                              *
+*   Not thread safe, components are created and destroyed on the UI thread.           *
+*   Chunks are kept for reuse until trim() is called.                                 *
+*   Define LEMUR_NO_ARENA to allocate every object from the heap, for comparison.     *
+***************************************************************************************/
+
+
+
+#include <cstddef>
+
+
+namespace Lemur
+{
+	class ComponentArena
+	{
+	private:
+
+		// Pool limits
+		static const size_t GRANULARITY = 16;					// Block sizes are rounded up to this, also their alignment
+		static const size_t MAX_POOLED_SIZE = 4096;				// Larger objects are allocated from the heap
+		static const size_t CHUNK_SIZE = 64 * 1024;				// Bytes requested from the heap at once
+		static const size_t POOL_COUNT = MAX_POOLED_SIZE / GRANULARITY;
+
+		// Header at the start of each chunk, padded so blocks keep their alignment
+		struct alignas(16) Chunk
+		{
+			Chunk* next;
+			size_t size;				// Bytes including the header
+		};
+
+		// Freed block, linked through its own storage
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+		// Blocks of a single size
+		struct Pool
+		{
+			Chunk* chunks;				// Chunks owned by the pool
+			FreeBlock* freeList;		// Freed blocks, reused first
+			char* next;					// Unused space in the newest chunk
+			char* end;
+			size_t liveBlocks;			// Blocks currently allocated
+			size_t chunkCount;
+			size_t blockSize;			// Set when a class pool is first used
+			Pool* nextTyped;			// Class pools are linked for stats and trimming
+		};
+
+		// Plain data so the pools are usable during static initialisation and destruction
+		static Pool pools[POOL_COUNT];
+		static Pool* typedPools;
+		static size_t heapBlocks;
+
+		static size_t roundUp(size_t aSize) { return (aSize == 0) ? GRANULARITY : (aSize + GRANULARITY - 1) / GRANULARITY * GRANULARITY; }
+
+		// Add a chunk to a pool
+		static void grow(Pool& aPool, size_t aBlockSize);
+
+		// Take and return blocks of a pool
+		static void* allocateFrom(Pool& aPool, size_t aBlockSize);
+		static void deallocateTo(Pool& aPool, void* aPointer);
+
+		// Return a pool's chunks to the heap if it has no live objects
+		static void release(Pool& aPool);
+
+		// Pool of a single class, registered on first use
+		template <typename T>
+		static Pool& getTypedPool();
+
+	public:
+
+		// Arena usage
+		struct Stats
+		{
+			size_t liveBlocks = 0;		// Pooled objects currently allocated
+			size_t heapBlocks = 0;		// Objects too large to pool
+			size_t chunks = 0;			// Chunks held by the pools
+			size_t reservedBytes = 0;	// Memory held by the chunks
+		};
+
+		// Allocate and free storage for an object, the size must match on free
+		static void* allocate(size_t aSize);
+		static void deallocate(void* aPointer, size_t aSize);
+
+		// Allocate and free from the pool of class T. Subclasses which don't declare their own operators
+		// are larger, and are given blocks from the size pools instead.
+		template <typename T>
+		static void* allocate(size_t aSize);
+		template <typename T>
+		static void deallocate(void* aPointer, size_t aSize);
+
+		static Stats getStats();
+
+		// Return the chunks of pools with no live objects to the heap
+		static void trim();
+	};
+
+
+	template <typename T>
+	ComponentArena::Pool& ComponentArena::getTypedPool()
+	{
+		// Zero initialised before any constructor runs, like the size pools
+		static Pool pool;
+
+		if (pool.blockSize == 0)
+		{
+			pool.blockSize = roundUp(sizeof(T));
+			pool.nextTyped = typedPools;
+			typedPools = &pool;
+		}
+
+		return pool;
+	}
+
+	template <typename T>
+	void* ComponentArena::allocate(size_t aSize)
+	{
+#ifndef LEMUR_NO_ARENA
+		if (sizeof(T) <= MAX_POOLED_SIZE && roundUp(aSize) == roundUp(sizeof(T)))
+		{
+			Pool& pool = getTypedPool<T>();
+			return allocateFrom(pool, pool.blockSize);
+		}
+#endif
+
+		return allocate(aSize);
+	}
+
+	template <typename T>
+	void ComponentArena::deallocate(void* aPointer, size_t aSize)
+	{
+#ifndef LEMUR_NO_ARENA
+		if (aPointer != nullptr && sizeof(T) <= MAX_POOLED_SIZE && roundUp(aSize) == roundUp(sizeof(T)))
+		{
+			deallocateTo(getTypedPool<T>(), aPointer);
+			return;
+		}
+#endif
+
+		deallocate(aPointer, aSize);
+	}
+
+
+	// Standard allocator over the arena, used for shared_ptr control blocks
+	template <typename T>
+	struct ArenaAllocator
+	{
+		using value_type = T;
+
+		ArenaAllocator() = default;
+
+		template <typename U>
+		ArenaAllocator(const ArenaAllocator<U>&) {}
+
+		T* allocate(size_t aCount)
+		{
+			return static_cast<T*>(ComponentArena::allocate(aCount * sizeof(T)));
+		}
+
+		void deallocate(T* aPointer, size_t aCount)
+		{
+			ComponentArena::deallocate(aPointer, aCount * sizeof(T));
+		}
+
+		template <typename U>
+		bool operator==(const ArenaAllocator<U>&) const { return true; }
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_COMPONENT_ARENA_H
@@ -19,6 +19,7 @@
 #include "component.h"
 #include "button.h"
 #include "label.h"
+#include "list_view.h"
 #include "panel.h"
 #include "tab_view.h"
 #include "textbox.h"
@@ -26,6 +26,7 @@
 #include "colour.h"
 #include "font.h"
 #include "image.h"
+#include "rect.h"
 #include "vector2.h"
 #include "resource_manager.h"
 
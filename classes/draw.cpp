@@ -15,86 +15,314 @@
 
 
 
+#include <unordered_map>
 #include "Draw.h"
+#include "text_cache.h"
 
 namespace Lemur
 {
-	void Draw::Line(NVGcontext* aContext, float aX1, float aY1, float aX2, float aY2, float thickness, Colour aColour)
+	// Pending batch state
+	NVGcontext* Draw::batchContext = nullptr;
+	Draw::BatchType Draw::batchType = Draw::BatchType::None;
+	NVGcolor Draw::batchColour;
+	float Draw::batchStrokeWidth = 0;
+
+	// Statistics
+	Draw::BatchStats Draw::frameStats;
+	Draw::BatchStats Draw::lastFrameStats;
+	NVGtextAtlasStats Draw::lastAtlasStats = {};
+
+	// Renderer callbacks wrapped by the statistics hooks, per context. The hooks are only given the
+	// renderer's user pointer, which is unique to each context, so the callbacks are kept by it.
+	static std::unordered_map<void*, NVGparams> hookedParams;
+	static Draw::BatchStats* hookStats = nullptr;
+
+	// Frames usually draw to one context, so the last lookup is kept
+	static void* lastHookedPtr = nullptr;
+	static const NVGparams* lastHookedParams = nullptr;
+
+	static const NVGparams& getHookedParams(void* uptr)
+	{
+		if (uptr != lastHookedPtr || lastHookedParams == nullptr)
+		{
+			lastHookedParams = &hookedParams.at(uptr);
+			lastHookedPtr = uptr;
+		}
+		return *lastHookedParams;
+	}
+
+	static void countRenderFill(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe, const float* bounds, const NVGpath* paths, int npaths)
+	{
+		hookStats->renderCalls++;
+		hookStats->paths += npaths;
+		for (int i = 0; i < npaths; i++)
+			hookStats->vertices += paths[i].nfill + paths[i].nstroke;
+
+		getHookedParams(uptr).renderFill(uptr, paint, compositeOperation, scissor, fringe, bounds, paths, npaths);
+	}
+
+	static void countRenderStroke(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe, float strokeWidth, const NVGpath* paths, int npaths)
+	{
+		hookStats->renderCalls++;
+		hookStats->paths += npaths;
+		for (int i = 0; i < npaths; i++)
+			hookStats->vertices += paths[i].nstroke;
+
+		getHookedParams(uptr).renderStroke(uptr, paint, compositeOperation, scissor, fringe, strokeWidth, paths, npaths);
+	}
+
+	static void countRenderTriangles(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, const NVGvertex* verts, int nverts, float fringe)
+	{
+		hookStats->renderCalls++;
+		hookStats->vertices += nverts;
+
+		getHookedParams(uptr).renderTriangles(uptr, paint, compositeOperation, scissor, verts, nverts, fringe);
+	}
+
+	static void countRenderFlush(void* uptr)
+	{
+		hookStats->flushes++;
+
+		getHookedParams(uptr).renderFlush(uptr);
+	}
+
+
+	//
+	// Batching
+	//
+
+	void Draw::InstallRenderHooks(NVGcontext* aContext)
+	{
+		NVGparams* params = nvgInternalParams(aContext);
+
+		// Already routed through the counters, wrapping again would call the hooks from themselves
+		if (params->renderFill == countRenderFill)
+			return;
+
+		// Keep the renderer's own callbacks and route through the counters
+		hookedParams[params->userPtr] = *params;
+		hookStats = &frameStats;
+
+		params->renderFill = countRenderFill;
+		params->renderStroke = countRenderStroke;
+		params->renderTriangles = countRenderTriangles;
+		params->renderFlush = countRenderFlush;
+	}
+
+	void Draw::RemoveRenderHooks(NVGcontext* aContext)
+	{
+		NVGparams* params = nvgInternalParams(aContext);
+
+		auto it = hookedParams.find(params->userPtr);
+		if (it == hookedParams.end() || params->renderFill != countRenderFill)
+			return;
+
+		params->renderFill = it->second.renderFill;
+		params->renderStroke = it->second.renderStroke;
+		params->renderTriangles = it->second.renderTriangles;
+		params->renderFlush = it->second.renderFlush;
+		hookedParams.erase(it);
+
+		lastHookedPtr = nullptr;
+		lastHookedParams = nullptr;
+	}
+
+	void Draw::BeginFrame(NVGcontext* aContext)
+	{
+		InstallRenderHooks(aContext);
+
+		batchContext = nullptr;
+		batchType = BatchType::None;
+		frameStats = BatchStats();
+	}
+
+	void Draw::EndFrame(NVGcontext* aContext)
+	{
+		Flush(aContext);
+
+		// Atlas counters are totals, the frame's share is the change since the last frame
+		NVGtextAtlasStats atlasStats;
+		nvgTextAtlasStats(aContext, &atlasStats);
+		frameStats.glyphLookups = atlasStats.lookups - lastAtlasStats.lookups;
+		frameStats.glyphHits = atlasStats.hits - lastAtlasStats.hits;
+		frameStats.glyphsRasterized = atlasStats.rasterized - lastAtlasStats.rasterized;
+		frameStats.atlasEvictions = atlasStats.evictions - lastAtlasStats.evictions;
+		frameStats.atlasPages = atlasStats.pages;
+		frameStats.atlasOccupancy = atlasStats.totalArea > 0 ? static_cast<float>(atlasStats.usedArea) / atlasStats.totalArea : 0;
+		lastAtlasStats = atlasStats;
+
+		lastFrameStats = frameStats;
+	}
+
+	const Draw::BatchStats& Draw::GetStats()
 	{
+		return lastFrameStats;
+	}
+
+	bool Draw::Batch(NVGcontext* aContext, BatchType aType, const Colour& aColour, float aStrokeWidth)
+	{
+		frameStats.primitives++;
+
+		// Fully transparent primitives draw nothing
+		if (aColour.getAlpha() == 0)
+			return false;
+
+		NVGcolor colour = aColour.asNvgColour();
+
+		// Same paint as the pending batch, keep adding to the path
+		if (batchContext == aContext && batchType == aType && batchStrokeWidth == aStrokeWidth &&
+			batchColour.r == colour.r && batchColour.g == colour.g && batchColour.b == colour.b && batchColour.a == colour.a)
+			return true;
+
+		Flush(batchContext);
+
 		nvgBeginPath(aContext);
+		batchContext = aContext;
+		batchType = aType;
+		batchColour = colour;
+		batchStrokeWidth = aStrokeWidth;
+
+		return true;
+	}
+
+	void Draw::Flush(NVGcontext* aContext)
+	{
+		if (batchType == BatchType::None || batchContext == nullptr || batchContext != aContext)
+			return;
+
+		if (batchType == BatchType::Fill)
+		{
+			nvgFillColor(batchContext, batchColour);
+			nvgFill(batchContext);
+		}
+		else
+		{
+			nvgStrokeColor(batchContext, batchColour);
+			nvgStrokeWidth(batchContext, batchStrokeWidth);
+			nvgStroke(batchContext);
+		}
+
+		frameStats.batches++;
+		batchType = BatchType::None;
+		batchContext = nullptr;
+	}
+
+
+	//
+	// State changes
+	//
+
+	void Draw::Scissor(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight)
+	{
+		Flush(aContext);
+		nvgScissor(aContext, aX, aY, aWidth, aHeight);
+	}
+
+	void Draw::IntersectScissor(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight)
+	{
+		Flush(aContext);
+		nvgIntersectScissor(aContext, aX, aY, aWidth, aHeight);
+	}
+
+	void Draw::Save(NVGcontext* aContext)
+	{
+		Flush(aContext);
+		nvgSave(aContext);
+	}
+
+	void Draw::Restore(NVGcontext* aContext)
+	{
+		Flush(aContext);
+		nvgRestore(aContext);
+	}
+
+
+	//
+	// Primitives
+	//
+
+	void Draw::Line(NVGcontext* aContext, float aX1, float aY1, float aX2, float aY2, float thickness, Colour aColour)
+	{
+		if (!Batch(aContext, BatchType::Stroke, aColour, thickness))
+			return;
+
 		nvgMoveTo(aContext, aX1, aY1);
 		nvgLineTo(aContext, aX2, aY2);
-		nvgStrokeWidth(aContext, thickness);
-		nvgStrokeColor(aContext, aColour.asNvgColour());
-		nvgStroke(aContext);
-		nvgClosePath(aContext);
 	}
 
 	void Draw::Rect(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight, const Colour aColour)
 	{
-		nvgBeginPath(aContext);
-		nvgMoveTo(aContext, aX, aY);
+		if (!Batch(aContext, BatchType::Fill, aColour, 0))
+			return;
+
 		nvgRect(aContext, aX, aY, aWidth, aHeight);
-		nvgFillColor(aContext, aColour.asNvgColour());
-		nvgFill(aContext);
-		nvgClosePath(aContext);
 	}
 
 	void Draw::RectStroke(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight, float aWeight, const Colour aColour)
 	{
-		nvgBeginPath(aContext);
+		if (!Batch(aContext, BatchType::Stroke, aColour, aWeight))
+			return;
+
 		nvgRect(aContext, aX, aY, aWidth, aHeight);
-		nvgStrokeColor(aContext, aColour.asNvgColour());
-		nvgStrokeWidth(aContext, aWeight);
-		nvgStroke(aContext);
-		nvgClosePath(aContext);
 	}
 
 	void Draw::RoundedRect(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight, float aRadius, const Colour aColour)
 	{
-		nvgBeginPath(aContext);
+		if (!Batch(aContext, BatchType::Fill, aColour, 0))
+			return;
+
 		nvgRoundedRect(aContext, aX, aY, aWidth, aHeight, aRadius);
-		nvgFillColor(aContext, aColour.asNvgColour());
-		nvgFill(aContext);
-		nvgClosePath(aContext);
 	}
 
 	void Draw::RoundedRectStroke(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight, float aRadius, float aWeight, const Colour aColour)
 	{
-		nvgBeginPath(aContext);
+		if (!Batch(aContext, BatchType::Stroke, aColour, aWeight))
+			return;
+
 		nvgRoundedRect(aContext, aX, aY, aWidth, aHeight, aRadius);
-		nvgStrokeColor(aContext, aColour.asNvgColour());
-		nvgStrokeWidth(aContext, aWeight);
-		nvgStroke(aContext);
-		nvgClosePath(aContext);
 	}
 
 	void Draw::Text(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight, const TextStyle* aStyle, const char* text)
 	{
-		nvgBeginPath(aContext);
+		// Text is rendered immediately, submit anything drawn before it
+		Flush(aContext);
+		frameStats.primitives++;
+		frameStats.batches++;
+
+		// Nothing to draw until the font is loaded
+		if (aStyle->font == nullptr || !aStyle->font->isLoaded())
+			return;
+
+		// Cached measurement of the string
+		std::shared_ptr<const TextLayout> layout = TextCache::get(aContext, aStyle->font->getId(), aStyle->size, 0, text);
+
 		nvgFillColor(aContext, aStyle->colour.asNvgColour());
-		nvgFill(aContext);
 		nvgFontSize(aContext, aStyle->size);
-		nvgFontFace(aContext, aStyle->font);
+		nvgFontFaceId(aContext, aStyle->font->getId());
 
 		// Set text alignment - TODO: Add support for vertical alignment
+		float anchorX = aX + aWidth / 2;
+		int align = NVG_ALIGN_CENTER;
+
 		if (aStyle->align.getAlign() & Align::LEFT)
 		{
-			nvgTextAlign(aContext, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
-			nvgText(aContext, aX, aY + aHeight / 2, text, nullptr);
+			anchorX = aX;
+			align = NVG_ALIGN_LEFT;
 		}
 		else if (aStyle->align.getAlign() & Align::RIGHT)
 		{
-			nvgTextAlign(aContext, NVG_ALIGN_RIGHT | NVG_ALIGN_MIDDLE);
-			nvgText(aContext, aX + aWidth / 2, aY + aHeight / 2, text, nullptr);
+			align = NVG_ALIGN_RIGHT;
 		}
-		else
+
+		// Align from the cached advance, so NanoVG doesn't measure the string again before drawing it
+		if (layout != nullptr && align != NVG_ALIGN_LEFT)
 		{
-			nvgTextAlign(aContext, NVG_ALIGN_CENTER | NVG_ALIGN_MIDDLE);
-			nvgText(aContext, aX + aWidth / 2, aY + aHeight / 2, text, nullptr);
+			anchorX -= (align == NVG_ALIGN_RIGHT) ? layout->advance : layout->advance * 0.5f;
+			align = NVG_ALIGN_LEFT;
 		}
-		
-		nvgClosePath(aContext);
+
+		nvgTextAlign(aContext, align | NVG_ALIGN_MIDDLE);
+		nvgText(aContext, anchorX, aY + aHeight / 2, text, nullptr);
 	}
 
 	void Draw::ResourceImage(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight, Image* aImage)
@@ -105,12 +333,36 @@ namespace Lemur
 
 		if (aImage->getId() != 0)
 		{
+			// Image paint can't join a colour batch
+			Flush(aContext);
+			frameStats.primitives++;
+			frameStats.batches++;
+
+			// Atlased images scale the whole page so their sub-rect lands on the drawn rect
+			NVGpaint paint;
+			if (aImage->isAtlased())
+			{
+				float scaleX = aWidth / aImage->getPixelWidth();
+				float scaleY = aHeight / aImage->getPixelHeight();
+				paint = nvgImagePattern(aContext, aX - aImage->getTextureX() * scaleX, aY - aImage->getTextureY() * scaleY,
+					aImage->getTextureWidth() * scaleX, aImage->getTextureHeight() * scaleY, 0, aImage->getId(), 1.0f);
+			}
+			else
+			{
+				paint = nvgImagePattern(aContext, aX, aY, aWidth, aHeight, 0, aImage->getId(), 1.0f);
+			}
+
 			nvgBeginPath(aContext);
 			nvgRect(aContext, aX, aY, aWidth, aHeight);
-			nvgFillPaint(aContext, nvgImagePattern(aContext, aX, aY, aWidth, aHeight, 0, aImage->getId(), 1.0f));
+			nvgFillPaint(aContext, paint);
 			nvgFill(aContext);
 			nvgClosePath(aContext);
 		}
+		else
+		{
+			// Placeholder until an asynchronously imported image is uploaded
+			RoundedRect(aContext, aX, aY, aWidth, aHeight, 2, Colour(128, 128, 128, 60));
+		}
 	}
 
 	void Draw::ResourceImage(NVGcontext* aContext, float aX, float aY, Image* aImage)
@@ -27,7 +27,62 @@ namespace Lemur
 	public:
 
 		// Structures
-		struct TextStyle { int size; const char* font; Colour colour; Align align; };
+		struct TextStyle { int size; const Font* font; Colour colour; Align align; };	// Fonts are resolved by TextStyles
+
+		// Per frame batching statistics
+		struct BatchStats
+		{
+			int primitives = 0;		// Primitives submitted through Draw
+			int batches = 0;		// Paths submitted to NanoVG after merging
+			int renderCalls = 0;	// Fill, stroke and triangle calls reaching the renderer
+			int vertices = 0;		// Vertices reaching the renderer
+			int paths = 0;			// NanoVG paths reaching the renderer
+			int flushes = 0;		// Renderer flushes, each submits the frame's calls to the GPU
+			int glyphLookups = 0;	// Glyph bitmaps requested from the font atlas, including layer frames
+			int glyphHits = 0;		// Requests found in the atlas
+			int glyphsRasterized = 0;	// Glyphs rasterized into the atlas
+			int atlasEvictions = 0;	// Atlas pages evicted to make room
+			int atlasPages = 0;		// Atlas pages in use at the end of the frame
+			float atlasOccupancy = 0;	// Fraction of the atlas pages covered by glyphs
+		};
+
+	private:
+
+		// Kind of path being accumulated
+		enum class BatchType { None, Fill, Stroke };
+
+		// Pending batch state. Consecutive primitives with the same paint are accumulated
+		// into one path and submitted together on the next state change or flush.
+		static NVGcontext* batchContext;
+		static BatchType batchType;
+		static NVGcolor batchColour;
+		static float batchStrokeWidth;
+
+		// Statistics
+		static BatchStats frameStats;
+		static BatchStats lastFrameStats;
+		static NVGtextAtlasStats lastAtlasStats;	// Atlas counters at the end of the last frame
+
+		// Start or continue a batch for the given paint. Returns false if there is nothing to draw.
+		static bool Batch(NVGcontext* aContext, BatchType aType, const Colour& aColour, float aStrokeWidth);
+
+		// Hook the renderer to count calls and vertices
+		static void InstallRenderHooks(NVGcontext* aContext);
+
+	public:
+
+		// Frame management
+		static void BeginFrame(NVGcontext* aContext);
+		static void EndFrame(NVGcontext* aContext);
+		static void Flush(NVGcontext* aContext);
+		static const BatchStats& GetStats();
+		static void RemoveRenderHooks(NVGcontext* aContext);	// Call before deleting a context
+
+		// State changes which end the pending batch
+		static void Scissor(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight);
+		static void IntersectScissor(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight);
+		static void Save(NVGcontext* aContext);
+		static void Restore(NVGcontext* aContext);
 
 		// Methods
 		static void Line(NVGcontext* aContext, float aX1, float aY1, float aX2, float aY2, float thickness, Colour aColour);
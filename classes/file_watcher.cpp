@@ -0,0 +1,225 @@
+#ifndef LEMUR_FILE_WATCHER_CPP
+#define LEMUR_FILE_WATCHER_CPP
+
+/**************************************************************************************
+* Lemur:        File Watcher Class                                                    *
+*-------------------------------------------------------------------------------------*
+* Filename:     FileWatcher.cpp                                                       *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Watches files for changes on a background thread, queueing the paths changed for  *
+*   the render thread to take once per frame.                                         *
+***************************************************************************************/
+
+
+
+#include <filesystem>
+#include "file_watcher.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+namespace Lemur
+{
+	FileWatcher::~FileWatcher()
+	{
+		stop();
+	}
+
+	void FileWatcher::watch(const std::string& aPath)
+	{
+		std::string absolutePath = getAbsolutePath(aPath);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (stopping || files.count(absolutePath) != 0)
+			return;
+
+		files[absolutePath] = { aPath, getWriteTime(absolutePath) };
+
+#ifdef __linux__
+		if (notifyFd == -1)
+		{
+			notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (notifyFd == -1 || pipe(stopPipe) != 0)
+				return;
+		}
+
+		// Watch the directory, as saving by rename replaces the file's inode
+		std::string directory = std::filesystem::path(absolutePath).parent_path().string();
+		int descriptor = inotify_add_watch(notifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (descriptor != -1)
+			directories[descriptor] = directory;
+#endif
+
+		if (!thread.joinable())
+			thread = std::thread(&FileWatcher::watchLoop, this);
+	}
+
+	std::vector<FileWatcher::Change> FileWatcher::takeChanges()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::vector<Change> taken;
+		taken.swap(changes);
+		return taken;
+	}
+
+	void FileWatcher::setWakeUpCallback(std::function<void()> aCallback)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		wakeUpCallback = std::move(aCallback);
+	}
+
+	void FileWatcher::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		condition.notify_all();
+
+#ifdef __linux__
+		if (stopPipe[1] != -1)
+		{
+			char byte = 0;
+			(void)write(stopPipe[1], &byte, 1);
+		}
+#endif
+
+		if (thread.joinable())
+			thread.join();
+
+#ifdef __linux__
+		for (int* fd : { &notifyFd, &stopPipe[0], &stopPipe[1] })
+		{
+			if (*fd != -1)
+				close(*fd);
+
+			*fd = -1;
+		}
+#endif
+	}
+
+	void FileWatcher::addChange(const std::string& aAbsolutePath)
+	{
+		std::function<void()> callback;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			auto file = files.find(aAbsolutePath);
+			if (file == files.end())
+				return;
+
+			for (const Change& change : changes)
+				if (change.path == file->second.path)
+					return;
+
+			changes.push_back({ file->second.path, std::chrono::steady_clock::now() });
+			callback = wakeUpCallback;
+		}
+
+		if (callback)
+			callback();
+	}
+
+#ifdef __linux__
+
+	void FileWatcher::watchLoop()
+	{
+		// Events are aligned to inotify_event, and are followed by their file names
+		alignas(inotify_event) char buffer[4096];
+
+		while (true)
+		{
+			pollfd descriptors[2] = { { notifyFd, POLLIN, 0 }, { stopPipe[0], POLLIN, 0 } };
+			if (poll(descriptors, 2, -1) < 0)
+				continue;
+
+			if (descriptors[1].revents != 0)
+				return;
+
+			ssize_t length;
+			while ((length = read(notifyFd, buffer, sizeof(buffer))) > 0)
+			{
+				for (char* event = buffer; event < buffer + length; )
+				{
+					const inotify_event* notify = reinterpret_cast<const inotify_event*>(event);
+					event += sizeof(inotify_event) + notify->len;
+
+					if (notify->len == 0)
+						continue;
+
+					std::string directory;
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						auto found = directories.find(notify->wd);
+						if (found == directories.end())
+							continue;
+
+						directory = found->second;
+					}
+
+					addChange(directory + "/" + notify->name);
+				}
+			}
+		}
+	}
+
+#else
+
+	void FileWatcher::watchLoop()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (!condition.wait_for(lock, std::chrono::milliseconds(POLL_INTERVAL_MS), [this]() { return stopping; }))
+		{
+			std::vector<std::string> changed;
+
+			for (auto& file : files)
+			{
+				int64_t writeTime = getWriteTime(file.first);
+				if (writeTime == file.second.writeTime)
+					continue;
+
+				// A file being rewritten can be missing briefly, wait until it is back
+				if (writeTime != 0)
+					changed.push_back(file.first);
+
+				file.second.writeTime = writeTime;
+			}
+
+			lock.unlock();
+			for (const std::string& path : changed)
+				addChange(path);
+			lock.lock();
+		}
+	}
+
+#endif
+
+	std::string FileWatcher::getAbsolutePath(const std::string& aPath)
+	{
+		std::error_code error;
+		std::filesystem::path path = std::filesystem::absolute(aPath, error);
+		return error ? aPath : path.lexically_normal().string();
+	}
+
+	int64_t FileWatcher::getWriteTime(const std::string& aPath)
+	{
+		std::error_code error;
+		auto time = std::filesystem::last_write_time(aPath, error);
+		return error ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_FILE_WATCHER_CPP
@@ -0,0 +1,105 @@
+#ifndef LEMUR_FILE_WATCHER_H
+#define LEMUR_FILE_WATCHER_H
+
+/**************************************************************************************
+* Lemur:        File Watcher Class                                                    *
+*-------------------------------------------------------------------------------------*
+* Filename:     FileWatcher.h                                                         *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Watches files for changes on a background thread, queueing the paths changed for  *
+*   the render thread to take once per frame.                                         *
+*                                                                                     *
+* Notes:                                                                              *
+*   On Linux the parent directories are watched with inotify, so editors that save    *
+*   by renaming a temporary file are seen. Elsewhere the write times are polled.      *
+***************************************************************************************/
+
+
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+namespace Lemur
+{
+	class FileWatcher
+	{
+	public:
+
+		// How often write times are checked where inotify isn't available
+		static const int POLL_INTERVAL_MS = 250;
+
+		// A changed file, with when the change was seen
+		struct Change
+		{
+			std::string path;
+			std::chrono::steady_clock::time_point time;
+		};
+
+	private:
+
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool stopping = false;
+
+		// A watched file, by its absolute path
+		struct WatchedFile
+		{
+			std::string path;			// Path as given to watch(), reported in changes
+			int64_t writeTime;			// Last write time, when polling
+		};
+
+		std::unordered_map<std::string, WatchedFile> files;
+		std::vector<Change> changes;
+		std::function<void()> wakeUpCallback;
+
+#ifdef __linux__
+		int notifyFd = -1;
+		int stopPipe[2] = { -1, -1 };
+		std::unordered_map<int, std::string> directories;		// Watch descriptors to directory paths
+#endif
+
+		// Wait for changes until stopped
+		void watchLoop();
+
+		// Queue a change to a watched file, once until it is taken
+		void addChange(const std::string& aAbsolutePath);
+
+		static std::string getAbsolutePath(const std::string& aPath);
+		static int64_t getWriteTime(const std::string& aPath);
+
+	public:
+
+		FileWatcher() = default;
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		// Watch a file. The watcher thread is started by the first call.
+		void watch(const std::string& aPath);
+
+		// Take the files changed since the last call
+		std::vector<Change> takeChanges();
+
+		// Called from the watcher thread when a change is queued, to wake an idle event loop
+		void setWakeUpCallback(std::function<void()> aCallback);
+
+		// Stop watching and join the thread
+		void stop();
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_FILE_WATCHER_H
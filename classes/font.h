@@ -23,7 +23,7 @@ namespace Lemur
 	// Font class
 	class Font {
 	private:
-		const int id;
+		int id;
 		const char* name;
 		const char* filePath;
 
@@ -35,6 +35,11 @@ namespace Lemur
 		const char* getName() const { return name; }
 		const char* getFilePath() const { return filePath; }
 		int getId() const { return id; }
+		void setFilePath(const char* aFilePath) { filePath = aFilePath; }
+
+		// Fonts imported asynchronously have an id of -1 until they are uploaded
+		bool isLoaded() const { return id >= 0; }
+		void setId(int aId) { id = aId; }
 	};
 
 } // namespace Lemur
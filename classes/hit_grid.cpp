@@ -0,0 +1,132 @@
+#ifndef LEMUR_HIT_GRID_CPP
+#define LEMUR_HIT_GRID_CPP
+
+/**************************************************************************************
+* Lemur:        Hit Test Grid Class                                                   *
+*-------------------------------------------------------------------------------------*
+* Filename:     HitGrid.cpp                                                           *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   A uniform grid over a container's children, used to find the children under a    *
+*   point without testing every child.                                                *
+***************************************************************************************/
+
+
+
+#include <cmath>
+#include "hit_grid.h"
+#include "component.h"
+
+
+namespace Lemur
+{
+	// Child bounds in container space, padded by a pixel to cover integer rounding in the exact hit test
+	static Rect getChildBounds(const Component* aChild)
+	{
+		Vector2 location = aChild->getLocation();
+		Vector2 size = aChild->getSize();
+		return Rect(location.x - 1, location.y - 1, size.x + 2, size.y + 2);
+	}
+
+
+	void HitGrid::getCellRange(const Rect& aRect, int& aColumn0, int& aRow0, int& aColumn1, int& aRow1) const
+	{
+		aColumn0 = static_cast<int>((aRect.x - bounds.x) / cellWidth);
+		aRow0 = static_cast<int>((aRect.y - bounds.y) / cellHeight);
+		aColumn1 = static_cast<int>((aRect.getRight() - bounds.x) / cellWidth);
+		aRow1 = static_cast<int>((aRect.getBottom() - bounds.y) / cellHeight);
+
+		// Clamp to the grid, edges are inclusive so the far edge may land one past the end
+		aColumn0 = (aColumn0 < 0) ? 0 : (aColumn0 >= columns ? columns - 1 : aColumn0);
+		aRow0 = (aRow0 < 0) ? 0 : (aRow0 >= rows ? rows - 1 : aRow0);
+		aColumn1 = (aColumn1 < 0) ? 0 : (aColumn1 >= columns ? columns - 1 : aColumn1);
+		aRow1 = (aRow1 < 0) ? 0 : (aRow1 >= rows ? rows - 1 : aRow1);
+	}
+
+
+	void HitGrid::build(const std::vector<std::shared_ptr<Component>>& aChildren)
+	{
+		dirty = false;
+		cellItems.clear();
+		cellStart.clear();
+		columns = 0;
+		rows = 0;
+
+		if (aChildren.empty())
+			return;
+
+		// Bounds of all children, in container space
+		bounds = Rect();
+		for (const std::shared_ptr<Component>& control : aChildren)
+		{
+			Rect childRect = getChildBounds(control.get());
+
+			bounds = (control == aChildren.front()) ? childRect : bounds.united(childRect);
+		}
+
+		// Aim for roughly one child per cell
+		int cellsPerAxis = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(aChildren.size()))));
+		if (cellsPerAxis > MAX_CELLS_PER_AXIS)
+			cellsPerAxis = MAX_CELLS_PER_AXIS;
+
+		columns = cellsPerAxis;
+		rows = cellsPerAxis;
+		cellWidth = (bounds.width > 0) ? bounds.width / columns : 1;
+		cellHeight = (bounds.height > 0) ? bounds.height / rows : 1;
+
+		// First pass, count the children in each cell
+		cellStart.assign(columns * rows + 1, 0);
+		for (const std::shared_ptr<Component>& control : aChildren)
+		{
+			int column0, row0, column1, row1;
+			getCellRange(getChildBounds(control.get()), column0, row0, column1, row1);
+
+			for (int row = row0; row <= row1; row++)
+				for (int column = column0; column <= column1; column++)
+					cellStart[row * columns + column + 1]++;
+		}
+
+		// Convert counts to start offsets
+		for (int i = 1; i < static_cast<int>(cellStart.size()); i++)
+			cellStart[i] += cellStart[i - 1];
+
+		// Second pass, fill cells in child order
+		std::vector<int> cellFill(cellStart.begin(), cellStart.end() - 1);
+		cellItems.resize(cellStart.back());
+		for (const std::shared_ptr<Component>& control : aChildren)
+		{
+			int column0, row0, column1, row1;
+			getCellRange(getChildBounds(control.get()), column0, row0, column1, row1);
+
+			for (int row = row0; row <= row1; row++)
+				for (int column = column0; column <= column1; column++)
+					cellItems[cellFill[row * columns + column]++] = control.get();
+		}
+	}
+
+
+	int HitGrid::query(float aX, float aY, Component* const** aResult) const
+	{
+		*aResult = nullptr;
+
+		if (columns == 0 || rows == 0)
+			return 0;
+
+		// Point lies outside all children
+		if (!bounds.contains(aX, aY))
+			return 0;
+
+		int column0, row0, column1, row1;
+		getCellRange(Rect(aX, aY, 0, 0), column0, row0, column1, row1);
+
+		int cell = row0 * columns + column0;
+		*aResult = cellItems.data() + cellStart[cell];
+		return cellStart[cell + 1] - cellStart[cell];
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_HIT_GRID_CPP
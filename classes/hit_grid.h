@@ -0,0 +1,63 @@
+#ifndef LEMUR_HIT_GRID_H
+#define LEMUR_HIT_GRID_H
+
+/**************************************************************************************
+* Lemur:        Hit Test Grid Class                                                   *
+*-------------------------------------------------------------------------------------*
+* Filename:     HitGrid.h                                                             *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   A uniform grid over a container's children, used to find the children under a    *
+*   point without testing every child.                                                *
+***************************************************************************************/
+
+
+
+#include <vector>
+#include <memory>
+#include "rect.h"
+
+
+namespace Lemur
+{
+	class Component;
+
+	class HitGrid
+	{
+	private:
+		// Grid limits
+		static const int MAX_CELLS_PER_AXIS = 64;
+
+		Rect bounds;							// Bounds of all children, in container space
+		int columns = 0;						// Number of cells across
+		int rows = 0;							// Number of cells down
+		float cellWidth = 0;					// Width of a cell
+		float cellHeight = 0;					// Height of a cell
+		bool dirty = true;						// Grid needs to be rebuilt before the next query
+
+		std::vector<int> cellStart;				// Index into cellItems of the first child of each cell
+		std::vector<Component*> cellItems;		// Children of each cell, stored cell after cell
+
+		// Get the range of cells covered by a rect
+		void getCellRange(const Rect& aRect, int& aColumn0, int& aRow0, int& aColumn1, int& aRow1) const;
+
+	public:
+
+		// Mark the grid as out of date, it will be rebuilt on the next query
+		void invalidate() { dirty = true; }
+		bool isDirty() const { return dirty; }
+
+		// Rebuild the grid from the children's locations and sizes
+		void build(const std::vector<std::shared_ptr<Component>>& aChildren);
+
+		// Get the children whose cell contains the point (container space).
+		// Candidates still need an exact bounds test. Returns the number of candidates.
+		int query(float aX, float aY, Component* const** aResult) const;
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_HIT_GRID_H
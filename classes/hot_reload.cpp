@@ -0,0 +1,121 @@
+#ifndef LEMUR_HOT_RELOAD_CPP
+#define LEMUR_HOT_RELOAD_CPP
+
+/**************************************************************************************
+* Lemur:        Hot Reload Class                                                      *
+*-------------------------------------------------------------------------------------*
+* Filename:     HotReload.cpp                                                         *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Applies edits to layout and resource files while the application runs. Changed   *
+*   layouts are recompiled and patched into the live component tree, and changed      *
+*   images, fonts and SVGs are reloaded in place.                                     *
+***************************************************************************************/
+
+
+
+#include <filesystem>
+#include <iostream>
+#include "hot_reload.h"
+#include "core.h"
+
+
+namespace Lemur
+{
+	bool HotReload::loadLayout(Component* aParent, const char* aXmlPath, const char* aCachePath, ResourceManager* aResources)
+	{
+		std::unique_ptr<CompiledLayout> layout(new CompiledLayout());
+		if (!LayoutLoader::compile(*layout, aXmlPath, aCachePath))
+			return false;
+
+		WatchedLayout watched;
+		watched.xmlPath = aXmlPath;
+		watched.cachePath = aCachePath != nullptr ? aCachePath : "";
+		watched.parent = aParent;
+		watched.resources = aResources;
+		watched.components = layout->instantiateNodes(aParent, aResources);
+		watched.layout = std::move(layout);
+
+		layouts.push_back(std::move(watched));
+		watcher.watch(aXmlPath);
+		return true;
+	}
+
+	void HotReload::watchResources(ResourceManager* aResources)
+	{
+		watchedResources = aResources;
+
+		for (const std::string& path : aResources->getResourceFiles())
+			watcher.watch(path);
+	}
+
+	void HotReload::setWakeUpCallback(std::function<void()> aCallback)
+	{
+		watcher.setWakeUpCallback(std::move(aCallback));
+	}
+
+	void HotReload::update(NVGcontext* aContext)
+	{
+		std::vector<FileWatcher::Change> changes = watcher.takeChanges();
+
+		for (const FileWatcher::Change& change : changes)
+		{
+			auto start = std::chrono::steady_clock::now();
+			std::string summary;
+
+			for (WatchedLayout& layout : layouts)
+			{
+				if (layout.xmlPath != change.path)
+					continue;
+
+				CompiledLayout::PatchStats stats;
+				if (!reloadLayout(layout, stats))
+				{
+					std::cout << "Hot reload: " << LayoutLoader::getLastError() << std::endl;
+					continue;
+				}
+
+				summary = " (" + std::to_string(stats.updated) + " updated, " + std::to_string(stats.created)
+					+ " added, " + std::to_string(stats.removed) + " removed)";
+			}
+
+			if (summary.empty() && (watchedResources == nullptr || watchedResources->reloadFile(aContext, change.path) == 0))
+				continue;
+
+			auto end = std::chrono::steady_clock::now();
+			lastReloadTime = std::chrono::duration<double, std::milli>(end - start).count();
+			double latency = std::chrono::duration<double, std::milli>(end - change.time).count();
+
+			std::cout << "Hot reload: " << std::filesystem::path(change.path).filename().string() << " in " << lastReloadTime
+				<< " ms, " << latency << " ms after the change" << summary << std::endl;
+		}
+	}
+
+	bool HotReload::reloadLayout(WatchedLayout& aLayout, CompiledLayout::PatchStats& aStats)
+	{
+		std::unique_ptr<CompiledLayout> layout(new CompiledLayout());
+
+		// The previous layout may be mapped from the cache, so it is only rewritten once released
+		if (!LayoutLoader::compile(*layout, aLayout.xmlPath.c_str()))
+			return false;
+
+		aLayout.components = layout->patch(*aLayout.layout, aLayout.components, aLayout.parent, aLayout.resources, &aStats);
+		aLayout.layout = std::move(layout);
+
+		if (!aLayout.cachePath.empty())
+			aLayout.layout->save(aLayout.cachePath.c_str());
+
+		return true;
+	}
+
+	double HotReload::getLastReloadTime() const
+	{
+		return lastReloadTime;
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_HOT_RELOAD_CPP
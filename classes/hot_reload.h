@@ -0,0 +1,80 @@
+#ifndef LEMUR_HOT_RELOAD_H
+#define LEMUR_HOT_RELOAD_H
+
+/**************************************************************************************
+* Lemur:        Hot Reload Class                                                      *
+*-------------------------------------------------------------------------------------*
+* Filename:     HotReload.h                                                           *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Applies edits to layout and resource files while the application runs. Changed   *
+*   layouts are recompiled and patched into the live component tree, and changed      *
+*   images, fonts and SVGs are reloaded in place.                                     *
+*                                                                                     *
+* Notes:                                                                              *
+*   Changes are applied by update() on the render thread, before events are handled.  *
+*   Components kept by a patch keep their state, such as text typed into a textbox.   *
+***************************************************************************************/
+
+
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "nanovg.h"
+#include "file_watcher.h"
+#include "layout_loader.h"
+
+
+namespace Lemur
+{
+	class Component;
+	class ResourceManager;
+
+	class HotReload
+	{
+	private:
+
+		// A layout loaded through loadLayout(), with the components made for each node
+		struct WatchedLayout
+		{
+			std::string xmlPath;
+			std::string cachePath;
+			Component* parent;
+			ResourceManager* resources;
+			std::unique_ptr<CompiledLayout> layout;
+			std::vector<Component*> components;
+		};
+
+		FileWatcher watcher;
+		std::vector<WatchedLayout> layouts;
+		ResourceManager* watchedResources = nullptr;
+		double lastReloadTime = 0;
+
+		// Recompile a changed layout and patch its components. Returns false if the new XML is invalid.
+		bool reloadLayout(WatchedLayout& aLayout, CompiledLayout::PatchStats& aStats);
+
+	public:
+
+		// Load a layout as LayoutLoader::load() does, then watch its XML for changes
+		bool loadLayout(Component* aParent, const char* aXmlPath, const char* aCachePath = nullptr, ResourceManager* aResources = nullptr);
+
+		// Watch the files of every resource imported so far
+		void watchResources(ResourceManager* aResources);
+
+		// Called from the watcher thread when a file changes, to wake an idle event loop
+		void setWakeUpCallback(std::function<void()> aCallback);
+
+		// Apply changes seen since the last update
+		void update(NVGcontext* aContext);
+
+		// Milliseconds taken to apply the last change
+		double getLastReloadTime() const;
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_HOT_RELOAD_H
@@ -23,6 +23,10 @@ namespace Lemur
 		double alpha;
 		const char* filePath;
 
+		// Sub-rect of the texture holding the image, in pixels. A texture size of 0 means the whole texture.
+		int textureX = 0, textureY = 0, textureWidth = 0, textureHeight = 0;
+		int pixelWidth = 0, pixelHeight = 0;
+
 	public:
 		Image(int aWidth, int aHeight, float aAlpha, const char* aFilePath, int aId)
 			: width(aWidth), height(aHeight), alpha(static_cast<double>(aAlpha)), filePath(aFilePath), id(aId) {}
@@ -33,6 +37,30 @@ namespace Lemur
 		double getAlpha() const { return alpha; }
 		const char* getFilePath() const { return filePath; }
 		int getId() const { return id; }
+
+		// Images imported asynchronously have no id until they are uploaded
+		bool isLoaded() const { return id != 0; }
+		void setId(int aId) { id = aId; }
+
+		// Images packed into an atlas page share its texture
+		bool isAtlased() const { return textureWidth != 0; }
+		int getTextureX() const { return textureX; }
+		int getTextureY() const { return textureY; }
+		int getTextureWidth() const { return textureWidth; }
+		int getTextureHeight() const { return textureHeight; }
+		int getPixelWidth() const { return pixelWidth; }
+		int getPixelHeight() const { return pixelHeight; }
+
+		void setAtlasRect(int aId, int aX, int aY, int aPixelWidth, int aPixelHeight, int aTextureWidth, int aTextureHeight)
+		{
+			id = aId;
+			textureX = aX;
+			textureY = aY;
+			pixelWidth = aPixelWidth;
+			pixelHeight = aPixelHeight;
+			textureWidth = aTextureWidth;
+			textureHeight = aTextureHeight;
+		}
 	};
 
 } // namespace Lemur
@@ -0,0 +1,224 @@
+#ifndef LEMUR_IMAGE_ATLAS_CPP
+#define LEMUR_IMAGE_ATLAS_CPP
+
+/**************************************************************************************
+* Lemur:        Image Atlas Class                                                     *
+*-------------------------------------------------------------------------------------*
+* Filename:     ImageAtlas.cpp                                                        *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Packs small images such as icons into shared texture pages, so drawing many of    *
+*   them binds a single texture. Space is allocated with a skyline packer, as in      *
+*   fontstash's glyph atlas.                                                          *
+***************************************************************************************/
+
+
+
+#include <algorithm>
+#include <cstring>
+#include "image_atlas.h"
+
+
+namespace Lemur
+{
+	int ImageAtlas::fits(const Page& aPage, int aNode, int aWidth, int aHeight)
+	{
+		int x = aPage.skyline[aNode].x;
+		int y = aPage.skyline[aNode].y;
+
+		if (x + aWidth > PAGE_SIZE)
+			return -1;
+
+		// Rest on the highest node the rect spans
+		int spaceLeft = aWidth;
+		for (int i = aNode; spaceLeft > 0; i++)
+		{
+			if (i == static_cast<int>(aPage.skyline.size()))
+				return -1;
+
+			y = std::max(y, aPage.skyline[i].y);
+			if (y + aHeight > PAGE_SIZE)
+				return -1;
+
+			spaceLeft -= aPage.skyline[i].width;
+		}
+
+		return y;
+	}
+
+	bool ImageAtlas::allocate(Page& aPage, int aWidth, int aHeight, int& aX, int& aY)
+	{
+		// Bottom left fit, preferring the narrowest node on ties
+		int bestNode = -1;
+		int bestBottom = PAGE_SIZE;
+		int bestWidth = PAGE_SIZE;
+
+		for (int i = 0; i < static_cast<int>(aPage.skyline.size()); i++)
+		{
+			int y = fits(aPage, i, aWidth, aHeight);
+			if (y == -1)
+				continue;
+
+			if (y + aHeight < bestBottom || (y + aHeight == bestBottom && aPage.skyline[i].width < bestWidth))
+			{
+				bestNode = i;
+				bestBottom = y + aHeight;
+				bestWidth = aPage.skyline[i].width;
+				aX = aPage.skyline[i].x;
+				aY = y;
+			}
+		}
+
+		if (bestNode == -1)
+			return false;
+
+		// Raise the skyline over the new rect
+		std::vector<SkylineNode>& skyline = aPage.skyline;
+		skyline.insert(skyline.begin() + bestNode, SkylineNode{ aX, aY + aHeight, aWidth });
+
+		// Trim or remove nodes now under the rect
+		for (int i = bestNode + 1; i < static_cast<int>(skyline.size()); i++)
+		{
+			int previousEnd = skyline[i - 1].x + skyline[i - 1].width;
+			if (skyline[i].x >= previousEnd)
+				break;
+
+			int shrink = previousEnd - skyline[i].x;
+			skyline[i].x += shrink;
+			skyline[i].width -= shrink;
+
+			if (skyline[i].width > 0)
+				break;
+
+			skyline.erase(skyline.begin() + i);
+			i--;
+		}
+
+		// Merge neighbours at the same height
+		for (int i = 0; i + 1 < static_cast<int>(skyline.size()); i++)
+		{
+			if (skyline[i].y == skyline[i + 1].y)
+			{
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+				i--;
+			}
+		}
+
+		return true;
+	}
+
+	void ImageAtlas::blit(Page& aPage, int aX, int aY, const unsigned char* aPixels, int aWidth, int aHeight)
+	{
+		int paddedHeight = aHeight + 2 * PADDING;
+
+		for (int row = 0; row < paddedHeight; row++)
+		{
+			int sourceRow = std::clamp(row - PADDING, 0, aHeight - 1);
+			const unsigned char* source = aPixels + static_cast<size_t>(sourceRow) * aWidth * 4;
+			unsigned char* target = aPage.pixels.data() + (static_cast<size_t>(aY + row) * PAGE_SIZE + aX) * 4;
+
+			// Edge pixels either side, the image row between
+			for (int i = 0; i < PADDING; i++)
+			{
+				memcpy(target + i * 4, source, 4);
+				memcpy(target + (PADDING + aWidth + i) * 4, source + (aWidth - 1) * 4, 4);
+			}
+
+			memcpy(target + PADDING * 4, source, static_cast<size_t>(aWidth) * 4);
+		}
+
+		aPage.dirty = true;
+	}
+
+	bool ImageAtlas::add(NVGcontext* aContext, Image* aImage, const unsigned char* aPixels, int aWidth, int aHeight)
+	{
+		if (aContext == nullptr || aImage == nullptr || aPixels == nullptr)
+			return false;
+
+		if (aWidth <= 0 || aHeight <= 0 || aWidth > MAX_IMAGE_SIZE || aHeight > MAX_IMAGE_SIZE)
+			return false;
+
+		int paddedWidth = aWidth + 2 * PADDING;
+		int paddedHeight = aHeight + 2 * PADDING;
+		int x = 0;
+		int y = 0;
+
+		// Newest page first, the older ones are likely full
+		Page* page = nullptr;
+		for (auto it = pages.rbegin(); it != pages.rend(); it++)
+		{
+			if (allocate(*it, paddedWidth, paddedHeight, x, y))
+			{
+				page = &*it;
+				break;
+			}
+		}
+
+		if (page == nullptr)
+		{
+			Page newPage;
+			newPage.pixels.assign(static_cast<size_t>(PAGE_SIZE) * PAGE_SIZE * 4, 0);
+			newPage.skyline.push_back(SkylineNode{ 0, 0, PAGE_SIZE });
+			newPage.image = nvgCreateImageRGBA(aContext, PAGE_SIZE, PAGE_SIZE, 0, newPage.pixels.data());
+
+			if (newPage.image == 0)
+				return false;
+
+			pages.push_back(std::move(newPage));
+			page = &pages.back();
+			allocate(*page, paddedWidth, paddedHeight, x, y);
+		}
+
+		blit(*page, x, y, aPixels, aWidth, aHeight);
+		aImage->setAtlasRect(page->image, x + PADDING, y + PADDING, aWidth, aHeight, PAGE_SIZE, PAGE_SIZE);
+
+		return true;
+	}
+
+	bool ImageAtlas::update(Image* aImage, const unsigned char* aPixels, int aWidth, int aHeight)
+	{
+		if (aImage == nullptr || aPixels == nullptr || !aImage->isAtlased())
+			return false;
+
+		if (aImage->getPixelWidth() != aWidth || aImage->getPixelHeight() != aHeight)
+			return false;
+
+		for (Page& page : pages)
+		{
+			if (page.image != aImage->getId())
+				continue;
+
+			blit(page, aImage->getTextureX() - PADDING, aImage->getTextureY() - PADDING, aPixels, aWidth, aHeight);
+			return true;
+		}
+
+		return false;
+	}
+
+	void ImageAtlas::flush(NVGcontext* aContext)
+	{
+		if (aContext == nullptr)
+			return;
+
+		for (Page& page : pages)
+		{
+			if (!page.dirty)
+				continue;
+
+			nvgUpdateImage(aContext, page.image, page.pixels.data());
+			page.dirty = false;
+		}
+	}
+
+	int ImageAtlas::getPageCount() const
+	{
+		return static_cast<int>(pages.size());
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_IMAGE_ATLAS_CPP
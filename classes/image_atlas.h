@@ -0,0 +1,89 @@
+#ifndef LEMUR_IMAGE_ATLAS_H
+#define LEMUR_IMAGE_ATLAS_H
+
+/**************************************************************************************
+* Lemur:        Image Atlas Class                                                     *
+*-------------------------------------------------------------------------------------*
+* Filename:     ImageAtlas.h                                                          *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Packs small images such as icons into shared texture pages, so drawing many of    *
+*   them binds a single texture. Space is allocated with a skyline packer, as in      *
+*   fontstash's glyph atlas.                                                          *
+*                                                                                     *
+* Notes:                                                                              *
+*   Pages are updated on the CPU and uploaded by flush(), once per frame, however     *
+*   many images were added. Images are never removed from a page.                    *
+***************************************************************************************/
+
+
+
+#include <vector>
+#include "nanovg.h"
+#include "image.h"
+
+
+namespace Lemur
+{
+	class ImageAtlas
+	{
+	public:
+
+		// Atlas limits
+		static const int PAGE_SIZE = 1024;			// Width and height of a page in pixels
+		static const int MAX_IMAGE_SIZE = 128;		// Larger images get their own texture
+		static const int PADDING = 1;				// Edge pixels repeated around each image, so filtering doesn't bleed
+
+	private:
+
+		// Top edge of the packed area over a horizontal span
+		struct SkylineNode
+		{
+			int x;
+			int y;
+			int width;
+		};
+
+		// A shared texture
+		struct Page
+		{
+			int image = 0;							// NanoVG image of the page
+			std::vector<unsigned char> pixels;		// RGBA copy, updated as images are added
+			std::vector<SkylineNode> skyline;		// Packed area, left to right
+			bool dirty = false;						// Pixels have changed since the last upload
+		};
+
+		std::vector<Page> pages;
+
+		// Find the lowest place a rect fits on a page, marking it as used
+		static bool allocate(Page& aPage, int aWidth, int aHeight, int& aX, int& aY);
+
+		// Get the height a rect would rest at over a skyline node, or -1 if it doesn't fit
+		static int fits(const Page& aPage, int aNode, int aWidth, int aHeight);
+
+		// Copy an image into a page, repeating its edges into the padding
+		static void blit(Page& aPage, int aX, int aY, const unsigned char* aPixels, int aWidth, int aHeight);
+
+	public:
+
+		// Pack RGBA pixels and point the image at its sub-rect of a page.
+		// Returns false, leaving the image unchanged, if the image is too large for the atlas.
+		bool add(NVGcontext* aContext, Image* aImage, const unsigned char* aPixels, int aWidth, int aHeight);
+
+		// Replace the pixels of an atlased image in place, for a reload of the same size.
+		// Returns false if the image isn't in the atlas at that size.
+		bool update(Image* aImage, const unsigned char* aPixels, int aWidth, int aHeight);
+
+		// Upload pages changed since the last flush
+		void flush(NVGcontext* aContext);
+
+		// Number of pages in use
+		int getPageCount() const;
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_IMAGE_ATLAS_H
@@ -15,7 +15,6 @@
 
 
 
-#include <unordered_map>
 #include "glfw/glfw3.h"
 #include <iostream>
 
@@ -31,16 +30,26 @@ namespace Lemur
 
 	public:
 
+		// Apply a press or release. Transitions are kept until the end of the frame, so a
+		// press and release between two frames is seen as both.
 		void changeState(bool aState)
 		{
-			if (!aState && !down)
-				released = false;
+			if (aState && !down)
+				pressed = true;
+
+			if (!aState && down)
+				released = true;
 
-			pressed = (!down && aState);
-			released = (down && !aState);
 			down = aState;
 		}
 
+		// Clear the transitions seen this frame
+		void endFrame()
+		{
+			pressed = false;
+			released = false;
+		}
+
 		bool isDown() const { return down; }
 		bool isPressDown() const { return pressed; }
 		bool isPressUp() const { return released; }
@@ -59,7 +68,10 @@ namespace Lemur
 
 	public:
 
-		std::unordered_map<int, KeyInput>keys;
+		// Every GLFW key code indexes the key array directly
+		static const int KEY_COUNT = GLFW_KEY_LAST + 1;
+
+		KeyInput keys[KEY_COUNT];
 		struct MouseStruct
 		{
 			KeyInput leftButton;
@@ -70,6 +82,7 @@ namespace Lemur
 		} mouse;
 
 		bool capsLock = false;
+		int mods = 0;							// GLFW_MOD flags of the last key event
 
 
 		InputMap()
@@ -77,50 +90,41 @@ namespace Lemur
 			mouse.scroll = 0;
 			mouse.position.x = 0;
 			mouse.position.y = 0;
+		}
+
+		// Get a key's state, GLFW_KEY_UNKNOWN and other invalid codes are never down
+		const KeyInput& getKey(int aKey) const
+		{
+			static const KeyInput none;
+			return (aKey >= 0 && aKey < KEY_COUNT) ? keys[aKey] : none;
+		}
 
+		// Get a mouse button's state by GLFW button number
+		KeyInput* getMouseButton(int aButton)
+		{
+			switch (aButton)
+			{
+			case GLFW_MOUSE_BUTTON_LEFT: return &mouse.leftButton;
+			case GLFW_MOUSE_BUTTON_RIGHT: return &mouse.rightButton;
+			case GLFW_MOUSE_BUTTON_MIDDLE: return &mouse.middleButton;
+			default: return nullptr;
+			}
+		}
+
+		// Clear transitions and scrolling once a frame has seen them
+		void endFrame()
+		{
+			mouse.leftButton.endFrame();
+			mouse.middleButton.endFrame();
+			mouse.rightButton.endFrame();
+			mouse.scroll = 0;
 
-			keys = {
-				{GLFW_KEY_A, KeyInput()},
-				{GLFW_KEY_B, KeyInput()},
-				{GLFW_KEY_C, KeyInput()},
-				{GLFW_KEY_D, KeyInput()},
-				{GLFW_KEY_E, KeyInput()},
-				{GLFW_KEY_F, KeyInput()},
-				{GLFW_KEY_G, KeyInput()},
-				{GLFW_KEY_H, KeyInput()},
-				{GLFW_KEY_I, KeyInput()},
-				{GLFW_KEY_J, KeyInput()},
-				{GLFW_KEY_K, KeyInput()},
-				{GLFW_KEY_L, KeyInput()},
-				{GLFW_KEY_M, KeyInput()},
-				{GLFW_KEY_N, KeyInput()},
-				{GLFW_KEY_O, KeyInput()},
-				{GLFW_KEY_P, KeyInput()},
-				{GLFW_KEY_Q, KeyInput()},
-				{GLFW_KEY_R, KeyInput()},
-				{GLFW_KEY_S, KeyInput()},
-				{GLFW_KEY_T, KeyInput()},
-				{GLFW_KEY_U, KeyInput()},
-				{GLFW_KEY_V, KeyInput()},
-				{GLFW_KEY_W, KeyInput()},
-				{GLFW_KEY_X, KeyInput()},
-				{GLFW_KEY_Y, KeyInput()},
-				{GLFW_KEY_Z, KeyInput()},
-				{GLFW_KEY_0, KeyInput()},
-				{GLFW_KEY_1, KeyInput()},
-				{GLFW_KEY_2, KeyInput()},
-				{GLFW_KEY_3, KeyInput()},
-				{GLFW_KEY_4, KeyInput()},
-				{GLFW_KEY_5, KeyInput()},
-				{GLFW_KEY_6, KeyInput()},
-				{GLFW_KEY_7, KeyInput()},
-				{GLFW_KEY_8, KeyInput()},
-				{GLFW_KEY_9, KeyInput()}
-			};
+			for (KeyInput& key : keys)
+				key.endFrame();
 		}
 
 	};
 
 } // namespace Lemur
 
-#endif // !LEMUR_INPUT_H
\ No newline at end of file
+#endif // !LEMUR_INPUT_H
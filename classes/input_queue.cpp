@@ -0,0 +1,70 @@
+#ifndef LEMUR_INPUT_QUEUE_CPP
+#define LEMUR_INPUT_QUEUE_CPP
+
+/**************************************************************************************
+* Lemur:        Input Event Queue Class                                               *
+*-------------------------------------------------------------------------------------*
+* Filename:     InputQueue.cpp                                                        *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   A fixed size, lock free queue of timestamped input events, filled by the window  *
+*   callbacks and drained in order once per frame.                                    *
+***************************************************************************************/
+
+
+
+#include "input_queue.h"
+
+
+namespace Lemur
+{
+	// Indices count up and wrap naturally, so full and empty are told apart by their difference
+	bool InputQueue::push(const InputEvent& aEvent)
+	{
+		uint32_t position = tail.load(std::memory_order_relaxed);
+
+		if (position - head.load(std::memory_order_acquire) >= CAPACITY)
+		{
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		events[position & (CAPACITY - 1)] = aEvent;
+		tail.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	const InputEvent* InputQueue::front() const
+	{
+		uint32_t position = head.load(std::memory_order_relaxed);
+
+		if (position == tail.load(std::memory_order_acquire))
+			return nullptr;
+
+		return &events[position & (CAPACITY - 1)];
+	}
+
+	void InputQueue::pop()
+	{
+		uint32_t position = head.load(std::memory_order_relaxed);
+
+		if (position != tail.load(std::memory_order_acquire))
+			head.store(position + 1, std::memory_order_release);
+	}
+
+	bool InputQueue::isEmpty() const
+	{
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+
+	uint32_t InputQueue::getDroppedCount() const
+	{
+		return dropped.load(std::memory_order_relaxed);
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_INPUT_QUEUE_CPP
@@ -0,0 +1,85 @@
+#ifndef LEMUR_INPUT_QUEUE_H
+#define LEMUR_INPUT_QUEUE_H
+
+/**************************************************************************************
+* Lemur:        Input Event Queue Class                                               *
+*-------------------------------------------------------------------------------------*
+* Filename:     InputQueue.h                                                          *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   A fixed size, lock free queue of timestamped input events, filled by the window  *
+*   callbacks and drained in order once per frame.                                    *
+*                                                                                     *
+* Notes:                                                                              *
+*   One thread may push and one thread may pop. The queue holds thousands of events, *
+*   far more than arrive in a frame, and counts any pushed while it is full.          *
+***************************************************************************************/
+
+
+
+#include <atomic>
+#include <cstdint>
+
+
+namespace Lemur
+{
+	// An input event, as received from GLFW
+	struct InputEvent
+	{
+		enum class Type : uint8_t
+		{
+			Key,			// key, scancode, action, mods
+			Char,			// codepoint, mods
+			MouseButton,	// key is the button, action, mods
+			MouseMove,		// x, y
+			Scroll			// x, y offsets
+		};
+
+		Type type = Type::Key;
+		int key = 0;				// GLFW key code or mouse button
+		int scancode = 0;
+		int action = 0;				// GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+		int mods = 0;				// GLFW_MOD flags
+		uint32_t codepoint = 0;		// Unicode character
+		double x = 0;
+		double y = 0;
+		double time = 0;			// glfwGetTime() when received
+	};
+
+
+	class InputQueue
+	{
+	public:
+
+		static const uint32_t CAPACITY = 4096;		// Power of two, so indices wrap with a mask
+
+	private:
+
+		InputEvent events[CAPACITY];
+		std::atomic<uint32_t> head = 0;				// Next event to pop, written by the consumer
+		std::atomic<uint32_t> tail = 0;				// Next slot to push, written by the producer
+		std::atomic<uint32_t> dropped = 0;
+
+	public:
+
+		// Add an event, returning false if the queue is full
+		bool push(const InputEvent& aEvent);
+
+		// Get the oldest event without removing it, or null if the queue is empty
+		const InputEvent* front() const;
+
+		// Remove the oldest event
+		void pop();
+
+		bool isEmpty() const;
+
+		// Events lost to a full queue
+		uint32_t getDroppedCount() const;
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_INPUT_QUEUE_H
@@ -18,6 +18,7 @@
 #include <iostream>
 #include <sstream>
 #include "label.h"
+#include "text_styles.h"
 
 
 namespace Lemur
@@ -39,6 +40,16 @@ namespace Lemur
 		text = aText;
 	}
 
+	void* Label::operator new(size_t aSize)
+	{
+		return ComponentArena::allocate<Label>(aSize);
+	}
+
+	void Label::operator delete(void* aPointer, size_t aSize)
+	{
+		ComponentArena::deallocate<Label>(aPointer, aSize);
+	}
+
 
 	// Getters and Setters
 
@@ -120,16 +131,15 @@ namespace Lemur
 		}
 
 		// Recalculate lines if dirty (text changes, or resize)
-		if (linesDirty)
+		if (linesDirty || text != linesText)
+		{
 			lines = getTextByLines();
+			linesText = text;
+			linesDirty = false;
+		}
 				
-		Draw::TextStyle labelTextStyle =
-		{
-			14,
-			"sans",
-			foreColour,
-			Align(Align::LEFT | Align::MIDDLE)
-		};
+		Draw::TextStyle labelTextStyle = TextStyles::get(TextStyles::Id::Label);
+		labelTextStyle.colour = foreColour;
 
 
 		if (singleLine || !wrapText)
@@ -140,13 +150,13 @@ namespace Lemur
 			float w = size.x;
 			float h = size.y;
 
-			nvgSave(aContext);
-			nvgScissor(aContext, x, y, w, h);
+			Draw::Save(aContext);
+			Draw::IntersectScissor(aContext, x, y, w, h);
 
 			Draw::Rect(aContext, x, y, w, h, backColour);
 			Draw::Text(aContext, x, y, w, h, &labelTextStyle, lines[0].c_str());
 
-			nvgRestore(aContext);
+			Draw::Restore(aContext);
 
 		}
 		else if (wrapText)
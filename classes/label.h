@@ -33,6 +33,7 @@ namespace Lemur
 
 		// Cached calculated lines
 		std::vector<std::string> lines;
+		std::string linesText;					// Text the lines were split from, text can be assigned directly
 		bool linesDirty = true;
 		Vector2 lastSize;
 
@@ -46,6 +47,10 @@ namespace Lemur
 			*/
 		Label(int aX = 0, int aY = 0, int aWidth = 150, int aHeight = 30, std::string aText = "Label");
 
+		// Allocated from this class's own arena pool
+		static void* operator new(size_t aSize);
+		static void operator delete(void* aPointer, size_t aSize);
+
 		// Getters and Setters
 		bool isSingleLine() const;
 		void setSingleLine(bool aSingleLine);
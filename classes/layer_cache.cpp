@@ -0,0 +1,230 @@
+#ifndef LEMUR_LAYER_CACHE_CPP
+#define LEMUR_LAYER_CACHE_CPP
+
+/**************************************************************************************
+* Lemur:        Render Layer Cache Class                                              *
+*-------------------------------------------------------------------------------------*
+* Filename:     LayerCache.cpp                                                        *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Offscreen framebuffers for layered components. A layer holds an image of its      *
+*   component's subtree, re-rendered only when something in the subtree is           *
+*   invalidated, and is otherwise drawn as a single textured quad.                    *
+***************************************************************************************/
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "layer_cache.h"
+#include "component.h"
+#include "nanovg_gl_utils.h"
+
+
+namespace Lemur
+{
+	std::unordered_map<Component*, LayerCache::Layer> LayerCache::layers;
+	bool LayerCache::supported = false;
+	size_t LayerCache::budget = LayerCache::DEFAULT_BUDGET;
+	size_t LayerCache::memoryUsage = 0;
+	unsigned long LayerCache::frame = 1;
+
+	// RGBA colour plus an 8 bit stencil per pixel
+	static size_t getLayerBytes(int aWidth, int aHeight)
+	{
+		return static_cast<size_t>(aWidth) * aHeight * 5;
+	}
+
+	// Number of ancestors of a component
+	static int getDepth(const Component* aComponent)
+	{
+		int depth = 0;
+		for (const Component* ancestor = aComponent->getParent(); ancestor != nullptr; ancestor = ancestor->getParent())
+			depth++;
+		return depth;
+	}
+
+
+	void LayerCache::setSupported(bool aSupported)
+	{
+		supported = aSupported;
+	}
+
+	bool LayerCache::isSupported()
+	{
+		return supported;
+	}
+
+	void LayerCache::add(Component* aComponent)
+	{
+		layers.emplace(aComponent, Layer());
+	}
+
+	void LayerCache::remove(Component* aComponent)
+	{
+		auto found = layers.find(aComponent);
+		if (found == layers.end())
+			return;
+
+		release(found->second);
+		layers.erase(found);
+	}
+
+	void LayerCache::invalidate(Component* aComponent)
+	{
+		auto found = layers.find(aComponent);
+		if (found != layers.end())
+			found->second.valid = false;
+	}
+
+	int LayerCache::getImage(Component* aComponent)
+	{
+		auto found = layers.find(aComponent);
+		if (found == layers.end())
+			return 0;
+
+		// Drawn this frame, so it is rendered ahead of the next frame if it's out of date
+		Layer& layer = found->second;
+		layer.lastDrawn = frame;
+
+		if (!layer.valid || layer.framebuffer == nullptr)
+			return 0;
+
+		return layer.framebuffer->image;
+	}
+
+	void LayerCache::release(Layer& aLayer)
+	{
+		if (aLayer.framebuffer != nullptr)
+			nvgluDeleteFramebuffer(aLayer.framebuffer);
+
+		memoryUsage -= aLayer.bytes;
+		aLayer.framebuffer = nullptr;
+		aLayer.bytes = 0;
+		aLayer.width = 0;
+		aLayer.height = 0;
+		aLayer.valid = false;
+	}
+
+	void LayerCache::evict(size_t aBytes, const Component* aKeep)
+	{
+		// Least recently drawn first
+		std::vector<std::pair<unsigned long, Component*>> candidates;
+		for (auto& pair : layers)
+			if (pair.first != aKeep && pair.second.framebuffer != nullptr && pair.second.lastDrawn < frame)
+				candidates.push_back({ pair.second.lastDrawn, pair.first });
+
+		std::sort(candidates.begin(), candidates.end());
+
+		for (auto& candidate : candidates)
+		{
+			if (memoryUsage + aBytes <= budget)
+				break;
+
+			release(layers[candidate.second]);
+		}
+	}
+
+	bool LayerCache::allocate(NVGcontext* aContext, Component* aComponent, Layer& aLayer, int aWidth, int aHeight)
+	{
+		if (aLayer.framebuffer != nullptr && aLayer.width == aWidth && aLayer.height == aHeight)
+			return true;
+
+		release(aLayer);
+
+		size_t bytes = getLayerBytes(aWidth, aHeight);
+		if (memoryUsage + bytes > budget)
+			evict(bytes, aComponent);
+
+		// Over budget, the component is drawn directly
+		if (memoryUsage + bytes > budget)
+			return false;
+
+		aLayer.framebuffer = nvgluCreateFramebuffer(aContext, aWidth, aHeight, 0);
+		if (aLayer.framebuffer == nullptr)
+			return false;
+
+		aLayer.width = aWidth;
+		aLayer.height = aHeight;
+		aLayer.bytes = bytes;
+		memoryUsage += bytes;
+		return true;
+	}
+
+	void LayerCache::renderLayers(NVGcontext* aContext, int aWindowWidth, int aWindowHeight)
+	{
+		if (!supported || layers.empty())
+		{
+			frame++;
+			return;
+		}
+
+		// Out of date layers that are on screen, nested layers first so their parents can composite them
+		std::vector<std::pair<int, Component*>> pending;
+		for (auto& pair : layers)
+			if (!pair.second.valid && pair.second.lastDrawn >= frame)
+				pending.push_back({ -getDepth(pair.first), pair.first });
+
+		std::sort(pending.begin(), pending.end());
+
+		for (auto& entry : pending)
+		{
+			Component* component = entry.second;
+			Layer& layer = layers[component];
+
+			int width = static_cast<int>(std::ceil(component->getSize().x));
+			int height = static_cast<int>(std::ceil(component->getSize().y));
+			if (width <= 0 || height <= 0)
+				continue;
+
+			if (!allocate(aContext, component, layer, width, height))
+				continue;
+
+			// Marked valid first, so invalidation while rendering leaves it out of date
+			layer.valid = true;
+
+			nvgluBindFramebuffer(layer.framebuffer);
+			glViewport(0, 0, width, height);
+			glClearColor(0, 0, 0, 0);
+			glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+			nvgBeginFrame(aContext, static_cast<float>(width), static_cast<float>(height), 1);
+			component->renderLayer(aContext);
+			nvgEndFrame(aContext);
+		}
+
+		nvgluBindFramebuffer(nullptr);
+		glViewport(0, 0, aWindowWidth, aWindowHeight);
+
+		frame++;
+	}
+
+	void LayerCache::setBudget(size_t aBytes)
+	{
+		budget = aBytes;
+		evict(0, nullptr);
+	}
+
+	size_t LayerCache::getBudget()
+	{
+		return budget;
+	}
+
+	size_t LayerCache::getMemoryUsage()
+	{
+		return memoryUsage;
+	}
+
+	void LayerCache::clear()
+	{
+		for (auto& pair : layers)
+			release(pair.second);
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_LAYER_CACHE_CPP
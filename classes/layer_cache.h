@@ -0,0 +1,98 @@
+#ifndef LEMUR_LAYER_CACHE_H
+#define LEMUR_LAYER_CACHE_H
+
+/**************************************************************************************
+* Lemur:        Render Layer Cache Class                                              *
+*-------------------------------------------------------------------------------------*
+* Filename:     LayerCache.h                                                          *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Offscreen framebuffers for layered components. A layer holds an image of its      *
+*   component's subtree, re-rendered only when something in the subtree is           *
+*   invalidated, and is otherwise drawn as a single textured quad.                    *
+*                                                                                     *
+* Notes:                                                                              *
+*   Requires the OpenGL backend. Without it layered components draw directly.        *
+*   Layers are rendered before the window's frame begins, so a layer invalidated      *
+*   while drawing is drawn directly for that frame and re-rendered on the next.       *
+***************************************************************************************/
+
+
+
+#include <unordered_map>
+#include "nanovg.h"
+
+
+struct NVGLUframebuffer;
+
+namespace Lemur
+{
+	class Component;
+
+	class LayerCache
+	{
+	private:
+
+		// Cache limits
+		static const size_t DEFAULT_BUDGET = 64 * 1024 * 1024;	// Bytes of layer textures and stencils kept
+
+		// Layer of a component
+		struct Layer
+		{
+			NVGLUframebuffer* framebuffer = nullptr;	// Render target, null until first rendered
+			int width = 0;								// Framebuffer width in pixels
+			int height = 0;								// Framebuffer height in pixels
+			size_t bytes = 0;							// Memory held by the framebuffer
+			bool valid = false;							// Image matches the component's subtree
+			unsigned long lastDrawn = 0;				// Last frame the component was drawn in
+		};
+
+		static std::unordered_map<Component*, Layer> layers;
+		static bool supported;
+		static size_t budget;
+		static size_t memoryUsage;
+		static unsigned long frame;
+
+		// Create or resize a layer's framebuffer, evicting layers that are off screen to make room
+		static bool allocate(NVGcontext* aContext, Component* aComponent, Layer& aLayer, int aWidth, int aHeight);
+
+		// Free a layer's framebuffer
+		static void release(Layer& aLayer);
+
+		// Free framebuffers of layers not drawn last frame until aBytes more would fit the budget
+		static void evict(size_t aBytes, const Component* aKeep);
+
+	public:
+
+		// Layers need a framebuffer capable backend, set by the window
+		static void setSupported(bool aSupported);
+		static bool isSupported();
+
+		// Register and unregister layered components
+		static void add(Component* aComponent);
+		static void remove(Component* aComponent);
+
+		// Mark a component's layer as out of date
+		static void invalidate(Component* aComponent);
+
+		// Get the image of an up to date layer, or 0 if the component must be drawn directly
+		static int getImage(Component* aComponent);
+
+		// Render out of date layers drawn in the last frame. Called before the window's frame begins.
+		static void renderLayers(NVGcontext* aContext, int aWindowWidth, int aWindowHeight);
+
+		// Memory budget in bytes
+		static void setBudget(size_t aBytes);
+		static size_t getBudget();
+		static size_t getMemoryUsage();
+
+		// Free every framebuffer, layers are re-rendered when next drawn
+		static void clear();
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_LAYER_CACHE_H
@@ -0,0 +1,293 @@
+#ifndef LEMUR_LAYOUT_CPP
+#define LEMUR_LAYOUT_CPP
+
+/**************************************************************************************
+* Lemur:        Layout Engine Class                                                   *
+*-------------------------------------------------------------------------------------*
+* Filename:     Layout.cpp                                                            *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Resolves anchors and container layouts for a whole component tree in one pass.   *
+*   The tree is flattened breadth first into arrays of geometry and layout inputs,    *
+*   so every parent is resolved before its children and each container's children    *
+*   are contiguous.                                                                   *
+***************************************************************************************/
+
+
+
+#include <algorithm>
+#include "layout.h"
+#include "component.h"
+
+
+namespace Lemur
+{
+	std::vector<Component*> LayoutEngine::nodes;
+	std::vector<int> LayoutEngine::firstChild;
+	std::vector<int> LayoutEngine::childCount;
+	std::vector<double> LayoutEngine::xs;
+	std::vector<double> LayoutEngine::ys;
+	std::vector<float> LayoutEngine::widths;
+	std::vector<float> LayoutEngine::heights;
+	std::vector<unsigned char> LayoutEngine::anchors;
+	std::vector<int> LayoutEngine::rightOffsets;
+	std::vector<int> LayoutEngine::bottomOffsets;
+	std::vector<float> LayoutEngine::flexes;
+	unsigned long LayoutEngine::passCount = 0;
+
+	void LayoutEngine::gather(Component* aRoot)
+	{
+		nodes.clear();
+		firstChild.clear();
+		childCount.clear();
+		xs.clear();
+		ys.clear();
+		widths.clear();
+		heights.clear();
+		anchors.clear();
+		rightOffsets.clear();
+		bottomOffsets.clear();
+		flexes.clear();
+
+		nodes.push_back(aRoot);
+
+		// Nodes are appended as their parent is visited, so the list grows as it is walked
+		for (int i = 0; i < static_cast<int>(nodes.size()); i++)
+		{
+			Component* node = nodes[i];
+
+			firstChild.push_back(static_cast<int>(nodes.size()));
+			childCount.push_back(static_cast<int>(node->childComponents.size()));
+
+			for (std::shared_ptr<Component>& child : node->childComponents)
+				nodes.push_back(child.get());
+
+			xs.push_back(node->location.x);
+			ys.push_back(node->location.y);
+			widths.push_back(node->size.x);
+			heights.push_back(node->size.y);
+
+			unsigned char flags = 0;
+			if (node->anchor[static_cast<int>(Anchor::Direction::Top)].enabled)
+				flags |= ANCHOR_TOP;
+			if (node->anchor[static_cast<int>(Anchor::Direction::Right)].enabled)
+				flags |= ANCHOR_RIGHT;
+			if (node->anchor[static_cast<int>(Anchor::Direction::Bottom)].enabled)
+				flags |= ANCHOR_BOTTOM;
+			if (node->anchor[static_cast<int>(Anchor::Direction::Left)].enabled)
+				flags |= ANCHOR_LEFT;
+
+			anchors.push_back(flags);
+			rightOffsets.push_back(node->anchor[static_cast<int>(Anchor::Direction::Right)].offset);
+			bottomOffsets.push_back(node->anchor[static_cast<int>(Anchor::Direction::Bottom)].offset);
+			flexes.push_back(node->flex);
+		}
+	}
+
+	void LayoutEngine::resolveAnchors(int aNode)
+	{
+		float parentWidth = widths[aNode];
+		float parentHeight = heights[aNode];
+
+		int end = firstChild[aNode] + childCount[aNode];
+		for (int i = firstChild[aNode]; i < end; i++)
+		{
+			unsigned char flags = anchors[i];
+			if (flags == 0)
+				continue;
+
+			// Left and right, stretch keeping the left edge where it is
+			if ((flags & ANCHOR_LEFT) && (flags & ANCHOR_RIGHT))
+				widths[i] = std::max(0.0f, static_cast<float>(parentWidth - xs[i] - rightOffsets[i]));
+
+			// Right only, pin the right edge
+			else if (flags & ANCHOR_RIGHT)
+				xs[i] = parentWidth - rightOffsets[i] - widths[i];
+
+			// Top and bottom, stretch keeping the top edge where it is
+			if ((flags & ANCHOR_TOP) && (flags & ANCHOR_BOTTOM))
+				heights[i] = std::max(0.0f, static_cast<float>(parentHeight - ys[i] - bottomOffsets[i]));
+
+			// Bottom only, pin the bottom edge
+			else if (flags & ANCHOR_BOTTOM)
+				ys[i] = parentHeight - bottomOffsets[i] - heights[i];
+		}
+	}
+
+	void LayoutEngine::resolveStack(int aNode, const ContainerLayout& aLayout, bool aHorizontal)
+	{
+		int begin = firstChild[aNode];
+		int end = begin + childCount[aNode];
+
+		// Hidden children take no space
+		int shown = 0;
+		float fixedSize = 0;
+		float flexTotal = 0;
+		for (int i = begin; i < end; i++)
+		{
+			if (!nodes[i]->enabled)
+				continue;
+
+			shown++;
+			if (flexes[i] > 0)
+				flexTotal += flexes[i];
+			else
+				fixedSize += aHorizontal ? widths[i] : heights[i];
+		}
+
+		if (shown == 0)
+			return;
+
+		float mainSize = (aHorizontal ? widths[aNode] : heights[aNode]) - 2.0f * aLayout.padding;
+		float crossSize = std::max(0.0f, (aHorizontal ? heights[aNode] : widths[aNode]) - 2.0f * aLayout.padding);
+
+		// Flexible children share what the fixed children and spacing leave
+		float remaining = std::max(0.0f, mainSize - fixedSize - aLayout.spacing * (shown - 1.0f));
+
+		double position = aLayout.padding;
+		for (int i = begin; i < end; i++)
+		{
+			if (!nodes[i]->enabled)
+				continue;
+
+			float& main = aHorizontal ? widths[i] : heights[i];
+			if (flexes[i] > 0)
+				main = remaining * flexes[i] / flexTotal;
+
+			if (aHorizontal)
+			{
+				xs[i] = position;
+				ys[i] = aLayout.padding;
+				heights[i] = crossSize;
+			}
+			else
+			{
+				xs[i] = aLayout.padding;
+				ys[i] = position;
+				widths[i] = crossSize;
+			}
+
+			position += main + aLayout.spacing;
+		}
+	}
+
+	void LayoutEngine::resolveGrid(int aNode, const ContainerLayout& aLayout)
+	{
+		int begin = firstChild[aNode];
+		int end = begin + childCount[aNode];
+
+		int columns = std::max(1, aLayout.columns);
+		float cellWidth = std::max(0.0f, (widths[aNode] - 2.0f * aLayout.padding - aLayout.spacing * (columns - 1.0f)) / columns);
+
+		double y = aLayout.padding;
+		float lineHeight = 0;
+		int column = 0;
+
+		for (int i = begin; i < end; i++)
+		{
+			if (!nodes[i]->enabled)
+				continue;
+
+			// Start a new line below the tallest cell of the last
+			if (column == columns)
+			{
+				y += lineHeight + aLayout.spacing;
+				lineHeight = 0;
+				column = 0;
+			}
+
+			xs[i] = aLayout.padding + column * static_cast<double>(cellWidth + aLayout.spacing);
+			ys[i] = y;
+			widths[i] = cellWidth;
+			lineHeight = std::max(lineHeight, heights[i]);
+
+			column++;
+		}
+	}
+
+	void LayoutEngine::apply()
+	{
+		// The root keeps its own geometry
+		nodes[0]->refreshScreenRect();
+
+		for (int i = 1; i < static_cast<int>(nodes.size()); i++)
+		{
+			Component* node = nodes[i];
+
+			bool changed = node->location.x != xs[i] || node->location.y != ys[i]
+				|| node->size.x != widths[i] || node->size.y != heights[i];
+
+			if (changed)
+			{
+				// Damage the old area
+				node->invalidate();
+
+				node->location.x = xs[i];
+				node->location.y = ys[i];
+				node->size.x = widths[i];
+				node->size.y = heights[i];
+				node->parent->hitGrid.invalidate();
+			}
+
+			// Parents were placed first, so their screen position is current
+			node->screenRect.x = node->parent->screenRect.x + node->location.x;
+			node->screenRect.y = node->parent->screenRect.y + node->location.y;
+			node->screenRect.width = node->size.x;
+			node->screenRect.height = node->size.y;
+
+			// Damage the new area
+			if (changed)
+				node->invalidate();
+		}
+	}
+
+	void LayoutEngine::run(Component* aRoot)
+	{
+		if (aRoot == nullptr)
+			return;
+
+		gather(aRoot);
+
+		// Breadth first, so a node's size is final before its children are placed against it
+		for (int i = 0; i < static_cast<int>(nodes.size()); i++)
+		{
+			if (childCount[i] == 0)
+				continue;
+
+			const ContainerLayout& layout = nodes[i]->containerLayout;
+			switch (layout.type)
+			{
+			case ContainerLayout::Type::Row:
+				resolveStack(i, layout, true);
+				break;
+
+			case ContainerLayout::Type::Column:
+				resolveStack(i, layout, false);
+				break;
+
+			case ContainerLayout::Type::Grid:
+				resolveGrid(i, layout);
+				break;
+
+			default:
+				resolveAnchors(i);
+				break;
+			}
+		}
+
+		apply();
+
+		passCount++;
+	}
+
+	unsigned long LayoutEngine::getPassCount()
+	{
+		return passCount;
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_LAYOUT_CPP
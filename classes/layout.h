@@ -0,0 +1,101 @@
+#ifndef LEMUR_LAYOUT_H
+#define LEMUR_LAYOUT_H
+
+/**************************************************************************************
+* Lemur:        Layout Engine Class                                                   *
+*-------------------------------------------------------------------------------------*
+* Filename:     Layout.h                                                              *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Resolves anchors and container layouts for a whole component tree in one pass.   *
+*   The tree is flattened breadth first into arrays of geometry and layout inputs,    *
+*   so every parent is resolved before its children and each container's children    *
+*   are contiguous.                                                                   *
+*                                                                                     *
+* Notes:                                                                              *
+*   The pass runs when a component asks for it through invalidateLayout(), once      *
+*   before the next frame is drawn, rather than every frame.                         *
+***************************************************************************************/
+
+
+
+#include <vector>
+
+
+namespace Lemur
+{
+	class Component;
+
+	// How a container positions its children. Children of a container ignore their anchors.
+	struct ContainerLayout
+	{
+		enum class Type
+		{
+			None = 0,		// Children are placed by their own location and anchors
+			Row = 1,		// Children side by side, stretched to the container's height
+			Column = 2,		// Children stacked top to bottom, stretched to the container's width
+			Grid = 3		// Children in equal width cells, each line as tall as its tallest child
+		};
+
+		Type type = Type::None;
+		int padding = 0;	// Space between the container's edges and its children
+		int spacing = 0;	// Space between neighbouring children
+		int columns = 2;	// Cells per line in a grid
+	};
+
+
+	class LayoutEngine
+	{
+	private:
+
+		// Anchor flags, one bit per Anchor::Direction
+		static const unsigned char ANCHOR_TOP = 1 << 0;
+		static const unsigned char ANCHOR_RIGHT = 1 << 1;
+		static const unsigned char ANCHOR_BOTTOM = 1 << 2;
+		static const unsigned char ANCHOR_LEFT = 1 << 3;
+
+		// Flattened tree, breadth first. Kept between passes to reuse their storage.
+		static std::vector<Component*> nodes;
+		static std::vector<int> firstChild;			// Index of a node's first child
+		static std::vector<int> childCount;			// Number of children, stored contiguously from firstChild
+
+		// Geometry, relative to the parent
+		static std::vector<double> xs;
+		static std::vector<double> ys;
+		static std::vector<float> widths;
+		static std::vector<float> heights;
+
+		// Layout inputs
+		static std::vector<unsigned char> anchors;
+		static std::vector<int> rightOffsets;
+		static std::vector<int> bottomOffsets;
+		static std::vector<float> flexes;
+
+		static unsigned long passCount;
+
+		// Flatten the tree into the arrays
+		static void gather(Component* aRoot);
+
+		// Position the children of a node
+		static void resolveAnchors(int aNode);
+		static void resolveStack(int aNode, const ContainerLayout& aLayout, bool aHorizontal);
+		static void resolveGrid(int aNode, const ContainerLayout& aLayout);
+
+		// Write changed geometry back to the components, damaging what moved
+		static void apply();
+
+	public:
+
+		// Lay out a whole tree, top down
+		static void run(Component* aRoot);
+
+		// Number of passes run, for diagnostics
+		static unsigned long getPassCount();
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_LAYOUT_H
@@ -0,0 +1,1165 @@
+#ifndef LEMUR_LAYOUT_LOADER_CPP
+#define LEMUR_LAYOUT_LOADER_CPP
+
+/**************************************************************************************
+* Lemur:        Layout Loader Classes                                                 *
+*-------------------------------------------------------------------------------------*
+* Filename:     LayoutLoader.cpp                                                      *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Builds component trees from XML layout files, so forms can change without         *
+*   recompiling. Layouts are compiled to a flat binary form, which is cached on disk  *
+*   and memory mapped on later launches to skip parsing the XML.                      *
+***************************************************************************************/
+
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <unordered_map>
+#include "pugixml.hpp"
+#include "layout_loader.h"
+#include "components.h"
+#include "resource_manager.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace Lemur
+{
+	static_assert(sizeof(CompiledLayout::Header) == 40, "Compiled layout header must match the file format");
+	static_assert(sizeof(CompiledLayout::Node) == 12, "Compiled layout node must match the file format");
+	static_assert(sizeof(CompiledLayout::Property) == 20, "Compiled layout property must match the file format");
+
+	std::string LayoutLoader::lastError;
+
+	namespace
+	{
+		using NodeType = CompiledLayout::NodeType;
+		using PropertyId = CompiledLayout::PropertyId;
+
+		// How an attribute's value is parsed
+		enum class ValueKind
+		{
+			String,
+			Int,
+			Float,
+			Bool,
+			Colour,
+			Anchors,
+			Align,
+			LayoutType,
+			LayoutPadding,
+			LayoutSpacing,
+			LayoutColumns
+		};
+
+		// Node types an attribute applies to, one bit per NodeType
+		const unsigned PANEL = 1 << static_cast<int>(NodeType::Panel);
+		const unsigned BUTTON = 1 << static_cast<int>(NodeType::Button);
+		const unsigned LABEL = 1 << static_cast<int>(NodeType::Label);
+		const unsigned TEXTBOX = 1 << static_cast<int>(NodeType::Textbox);
+		const unsigned TAB_VIEW = 1 << static_cast<int>(NodeType::TabView);
+		const unsigned TAB = 1 << static_cast<int>(NodeType::Tab);
+		const unsigned COMPONENTS = PANEL | BUTTON | LABEL | TEXTBOX | TAB_VIEW;
+
+		struct AttributeInfo
+		{
+			const char* name;
+			PropertyId id;
+			ValueKind kind;
+			unsigned types;
+		};
+
+		const AttributeInfo ATTRIBUTES[] =
+		{
+			{ "name", PropertyId::Name, ValueKind::String, COMPONENTS | TAB },
+			{ "text", PropertyId::Text, ValueKind::String, COMPONENTS | TAB },
+			{ "x", PropertyId::X, ValueKind::Int, COMPONENTS },
+			{ "y", PropertyId::Y, ValueKind::Int, COMPONENTS },
+			{ "width", PropertyId::Width, ValueKind::Int, COMPONENTS },
+			{ "height", PropertyId::Height, ValueKind::Int, COMPONENTS },
+			{ "backColour", PropertyId::BackColour, ValueKind::Colour, COMPONENTS },
+			{ "foreColour", PropertyId::ForeColour, ValueKind::Colour, COMPONENTS },
+			{ "stroke", PropertyId::Stroke, ValueKind::Colour, COMPONENTS },
+			{ "strokeWidth", PropertyId::StrokeWidth, ValueKind::Float, COMPONENTS },
+			{ "headerColour", PropertyId::HeaderColour, ValueKind::Colour, TAB_VIEW },
+			{ "zOrder", PropertyId::ZOrder, ValueKind::Int, COMPONENTS },
+			{ "enabled", PropertyId::Enabled, ValueKind::Bool, COMPONENTS },
+			{ "visible", PropertyId::Visible, ValueKind::Bool, COMPONENTS },
+			{ "layered", PropertyId::Layered, ValueKind::Bool, COMPONENTS },
+			{ "layout", PropertyId::Layout, ValueKind::LayoutType, COMPONENTS },
+			{ "padding", PropertyId::Layout, ValueKind::LayoutPadding, COMPONENTS },
+			{ "spacing", PropertyId::Layout, ValueKind::LayoutSpacing, COMPONENTS },
+			{ "columns", PropertyId::Layout, ValueKind::LayoutColumns, COMPONENTS },
+			{ "flex", PropertyId::Flex, ValueKind::Float, COMPONENTS },
+			{ "fontSize", PropertyId::FontSize, ValueKind::Float, BUTTON | TEXTBOX },
+			{ "font", PropertyId::Font, ValueKind::String, TEXTBOX },
+			{ "align", PropertyId::Align, ValueKind::Align, LABEL | TEXTBOX },
+			{ "singleLine", PropertyId::SingleLine, ValueKind::Bool, LABEL },
+			{ "textWrap", PropertyId::TextWrap, ValueKind::Bool, LABEL },
+			{ "lineSpacing", PropertyId::LineSpacing, ValueKind::Float, LABEL },
+			{ "image", PropertyId::BackgroundImage, ValueKind::String, PANEL | BUTTON },
+			{ "anchors", PropertyId::Anchors, ValueKind::Anchors, COMPONENTS },
+			{ "activeTab", PropertyId::ActiveTab, ValueKind::Int, TAB_VIEW },
+		};
+
+		const char* NODE_NAMES[] = { "Panel", "Button", "Label", "Textbox", "TabView", "Tab" };
+
+		// Node types a property applies to, from every attribute setting it
+		unsigned getPropertyTypes(uint16_t aId)
+		{
+			unsigned types = 0;
+			for (const AttributeInfo& attribute : ATTRIBUTES)
+				if (static_cast<uint16_t>(attribute.id) == aId)
+					types |= attribute.types;
+
+			return types;
+		}
+
+		// Split a list of words separated by spaces, commas or pipes
+		std::vector<std::string> splitWords(const char* aText)
+		{
+			std::vector<std::string> words;
+			std::string word;
+
+			for (const char* c = aText; ; c++)
+			{
+				if (*c == 0 || *c == ' ' || *c == ',' || *c == '|' || *c == '\t')
+				{
+					if (!word.empty())
+						words.push_back(word);
+
+					word.clear();
+					if (*c == 0)
+						break;
+				}
+				else
+					word += *c;
+			}
+
+			return words;
+		}
+
+		bool parseInt(const char* aText, int32_t& aValue)
+		{
+			char* end = nullptr;
+			long value = strtol(aText, &end, 10);
+			if (end == aText || *end != 0)
+				return false;
+
+			aValue = static_cast<int32_t>(value);
+			return true;
+		}
+
+		bool parseFloat(const char* aText, float& aValue)
+		{
+			char* end = nullptr;
+			aValue = strtof(aText, &end);
+			return end != aText && *end == 0;
+		}
+
+		// "#RRGGBB", "#RRGGBBAA" or "r, g, b[, a]"
+		bool parseColour(const char* aText, int32_t* aRgba)
+		{
+			aRgba[3] = 255;
+
+			if (aText[0] == '#')
+			{
+				size_t length = strlen(aText + 1);
+				if (length != 6 && length != 8)
+					return false;
+
+				char* end = nullptr;
+				unsigned long value = strtoul(aText + 1, &end, 16);
+				if (*end != 0)
+					return false;
+
+				if (length == 6)
+					value = (value << 8) | 0xFF;
+
+				for (int i = 0; i < 4; i++)
+					aRgba[i] = static_cast<int32_t>((value >> (24 - i * 8)) & 0xFF);
+
+				return true;
+			}
+
+			std::vector<std::string> channels = splitWords(aText);
+			if (channels.size() != 3 && channels.size() != 4)
+				return false;
+
+			for (size_t i = 0; i < channels.size(); i++)
+				if (!parseInt(channels[i].c_str(), aRgba[i]) || aRgba[i] < 0 || aRgba[i] > 255)
+					return false;
+
+			return true;
+		}
+
+		bool parseBool(const char* aText, int32_t& aValue)
+		{
+			if (strcmp(aText, "true") == 0 || strcmp(aText, "1") == 0)
+				aValue = 1;
+			else if (strcmp(aText, "false") == 0 || strcmp(aText, "0") == 0)
+				aValue = 0;
+			else
+				return false;
+
+			return true;
+		}
+
+		// Parse a word list into flags, returning false on an unknown word
+		template<size_t N>
+		bool parseFlags(const char* aText, const char* const (&aNames)[N], const int (&aFlags)[N], int32_t& aValue)
+		{
+			aValue = 0;
+
+			for (const std::string& word : splitWords(aText))
+			{
+				size_t i = 0;
+				while (i < N && word != aNames[i])
+					i++;
+
+				if (i == N)
+					return false;
+
+				aValue |= aFlags[i];
+			}
+
+			return true;
+		}
+
+		// Intermediate form of a node while compiling
+		struct CompileNode
+		{
+			NodeType type;
+			int32_t parent;
+			bool hasProperty[static_cast<int>(PropertyId::Count)] = {};
+			CompiledLayout::Property properties[static_cast<int>(PropertyId::Count)] = {};
+		};
+
+		struct Compiler
+		{
+			std::vector<CompileNode> nodes;
+			std::string strings;
+			std::string error;
+
+			uint32_t addString(const char* aText)
+			{
+				uint32_t offset = static_cast<uint32_t>(strings.size());
+				strings.append(aText);
+				strings.push_back(0);
+				return offset;
+			}
+
+			bool fail(const pugi::xml_node& aElement, const std::string& aMessage)
+			{
+				error = std::string("<") + aElement.name() + "> " + aMessage;
+				return false;
+			}
+
+			bool parseAttribute(CompileNode& aNode, const pugi::xml_node& aElement, const pugi::xml_attribute& aAttribute)
+			{
+				const AttributeInfo* info = nullptr;
+				for (const AttributeInfo& attribute : ATTRIBUTES)
+					if (strcmp(attribute.name, aAttribute.name()) == 0)
+						info = &attribute;
+
+				if (info == nullptr)
+					return fail(aElement, std::string("has unknown attribute '") + aAttribute.name() + "'");
+
+				if ((info->types & (1u << static_cast<int>(aNode.type))) == 0)
+					return fail(aElement, std::string("does not support attribute '") + aAttribute.name() + "'");
+
+				int index = static_cast<int>(info->id);
+				CompiledLayout::Property& property = aNode.properties[index];
+				const char* value = aAttribute.value();
+				bool valid = true;
+
+				// Layout attributes share one property, starting from the ContainerLayout defaults
+				if (info->id == PropertyId::Layout && !aNode.hasProperty[index])
+				{
+					property.ints[0] = static_cast<int32_t>(ContainerLayout::Type::None);
+					property.ints[1] = ContainerLayout().padding;
+					property.ints[2] = ContainerLayout().spacing;
+					property.ints[3] = ContainerLayout().columns;
+				}
+
+				property.id = static_cast<uint16_t>(info->id);
+				aNode.hasProperty[index] = true;
+
+				switch (info->kind)
+				{
+				case ValueKind::String:
+					property.string = addString(value);
+					break;
+				case ValueKind::Int:
+					valid = parseInt(value, property.ints[0]);
+					break;
+				case ValueKind::Float:
+					valid = parseFloat(value, property.floats[0]);
+					break;
+				case ValueKind::Bool:
+					valid = parseBool(value, property.ints[0]);
+					break;
+				case ValueKind::Colour:
+					valid = parseColour(value, property.ints);
+					break;
+				case ValueKind::Anchors:
+				{
+					static const char* const names[] = { "top", "right", "bottom", "left" };
+					static const int flags[] = { 1 << 0, 1 << 1, 1 << 2, 1 << 3 };
+					valid = parseFlags(value, names, flags, property.ints[0]);
+					break;
+				}
+				case ValueKind::Align:
+				{
+					static const char* const names[] = { "left", "right", "top", "bottom", "centre", "center", "middle" };
+					static const int flags[] = { Align::LEFT, Align::RIGHT, Align::TOP, Align::BOTTOM, Align::CENTRE, Align::CENTRE, Align::MIDDLE };
+					valid = parseFlags(value, names, flags, property.ints[0]);
+					break;
+				}
+				case ValueKind::LayoutType:
+				{
+					static const char* const names[] = { "none", "row", "column", "grid" };
+					static const int types[] = { 0, 1, 2, 3 };
+					int32_t type = 0;
+					valid = parseFlags(value, names, types, type) && splitWords(value).size() == 1;
+					property.ints[0] = type;
+					break;
+				}
+				case ValueKind::LayoutPadding:
+					valid = parseInt(value, property.ints[1]);
+					break;
+				case ValueKind::LayoutSpacing:
+					valid = parseInt(value, property.ints[2]);
+					break;
+				case ValueKind::LayoutColumns:
+					valid = parseInt(value, property.ints[3]) && property.ints[3] > 0;
+					break;
+				}
+
+				if (!valid)
+					return fail(aElement, std::string("has an invalid ") + aAttribute.name() + " '" + value + "'");
+
+				return true;
+			}
+
+			bool compileElement(const pugi::xml_node& aElement, int32_t aParent, NodeType aParentType)
+			{
+				int type = 0;
+				while (type < 6 && strcmp(NODE_NAMES[type], aElement.name()) != 0)
+					type++;
+
+				if (type == 6)
+					return fail(aElement, "is not a layout element");
+
+				// Tabs live in tab views, and only there
+				bool isTab = static_cast<NodeType>(type) == NodeType::Tab;
+				bool inTabView = aParent >= 0 && aParentType == NodeType::TabView;
+				if (isTab != inTabView)
+					return fail(aElement, isTab ? "must be inside a <TabView>" : "can't be inside a <TabView>, use a <Tab>");
+
+				CompileNode node;
+				node.type = static_cast<NodeType>(type);
+				node.parent = aParent;
+
+				for (const pugi::xml_attribute& attribute : aElement.attributes())
+					if (!parseAttribute(node, aElement, attribute))
+						return false;
+
+				int32_t index = static_cast<int32_t>(nodes.size());
+				nodes.push_back(node);
+
+				for (const pugi::xml_node& child : aElement.children())
+				{
+					if (child.type() != pugi::node_element)
+						continue;
+
+					if (!compileElement(child, index, node.type))
+						return false;
+				}
+
+				return true;
+			}
+		};
+
+		bool getSourceStamp(const char* aPath, uint64_t& aSize, int64_t& aTime)
+		{
+			std::error_code error;
+			std::filesystem::path path(aPath);
+
+			aSize = static_cast<uint64_t>(std::filesystem::file_size(path, error));
+			if (error)
+				return false;
+
+			aTime = static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+			return !error;
+		}
+	}
+
+	CompiledLayout::~CompiledLayout()
+	{
+		reset();
+	}
+
+	void CompiledLayout::reset()
+	{
+		if (mappedView != nullptr)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(mappedView);
+#else
+			munmap(mappedView, mappedSize);
+#endif
+			mappedView = nullptr;
+			mappedSize = 0;
+		}
+
+		buffer.clear();
+		header = nullptr;
+		nodes = nullptr;
+		properties = nullptr;
+		strings = nullptr;
+	}
+
+	bool CompiledLayout::bind(const unsigned char* aData, size_t aSize)
+	{
+		header = nullptr;
+
+		if (aSize < sizeof(Header))
+		{
+			error = "compiled layout is truncated";
+			return false;
+		}
+
+		const Header* candidate = reinterpret_cast<const Header*>(aData);
+		if (memcmp(candidate->magic, "LMLC", 4) != 0 || candidate->version != VERSION)
+		{
+			error = "compiled layout is from another version";
+			return false;
+		}
+
+		size_t expected = sizeof(Header) + static_cast<size_t>(candidate->nodeCount) * sizeof(Node)
+			+ static_cast<size_t>(candidate->propertyCount) * sizeof(Property) + candidate->stringSize;
+
+		if (aSize != expected || (candidate->stringSize > 0 && aData[aSize - 1] != 0))
+		{
+			error = "compiled layout is truncated";
+			return false;
+		}
+
+		header = candidate;
+		nodes = reinterpret_cast<const Node*>(aData + sizeof(Header));
+		properties = reinterpret_cast<const Property*>(nodes + header->nodeCount);
+		strings = reinterpret_cast<const char*>(properties + header->propertyCount);
+
+		// Instantiating casts components by node type, trusting indices, parents and properties from
+		// here on, so check them once as the XML compiler does
+		for (uint32_t i = 0; i < header->nodeCount; i++)
+		{
+			const Node& node = nodes[i];
+			bool valid = node.type <= static_cast<uint8_t>(NodeType::Tab)
+				&& node.parent < static_cast<int32_t>(i) && node.parent >= -1
+				&& static_cast<uint64_t>(node.firstProperty) + node.propertyCount <= header->propertyCount;
+
+			// Tabs, and only tabs, go inside a tab view
+			if (valid)
+			{
+				bool isTab = node.type == static_cast<uint8_t>(NodeType::Tab);
+				bool inTabView = node.parent >= 0 && nodes[node.parent].type == static_cast<uint8_t>(NodeType::TabView);
+				valid = isTab == inTabView;
+			}
+
+			for (uint32_t p = 0; valid && p < node.propertyCount; p++)
+			{
+				const Property& property = properties[node.firstProperty + p];
+				valid = property.id < static_cast<uint16_t>(PropertyId::Count)
+					&& (getPropertyTypes(property.id) & (1u << node.type)) != 0;
+
+				bool isString = property.id == static_cast<uint16_t>(PropertyId::Name) || property.id == static_cast<uint16_t>(PropertyId::Text)
+					|| property.id == static_cast<uint16_t>(PropertyId::Font) || property.id == static_cast<uint16_t>(PropertyId::BackgroundImage);
+				if (valid && isString)
+					valid = property.string < header->stringSize;
+			}
+
+			if (!valid)
+			{
+				error = "compiled layout is corrupt";
+				header = nullptr;
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool CompiledLayout::compileFile(const char* aXmlPath)
+	{
+		reset();
+		error.clear();
+
+		pugi::xml_document document;
+		pugi::xml_parse_result result = document.load_file(aXmlPath);
+		if (!result)
+		{
+			error = std::string(aXmlPath) + ": " + result.description() + " at offset " + std::to_string(result.offset);
+			return false;
+		}
+
+		pugi::xml_node root = document.child("Layout");
+		if (!root)
+		{
+			error = std::string(aXmlPath) + ": missing <Layout> root";
+			return false;
+		}
+
+		Compiler compiler;
+		for (const pugi::xml_node& child : root.children())
+		{
+			if (child.type() != pugi::node_element)
+				continue;
+
+			if (!compiler.compileElement(child, -1, NodeType::Panel))
+			{
+				error = std::string(aXmlPath) + ": " + compiler.error;
+				return false;
+			}
+		}
+
+		// Flatten into the file layout
+		Header fileHeader = {};
+		memcpy(fileHeader.magic, "LMLC", 4);
+		fileHeader.version = VERSION;
+		getSourceStamp(aXmlPath, fileHeader.sourceSize, fileHeader.sourceTime);
+		fileHeader.nodeCount = static_cast<uint32_t>(compiler.nodes.size());
+
+		std::vector<Node> fileNodes;
+		std::vector<Property> fileProperties;
+		fileNodes.reserve(compiler.nodes.size());
+
+		for (const CompileNode& node : compiler.nodes)
+		{
+			Node fileNode = {};
+			fileNode.type = static_cast<uint8_t>(node.type);
+			fileNode.parent = node.parent;
+			fileNode.firstProperty = static_cast<uint32_t>(fileProperties.size());
+
+			for (int i = 0; i < static_cast<int>(PropertyId::Count); i++)
+				if (node.hasProperty[i])
+					fileProperties.push_back(node.properties[i]);
+
+			fileNode.propertyCount = static_cast<uint16_t>(fileProperties.size() - fileNode.firstProperty);
+			fileNodes.push_back(fileNode);
+		}
+
+		fileHeader.propertyCount = static_cast<uint32_t>(fileProperties.size());
+		fileHeader.stringSize = static_cast<uint32_t>(compiler.strings.size());
+
+		buffer.resize(sizeof(Header) + fileNodes.size() * sizeof(Node) + fileProperties.size() * sizeof(Property) + compiler.strings.size());
+		unsigned char* out = buffer.data();
+		memcpy(out, &fileHeader, sizeof(Header));
+		out += sizeof(Header);
+		memcpy(out, fileNodes.data(), fileNodes.size() * sizeof(Node));
+		out += fileNodes.size() * sizeof(Node);
+		memcpy(out, fileProperties.data(), fileProperties.size() * sizeof(Property));
+		out += fileProperties.size() * sizeof(Property);
+		memcpy(out, compiler.strings.data(), compiler.strings.size());
+
+		return bind(buffer.data(), buffer.size());
+	}
+
+	bool CompiledLayout::mapFile(const char* aCachePath)
+	{
+		reset();
+		error.clear();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(aCachePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			error = std::string(aCachePath) + ": can't open compiled layout";
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		HANDLE mapping = nullptr;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		// The view keeps the file open
+		if (mapping != nullptr)
+		{
+			mappedView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			mappedSize = static_cast<size_t>(fileSize.QuadPart);
+			CloseHandle(mapping);
+		}
+
+		CloseHandle(file);
+#else
+		int file = open(aCachePath, O_RDONLY);
+		if (file < 0)
+		{
+			error = std::string(aCachePath) + ": can't open compiled layout";
+			return false;
+		}
+
+		struct stat status;
+		if (fstat(file, &status) == 0 && status.st_size > 0)
+		{
+			void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+			if (view != MAP_FAILED)
+			{
+				mappedView = view;
+				mappedSize = static_cast<size_t>(status.st_size);
+			}
+		}
+
+		close(file);
+#endif
+
+		if (mappedView == nullptr)
+		{
+			error = std::string(aCachePath) + ": can't map compiled layout";
+			return false;
+		}
+
+		if (!bind(static_cast<const unsigned char*>(mappedView), mappedSize))
+		{
+			error = std::string(aCachePath) + ": " + error;
+			reset();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool CompiledLayout::save(const char* aCachePath) const
+	{
+		if (header == nullptr)
+			return false;
+
+		FILE* file = fopen(aCachePath, "wb");
+		if (file == nullptr)
+			return false;
+
+		size_t size = mappedView != nullptr ? mappedSize : buffer.size();
+		const void* data = mappedView != nullptr ? mappedView : buffer.data();
+		bool written = fwrite(data, 1, size, file) == size;
+
+		return fclose(file) == 0 && written;
+	}
+
+	bool CompiledLayout::isCompiledFrom(const char* aXmlPath) const
+	{
+		uint64_t size = 0;
+		int64_t time = 0;
+
+		if (header == nullptr || !getSourceStamp(aXmlPath, size, time))
+			return false;
+
+		return header->sourceSize == size && header->sourceTime == time;
+	}
+
+	Component* CompiledLayout::createNode(const Node& aNode, Component* aParent, bool aParentIsTab, ResourceManager* aResources) const
+	{
+		NodeType type = static_cast<NodeType>(aNode.type);
+		const Property* first = properties + aNode.firstProperty;
+		const Property* last = first + aNode.propertyCount;
+		Component* component = nullptr;
+
+		if (type == NodeType::Tab)
+		{
+			// Tabs are created by their view, titled by their text
+			const char* text = "Tab";
+			for (const Property* property = first; property != last; property++)
+				if (property->id == static_cast<uint16_t>(PropertyId::Text))
+					text = strings + property->string;
+
+			component = static_cast<TabView*>(aParent)->addTab(text);
+		}
+		else
+		{
+			switch (type)
+			{
+			case NodeType::Panel:
+				component = new Panel();
+				break;
+			case NodeType::Button:
+				component = new Button();
+				break;
+			case NodeType::Label:
+				component = new Label();
+				break;
+			case NodeType::Textbox:
+				component = new Textbox();
+				break;
+			default:
+				component = new TabView();
+				break;
+			}
+
+			// Added before its properties are set, so anchors measure against the parent
+			if (aParentIsTab)
+				static_cast<Tab*>(aParent)->addPanelChildControl(component);
+			else if (aParent != nullptr)
+				aParent->addChildControl(component);
+		}
+
+		for (const Property* property = first; property != last; property++)
+			applyProperty(component, type, *property, aResources);
+
+		return component;
+	}
+
+	void CompiledLayout::applyProperty(Component* aComponent, NodeType aType, const Property& aProperty, ResourceManager* aResources) const
+	{
+		const int32_t* ints = aProperty.ints;
+		const float* floats = aProperty.floats;
+
+		switch (static_cast<PropertyId>(aProperty.id))
+		{
+		case PropertyId::Name:
+			aComponent->setName(strings + aProperty.string);
+			break;
+
+		case PropertyId::Text:
+			aComponent->setText(strings + aProperty.string);
+			break;
+
+		case PropertyId::X:
+			aComponent->setLocation(ints[0], aComponent->getLocationY());
+			break;
+
+		case PropertyId::Y:
+			aComponent->setLocation(aComponent->getLocationX(), ints[0]);
+			break;
+
+		case PropertyId::Width:
+			aComponent->setSize(ints[0], aComponent->getHeight());
+			break;
+
+		case PropertyId::Height:
+			aComponent->setSize(aComponent->getWidth(), ints[0]);
+			break;
+
+		case PropertyId::BackColour:
+			aComponent->setBackColour(Colour(ints[0], ints[1], ints[2], ints[3]));
+			break;
+
+		case PropertyId::ForeColour:
+			aComponent->setForeColour(Colour(ints[0], ints[1], ints[2], ints[3]));
+			break;
+
+		case PropertyId::Stroke:
+			aComponent->setStroke(Colour(ints[0], ints[1], ints[2], ints[3]));
+			break;
+
+		case PropertyId::StrokeWidth:
+			aComponent->strokeWidth = floats[0];
+			break;
+
+		case PropertyId::HeaderColour:
+			static_cast<TabView*>(aComponent)->headerColour = Colour(ints[0], ints[1], ints[2], ints[3]);
+			break;
+
+		case PropertyId::ZOrder:
+			aComponent->setZOrder(ints[0]);
+			break;
+
+		case PropertyId::Enabled:
+			aComponent->enabled = ints[0] != 0;
+			break;
+
+		case PropertyId::Visible:
+			aComponent->show = ints[0] != 0;
+			break;
+
+		case PropertyId::Layered:
+			aComponent->setLayered(ints[0] != 0);
+			break;
+
+		case PropertyId::Layout:
+		{
+			ContainerLayout layout;
+			layout.type = static_cast<ContainerLayout::Type>(ints[0]);
+			layout.padding = ints[1];
+			layout.spacing = ints[2];
+			layout.columns = ints[3];
+			aComponent->setContainerLayout(layout);
+			break;
+		}
+
+		case PropertyId::Flex:
+			aComponent->setFlex(floats[0]);
+			break;
+
+		case PropertyId::FontSize:
+			if (aType == NodeType::Button)
+				static_cast<Button*>(aComponent)->setFontSize(static_cast<int>(floats[0]));
+			else
+				static_cast<Textbox*>(aComponent)->setFontSize(floats[0]);
+			break;
+
+		case PropertyId::Font:
+			static_cast<Textbox*>(aComponent)->setFont(strings + aProperty.string);
+			break;
+
+		case PropertyId::Align:
+			if (aType == NodeType::Label)
+				static_cast<Label*>(aComponent)->setAlign(Align(ints[0]));
+			else
+				static_cast<Textbox*>(aComponent)->setAlign(Align(ints[0]));
+			break;
+
+		case PropertyId::SingleLine:
+			static_cast<Label*>(aComponent)->setSingleLine(ints[0] != 0);
+			break;
+
+		case PropertyId::TextWrap:
+			static_cast<Label*>(aComponent)->setTextWrap(ints[0] != 0);
+			break;
+
+		case PropertyId::LineSpacing:
+			static_cast<Label*>(aComponent)->setLineSpacingFactor(floats[0]);
+			break;
+
+		case PropertyId::BackgroundImage:
+		{
+			if (aResources == nullptr)
+				break;
+
+			auto image = aResources->images.find(strings + aProperty.string);
+			if (image == aResources->images.end())
+				break;
+
+			if (aType == NodeType::Panel)
+				static_cast<Panel*>(aComponent)->setBackgroundImage(image->second);
+			else
+				static_cast<Button*>(aComponent)->setBackgroundImage(image->second);
+			break;
+		}
+
+		case PropertyId::Anchors:
+			for (int direction = 0; direction < 4; direction++)
+				aComponent->setAnchor(static_cast<Anchor::Direction>(direction), (ints[0] & (1 << direction)) != 0);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	std::vector<Component*> CompiledLayout::instantiate(Component* aParent, ResourceManager* aResources) const
+	{
+		std::vector<Component*> created = instantiateNodes(aParent, aResources);
+		std::vector<Component*> topLevel;
+
+		for (uint32_t i = 0; i < created.size(); i++)
+			if (nodes[i].parent < 0)
+				topLevel.push_back(created[i]);
+
+		return topLevel;
+	}
+
+	std::vector<Component*> CompiledLayout::instantiateNodes(Component* aParent, ResourceManager* aResources) const
+	{
+		if (header == nullptr)
+			return std::vector<Component*>();
+
+		// Parents always come before their children
+		std::vector<Component*> created(header->nodeCount, nullptr);
+
+		for (uint32_t i = 0; i < header->nodeCount; i++)
+		{
+			const Node& node = nodes[i];
+			Component* parent = node.parent >= 0 ? created[node.parent] : aParent;
+			bool parentIsTab = node.parent >= 0 && nodes[node.parent].type == static_cast<uint8_t>(NodeType::Tab);
+
+			created[i] = createNode(node, parent, parentIsTab, aResources);
+		}
+
+		// Tabs are selected once they all exist
+		for (uint32_t i = 0; i < header->nodeCount; i++)
+		{
+			const Node& node = nodes[i];
+			for (uint32_t p = 0; p < node.propertyCount; p++)
+			{
+				const Property& property = properties[node.firstProperty + p];
+				if (property.id == static_cast<uint16_t>(PropertyId::ActiveTab))
+					static_cast<TabView*>(created[i])->setActiveTab(property.ints[0]);
+			}
+		}
+
+		return created;
+	}
+
+	const char* CompiledLayout::getNodeName(uint32_t aIndex) const
+	{
+		const Node& node = nodes[aIndex];
+
+		// Properties are sorted by id, so the name is first when set
+		if (node.propertyCount > 0 && properties[node.firstProperty].id == static_cast<uint16_t>(PropertyId::Name))
+			return strings + properties[node.firstProperty].string;
+
+		return nullptr;
+	}
+
+	bool CompiledLayout::isSameValue(const Property& aProperty, const CompiledLayout& aOther, const Property& aOtherProperty) const
+	{
+		PropertyId id = static_cast<PropertyId>(aProperty.id);
+		if (id == PropertyId::Name || id == PropertyId::Text || id == PropertyId::Font || id == PropertyId::BackgroundImage)
+			return strcmp(strings + aProperty.string, aOther.strings + aOtherProperty.string) == 0;
+
+		return memcmp(aProperty.ints, aOtherProperty.ints, sizeof(aProperty.ints)) == 0;
+	}
+
+	std::vector<Component*> CompiledLayout::patch(const CompiledLayout& aPrevious, const std::vector<Component*>& aPreviousComponents,
+		Component* aParent, ResourceManager* aResources, PatchStats* aStats) const
+	{
+		PatchStats stats;
+		if (header == nullptr)
+			return std::vector<Component*>();
+
+		uint32_t previousCount = aPrevious.header != nullptr ? aPrevious.header->nodeCount : 0;
+		if (aPreviousComponents.size() != previousCount)
+			previousCount = 0;
+
+		// Key nodes by type and name, or by position among unnamed siblings of the same type
+		auto makeKeys = [](const CompiledLayout& aLayout, uint32_t aCount)
+		{
+			std::vector<std::string> keys(aCount);
+			std::unordered_map<std::string, int> ordinals;
+
+			for (uint32_t i = 0; i < aCount; i++)
+			{
+				std::string typeKey = std::to_string(aLayout.nodes[i].type);
+				const char* name = aLayout.getNodeName(i);
+
+				if (name != nullptr)
+					keys[i] = typeKey + "=" + name;
+				else
+					keys[i] = typeKey + "#" + std::to_string(ordinals[std::to_string(aLayout.nodes[i].parent) + "/" + typeKey]++);
+			}
+
+			return keys;
+		};
+
+		std::vector<std::string> previousKeys = makeKeys(aPrevious, previousCount);
+		std::vector<std::string> keys = makeKeys(*this, header->nodeCount);
+
+		// Previous nodes by parent and key, the first of any duplicates winning
+		std::unordered_map<std::string, uint32_t> previousNodes;
+		for (uint32_t i = 0; i < previousCount; i++)
+			previousNodes.emplace(std::to_string(aPrevious.nodes[i].parent) + "/" + previousKeys[i], i);
+
+		// Match nodes under matched parents, top down
+		std::vector<int32_t> match(header->nodeCount, -1);
+		std::vector<bool> kept(previousCount, false);
+
+		for (uint32_t i = 0; i < header->nodeCount; i++)
+		{
+			int32_t parent = nodes[i].parent;
+			int32_t previousParent = parent >= 0 ? match[parent] : -1;
+			if (parent >= 0 && previousParent < 0)
+				continue;
+
+			auto found = previousNodes.find(std::to_string(previousParent) + "/" + keys[i]);
+			if (found == previousNodes.end() || kept[found->second])
+				continue;
+
+			// A property no longer set can't be reset, so the node is created again
+			const Node& previous = aPrevious.nodes[found->second];
+			const Property* current = properties + nodes[i].firstProperty;
+			const Property* currentEnd = current + nodes[i].propertyCount;
+			bool removedProperty = false;
+
+			for (uint32_t p = 0; p < previous.propertyCount && !removedProperty; p++)
+			{
+				uint16_t id = aPrevious.properties[previous.firstProperty + p].id;
+				while (current != currentEnd && current->id < id)
+					current++;
+
+				removedProperty = current == currentEnd || current->id != id;
+			}
+
+			if (removedProperty)
+				continue;
+
+			match[i] = static_cast<int32_t>(found->second);
+			kept[found->second] = true;
+		}
+
+		// Remove unmatched subtrees from the top, their children go with them
+		for (uint32_t i = 0; i < previousCount; i++)
+		{
+			int32_t parent = aPrevious.nodes[i].parent;
+			if (kept[i] || (parent >= 0 && !kept[parent]))
+				continue;
+
+			Component* component = aPreviousComponents[i];
+			if (component->getParent() != nullptr)
+				component->getParent()->removeChildControl(component);
+
+			stats.removed++;
+		}
+
+		// Update kept nodes and create new ones, parents first
+		std::vector<Component*> components(header->nodeCount, nullptr);
+
+		for (uint32_t i = 0; i < header->nodeCount; i++)
+		{
+			const Node& node = nodes[i];
+			NodeType type = static_cast<NodeType>(node.type);
+			Component* parent = node.parent >= 0 ? components[node.parent] : aParent;
+			bool parentIsTab = node.parent >= 0 && nodes[node.parent].type == static_cast<uint8_t>(NodeType::Tab);
+
+			if (match[i] < 0)
+			{
+				components[i] = createNode(node, parent, parentIsTab, aResources);
+				stats.created++;
+				continue;
+			}
+
+			Component* component = aPreviousComponents[match[i]];
+			const Node& previous = aPrevious.nodes[match[i]];
+			const Property* previousProperty = aPrevious.properties + previous.firstProperty;
+			const Property* previousEnd = previousProperty + previous.propertyCount;
+			bool changed = false;
+			bool geometryChanged = false;
+
+			for (uint32_t p = 0; p < node.propertyCount; p++)
+			{
+				const Property& property = properties[node.firstProperty + p];
+				PropertyId id = static_cast<PropertyId>(property.id);
+
+				while (previousProperty != previousEnd && previousProperty->id < property.id)
+					previousProperty++;
+
+				bool same = previousProperty != previousEnd && previousProperty->id == property.id
+					&& isSameValue(property, aPrevious, *previousProperty);
+
+				// Anchor offsets are measured from the geometry, so follow its changes
+				if (same && !(id == PropertyId::Anchors && geometryChanged))
+					continue;
+
+				if (id == PropertyId::ActiveTab)
+					static_cast<TabView*>(component)->setActiveTab(property.ints[0]);
+				else
+					applyProperty(component, type, property, aResources);
+
+				geometryChanged = geometryChanged || id == PropertyId::X || id == PropertyId::Y || id == PropertyId::Width || id == PropertyId::Height;
+				changed = true;
+			}
+
+			if (changed)
+				stats.updated++;
+
+			components[i] = component;
+		}
+
+		// Put siblings back in document order, moving as few as possible
+		std::unordered_map<int32_t, Component*> lastSibling;
+
+		for (uint32_t i = 0; i < header->nodeCount; i++)
+		{
+			int32_t parentIndex = nodes[i].parent;
+			Component* container = parentIndex >= 0 ? components[parentIndex] : aParent;
+			if (parentIndex >= 0 && nodes[parentIndex].type == static_cast<uint8_t>(NodeType::Tab))
+				container = static_cast<Tab*>(container)->panel;
+
+			Component*& previous = lastSibling[parentIndex];
+			if (previous != nullptr && container != nullptr)
+			{
+				int index = container->getChildIndex(components[i]);
+				int previousIndex = container->getChildIndex(previous);
+				if (index < previousIndex)
+					container->setChildIndex(components[i], previousIndex);
+			}
+
+			previous = components[i];
+		}
+
+		// Tab views may have lost or reordered tabs, keep the selected one
+		for (uint32_t i = 0; i < header->nodeCount; i++)
+		{
+			if (nodes[i].type != static_cast<uint8_t>(NodeType::TabView) || match[i] < 0)
+				continue;
+
+			TabView* tabView = static_cast<TabView*>(components[i]);
+			Tab* active = tabView->getActiveTab();
+			tabView->setActiveTab(active != nullptr ? tabView->getIndexOfTab(active) : 0);
+		}
+
+		if (aStats != nullptr)
+			*aStats = stats;
+
+		return components;
+	}
+
+	bool CompiledLayout::isLoaded() const
+	{
+		return header != nullptr;
+	}
+
+	int CompiledLayout::getNodeCount() const
+	{
+		return header != nullptr ? static_cast<int>(header->nodeCount) : 0;
+	}
+
+	const std::string& CompiledLayout::getError() const
+	{
+		return error;
+	}
+
+
+
+	bool LayoutLoader::compile(CompiledLayout& aLayout, const char* aXmlPath, const char* aCachePath)
+	{
+		// Only trust a cache built from the XML as it is now
+		if (aCachePath != nullptr && aLayout.mapFile(aCachePath) && aLayout.isCompiledFrom(aXmlPath))
+			return true;
+
+		if (!aLayout.compileFile(aXmlPath))
+		{
+			lastError = aLayout.getError();
+			return false;
+		}
+
+		if (aCachePath != nullptr)
+			aLayout.save(aCachePath);
+
+		return true;
+	}
+
+	bool LayoutLoader::load(Component* aParent, const char* aXmlPath, const char* aCachePath, ResourceManager* aResources)
+	{
+		CompiledLayout layout;
+		if (!compile(layout, aXmlPath, aCachePath))
+			return false;
+
+		layout.instantiate(aParent, aResources);
+		return true;
+	}
+
+	const std::string& LayoutLoader::getLastError()
+	{
+		return lastError;
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_LAYOUT_LOADER_CPP
@@ -0,0 +1,229 @@
+#ifndef LEMUR_LAYOUT_LOADER_H
+#define LEMUR_LAYOUT_LOADER_H
+
+/**************************************************************************************
+* Lemur:        Layout Loader Classes                                                 *
+*-------------------------------------------------------------------------------------*
+* Filename:     LayoutLoader.h                                                        *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Builds component trees from XML layout files, so forms can change without         *
+*   recompiling. Layouts are compiled to a flat binary form, which is cached on disk  *
+*   and memory mapped on later launches to skip parsing the XML.                      *
+*                                                                                     *
+* Notes:                                                                              *
+*   A layout is a <Layout> root holding Panel, Button, Label, Textbox and TabView     *
+*   elements. Tabs are <Tab text="..."> elements inside a TabView, their children     *
+*   going into the tab's panel. Attributes are parsed when compiling, so a compiled   *
+*   layout is instantiated without any string parsing. Example:                       *
+*                                                                                     *
+*     <Layout>                                                                        *
+*       <Panel name="Sidebar" x="0" y="0" width="200" height="600"                    *
+*              backColour="#1F2730" anchors="top bottom left" layout="column">         *
+*         <Button name="Save" height="30" text="Save"/>                               *
+*       </Panel>                                                                      *
+*     </Layout>                                                                       *
+***************************************************************************************/
+
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace Lemur
+{
+	class Component;
+	class ResourceManager;
+
+	// A layout in its compiled form: flat arrays of nodes, in document order, and their properties
+	class CompiledLayout
+	{
+	public:
+
+		// Compiled file format, bumped when any of the records below change
+		static const uint32_t VERSION = 1;
+
+		enum class NodeType : uint8_t
+		{
+			Panel = 0,
+			Button = 1,
+			Label = 2,
+			Textbox = 3,
+			TabView = 4,
+			Tab = 5
+		};
+
+		// Properties are stored in this order for each node, so geometry is set before anchors
+		enum class PropertyId : uint16_t
+		{
+			Name = 0,			// string
+			Text,				// string
+			X,					// int
+			Y,					// int
+			Width,				// int
+			Height,				// int
+			BackColour,			// r, g, b, a
+			ForeColour,			// r, g, b, a
+			Stroke,				// r, g, b, a
+			StrokeWidth,		// float
+			HeaderColour,		// r, g, b, a
+			ZOrder,				// int
+			Enabled,			// bool
+			Visible,			// bool
+			Layered,			// bool
+			Layout,				// type, padding, spacing, columns
+			Flex,				// float
+			FontSize,			// float
+			Font,				// string
+			Align,				// Align flags
+			SingleLine,			// bool
+			TextWrap,			// bool
+			LineSpacing,		// float
+			BackgroundImage,	// string, an image reference in the resource manager
+			Anchors,			// Anchor::Direction bits
+			ActiveTab,			// int, applied once the tabs exist
+			Count
+		};
+
+		// Changes made by patch()
+		struct PatchStats
+		{
+			int updated = 0;			// Kept components with changed properties
+			int created = 0;			// Components added
+			int removed = 0;			// Subtrees removed
+		};
+
+		// Compiled records, laid out for reading straight from a mapped file
+		struct Header
+		{
+			char magic[4];				// "LMLC"
+			uint32_t version;
+			uint64_t sourceSize;		// Size of the XML file compiled
+			int64_t sourceTime;			// Last write time of the XML file compiled
+			uint32_t nodeCount;
+			uint32_t propertyCount;
+			uint32_t stringSize;		// Bytes of null terminated strings after the properties
+			uint32_t reserved;
+		};
+
+		struct Node
+		{
+			uint8_t type;				// NodeType
+			uint8_t reserved;
+			uint16_t propertyCount;
+			uint32_t firstProperty;
+			int32_t parent;				// Index of the parent node, or -1 for the top level
+		};
+
+		struct Property
+		{
+			uint16_t id;				// PropertyId
+			uint16_t reserved;
+			union
+			{
+				int32_t ints[4];
+				float floats[4];
+				uint32_t string;		// Offset into the strings
+			};
+		};
+
+	private:
+
+		// Compiled from XML, or the mapped cache file
+		std::vector<unsigned char> buffer;
+		void* mappedView = nullptr;
+		size_t mappedSize = 0;
+
+		// Views into the data
+		const Header* header = nullptr;
+		const Node* nodes = nullptr;
+		const Property* properties = nullptr;
+		const char* strings = nullptr;
+
+		std::string error;
+
+		// Check compiled data and point the views into it
+		bool bind(const unsigned char* aData, size_t aSize);
+
+		// Release the buffer or mapping
+		void reset();
+
+		// Find a node's name, or null if it has none
+		const char* getNodeName(uint32_t aIndex) const;
+
+		// Check if two properties hold the same value
+		bool isSameValue(const Property& aProperty, const CompiledLayout& aOther, const Property& aOtherProperty) const;
+
+		// Create a node's component, add it to its parent and apply its properties
+		Component* createNode(const Node& aNode, Component* aParent, bool aParentIsTab, ResourceManager* aResources) const;
+		void applyProperty(Component* aComponent, NodeType aType, const Property& aProperty, ResourceManager* aResources) const;
+
+	public:
+
+		CompiledLayout() = default;
+		CompiledLayout(const CompiledLayout&) = delete;
+		CompiledLayout& operator=(const CompiledLayout&) = delete;
+		~CompiledLayout();
+
+		// Parse and compile an XML layout file. Returns false, with getError() set, if it is invalid.
+		bool compileFile(const char* aXmlPath);
+
+		// Map a compiled layout written by save(). Returns false if it is missing or from another version.
+		bool mapFile(const char* aCachePath);
+
+		// Write the compiled layout to a cache file
+		bool save(const char* aCachePath) const;
+
+		// Check if the compiled layout was built from the current version of an XML file
+		bool isCompiledFrom(const char* aXmlPath) const;
+
+		// Create the components and add them to a parent, returning the top level components.
+		// Background images are looked up in the resource manager, if one is given.
+		std::vector<Component*> instantiate(Component* aParent, ResourceManager* aResources = nullptr) const;
+
+		// Create the components as instantiate() does, returning the component of every node
+		std::vector<Component*> instantiateNodes(Component* aParent, ResourceManager* aResources = nullptr) const;
+
+		// Change components instantiated from a previous version of the layout to match this one, returning
+		// the component of every node. Nodes are matched by type and name, or by position among unnamed
+		// siblings of the same type. Matched components keep their state and only have changed properties
+		// set. A node which no longer sets a property is created again, as the default isn't known.
+		std::vector<Component*> patch(const CompiledLayout& aPrevious, const std::vector<Component*>& aPreviousComponents,
+			Component* aParent, ResourceManager* aResources = nullptr, PatchStats* aStats = nullptr) const;
+
+		// Getters
+		bool isLoaded() const;
+		int getNodeCount() const;
+		const std::string& getError() const;
+	};
+
+
+	class LayoutLoader
+	{
+	public:
+
+		// Get the compiled form of an XML layout, from the cache if it is up to date with the XML,
+		// otherwise compiling the XML and rewriting the cache. Returns false if the XML is invalid.
+		static bool compile(CompiledLayout& aLayout, const char* aXmlPath, const char* aCachePath = nullptr);
+
+		// Load an XML layout into a parent. With a cache path, the compiled cache is mapped if it is
+		// up to date with the XML file, otherwise the XML is compiled and the cache rewritten.
+		// Returns false, adding nothing, if the layout can't be loaded.
+		static bool load(Component* aParent, const char* aXmlPath, const char* aCachePath = nullptr, ResourceManager* aResources = nullptr);
+
+		// Error from the last load that failed
+		static const std::string& getLastError();
+
+	private:
+
+		static std::string lastError;
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_LAYOUT_LOADER_H
@@ -0,0 +1,337 @@
+#ifndef LEMUR_UI_LIST_VIEW_CPP
+#define LEMUR_UI_LIST_VIEW_CPP
+
+/**************************************************************************************
+* Lemur:        GUI Virtualized List View Class                                       *
+*-------------------------------------------------------------------------------------*
+* Filename:     list_view.cpp                                                         *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Scrolling list and grid containers for large data sets. Rows are supplied by a    *
+*   data source and shown through a small pool of recycled row widgets, so memory     *
+*   and frame time depend on the visible rows rather than the total.                  *
+***************************************************************************************/
+
+
+
+#include <algorithm>
+#include <cmath>
+#include "list_view.h"
+#include "label.h"
+
+
+namespace Lemur
+{
+	/**
+	* \brief Constructs a ListView object with the specified attributes.
+	* \param location (Point) The position of the list.
+	* \param size (Point) The size of the list.
+	*/
+	ListView::ListView(int aX, int aY, int aWidth, int aHeight)
+	{
+		location.x = aX;
+		location.y = aY;
+		size.x = aWidth;
+		size.y = aHeight;
+
+		backColour = Colour::BACKGROUND1;
+		stroke = Colour(0, 0, 0, 0);
+		foreColour = Colour(255, 255, 255, 200);
+		scrollbarColour = Colour(255, 255, 255, 80);
+
+		text = "";
+	}
+
+	void* ListView::operator new(size_t aSize)
+	{
+		return ComponentArena::allocate<ListView>(aSize);
+	}
+
+	void ListView::operator delete(void* aPointer, size_t aSize)
+	{
+		ComponentArena::deallocate<ListView>(aPointer, aSize);
+	}
+
+
+	void ListView::setDataSource(const ListDataSource& aDataSource)
+	{
+		// Widgets from the old source may be of a different type
+		resizePool(0);
+
+		dataSource = aDataSource;
+		scrollOffset = 0;
+		refresh();
+	}
+
+	const ListDataSource& ListView::getDataSource() const
+	{
+		return dataSource;
+	}
+
+	void ListView::refresh()
+	{
+		rowCount = dataSource.getRowCount ? std::max(0, dataSource.getRowCount()) : 0;
+
+		std::fill(boundRows.begin(), boundRows.end(), -1);
+		layoutRows();
+		invalidate();
+	}
+
+	void ListView::refreshRow(int aRow)
+	{
+		if (pool.empty() || aRow < 0)
+			return;
+
+		int slot = aRow % static_cast<int>(pool.size());
+		if (boundRows[slot] != aRow)
+			return;
+
+		if (dataSource.bindRow)
+			dataSource.bindRow(aRow, pool[slot]);
+
+		pool[slot]->invalidate();
+	}
+
+
+	// Getters and Setters
+	int ListView::getColumns() const
+	{
+		return columns;
+	}
+
+	void ListView::setColumns(int aColumns)
+	{
+		aColumns = std::max(1, aColumns);
+		if (columns == aColumns)
+			return;
+
+		columns = aColumns;
+		layoutDirty = true;
+		invalidate();
+	}
+
+	int ListView::getRowCount() const
+	{
+		return rowCount;
+	}
+
+	double ListView::getScrollOffset() const
+	{
+		return scrollOffset;
+	}
+
+	void ListView::setScrollOffset(double aOffset)
+	{
+		double maxOffset = std::max(0.0, getContentHeight() - size.y);
+		aOffset = std::clamp(aOffset, 0.0, maxOffset);
+
+		if (scrollOffset == aOffset)
+			return;
+
+		scrollOffset = aOffset;
+		layoutRows();
+
+		// Redraw the background and scroll indicator
+		invalidate();
+	}
+
+	double ListView::getContentHeight() const
+	{
+		return static_cast<double>(getLineCount()) * getRowHeight();
+	}
+
+	void ListView::scrollToRow(int aRow)
+	{
+		if (aRow < 0 || aRow >= rowCount)
+			return;
+
+		double top = static_cast<double>(aRow / columns) * getRowHeight();
+		double bottom = top + getRowHeight();
+
+		if (top < scrollOffset)
+			setScrollOffset(top);
+		else if (bottom > scrollOffset + size.y)
+			setScrollOffset(bottom - size.y);
+	}
+
+	int ListView::getRowOf(const Component* aWidget) const
+	{
+		for (int i = 0; i < static_cast<int>(pool.size()); i++)
+			if (pool[i] == aWidget)
+				return boundRows[i];
+
+		return -1;
+	}
+
+	int ListView::getRowHeight() const
+	{
+		return std::max(1, dataSource.rowHeight);
+	}
+
+	int ListView::getLineCount() const
+	{
+		return (rowCount + columns - 1) / columns;
+	}
+
+
+	void ListView::resizePool(int aSize)
+	{
+		if (static_cast<int>(pool.size()) == aSize)
+			return;
+
+		// Drop widgets from the end, the children own them
+		while (static_cast<int>(pool.size()) > aSize)
+		{
+			Component* widget = pool.back();
+			pool.pop_back();
+
+			for (int i = 0; i < static_cast<int>(childComponents.size()); i++)
+			{
+				if (childComponents[i].get() == widget)
+				{
+					detachChild(i);
+					break;
+				}
+			}
+		}
+
+		while (static_cast<int>(pool.size()) < aSize)
+		{
+			Component* widget = dataSource.createRow ? dataSource.createRow() : new Label(0, 0, 0, 0, "");
+			addChildControl(widget);
+			pool.push_back(widget);
+		}
+
+		// Slots map to different rows with a new pool size
+		boundRows.assign(pool.size(), -1);
+	}
+
+	void ListView::layoutRows()
+	{
+		layoutDirty = false;
+		lastSize = size;
+
+		int rowHeight = getRowHeight();
+		double maxOffset = std::max(0.0, getContentHeight() - size.y);
+		scrollOffset = std::clamp(scrollOffset, 0.0, maxOffset);
+
+		// Enough lines to cover the view when the first is partly scrolled out
+		int visibleLines = static_cast<int>(std::ceil(size.y / rowHeight)) + 1;
+		resizePool(std::min(visibleLines * columns, rowCount));
+
+		if (pool.empty())
+			return;
+
+		int poolSize = static_cast<int>(pool.size());
+		int firstRow = static_cast<int>(scrollOffset / rowHeight) * columns;
+		int lastRow = std::min(firstRow + poolSize, rowCount);
+
+		// Leave room for the scroll indicator when the content overflows
+		double cellWidth = (size.x - (maxOffset > 0 ? SCROLLBAR_WIDTH : 0)) / columns;
+
+		for (int row = firstRow; row < lastRow; row++)
+		{
+			int slot = row % poolSize;
+			Component* widget = pool[slot];
+
+			widget->enabled = true;
+			widget->setLocation((row % columns) * cellWidth, static_cast<double>(row / columns) * rowHeight - scrollOffset);
+			widget->setSize(cellWidth, static_cast<double>(rowHeight));
+
+			if (boundRows[slot] != row)
+			{
+				boundRows[slot] = row;
+
+				if (dataSource.bindRow)
+					dataSource.bindRow(row, widget);
+			}
+		}
+
+		// Slots past the last row, parked below the view where they can't be drawn or hit
+		for (int row = lastRow; row < firstRow + poolSize; row++)
+		{
+			int slot = row % poolSize;
+			Component* widget = pool[slot];
+
+			widget->enabled = false;
+			widget->setLocation(0.0, static_cast<double>(size.y) + rowHeight);
+			boundRows[slot] = -1;
+		}
+	}
+
+
+	/**
+	* \brief Renders a ListView to a given NanoVG context (NVGContext).
+	* \param context (NVGcontext*) The nanovg pointer for rendering.
+	*/
+	void ListView::onFrame(NVGcontext* aContext)
+	{
+		// Re-layout when resized, for instance by anchors
+		if (layoutDirty || size.x != lastSize.x || size.y != lastSize.y)
+			layoutRows();
+
+		// Static cast properties
+		float x = getLocation().x;
+		float y = getLocation().y;
+		float w = size.x;
+		float h = size.y;
+
+		//
+		// Begin drawing ListView
+		//
+		Draw::Rect(aContext, x, y, w, h, backColour);
+
+		// Draw the visible rows
+		drawChildComponents(aContext);
+
+		// Scroll position indicator
+		double contentHeight = getContentHeight();
+		if (contentHeight > h)
+		{
+			float thumbHeight = std::max(16.0f, static_cast<float>(h * h / contentHeight));
+			float thumbY = y + static_cast<float>((h - thumbHeight) * scrollOffset / (contentHeight - h));
+
+			Draw::RoundedRect(aContext, x + w - SCROLLBAR_WIDTH, thumbY, SCROLLBAR_WIDTH, thumbHeight, SCROLLBAR_WIDTH / 2, scrollbarColour);
+		}
+
+		Draw::RectStroke(aContext, x, y, w, h, 0.5, stroke);
+	}
+
+
+	void ListView::actionEvents(InputMap* aInput)
+	{
+		// Wheel steps are positive scrolling up
+		if (mouseOver && aInput->mouse.scroll != 0)
+			setScrollOffset(scrollOffset - static_cast<double>(aInput->mouse.scroll) * SCROLL_ROWS * getRowHeight());
+	}
+
+
+	/**
+	* \brief Constructs a GridView object with the specified attributes.
+	* \param location (Point) The position of the grid.
+	* \param size (Point) The size of the grid.
+	* \param columns (int) The number of cells per line.
+	*/
+	GridView::GridView(int aX, int aY, int aWidth, int aHeight, int aColumns)
+		: ListView(aX, aY, aWidth, aHeight)
+	{
+		columns = std::max(1, aColumns);
+	}
+
+	void* GridView::operator new(size_t aSize)
+	{
+		return ComponentArena::allocate<GridView>(aSize);
+	}
+
+	void GridView::operator delete(void* aPointer, size_t aSize)
+	{
+		ComponentArena::deallocate<GridView>(aPointer, aSize);
+	}
+
+}// namespace Lemur
+
+
+#endif // !LEMUR_UI_LIST_VIEW_CPP
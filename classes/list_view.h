@@ -0,0 +1,144 @@
+#ifndef LEMUR_UI_LIST_VIEW_H
+#define LEMUR_UI_LIST_VIEW_H
+
+/**************************************************************************************
+* Lemur:        GUI Virtualized List View Class                                       *
+*-------------------------------------------------------------------------------------*
+* Filename:     list_view.h                                                           *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Scrolling list and grid containers for large data sets. Rows are supplied by a    *
+*   data source and shown through a small pool of recycled row widgets, so memory     *
+*   and frame time depend on the visible rows rather than the total.                  *
+*                                                                                     *
+* Notes:                                                                              *
+*   Row widgets are rebound as they scroll into view, so any state they hold must be  *
+*   restored by the bind callback. Call refresh() after the data set changes.         *
+***************************************************************************************/
+
+
+
+#include <functional>
+#include <vector>
+#include "core.h"
+#include "component.h"
+#include "draw.h"
+
+
+namespace Lemur
+{
+	// Supplies the rows of a ListView
+	struct ListDataSource
+	{
+		std::function<int()> getRowCount;						// Number of rows in the data set
+		int rowHeight = 24;										// Height of every row in pixels
+		std::function<Component*()> createRow;					// Create a row widget for the pool, a Label if not set
+		std::function<void(int, Component*)> bindRow;			// Show a row's data in a pooled widget
+	};
+
+
+	class ListView : public Component
+	{
+	protected:
+		// Scrolling
+		static const int SCROLL_ROWS = 3;			// Rows moved per mouse wheel step
+		static const int SCROLLBAR_WIDTH = 6;		// Width of the scroll position indicator
+
+		ListDataSource dataSource;
+		int columns = 1;							// Cells per row line, more than one lays rows out as a grid
+		int rowCount = 0;							// Row count read at the last refresh
+		double scrollOffset = 0;					// Pixels scrolled from the top of the content
+
+		// Recycled row widgets, owned as children. A row is shown by slot (row % pool size),
+		// so scrolling by a line only rebinds the slots that came into view.
+		std::vector<Component*> pool;
+		std::vector<int> boundRows;					// Row bound to each slot, -1 when unbound
+		bool layoutDirty = true;
+		Vector2 lastSize;
+
+		Colour scrollbarColour;
+
+		// Create or drop row widgets so the pool covers the visible rows
+		void resizePool(int aSize);
+
+		// Position pool widgets over the visible rows, binding any that changed row
+		void layoutRows();
+
+		// Get the height of a row, at least one pixel
+		int getRowHeight() const;
+
+		// Get the number of row lines, rows divided across the columns
+		int getLineCount() const;
+
+	public:
+
+		/**
+			* \brief Constructs a ListView object with the specified attributes.
+			* \param location (Point) The position of the list.
+			* \param size (Point) The size of the list.
+			*/
+		ListView(int aX = 0, int aY = 0, int aWidth = 200, int aHeight = 300);
+
+		// Allocated from this class's own arena pool
+		static void* operator new(size_t aSize);
+		static void operator delete(void* aPointer, size_t aSize);
+
+		// Data source, replaces the row widget pool
+		void setDataSource(const ListDataSource& aDataSource);
+		const ListDataSource& getDataSource() const;
+
+		// Re-read the row count and rebind every visible row
+		void refresh();
+
+		// Rebind a single row if it is visible
+		void refreshRow(int aRow);
+
+		// Getters and Setters
+		int getColumns() const;
+		void setColumns(int aColumns);
+		int getRowCount() const;
+		double getScrollOffset() const;
+		void setScrollOffset(double aOffset);
+		double getContentHeight() const;
+
+		// Scroll the least distance that brings a row fully into view
+		void scrollToRow(int aRow);
+
+		// Get the row a pooled widget is showing, or -1
+		int getRowOf(const Component* aWidget) const;
+
+		/**
+			* \brief Renders a ListView to a given NanoVG context (NVGContext).
+			* \param context (NVGcontext*) The nanovg pointer for rendering.
+			*/
+		virtual void onFrame(NVGcontext* aContext) override;
+
+		void actionEvents(InputMap* aInput);
+
+	};
+
+
+	// ListView laying its rows out as cells, a fixed number per line
+	class GridView : public ListView
+	{
+	public:
+
+		/**
+			* \brief Constructs a GridView object with the specified attributes.
+			* \param location (Point) The position of the grid.
+			* \param size (Point) The size of the grid.
+			* \param columns (int) The number of cells per line.
+			*/
+		GridView(int aX = 0, int aY = 0, int aWidth = 300, int aHeight = 300, int aColumns = 4);
+
+		// Allocated from this class's own arena pool
+		static void* operator new(size_t aSize);
+		static void operator delete(void* aPointer, size_t aSize);
+	};
+
+}// namespace Lemur
+
+#endif // !LEMUR_UI_LIST_VIEW_H
@@ -44,6 +44,16 @@ namespace Lemur
 		text = "";
 	}
 
+	void* Panel::operator new(size_t aSize)
+	{
+		return ComponentArena::allocate<Panel>(aSize);
+	}
+
+	void Panel::operator delete(void* aPointer, size_t aSize)
+	{
+		ComponentArena::deallocate<Panel>(aPointer, aSize);
+	}
+
 	void Panel::setBackgroundImage(Image* aImage)
 	{
 		backgroundImage = aImage;
@@ -39,6 +39,10 @@ namespace Lemur
 			*/
 		Panel(int aX = 0, int aY = 0, int aWidth = 150, int aHeight = 30);
 
+		// Allocated from this class's own arena pool
+		static void* operator new(size_t aSize);
+		static void operator delete(void* aPointer, size_t aSize);
+
 		void setBackgroundImage(Image* aImage);
 		void clearBackgroundImage();
 			
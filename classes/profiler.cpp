@@ -0,0 +1,306 @@
+#ifndef LEMUR_PROFILER_CPP
+#define LEMUR_PROFILER_CPP
+
+/**************************************************************************************
+* Lemur:        Frame Profiler Class                                                  *
+*-------------------------------------------------------------------------------------*
+* Filename:     Profiler.cpp                                                          *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Records high resolution timings for each frame phase and component, along with   *
+*   NanoVG render statistics. Timings are kept in lock-free ring buffers and can be   *
+*   dumped as a Chrome trace (chrome://tracing, Perfetto).                            *
+***************************************************************************************/
+
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "profiler.h"
+
+
+namespace Lemur
+{
+	bool Profiler::enabled = false;
+
+	Profiler::Slot Profiler::events[Profiler::EVENT_CAPACITY];
+	std::atomic<unsigned long long> Profiler::eventHead{ 0 };
+
+	Profiler::FrameRecord Profiler::frames[Profiler::FRAME_CAPACITY];
+	std::atomic<unsigned long long> Profiler::frameHead{ 0 };
+
+	Profiler::FrameRecord Profiler::currentFrame;
+	long long Profiler::phaseStart = 0;
+	bool Profiler::frameOpen = false;
+
+	// Nested time of the innermost open scope on this thread
+	static thread_local long long* openScopeChildren = nullptr;
+
+	// Small stable id for the calling thread
+	static unsigned int getThreadId()
+	{
+		static thread_local unsigned int id = static_cast<unsigned int>(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xFFFF);
+		return id;
+	}
+
+	static void copyName(char* aDestination, const char* aSource)
+	{
+		strncpy(aDestination, aSource != nullptr ? aSource : "", Profiler::NAME_LENGTH - 1);
+		aDestination[Profiler::NAME_LENGTH - 1] = '\0';
+	}
+
+
+	//
+	// Scope
+	//
+
+	Profiler::Scope::Scope(const char* aName, const char* aCategory)
+	{
+		active = enabled;
+		if (!active)
+			return;
+
+		name = (aName != nullptr && aName[0] != '\0') ? aName : aCategory;
+		category = aCategory;
+		parentChildren = openScopeChildren;
+		openScopeChildren = &children;
+		start = now();
+	}
+
+	Profiler::Scope::~Scope()
+	{
+		if (!active)
+			return;
+
+		long long duration = now() - start;
+
+		openScopeChildren = parentChildren;
+		if (parentChildren != nullptr)
+			*parentChildren += duration;
+
+		record(name, category, start, duration, duration - children);
+	}
+
+
+	//
+	// Recording
+	//
+
+	void Profiler::setEnabled(bool aEnabled)
+	{
+		enabled = aEnabled;
+		frameOpen = false;
+	}
+
+	bool Profiler::isEnabled()
+	{
+		return enabled;
+	}
+
+	long long Profiler::now()
+	{
+		static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	void Profiler::record(const char* aName, const char* aCategory, long long aStart, long long aDuration, long long aSelf)
+	{
+		// Claim a slot, then publish it once written so readers never see a partial event
+		unsigned long long index = eventHead.fetch_add(1, std::memory_order_relaxed);
+		Slot& slot = events[index % EVENT_CAPACITY];
+
+		slot.sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		copyName(slot.event.name, aName);
+		slot.event.category = aCategory;
+		slot.event.start = aStart;
+		slot.event.duration = aDuration;
+		slot.event.self = aSelf;
+		slot.event.thread = getThreadId();
+
+		slot.sequence.store(index + 1, std::memory_order_release);
+
+		// Track the frame's slowest components on the main thread
+		if (!frameOpen || (strcmp(aCategory, "component") != 0 && strcmp(aCategory, "events") != 0))
+			return;
+
+		Hotspot* hotspots = currentFrame.hotspots;
+		for (int i = 0; i < HOTSPOT_COUNT; i++)
+		{
+			if (aSelf <= hotspots[i].self)
+				continue;
+
+			for (int j = HOTSPOT_COUNT - 1; j > i; j--)
+				hotspots[j] = hotspots[j - 1];
+
+			copyName(hotspots[i].name, aName);
+			hotspots[i].category = aCategory;
+			hotspots[i].self = aSelf;
+			break;
+		}
+	}
+
+	int Profiler::copyEvents(Event* aOut, int aMax)
+	{
+		unsigned long long head = eventHead.load(std::memory_order_acquire);
+		unsigned long long count = (head < EVENT_CAPACITY) ? head : EVENT_CAPACITY;
+		if (count > static_cast<unsigned long long>(aMax))
+			count = aMax;
+
+		int copied = 0;
+		for (unsigned long long index = head - count; index < head; index++)
+		{
+			Slot& slot = events[index % EVENT_CAPACITY];
+
+			if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+				continue;
+
+			aOut[copied] = slot.event;
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			// Skip slots overwritten while copying
+			if (slot.sequence.load(std::memory_order_relaxed) == index + 1)
+				copied++;
+		}
+
+		return copied;
+	}
+
+
+	//
+	// Frames
+	//
+
+	void Profiler::beginFrame()
+	{
+		if (!enabled)
+			return;
+
+		currentFrame = FrameRecord();
+		currentFrame.start = now();
+		phaseStart = currentFrame.start;
+		frameOpen = true;
+	}
+
+	void Profiler::endPhase(Phase aPhase)
+	{
+		if (!enabled || !frameOpen)
+			return;
+
+		long long end = now();
+		currentFrame.phase[static_cast<int>(aPhase)] = end - phaseStart;
+		record(getPhaseName(aPhase), "phase", phaseStart, end - phaseStart, end - phaseStart);
+		phaseStart = end;
+	}
+
+	void Profiler::endFrame()
+	{
+		if (!enabled || !frameOpen)
+			return;
+
+		frameOpen = false;
+		currentFrame.total = now() - currentFrame.start;
+		currentFrame.draw = Draw::GetStats();
+		record("Frame", "frame", currentFrame.start, currentFrame.total, 0);
+
+		unsigned long long head = frameHead.load(std::memory_order_relaxed);
+		frames[head % FRAME_CAPACITY] = currentFrame;
+		frameHead.store(head + 1, std::memory_order_release);
+	}
+
+	void Profiler::discardFrame()
+	{
+		frameOpen = false;
+	}
+
+	int Profiler::getFrameHistory(FrameRecord* aOut, int aMax)
+	{
+		unsigned long long head = frameHead.load(std::memory_order_acquire);
+		unsigned long long count = (head < FRAME_CAPACITY) ? head : FRAME_CAPACITY;
+		if (count > static_cast<unsigned long long>(aMax))
+			count = aMax;
+
+		int copied = 0;
+		for (unsigned long long index = head - count; index < head; index++)
+			aOut[copied++] = frames[index % FRAME_CAPACITY];
+
+		return copied;
+	}
+
+	const char* Profiler::getPhaseName(Phase aPhase)
+	{
+		switch (aPhase)
+		{
+		case Phase::Events: return "triggerEventsChain";
+		case Phase::Reset: return "resetContext";
+		case Phase::Frame: return "onFrame";
+		case Phase::End: return "endFrame";
+		default: return "unknown";
+		}
+	}
+
+
+	//
+	// Chrome trace
+	//
+
+	// Write a JSON string, escaping quotes, backslashes and control characters
+	static void writeJsonString(FILE* aFile, const char* aText)
+	{
+		fputc('"', aFile);
+		for (const char* c = aText; *c != '\0'; c++)
+		{
+			if (*c == '"' || *c == '\\')
+				fprintf(aFile, "\\%c", *c);
+			else if (static_cast<unsigned char>(*c) < 0x20)
+				fprintf(aFile, "\\u%04x", *c);
+			else
+				fputc(*c, aFile);
+		}
+		fputc('"', aFile);
+	}
+
+	bool Profiler::writeChromeTrace(const std::string& aPath)
+	{
+		FILE* file = fopen(aPath.c_str(), "w");
+		if (file == nullptr)
+			return false;
+
+		std::vector<Event> snapshot(EVENT_CAPACITY);
+		int count = copyEvents(snapshot.data(), EVENT_CAPACITY);
+
+		// Complete events, timestamps in microseconds
+		fprintf(file, "{\"traceEvents\":[\n");
+		for (int i = 0; i < count; i++)
+		{
+			const Event& event = snapshot[i];
+
+			fprintf(file, "{\"name\":");
+			writeJsonString(file, event.name);
+			fprintf(file, ",\"cat\":");
+			writeJsonString(file, event.category);
+			fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"self_us\":%.3f}}%s\n",
+				event.start / 1000.0,
+				event.duration / 1000.0,
+				event.thread,
+				event.self / 1000.0,
+				(i + 1 < count) ? "," : "");
+		}
+		fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+
+		bool written = !ferror(file);
+		fclose(file);
+		return written;
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_PROFILER_CPP
@@ -0,0 +1,150 @@
+#ifndef LEMUR_PROFILER_H
+#define LEMUR_PROFILER_H
+
+/**************************************************************************************
+* Lemur:        Frame Profiler Class                                                  *
+*-------------------------------------------------------------------------------------*
+* Filename:     Profiler.h                                                            *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Records high resolution timings for each frame phase and component, along with   *
+*   NanoVG render statistics. Timings are kept in lock-free ring buffers and can be   *
+*   dumped as a Chrome trace (chrome://tracing, Perfetto).                            *
+*                                                                                     *
+* Notes:                                                                              *
+*   Disabled by default. When disabled a scope costs a single flag check.             *
+***************************************************************************************/
+
+
+
+#include <atomic>
+#include <string>
+#include "draw.h"
+
+
+namespace Lemur
+{
+	class Profiler
+	{
+	public:
+
+		// Phases of Application::update, in order
+		enum class Phase { Events = 0, Reset = 1, Frame = 2, End = 3, Count = 4 };
+
+		// Limits
+		static const int EVENT_CAPACITY = 16384;	// Timed scopes kept for trace dumps
+		static const int FRAME_CAPACITY = 240;		// Frames kept for the overlay graph
+		static const int NAME_LENGTH = 40;			// Characters kept from a scope name
+		static const int HOTSPOT_COUNT = 3;			// Slowest components kept per frame
+
+		// A timed scope
+		struct Event
+		{
+			char name[NAME_LENGTH];					// Scope or component name
+			const char* category;					// Static category string
+			long long start;						// Start time in nanoseconds
+			long long duration;						// Total time in nanoseconds
+			long long self;							// Time excluding nested scopes
+			unsigned int thread;					// Recording thread
+		};
+
+		// Slowest component of a frame, by self time
+		struct Hotspot
+		{
+			char name[NAME_LENGTH];
+			const char* category;
+			long long self;
+		};
+
+		// Summary of one drawn frame
+		struct FrameRecord
+		{
+			long long start = 0;									// Start time in nanoseconds
+			long long total = 0;									// Frame time in nanoseconds
+			long long phase[static_cast<int>(Phase::Count)] = {};	// Time per phase in nanoseconds
+			Draw::BatchStats draw;									// NanoVG statistics
+			Hotspot hotspots[HOTSPOT_COUNT] = {};					// Slowest components, slowest first
+		};
+
+		// Times the enclosing block when the profiler is enabled
+		class Scope
+		{
+		private:
+			const char* name;
+			const char* category;
+			long long start;
+			long long children = 0;			// Time spent in nested scopes
+			long long* parentChildren;		// Enclosing scope's nested time
+			bool active;
+
+		public:
+			Scope(const char* aName, const char* aCategory = "scope");
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+		};
+
+	private:
+
+		// Event ring slot, the sequence marks a completely written event
+		struct Slot
+		{
+			std::atomic<unsigned long long> sequence{ 0 };
+			Event event;
+		};
+
+		static bool enabled;
+
+		// Event ring, written by any thread
+		static Slot events[EVENT_CAPACITY];
+		static std::atomic<unsigned long long> eventHead;
+
+		// Frame ring, written by the main thread
+		static FrameRecord frames[FRAME_CAPACITY];
+		static std::atomic<unsigned long long> frameHead;
+
+		// Frame being recorded
+		static FrameRecord currentFrame;
+		static long long phaseStart;
+		static bool frameOpen;
+
+		// Add an event to the ring, and to the frame's hotspots if it belongs to a component
+		static void record(const char* aName, const char* aCategory, long long aStart, long long aDuration, long long aSelf);
+
+		// Copy the event ring, oldest first. Returns the number of events copied.
+		static int copyEvents(Event* aOut, int aMax);
+
+	public:
+
+		// Enable or disable recording
+		static void setEnabled(bool aEnabled);
+		static bool isEnabled();
+
+		// Time in nanoseconds since the profiler started
+		static long long now();
+
+		// Frame phases, called by Application::update
+		static void beginFrame();
+		static void endPhase(Phase aPhase);
+		static void endFrame();
+
+		// Drop the current frame, used when a frame is skipped and the loop sleeps
+		static void discardFrame();
+
+		// Copy up to aMax recent frames, oldest first. Returns the number of frames copied.
+		static int getFrameHistory(FrameRecord* aOut, int aMax);
+
+		// Get the name of a phase
+		static const char* getPhaseName(Phase aPhase);
+
+		// Write the recorded events as Chrome trace JSON. Returns false if the file could not be written.
+		static bool writeChromeTrace(const std::string& aPath);
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_PROFILER_H
@@ -0,0 +1,84 @@
+#ifndef LEMUR_RECT_H
+#define LEMUR_RECT_H
+
+/**************************************************************************************
+* Lemur:        System Rect Class                                                     *
+*-------------------------------------------------------------------------------------*
+* Filename:     Rect.h                                                                *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   An axis aligned rectangle used for bounds, clipping and damage regions            *
+***************************************************************************************/
+
+
+namespace Lemur
+{
+	// Rect class
+	class Rect {
+	public:
+		float x, y, width, height;
+
+		// Constructors
+		Rect() : x(0), y(0), width(0), height(0) {}
+		Rect(float aX, float aY, float aWidth, float aHeight) : x(aX), y(aY), width(aWidth), height(aHeight) {}
+
+		// Getters
+		float getRight() const { return x + width; }
+		float getBottom() const { return y + height; }
+
+		// Returns true if the rect has no area
+		bool isEmpty() const { return width <= 0 || height <= 0; }
+
+		// Returns true if the point lies within the rect (edges inclusive)
+		bool contains(float aX, float aY) const
+		{
+			return aX >= x && aX <= getRight() && aY >= y && aY <= getBottom();
+		}
+
+		// Returns true if the two rects overlap
+		bool intersects(const Rect& aOther) const
+		{
+			if (isEmpty() || aOther.isEmpty())
+				return false;
+
+			return x < aOther.getRight() && aOther.x < getRight() && y < aOther.getBottom() && aOther.y < getBottom();
+		}
+
+		// Returns the overlapping area of the two rects, or an empty rect
+		Rect intersection(const Rect& aOther) const
+		{
+			float left = (x > aOther.x) ? x : aOther.x;
+			float top = (y > aOther.y) ? y : aOther.y;
+			float right = (getRight() < aOther.getRight()) ? getRight() : aOther.getRight();
+			float bottom = (getBottom() < aOther.getBottom()) ? getBottom() : aOther.getBottom();
+
+			if (right <= left || bottom <= top)
+				return Rect();
+
+			return Rect(left, top, right - left, bottom - top);
+		}
+
+		// Returns the smallest rect containing both rects. Empty rects are ignored.
+		Rect united(const Rect& aOther) const
+		{
+			if (aOther.isEmpty())
+				return *this;
+
+			if (isEmpty())
+				return aOther;
+
+			float left = (x < aOther.x) ? x : aOther.x;
+			float top = (y < aOther.y) ? y : aOther.y;
+			float right = (getRight() > aOther.getRight()) ? getRight() : aOther.getRight();
+			float bottom = (getBottom() > aOther.getBottom()) ? getBottom() : aOther.getBottom();
+
+			return Rect(left, top, right - left, bottom - top);
+		}
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_RECT_H
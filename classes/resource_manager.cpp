@@ -0,0 +1,541 @@
+#ifndef LEMUR_RESOURCE_MANAGER_CPP
+#define LEMUR_RESOURCE_MANAGER_CPP
+
+/**************************************************************************************
+* Lemur:        Core System Resource Manager Class                                    *
+*-------------------------------------------------------------------------------------*
+* Filename:     ResourceManager.cpp                                                   *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Image imports and asynchronous font imports. Files are read and decoded on        *
+*   worker threads, then handed to NanoVG on the render thread.                       *
+***************************************************************************************/
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include "core.h"
+#include "fontstash.h"
+#include "profiler.h"
+#include "stb_image.h"
+#include "text_cache.h"
+#include "text_styles.h"
+
+
+namespace Lemur
+{
+	ResourceManager::~ResourceManager()
+	{
+		// No worker may queue an upload once the queue is being freed
+		loader.shutdown();
+
+		for (PendingUpload& upload : uploads)
+		{
+			if (upload.image != nullptr)
+				stbi_image_free(upload.data);
+			else
+				free(upload.data);
+		}
+	}
+
+	void ResourceManager::queueUpload(PendingUpload&& aUpload)
+	{
+		{
+			std::lock_guard<std::mutex> lock(uploadMutex);
+			uploads.push_back(std::move(aUpload));
+		}
+
+		if (wakeUp)
+			wakeUp();
+	}
+
+	void ResourceManager::uploadImage(NVGcontext* aContext, Image* aImage, const unsigned char* aPixels, int aWidth, int aHeight)
+	{
+		if (atlas.add(aContext, aImage, aPixels, aWidth, aHeight))
+			return;
+
+		aImage->setId(nvgCreateImageRGBA(aContext, aWidth, aHeight, 0, aPixels));
+	}
+
+	Image* ResourceManager::importImageFromFile(NVGcontext* aContext, int aWidth, int aHeight, const char* aReference, const char* aFilePath)
+	{
+		// Check if an image with the given reference already exists
+		std::unordered_map<std::string, Image*>::iterator imageIter = images.find(aReference);
+		if (imageIter != images.end())
+		{
+			// Image with the same reference already exists, return a pointer to it
+			return imageIter->second;
+		}
+
+		// Image with the given reference does not exist, create a new image
+		Image* newImage = new Image(aWidth, aHeight, 1.0, aFilePath, 0);
+
+		// Same decode options as nvgCreateImage
+		stbi_set_unpremultiply_on_load(1);
+		stbi_convert_iphone_png_to_rgb(1);
+
+		int pixelWidth = 0, pixelHeight = 0, components = 0;
+		unsigned char* pixels = stbi_load(aFilePath, &pixelWidth, &pixelHeight, &components, 4);
+		if (pixels != nullptr)
+		{
+			uploadImage(aContext, newImage, pixels, pixelWidth, pixelHeight);
+			stbi_image_free(pixels);
+		}
+
+		// Store the new image in the resource manager
+		images[aReference] = newImage;
+
+		// Return a pointer to the new image
+		return newImage;
+	}
+
+	Image* ResourceManager::importImageAsync(int aWidth, int aHeight, const char* aReference, const char* aFilePath, std::function<void(Image*)> aOnLoaded)
+	{
+		// Check if an image with the given reference already exists
+		std::unordered_map<std::string, Image*>::iterator imageIter = images.find(aReference);
+		if (imageIter != images.end())
+			return imageIter->second;
+
+		// Stored straight away, so later imports of the same reference share it
+		Image* newImage = new Image(aWidth, aHeight, 1.0, aFilePath, 0);
+		images[aReference] = newImage;
+		pendingLoads++;
+
+		// Same decode options as nvgCreateImage, set here as they are global
+		stbi_set_unpremultiply_on_load(1);
+		stbi_convert_iphone_png_to_rgb(1);
+
+		std::string filePath = aFilePath;
+		loader.submit([this, newImage, filePath, aOnLoaded]() {
+			PendingUpload upload;
+			upload.image = newImage;
+			upload.onImageLoaded = aOnLoaded;
+
+			int components = 0;
+			upload.data = stbi_load(filePath.c_str(), &upload.width, &upload.height, &components, 4);
+
+			queueUpload(std::move(upload));
+		});
+
+		return newImage;
+	}
+
+	Font* ResourceManager::importFontFromFile(NVGcontext* aContext, const char* aReference, const char* aFilePath)
+	{
+		// Check if an font with the given reference already exists
+		std::unordered_map<std::string, Font*>::iterator fontIter = fonts.find(aReference);
+		if (fontIter != fonts.end())
+		{
+			// font with the same reference already exists, return a pointer to it
+			return fontIter->second;
+		}
+
+		// font with the given reference does not exist, load it into the font text styles refer to
+		Font* newFont = TextStyles::getFont(aReference);
+		newFont->setFilePath(aFilePath);
+		newFont->setId(nvgCreateFont(aContext, aReference, aFilePath));
+
+		// Store the new font in the resource manager
+		fonts[aReference] = newFont;
+
+		// Return a pointer to the new font
+		return newFont;
+	}
+
+	Font* ResourceManager::importFontAsync(const char* aReference, const char* aFilePath, std::function<void(Font*)> aOnLoaded)
+	{
+		// Check if a font with the given reference already exists
+		std::unordered_map<std::string, Font*>::iterator fontIter = fonts.find(aReference);
+		if (fontIter != fonts.end())
+			return fontIter->second;
+
+		// Load into the font text styles refer to, so they draw with it once it is uploaded
+		Font* newFont = TextStyles::getFont(aReference);
+		newFont->setFilePath(aFilePath);
+		fonts[aReference] = newFont;
+		pendingLoads++;
+
+		std::string filePath = aFilePath;
+		loader.submit([this, newFont, filePath, aOnLoaded]() {
+			PendingUpload upload;
+			upload.font = newFont;
+			upload.onFontLoaded = aOnLoaded;
+
+			// Read the whole file, NanoVG takes ownership and frees it with free()
+			FILE* file = fopen(filePath.c_str(), "rb");
+			if (file != nullptr)
+			{
+				fseek(file, 0, SEEK_END);
+				long size = ftell(file);
+				fseek(file, 0, SEEK_SET);
+
+				if (size > 0)
+				{
+					upload.data = static_cast<unsigned char*>(malloc(size));
+					if (upload.data != nullptr && fread(upload.data, 1, size, file) != static_cast<size_t>(size))
+					{
+						free(upload.data);
+						upload.data = nullptr;
+					}
+					upload.size = static_cast<int>(size);
+				}
+
+				fclose(file);
+			}
+
+			queueUpload(std::move(upload));
+		});
+
+		return newFont;
+	}
+
+	ResourceManager::WarmUpStats ResourceManager::warmUpFont(NVGcontext* aContext, const Font* aFont, const std::vector<float>& aSizes, CharacterSet aCharacters)
+	{
+		std::vector<uint32_t> codepoints;
+
+		for (uint32_t c = 0x20; c < 0x7F; c++)
+			codepoints.push_back(c);
+
+		if (aCharacters == CharacterSet::Latin1)
+			for (uint32_t c = 0xA0; c <= 0xFF; c++)
+				codepoints.push_back(c);
+
+		return warmUpGlyphs(aContext, aFont, aSizes, codepoints);
+	}
+
+	ResourceManager::WarmUpStats ResourceManager::warmUpFont(NVGcontext* aContext, const Font* aFont, const std::vector<float>& aSizes, const char* aCharacters)
+	{
+		std::vector<uint32_t> codepoints;
+
+		// Decode the UTF-8, skipping invalid bytes, whitespace and repeats
+		const unsigned char* text = reinterpret_cast<const unsigned char*>(aCharacters != nullptr ? aCharacters : "");
+		while (*text != 0)
+		{
+			uint32_t codepoint = *text++;
+			int continuation = codepoint >= 0xF0 ? 3 : codepoint >= 0xE0 ? 2 : codepoint >= 0xC0 ? 1 : 0;
+
+			if (codepoint >= 0x80 && continuation == 0)
+				continue;
+
+			codepoint &= 0x3F >> continuation;
+			for (; continuation > 0 && (*text & 0xC0) == 0x80; continuation--)
+				codepoint = (codepoint << 6) | (*text++ & 0x3F);
+
+			if (continuation > 0 || codepoint <= 0x20)
+				continue;
+
+			codepoints.push_back(codepoint);
+		}
+
+		std::sort(codepoints.begin(), codepoints.end());
+		codepoints.erase(std::unique(codepoints.begin(), codepoints.end()), codepoints.end());
+
+		return warmUpGlyphs(aContext, aFont, aSizes, codepoints);
+	}
+
+	ResourceManager::WarmUpStats ResourceManager::warmUpGlyphs(NVGcontext* aContext, const Font* aFont, const std::vector<float>& aSizes, const std::vector<uint32_t>& aCodepoints)
+	{
+		WarmUpStats stats;
+
+		if (aContext == nullptr || aFont == nullptr || !aFont->isLoaded())
+			return stats;
+
+		Profiler::Scope scope("Glyph warm-up", "resource");
+
+		// Glyphs rasterized by the workers, shared so workers starting late find nothing left
+		struct Batch
+		{
+			std::vector<FONSstagedGlyph> glyphs;
+			std::vector<unsigned char> pixels;		// Staging bitmaps of every glyph, back to back
+			std::atomic<size_t> next{ 0 };
+			std::atomic<size_t> done{ 0 };
+			std::mutex mutex;
+			std::condition_variable finished;
+		};
+
+		auto start = std::chrono::steady_clock::now();
+		auto batch = std::make_shared<Batch>();
+		FONScontext* stash = nvgFontStash(aContext);
+
+		// Measure the glyphs missing from the atlas
+		size_t pixelCount = 0;
+		for (float size : aSizes)
+		{
+			for (uint32_t codepoint : aCodepoints)
+			{
+				FONSstagedGlyph glyph;
+				if (!fonsPrepareGlyph(stash, aFont->getId(), codepoint, size, 0, &glyph))
+					continue;
+
+				batch->glyphs.push_back(glyph);
+				pixelCount += static_cast<size_t>(glyph.width) * glyph.height;
+			}
+		}
+
+		if (batch->glyphs.empty())
+			return stats;
+
+		batch->pixels.resize(pixelCount);
+		size_t offset = 0;
+		for (FONSstagedGlyph& glyph : batch->glyphs)
+		{
+			glyph.data = batch->pixels.data() + offset;
+			offset += static_cast<size_t>(glyph.width) * glyph.height;
+		}
+
+		// Rasterize on the workers and this thread, which waits anyway. The stash isn't changed until all are done.
+		// FreeType renders every glyph into the face's one glyph slot, so with it this thread rasterizes alone.
+		auto rasterize = [batch, stash]()
+		{
+			size_t count = batch->glyphs.size();
+			for (size_t i = batch->next++; i < count; i = batch->next++)
+			{
+				fonsRasterizeGlyph(stash, &batch->glyphs[i]);
+
+				if (++batch->done == count)
+				{
+					std::lock_guard<std::mutex> lock(batch->mutex);
+					batch->finished.notify_all();
+				}
+			}
+		};
+
+#ifndef FONS_USE_FREETYPE
+		for (int i = 0; i < loader.getThreadCount(); i++)
+			loader.submit(rasterize);
+#endif
+
+		rasterize();
+
+		{
+			std::unique_lock<std::mutex> lock(batch->mutex);
+			batch->finished.wait(lock, [&batch]() { return batch->done == batch->glyphs.size(); });
+		}
+
+		auto rasterized = std::chrono::steady_clock::now();
+
+		// Pack tallest first, which wastes less of the skyline, then upload each changed page once
+		std::sort(batch->glyphs.begin(), batch->glyphs.end(),
+			[](const FONSstagedGlyph& aA, const FONSstagedGlyph& aB) { return aA.height > aB.height; });
+
+		for (const FONSstagedGlyph& glyph : batch->glyphs)
+		{
+			if (!fonsAddGlyphBitmap(stash, &glyph))
+				break;
+
+			stats.glyphs++;
+		}
+
+		nvgFlushTextAtlas(aContext);
+
+		auto end = std::chrono::steady_clock::now();
+		stats.rasterizeTime = std::chrono::duration<double, std::milli>(rasterized - start).count();
+		stats.uploadTime = std::chrono::duration<double, std::milli>(end - rasterized).count();
+
+		return stats;
+	}
+
+	int ResourceManager::processUploads(NVGcontext* aContext)
+	{
+		if (aContext == nullptr)
+			return 0;
+
+		svgRasters.nextFrame();
+
+		// Nothing decoding, just send any atlas changes
+		if (pendingLoads == 0)
+		{
+			atlas.flush(aContext);
+			return 0;
+		}
+
+		std::vector<PendingUpload> ready;
+		{
+			std::lock_guard<std::mutex> lock(uploadMutex);
+			ready.swap(uploads);
+		}
+
+		bool fontsChanged = false;
+
+		for (PendingUpload& upload : ready)
+		{
+			if (upload.image != nullptr)
+			{
+				if (upload.data != nullptr)
+				{
+					uploadImage(aContext, upload.image, upload.data, upload.width, upload.height);
+					stbi_image_free(upload.data);
+				}
+			}
+			else if (upload.font != nullptr)
+			{
+				// NanoVG frees the data, even if the font fails to load
+				if (upload.data != nullptr)
+				{
+					upload.font->setId(nvgCreateFontMem(aContext, upload.font->getName(), upload.data, upload.size, 1));
+					fontsChanged = true;
+				}
+			}
+		}
+
+		// Layouts measured while the font was missing are out of date
+		if (fontsChanged)
+			TextCache::clear();
+
+		pendingLoads -= static_cast<int>(ready.size());
+
+		// One upload per changed page, however many images were packed
+		atlas.flush(aContext);
+
+		// Callbacks last, so they see every resource from this batch
+		for (PendingUpload& upload : ready)
+		{
+			if (upload.onImageLoaded)
+				upload.onImageLoaded(upload.image);
+
+			if (upload.onFontLoaded)
+				upload.onFontLoaded(upload.font);
+		}
+
+		return static_cast<int>(ready.size());
+	}
+
+	SvgDocument* ResourceManager::importSvgFromFile(const char* aReference, const char* aFilePath)
+	{
+		auto svgIter = svgs.find(aReference);
+		if (svgIter != svgs.end())
+			return svgIter->second;
+
+		SvgDocument* document = new SvgDocument();
+		if (!document->loadFromFile(aFilePath))
+		{
+			delete document;
+			return nullptr;
+		}
+
+		svgs[aReference] = document;
+		return document;
+	}
+
+	Image* ResourceManager::getSvgImage(NVGcontext* aContext, const char* aReference, int aWidth, int aHeight, float aDevicePixelRatio)
+	{
+		auto svgIter = svgs.find(aReference);
+		if (svgIter == svgs.end())
+			return nullptr;
+
+		return svgRasters.get(aContext, svgIter->second, aWidth, aHeight, aDevicePixelRatio);
+	}
+
+	void ResourceManager::setSvgCacheBudget(size_t aBytes)
+	{
+		svgRasters.setBudget(aBytes);
+	}
+
+	std::vector<std::string> ResourceManager::getResourceFiles() const
+	{
+		std::vector<std::string> files;
+
+		for (const auto& image : images)
+			if (image.second->getFilePath() != nullptr)
+				files.push_back(image.second->getFilePath());
+
+		for (const auto& font : fonts)
+			if (font.second->getFilePath() != nullptr)
+				files.push_back(font.second->getFilePath());
+
+		for (const auto& svg : svgs)
+			files.push_back(svg.second->getFilePath());
+
+		return files;
+	}
+
+	int ResourceManager::reloadFile(NVGcontext* aContext, const std::string& aFilePath)
+	{
+		if (aContext == nullptr)
+			return 0;
+
+		int reloaded = 0;
+
+		for (auto& entry : images)
+		{
+			Image* image = entry.second;
+			if (image->getFilePath() == nullptr || aFilePath != image->getFilePath())
+				continue;
+
+			stbi_set_unpremultiply_on_load(1);
+			stbi_convert_iphone_png_to_rgb(1);
+
+			int pixelWidth = 0, pixelHeight = 0, components = 0;
+			unsigned char* pixels = stbi_load(aFilePath.c_str(), &pixelWidth, &pixelHeight, &components, 4);
+			if (pixels == nullptr)
+				continue;
+
+			// Same size atlas slots are overwritten, other images get new space or a new texture
+			if (!atlas.update(image, pixels, pixelWidth, pixelHeight))
+			{
+				if (!image->isAtlased() && image->getId() != 0)
+					nvgDeleteImage(aContext, image->getId());
+
+				image->setAtlasRect(0, 0, 0, 0, 0, 0, 0);
+				uploadImage(aContext, image, pixels, pixelWidth, pixelHeight);
+			}
+
+			stbi_image_free(pixels);
+			reloaded++;
+		}
+
+		bool fontsChanged = false;
+		for (auto& entry : fonts)
+		{
+			Font* font = entry.second;
+			if (font->getFilePath() == nullptr || aFilePath != font->getFilePath())
+				continue;
+
+			int id = nvgCreateFont(aContext, font->getName(), aFilePath.c_str());
+			if (id < 0)
+				continue;
+
+			font->setId(id);
+			fontsChanged = true;
+			reloaded++;
+		}
+
+		if (fontsChanged)
+			TextCache::clear();
+
+		for (auto& entry : svgs)
+		{
+			SvgDocument* document = entry.second;
+			if (aFilePath != document->getFilePath() || !document->loadFromFile(aFilePath.c_str()))
+				continue;
+
+			svgRasters.remove(aContext, document);
+			reloaded++;
+		}
+
+		// Atlas changes go up with the next processUploads
+		return reloaded;
+	}
+
+	bool ResourceManager::hasPendingLoads() const
+	{
+		return pendingLoads > 0;
+	}
+
+	void ResourceManager::setWakeUpCallback(std::function<void()> aWakeUp)
+	{
+		wakeUp = aWakeUp;
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_RESOURCE_MANAGER_CPP
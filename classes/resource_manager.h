@@ -11,25 +11,91 @@
 *-------------------------------------------------------------------------------------*
 * Description:                                                                        *
 *   Central manager for system resources (images, fonts etc)                          *
+*                                                                                     *
+* Notes:                                                                              *
+*   Asynchronous imports decode on worker threads and are uploaded by the window on   *
+*   the render thread, before the next frame is drawn.                                *
 ***************************************************************************************/
 
 
 
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <functional>
+#include <mutex>
 #include <unordered_map>
 #include "image.h"
+#include "image_atlas.h"
+#include "svg_document.h"
+#include "svg_raster_cache.h"
+#include "thread_pool.h"
 
 namespace Lemur
 {
 	// Resource Manager class
 	class ResourceManager
 	{
+	public:
+
+		// Characters to warm up a font with
+		enum class CharacterSet
+		{
+			Ascii,		// Printable ASCII
+			Latin1		// Printable ASCII and Latin-1 Supplement
+		};
+
+		// Result of a font warm-up
+		struct WarmUpStats
+		{
+			int glyphs = 0;					// Glyphs added to the atlas
+			double rasterizeTime = 0;		// Milliseconds rasterizing, spread over the workers
+			double uploadTime = 0;			// Milliseconds packing the glyphs into the atlas and uploading them
+		};
+
+	private:
+		// Decoded resource waiting to be uploaded on the render thread
+		struct PendingUpload
+		{
+			Image* image = nullptr;						// Image being loaded, or null for a font
+			Font* font = nullptr;						// Font being loaded, or null for an image
+			unsigned char* data = nullptr;				// Decoded pixels or font file, null if loading failed
+			int width = 0;								// Pixel width of decoded images
+			int height = 0;								// Pixel height of decoded images
+			int size = 0;								// Byte size of font files
+			std::function<void(Image*)> onImageLoaded;	// Completion callbacks, run on the render thread
+			std::function<void(Font*)> onFontLoaded;
+		};
+
+		std::mutex uploadMutex;							// Guards uploads, shared with the workers
+		std::vector<PendingUpload> uploads;				// Resources decoded since the last frame
+		int pendingLoads = 0;							// Imports not yet uploaded, render thread only
+		std::function<void()> wakeUp;					// Wakes the event loop when a decode finishes
+
+		// Small images share atlas pages so they draw with one texture
+		ImageAtlas atlas;
+
+		// Rasters of imported SVGs at the sizes they have been drawn
+		SvgRasterCache svgRasters;
+
+		// Worker threads decoding imports
+		ThreadPool loader;
+
+		// Queue a decoded resource for upload
+		void queueUpload(PendingUpload&& aUpload);
+
+		// Give an image decoded RGBA pixels, packed into the atlas if small enough
+		void uploadImage(NVGcontext* aContext, Image* aImage, const unsigned char* aPixels, int aWidth, int aHeight);
+
+		// Rasterize the glyphs of code points at each size not already in the glyph atlas
+		WarmUpStats warmUpGlyphs(NVGcontext* aContext, const Font* aFont, const std::vector<float>& aSizes, const std::vector<uint32_t>& aCodepoints);
+
 	public:
 		std::unordered_map<std::string, Font*> fonts;
 		std::unordered_map<std::string, Image*> images;
+		std::unordered_map<std::string, SvgDocument*> svgs;
 
 
 		/* REMOVED - KEPT IN FOR FUTURE CONSIDERATION
@@ -69,52 +135,66 @@ namespace Lemur
 		// Import an image into the resource manager
 		// If an image with the same reference already exists, return a pointer to it
 		// Otherwise, create a new image and store it in the resource manager, then return a pointer to it
-		Image* importImageFromFile(NVGcontext* aContext, int aWidth, int aHeight, const char* aReference, const char* aFilePath)
-		{
-			// Check if an image with the given reference already exists
-			std::unordered_map<std::string, Image*>::iterator imageIter = images.find(aReference);
-			if (imageIter != images.end())
-			{
-				// Image with the same reference already exists, return a pointer to it
-				return imageIter->second;
-			}
-
-			// Image with the given reference does not exist, create a new image
-			int imageHandle = nvgCreateImage(aContext, aFilePath, 0);
-			Image* newImage = new Image(aWidth, aHeight, 1.0, aFilePath, imageHandle);
-
-			// Store the new image in the resource manager
-			images[aReference] = newImage;
-
-			// Return a pointer to the new image
-			return newImage;
-		}
+		// Images up to ImageAtlas::MAX_IMAGE_SIZE are packed into a shared atlas page, uploaded on the next frame
+		Image* importImageFromFile(NVGcontext* aContext, int aWidth, int aHeight, const char* aReference, const char* aFilePath);
 
 
 
 		// Import an font into the resource manager
 		// If an font with the same reference already exists, return a pointer to it
 		// Otherwise, create a new font and store it in the resource manager, then return a pointer to it
-		Font* importFontFromFile(NVGcontext* aContext, const char* aReference, const char* aFilePath)
-		{
-			// Check if an font with the given reference already exists
-			std::unordered_map<std::string, Font*>::iterator fontIter = fonts.find(aReference);
-			if (fontIter != fonts.end())
-			{
-				// font with the same reference already exists, return a pointer to it
-				return fontIter->second;
-			}
+		Font* importFontFromFile(NVGcontext* aContext, const char* aReference, const char* aFilePath);
+
+
+
+		// Import an SVG, parsed now and rasterized when it is first drawn at each size.
+		// Returns null if the file can't be parsed.
+		SvgDocument* importSvgFromFile(const char* aReference, const char* aFilePath);
+
+		// Get an imported SVG rasterized for a rect in points, at its exact pixel size on a display with the given
+		// pixel ratio. Rasters are cached by pixel size and evicted least recently used first, once over budget,
+		// so fetch the image each frame it is drawn rather than keeping it.
+		Image* getSvgImage(NVGcontext* aContext, const char* aReference, int aWidth, int aHeight, float aDevicePixelRatio = 1.0f);
+
+		// Texture memory kept for SVG rasters before evicting
+		void setSvgCacheBudget(size_t aBytes);
+
+		// Put a loaded font's glyphs in the glyph atlas before they are first drawn, so the frames
+		// drawing them don't stall rasterizing. Glyphs are rasterized on the worker threads, then
+		// packed and uploaded together. Sizes are in pixels, characters are a set or a UTF-8 string
+		// of the text expected. Call from the render thread, after the font has loaded.
+		WarmUpStats warmUpFont(NVGcontext* aContext, const Font* aFont, const std::vector<float>& aSizes, CharacterSet aCharacters);
+		WarmUpStats warmUpFont(NVGcontext* aContext, const Font* aFont, const std::vector<float>& aSizes, const char* aCharacters);
+
+		// Files of every imported image, font and SVG, for watching
+		std::vector<std::string> getResourceFiles() const;
+
+		// Reload resources imported from a file in place, so components keep their pointers to them.
+		// Fonts are added again under the same name, which replaces the old font. Returns the number reloaded.
+		int reloadFile(NVGcontext* aContext, const std::string& aFilePath);
+
+
+
+		// Free decoded resources that were never uploaded
+		~ResourceManager();
+
+		// Import an image without blocking. The returned image has no id, and is drawn as a placeholder,
+		// until it is decoded on a worker thread and uploaded during a later Window::resetContext().
+		// The callback runs on the render thread once the image is uploaded or has failed to load.
+		Image* importImageAsync(int aWidth, int aHeight, const char* aReference, const char* aFilePath, std::function<void(Image*)> aOnLoaded = nullptr);
+
+		// Import a font without blocking. Text in the font is not drawn until it is uploaded.
+		Font* importFontAsync(const char* aReference, const char* aFilePath, std::function<void(Font*)> aOnLoaded = nullptr);
 
-			// font with the given reference does not exist, create a new font
-			int fontHandle = nvgCreateFont(aContext, aReference, aFilePath);
-			Font* newFont = new Font(aReference, aFilePath, fontHandle);
+		// Upload resources decoded since the last call and changed atlas pages, on the render thread.
+		// Called once per frame, which also ages the SVG rasters. Returns the number of resources uploaded.
+		int processUploads(NVGcontext* aContext);
 
-			// Store the new font in the resource manager
-			fonts[aReference] = newFont;
+		// Check if any asynchronous imports have not been uploaded yet
+		bool hasPendingLoads() const;
 
-			// Return a pointer to the new font
-			return newFont;
-		}
+		// Called from a worker thread when a decode finishes, to wake the event loop
+		void setWakeUpCallback(std::function<void()> aWakeUp);
 	};
 
 } // namespace Lemur
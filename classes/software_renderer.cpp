@@ -0,0 +1,831 @@
+#ifndef LEMUR_SOFTWARE_RENDERER_CPP
+#define LEMUR_SOFTWARE_RENDERER_CPP
+
+/**************************************************************************************
+* Lemur:        Software Renderer Class                                               *
+*-------------------------------------------------------------------------------------*
+* Filename:     SoftwareRenderer.cpp                                                  *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   A NanoVG render backend which rasterizes into an in-memory RGBA buffer on the     *
+*   CPU, used to run the UI without a GPU or display.                                 *
+*                                                                                     *
+* Notes:                                                                              *
+*   Shading follows the GL3 backend's fill shader so output matches the GPU path.     *
+***************************************************************************************/
+
+
+
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include "software_renderer.h"
+
+
+namespace Lemur
+{
+	//
+	// Rasterization helpers
+	//
+
+	static inline float clampUnit(float aValue)
+	{
+		return aValue < 0.0f ? 0.0f : (aValue > 1.0f ? 1.0f : aValue);
+	}
+
+	// Signed area of the parallelogram (a, b, p), positive when p lies to one side of a->b
+	static inline float edgeFunction(float aX0, float aY0, float aX1, float aY1, float aPx, float aPy)
+	{
+		return (aX1 - aX0) * (aPy - aY0) - (aY1 - aY0) * (aPx - aX0);
+	}
+
+	// Edges exactly through a pixel centre belong to one of the two triangles sharing them
+	static inline bool edgeOwnsTies(float aX0, float aY0, float aX1, float aY1)
+	{
+		float dy = aY1 - aY0;
+		float dx = aX1 - aX0;
+		return dy > 0 || (dy == 0 && dx < 0);
+	}
+
+	// Rasterize a triangle within columns [0, aWidth) and rows [aTop, aBottom), sampling at pixel centres.
+	// aPixel is called with the pixel, the barycentric weights of b and c, and the triangle's winding (+1/-1).
+	template <typename PixelFunction>
+	static void rasterizeTriangle(const NVGvertex& a, const NVGvertex& b, const NVGvertex& c, int aWidth, int aTop, int aBottom, PixelFunction aPixel)
+	{
+		float area = edgeFunction(a.x, a.y, b.x, b.y, c.x, c.y);
+		if (area == 0)
+			return;
+
+		// Work in a consistent orientation so the tie rule is the same for every triangle
+		int winding = (area > 0) ? 1 : -1;
+		const NVGvertex& v0 = a;
+		const NVGvertex& v1 = (area > 0) ? b : c;
+		const NVGvertex& v2 = (area > 0) ? c : b;
+		float invArea = 1.0f / std::fabs(area);
+
+		// Bounding box, clipped to the band
+		float minX = std::fmin(v0.x, std::fmin(v1.x, v2.x));
+		float maxX = std::fmax(v0.x, std::fmax(v1.x, v2.x));
+		float minY = std::fmin(v0.y, std::fmin(v1.y, v2.y));
+		float maxY = std::fmax(v0.y, std::fmax(v1.y, v2.y));
+
+		int x0 = static_cast<int>(std::floor(minX));
+		int x1 = static_cast<int>(std::ceil(maxX));
+		int y0 = static_cast<int>(std::floor(minY));
+		int y1 = static_cast<int>(std::ceil(maxY));
+
+		if (x0 < 0) x0 = 0;
+		if (x1 > aWidth) x1 = aWidth;
+		if (y0 < aTop) y0 = aTop;
+		if (y1 > aBottom) y1 = aBottom;
+
+		if (x0 >= x1 || y0 >= y1)
+			return;
+
+		bool tie0 = edgeOwnsTies(v1.x, v1.y, v2.x, v2.y);
+		bool tie1 = edgeOwnsTies(v2.x, v2.y, v0.x, v0.y);
+		bool tie2 = edgeOwnsTies(v0.x, v0.y, v1.x, v1.y);
+
+		// Edge function steps per pixel in x
+		float step0 = -(v2.y - v1.y);
+		float step1 = -(v0.y - v2.y);
+		float step2 = -(v1.y - v0.y);
+
+		for (int y = y0; y < y1; y++)
+		{
+			float py = y + 0.5f;
+			float px = x0 + 0.5f;
+
+			float w0 = edgeFunction(v1.x, v1.y, v2.x, v2.y, px, py);
+			float w1 = edgeFunction(v2.x, v2.y, v0.x, v0.y, px, py);
+			float w2 = edgeFunction(v0.x, v0.y, v1.x, v1.y, px, py);
+
+			for (int x = x0; x < x1; x++)
+			{
+				bool inside = (w0 > 0 || (w0 == 0 && tie0)) && (w1 > 0 || (w1 == 0 && tie1)) && (w2 > 0 || (w2 == 0 && tie2));
+
+				if (inside)
+				{
+					// Weights of the triangle's original b and c
+					float wb = ((area > 0) ? w1 : w2) * invArea;
+					float wc = ((area > 0) ? w2 : w1) * invArea;
+					aPixel(x, y, wb, wc, winding);
+				}
+
+				w0 += step0;
+				w1 += step1;
+				w2 += step2;
+			}
+		}
+	}
+
+	// Distance to a rounded rect, matching the GL shader's sdroundrect
+	static inline float sdRoundRect(float aX, float aY, float aExtentX, float aExtentY, float aRadius)
+	{
+		float dx = std::fabs(aX) - (aExtentX - aRadius);
+		float dy = std::fabs(aY) - (aExtentY - aRadius);
+		float inside = std::fmin(std::fmax(dx, dy), 0.0f);
+		float ox = std::fmax(dx, 0.0f);
+		float oy = std::fmax(dy, 0.0f);
+		return inside + std::sqrt(ox * ox + oy * oy) - aRadius;
+	}
+
+	static inline void transformPoint(const float* aXform, float aX, float aY, float& aOutX, float& aOutY)
+	{
+		aOutX = aX * aXform[0] + aY * aXform[2] + aXform[4];
+		aOutY = aX * aXform[1] + aY * aXform[3] + aXform[5];
+	}
+
+	static inline void premultiply(const NVGcolor& aColour, float* aOut)
+	{
+		aOut[0] = aColour.r * aColour.a;
+		aOut[1] = aColour.g * aColour.a;
+		aOut[2] = aColour.b * aColour.a;
+		aOut[3] = aColour.a;
+	}
+
+
+	//
+	// Construction
+	//
+
+	SoftwareRenderer::SoftwareRenderer(int aWidth, int aHeight, int aThreadCount)
+	{
+		threadCount = aThreadCount;
+		if (threadCount <= 0)
+			threadCount = static_cast<int>(std::thread::hardware_concurrency());
+		if (threadCount <= 0)
+			threadCount = 1;
+
+		width = 0;
+		height = 0;
+		resize(aWidth, aHeight);
+	}
+
+	SoftwareRenderer::~SoftwareRenderer()
+	{
+		{
+			std::lock_guard<std::mutex> lock(workMutex);
+			stopping = true;
+		}
+		workReady.notify_all();
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	NVGcontext* SoftwareRenderer::createContext()
+	{
+		NVGparams params;
+		memset(&params, 0, sizeof(params));
+
+		params.userPtr = this;
+		params.edgeAntiAlias = 0;
+		params.renderCreate = renderCreate;
+		params.renderCreateTexture = renderCreateTexture;
+		params.renderDeleteTexture = renderDeleteTexture;
+		params.renderUpdateTexture = renderUpdateTexture;
+		params.renderGetTextureSize = renderGetTextureSize;
+		params.renderViewport = renderViewport;
+		params.renderCancel = renderCancel;
+		params.renderFlush = renderFlush;
+		params.renderFill = renderFill;
+		params.renderStroke = renderStroke;
+		params.renderTriangles = renderTriangles;
+		params.renderDelete = renderDelete;
+
+		return nvgCreateInternal(&params);
+	}
+
+	void SoftwareRenderer::resize(int aWidth, int aHeight)
+	{
+		width = (aWidth > 0) ? aWidth : 0;
+		height = (aHeight > 0) ? aHeight : 0;
+		pixels.assign(static_cast<size_t>(width) * height * 4, 0);
+		windingBuffers.clear();
+	}
+
+	void SoftwareRenderer::clear(const Colour& aColour)
+	{
+		clear(Rect(0, 0, static_cast<float>(width), static_cast<float>(height)), aColour);
+	}
+
+	void SoftwareRenderer::clear(const Rect& aRect, const Colour& aColour)
+	{
+		Rect area = aRect.intersection(Rect(0, 0, static_cast<float>(width), static_cast<float>(height)));
+		if (area.isEmpty())
+			return;
+
+		int x0 = static_cast<int>(std::floor(area.x));
+		int y0 = static_cast<int>(std::floor(area.y));
+		int x1 = static_cast<int>(std::ceil(area.getRight()));
+		int y1 = static_cast<int>(std::ceil(area.getBottom()));
+
+		unsigned char r = static_cast<unsigned char>(aColour.getRed());
+		unsigned char g = static_cast<unsigned char>(aColour.getGreen());
+		unsigned char b = static_cast<unsigned char>(aColour.getBlue());
+		unsigned char a = static_cast<unsigned char>(aColour.getAlpha());
+
+		for (int y = y0; y < y1; y++)
+		{
+			unsigned char* row = &pixels[(static_cast<size_t>(y) * width + x0) * 4];
+			for (int x = x0; x < x1; x++, row += 4)
+			{
+				row[0] = r;
+				row[1] = g;
+				row[2] = b;
+				row[3] = a;
+			}
+		}
+	}
+
+	int SoftwareRenderer::getWidth() const
+	{
+		return width;
+	}
+
+	int SoftwareRenderer::getHeight() const
+	{
+		return height;
+	}
+
+	int SoftwareRenderer::getThreadCount() const
+	{
+		return threadCount;
+	}
+
+	const unsigned char* SoftwareRenderer::getPixels() const
+	{
+		return pixels.data();
+	}
+
+
+	//
+	// Textures
+	//
+
+	SoftwareRenderer::Texture* SoftwareRenderer::findTexture(int aId)
+	{
+		for (Texture& texture : textures)
+			if (texture.id == aId)
+				return &texture;
+
+		return nullptr;
+	}
+
+
+	//
+	// Paint conversion
+	//
+
+	bool SoftwareRenderer::convertPaint(Shader& aShader, NVGpaint* aPaint, NVGscissor* aScissor, float aFringe)
+	{
+		memset(&aShader, 0, sizeof(aShader));
+
+		premultiply(aPaint->innerColor, aShader.innerColour);
+		premultiply(aPaint->outerColor, aShader.outerColour);
+
+		// Scissor, a zero matrix with unit extent leaves every pixel unclipped
+		if (aScissor->extent[0] < -0.5f || aScissor->extent[1] < -0.5f)
+		{
+			aShader.scissorExt[0] = 1.0f;
+			aShader.scissorExt[1] = 1.0f;
+			aShader.scissorScale[0] = 1.0f;
+			aShader.scissorScale[1] = 1.0f;
+		}
+		else
+		{
+			nvgTransformInverse(aShader.scissorMat, aScissor->xform);
+			aShader.scissorExt[0] = aScissor->extent[0];
+			aShader.scissorExt[1] = aScissor->extent[1];
+			aShader.scissorScale[0] = std::sqrt(aScissor->xform[0] * aScissor->xform[0] + aScissor->xform[2] * aScissor->xform[2]) / aFringe;
+			aShader.scissorScale[1] = std::sqrt(aScissor->xform[1] * aScissor->xform[1] + aScissor->xform[3] * aScissor->xform[3]) / aFringe;
+		}
+
+		aShader.extent[0] = aPaint->extent[0];
+		aShader.extent[1] = aPaint->extent[1];
+		aShader.radius = aPaint->radius;
+		aShader.feather = aPaint->feather;
+
+		if (aPaint->image != 0)
+		{
+			Texture* texture = findTexture(aPaint->image);
+			if (texture == nullptr)
+				return false;
+
+			if ((texture->flags & NVG_IMAGE_FLIPY) != 0)
+			{
+				float m1[6], m2[6];
+				nvgTransformTranslate(m1, 0.0f, aShader.extent[1] * 0.5f);
+				nvgTransformMultiply(m1, aPaint->xform);
+				nvgTransformScale(m2, 1.0f, -1.0f);
+				nvgTransformMultiply(m2, m1);
+				nvgTransformTranslate(m1, 0.0f, -aShader.extent[1] * 0.5f);
+				nvgTransformMultiply(m1, m2);
+				nvgTransformInverse(aShader.paintMat, m1);
+			}
+			else
+			{
+				nvgTransformInverse(aShader.paintMat, aPaint->xform);
+			}
+
+			aShader.image = aPaint->image;
+			aShader.type = 1;
+		}
+		else
+		{
+			nvgTransformInverse(aShader.paintMat, aPaint->xform);
+			aShader.type = 0;
+		}
+
+		return true;
+	}
+
+
+	//
+	// Shading
+	//
+
+	void SoftwareRenderer::shadePixel(const Shader& aShader, const Texture* aTexture, int aX, int aY, float aU, float aV)
+	{
+		float px = aX + 0.5f;
+		float py = aY + 0.5f;
+
+		// Scissor mask
+		float sx, sy;
+		transformPoint(aShader.scissorMat, px, py, sx, sy);
+		sx = 0.5f - (std::fabs(sx) - aShader.scissorExt[0]) * aShader.scissorScale[0];
+		sy = 0.5f - (std::fabs(sy) - aShader.scissorExt[1]) * aShader.scissorScale[1];
+		float scissor = clampUnit(sx) * clampUnit(sy);
+
+		if (scissor <= 0.0f)
+			return;
+
+		float colour[4];
+
+		if (aShader.type == 0)
+		{
+			// Box gradient, solid colours have matching inner and outer colours
+			if (memcmp(aShader.innerColour, aShader.outerColour, sizeof(aShader.innerColour)) == 0)
+			{
+				memcpy(colour, aShader.innerColour, sizeof(colour));
+			}
+			else
+			{
+				float gx, gy;
+				transformPoint(aShader.paintMat, px, py, gx, gy);
+				float d = clampUnit((sdRoundRect(gx, gy, aShader.extent[0], aShader.extent[1], aShader.radius) + aShader.feather * 0.5f) / aShader.feather);
+
+				for (int i = 0; i < 4; i++)
+					colour[i] = aShader.innerColour[i] + (aShader.outerColour[i] - aShader.innerColour[i]) * d;
+			}
+		}
+		else
+		{
+			if (aTexture == nullptr)
+				return;
+
+			// Image fills map through the paint transform, textured triangles use their own coordinates
+			float u = aU, v = aV;
+			if (aShader.type == 1)
+			{
+				transformPoint(aShader.paintMat, px, py, u, v);
+				u /= aShader.extent[0];
+				v /= aShader.extent[1];
+			}
+
+			// Nearest sample, repeating or clamping as the image requests
+			int tx = static_cast<int>(std::floor(u * aTexture->width));
+			int ty = static_cast<int>(std::floor(v * aTexture->height));
+
+			if (aTexture->flags & NVG_IMAGE_REPEATX)
+				tx = ((tx % aTexture->width) + aTexture->width) % aTexture->width;
+			else
+				tx = (tx < 0) ? 0 : (tx >= aTexture->width ? aTexture->width - 1 : tx);
+
+			if (aTexture->flags & NVG_IMAGE_REPEATY)
+				ty = ((ty % aTexture->height) + aTexture->height) % aTexture->height;
+			else
+				ty = (ty < 0) ? 0 : (ty >= aTexture->height ? aTexture->height - 1 : ty);
+
+			if (aTexture->type == NVG_TEXTURE_ALPHA)
+			{
+				float alpha = aTexture->data[static_cast<size_t>(ty) * aTexture->width + tx] / 255.0f;
+				colour[0] = colour[1] = colour[2] = colour[3] = alpha;
+			}
+			else
+			{
+				const unsigned char* texel = &aTexture->data[(static_cast<size_t>(ty) * aTexture->width + tx) * 4];
+				colour[3] = texel[3] / 255.0f;
+
+				// Straight alpha images are premultiplied on sampling
+				float scale = (aTexture->flags & NVG_IMAGE_PREMULTIPLIED) ? 1.0f / 255.0f : colour[3] / 255.0f;
+				colour[0] = texel[0] * scale;
+				colour[1] = texel[1] * scale;
+				colour[2] = texel[2] * scale;
+			}
+
+			for (int i = 0; i < 4; i++)
+				colour[i] *= aShader.innerColour[i];
+		}
+
+		for (int i = 0; i < 4; i++)
+			colour[i] *= scissor;
+
+		if (colour[3] <= 0.0f)
+			return;
+
+		// Premultiplied source-over blend
+		unsigned char* pixel = &pixels[(static_cast<size_t>(aY) * width + aX) * 4];
+		float inverseAlpha = 1.0f - colour[3];
+
+		for (int i = 0; i < 4; i++)
+		{
+			float value = colour[i] * 255.0f + pixel[i] * inverseAlpha;
+			pixel[i] = static_cast<unsigned char>(value >= 255.0f ? 255 : static_cast<int>(value + 0.5f));
+		}
+	}
+
+
+	//
+	// Rasterization
+	//
+
+	void SoftwareRenderer::rasterizeCall(const Call& aCall, int aTop, int aBottom, std::vector<int>& aWinding)
+	{
+		const Shader& shader = aCall.shader;
+		const Texture* texture = (shader.image != 0) ? findTexture(shader.image) : nullptr;
+
+		// Shade every covered pixel
+		auto shade = [&](int aX, int aY, float, float, int) {
+			shadePixel(shader, texture, aX, aY, 0, 0);
+		};
+
+		// Draw a triangle strip
+		auto drawStrip = [&](int aOffset, int aCount) {
+			for (int i = 0; i + 2 < aCount; i++)
+				rasterizeTriangle(vertices[aOffset + i], vertices[aOffset + i + 1], vertices[aOffset + i + 2], width, aTop, aBottom, shade);
+		};
+
+		switch (aCall.type)
+		{
+		case Call::Type::ConvexFill:
+		{
+			// Convex paths are drawn directly as fans
+			for (int p = aCall.pathOffset; p < aCall.pathOffset + aCall.pathCount; p++)
+			{
+				const PathRange& path = paths[p];
+				for (int i = 1; i + 1 < path.fillCount; i++)
+					rasterizeTriangle(vertices[path.fillOffset], vertices[path.fillOffset + i], vertices[path.fillOffset + i + 1], width, aTop, aBottom, shade);
+
+				drawStrip(path.strokeOffset, path.strokeCount);
+			}
+			break;
+		}
+
+		case Call::Type::Fill:
+		{
+			// Accumulate nonzero winding from every path's fan, as the GL backend does in the stencil buffer
+			auto wind = [&](int aX, int aY, float, float, int aDirection) {
+				aWinding[static_cast<size_t>(aY - aTop) * width + aX] += aDirection;
+			};
+
+			for (int p = aCall.pathOffset; p < aCall.pathOffset + aCall.pathCount; p++)
+			{
+				const PathRange& path = paths[p];
+				for (int i = 1; i + 1 < path.fillCount; i++)
+					rasterizeTriangle(vertices[path.fillOffset], vertices[path.fillOffset + i], vertices[path.fillOffset + i + 1], width, aTop, aBottom, wind);
+			}
+
+			// Cover the bounds, shading wound pixels and resetting the buffer
+			int x0 = static_cast<int>(std::floor(aCall.bounds[0]));
+			int y0 = static_cast<int>(std::floor(aCall.bounds[1]));
+			int x1 = static_cast<int>(std::ceil(aCall.bounds[2]));
+			int y1 = static_cast<int>(std::ceil(aCall.bounds[3]));
+
+			if (x0 < 0) x0 = 0;
+			if (x1 > width) x1 = width;
+			if (y0 < aTop) y0 = aTop;
+			if (y1 > aBottom) y1 = aBottom;
+
+			for (int y = y0; y < y1; y++)
+			{
+				int* row = &aWinding[static_cast<size_t>(y - aTop) * width];
+				for (int x = x0; x < x1; x++)
+				{
+					if (row[x] != 0)
+					{
+						shadePixel(shader, texture, x, y, 0, 0);
+						row[x] = 0;
+					}
+				}
+			}
+
+			// Anti-aliased fringes
+			for (int p = aCall.pathOffset; p < aCall.pathOffset + aCall.pathCount; p++)
+				drawStrip(paths[p].strokeOffset, paths[p].strokeCount);
+
+			break;
+		}
+
+		case Call::Type::Stroke:
+		{
+			for (int p = aCall.pathOffset; p < aCall.pathOffset + aCall.pathCount; p++)
+				drawStrip(paths[p].strokeOffset, paths[p].strokeCount);
+			break;
+		}
+
+		case Call::Type::Triangles:
+		{
+			// Textured triangles, interpolating texture coordinates
+			for (int i = 0; i + 2 < aCall.triangleCount; i += 3)
+			{
+				const NVGvertex& a = vertices[aCall.triangleOffset + i];
+				const NVGvertex& b = vertices[aCall.triangleOffset + i + 1];
+				const NVGvertex& c = vertices[aCall.triangleOffset + i + 2];
+
+				rasterizeTriangle(a, b, c, width, aTop, aBottom, [&](int aX, int aY, float aWeightB, float aWeightC, int) {
+					float weightA = 1.0f - aWeightB - aWeightC;
+					float u = a.u * weightA + b.u * aWeightB + c.u * aWeightC;
+					float v = a.v * weightA + b.v * aWeightB + c.v * aWeightC;
+					shadePixel(shader, texture, aX, aY, u, v);
+				});
+			}
+			break;
+		}
+		}
+	}
+
+	void SoftwareRenderer::rasterizeBand(int aBand, int aTop, int aBottom)
+	{
+		std::vector<int>& winding = windingBuffers[aBand];
+
+		for (const Call& call : calls)
+			rasterizeCall(call, aTop, aBottom, winding);
+	}
+
+	void SoftwareRenderer::workerLoop(int aBand, unsigned long aGeneration)
+	{
+		unsigned long generation = aGeneration;
+
+		while (true)
+		{
+			int bands;
+			int bandHeight;
+			{
+				std::unique_lock<std::mutex> lock(workMutex);
+				workReady.wait(lock, [this, generation]() { return stopping || workGeneration != generation; });
+				if (stopping)
+					return;
+
+				generation = workGeneration;
+				bands = workBands;
+				bandHeight = workBandHeight;
+			}
+
+			// Short framebuffers have fewer bands than workers
+			if (aBand >= bands - 1)
+				continue;
+
+			int top = aBand * bandHeight;
+			int bottom = (top + bandHeight < height) ? top + bandHeight : height;
+			rasterizeBand(aBand, top, bottom);
+
+			std::lock_guard<std::mutex> lock(workMutex);
+			if (--workPending == 0)
+				workDone.notify_one();
+		}
+	}
+
+
+	//
+	// NanoVG render callbacks
+	//
+
+	int SoftwareRenderer::renderCreate(void*)
+	{
+		return 1;
+	}
+
+	int SoftwareRenderer::renderCreateTexture(void* aUserPtr, int aType, int aWidth, int aHeight, int aImageFlags, const unsigned char* aData)
+	{
+		SoftwareRenderer* renderer = static_cast<SoftwareRenderer*>(aUserPtr);
+
+		Texture texture;
+		texture.id = renderer->nextTextureId++;
+		texture.type = aType;
+		texture.width = aWidth;
+		texture.height = aHeight;
+		texture.flags = aImageFlags;
+
+		size_t bytes = static_cast<size_t>(aWidth) * aHeight * (aType == NVG_TEXTURE_RGBA ? 4 : 1);
+		if (aData != nullptr)
+			texture.data.assign(aData, aData + bytes);
+		else
+			texture.data.assign(bytes, 0);
+
+		renderer->textures.push_back(std::move(texture));
+		return renderer->textures.back().id;
+	}
+
+	int SoftwareRenderer::renderDeleteTexture(void* aUserPtr, int aImage)
+	{
+		SoftwareRenderer* renderer = static_cast<SoftwareRenderer*>(aUserPtr);
+
+		for (int i = 0; i < static_cast<int>(renderer->textures.size()); i++)
+		{
+			if (renderer->textures[i].id == aImage)
+			{
+				renderer->textures.erase(renderer->textures.begin() + i);
+				return 1;
+			}
+		}
+
+		return 0;
+	}
+
+	int SoftwareRenderer::renderUpdateTexture(void* aUserPtr, int aImage, int aX, int aY, int aWidth, int aHeight, const unsigned char* aData)
+	{
+		SoftwareRenderer* renderer = static_cast<SoftwareRenderer*>(aUserPtr);
+		Texture* texture = renderer->findTexture(aImage);
+		if (texture == nullptr)
+			return 0;
+
+		// Data is the whole image, copy the updated sub-rect row by row
+		int bytesPerPixel = (texture->type == NVG_TEXTURE_RGBA) ? 4 : 1;
+		for (int y = aY; y < aY + aHeight; y++)
+		{
+			size_t offset = (static_cast<size_t>(y) * texture->width + aX) * bytesPerPixel;
+			memcpy(&texture->data[offset], aData + offset, static_cast<size_t>(aWidth) * bytesPerPixel);
+		}
+
+		return 1;
+	}
+
+	int SoftwareRenderer::renderGetTextureSize(void* aUserPtr, int aImage, int* aWidth, int* aHeight)
+	{
+		SoftwareRenderer* renderer = static_cast<SoftwareRenderer*>(aUserPtr);
+		Texture* texture = renderer->findTexture(aImage);
+		if (texture == nullptr)
+			return 0;
+
+		*aWidth = texture->width;
+		*aHeight = texture->height;
+		return 1;
+	}
+
+	void SoftwareRenderer::renderViewport(void*, float, float, float)
+	{
+		// Framebuffer size is owned by the renderer, see resize()
+	}
+
+	void SoftwareRenderer::renderCancel(void* aUserPtr)
+	{
+		SoftwareRenderer* renderer = static_cast<SoftwareRenderer*>(aUserPtr);
+		renderer->calls.clear();
+		renderer->paths.clear();
+		renderer->vertices.clear();
+	}
+
+	void SoftwareRenderer::renderFlush(void* aUserPtr)
+	{
+		SoftwareRenderer* renderer = static_cast<SoftwareRenderer*>(aUserPtr);
+
+		if (!renderer->calls.empty() && renderer->width > 0 && renderer->height > 0)
+		{
+			// Split the framebuffer into horizontal bands, one per thread
+			int bands = renderer->threadCount;
+			if (bands > renderer->height)
+				bands = renderer->height;
+
+			int bandHeight = (renderer->height + bands - 1) / bands;
+
+			if (static_cast<int>(renderer->windingBuffers.size()) != bands)
+				renderer->windingBuffers.assign(bands, std::vector<int>(static_cast<size_t>(renderer->width) * bandHeight, 0));
+
+			// Hand the other bands to the workers, the last band runs on this thread
+			if (bands > 1)
+			{
+				{
+					std::lock_guard<std::mutex> lock(renderer->workMutex);
+
+					for (int band = static_cast<int>(renderer->workers.size()); band < renderer->threadCount - 1; band++)
+						renderer->workers.emplace_back(&SoftwareRenderer::workerLoop, renderer, band, renderer->workGeneration);
+
+					renderer->workBands = bands;
+					renderer->workBandHeight = bandHeight;
+					renderer->workPending = bands - 1;
+					renderer->workGeneration++;
+				}
+				renderer->workReady.notify_all();
+			}
+
+			renderer->rasterizeBand(bands - 1, (bands - 1) * bandHeight, renderer->height);
+
+			if (bands > 1)
+			{
+				std::unique_lock<std::mutex> lock(renderer->workMutex);
+				renderer->workDone.wait(lock, [renderer]() { return renderer->workPending == 0; });
+			}
+		}
+
+		renderCancel(aUserPtr);
+	}
+
+	void SoftwareRenderer::renderFill(void* aUserPtr, NVGpaint* aPaint, NVGcompositeOperationState, NVGscissor* aScissor, float aFringe, const float* aBounds, const NVGpath* aPaths, int aPathCount)
+	{
+		SoftwareRenderer* renderer = static_cast<SoftwareRenderer*>(aUserPtr);
+
+		Call call;
+		if (!renderer->convertPaint(call.shader, aPaint, aScissor, aFringe))
+			return;
+
+		call.type = (aPathCount == 1 && aPaths[0].convex) ? Call::Type::ConvexFill : Call::Type::Fill;
+		call.pathOffset = static_cast<int>(renderer->paths.size());
+		call.pathCount = aPathCount;
+		call.triangleOffset = 0;
+		call.triangleCount = 0;
+		memcpy(call.bounds, aBounds, sizeof(call.bounds));
+
+		// Copy path geometry, NanoVG reuses its buffers once the call returns
+		for (int i = 0; i < aPathCount; i++)
+		{
+			PathRange range;
+			range.fillOffset = static_cast<int>(renderer->vertices.size());
+			range.fillCount = aPaths[i].nfill;
+			renderer->vertices.insert(renderer->vertices.end(), aPaths[i].fill, aPaths[i].fill + aPaths[i].nfill);
+
+			range.strokeOffset = static_cast<int>(renderer->vertices.size());
+			range.strokeCount = aPaths[i].nstroke;
+			renderer->vertices.insert(renderer->vertices.end(), aPaths[i].stroke, aPaths[i].stroke + aPaths[i].nstroke);
+
+			renderer->paths.push_back(range);
+		}
+
+		renderer->calls.push_back(call);
+	}
+
+	void SoftwareRenderer::renderStroke(void* aUserPtr, NVGpaint* aPaint, NVGcompositeOperationState, NVGscissor* aScissor, float aFringe, float, const NVGpath* aPaths, int aPathCount)
+	{
+		SoftwareRenderer* renderer = static_cast<SoftwareRenderer*>(aUserPtr);
+
+		Call call;
+		if (!renderer->convertPaint(call.shader, aPaint, aScissor, aFringe))
+			return;
+
+		call.type = Call::Type::Stroke;
+		call.pathOffset = static_cast<int>(renderer->paths.size());
+		call.pathCount = aPathCount;
+		call.triangleOffset = 0;
+		call.triangleCount = 0;
+		memset(call.bounds, 0, sizeof(call.bounds));
+
+		for (int i = 0; i < aPathCount; i++)
+		{
+			PathRange range;
+			range.fillOffset = 0;
+			range.fillCount = 0;
+			range.strokeOffset = static_cast<int>(renderer->vertices.size());
+			range.strokeCount = aPaths[i].nstroke;
+			renderer->vertices.insert(renderer->vertices.end(), aPaths[i].stroke, aPaths[i].stroke + aPaths[i].nstroke);
+
+			renderer->paths.push_back(range);
+		}
+
+		renderer->calls.push_back(call);
+	}
+
+	void SoftwareRenderer::renderTriangles(void* aUserPtr, NVGpaint* aPaint, NVGcompositeOperationState, NVGscissor* aScissor, const NVGvertex* aVertices, int aVertexCount, float)
+	{
+		SoftwareRenderer* renderer = static_cast<SoftwareRenderer*>(aUserPtr);
+
+		Call call;
+		if (!renderer->convertPaint(call.shader, aPaint, aScissor, 1.0f))
+			return;
+
+		// Textured triangles sample with their own coordinates
+		call.shader.type = 3;
+		call.type = Call::Type::Triangles;
+		call.pathOffset = 0;
+		call.pathCount = 0;
+		call.triangleOffset = static_cast<int>(renderer->vertices.size());
+		call.triangleCount = aVertexCount;
+		memset(call.bounds, 0, sizeof(call.bounds));
+
+		renderer->vertices.insert(renderer->vertices.end(), aVertices, aVertices + aVertexCount);
+		renderer->calls.push_back(call);
+	}
+
+	void SoftwareRenderer::renderDelete(void* aUserPtr)
+	{
+		SoftwareRenderer* renderer = static_cast<SoftwareRenderer*>(aUserPtr);
+		renderCancel(aUserPtr);
+		renderer->textures.clear();
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_SOFTWARE_RENDERER_CPP
@@ -0,0 +1,177 @@
+#ifndef LEMUR_SOFTWARE_RENDERER_H
+#define LEMUR_SOFTWARE_RENDERER_H
+
+/**************************************************************************************
+* Lemur:        Software Renderer Class                                               *
+*-------------------------------------------------------------------------------------*
+* Filename:     SoftwareRenderer.h                                                    *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   A NanoVG render backend which rasterizes into an in-memory RGBA buffer on the     *
+*   CPU, used to run the UI without a GPU or display.                                 *
+*                                                                                     *
+* Notes:                                                                              *
+*   Edge anti-aliasing is not supported, the context is always created without it.    *
+*   All composite operations are drawn as source-over.                                *
+***************************************************************************************/
+
+
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "nanovg.h"
+#include "colour.h"
+#include "rect.h"
+
+
+namespace Lemur
+{
+	class SoftwareRenderer
+	{
+	public:
+
+		// Paint and scissor state for a draw call, laid out as the GL backend's fragment uniforms
+		struct Shader
+		{
+			float scissorMat[6];
+			float scissorExt[2];
+			float scissorScale[2];
+			float paintMat[6];
+			float extent[2];
+			float radius;
+			float feather;
+			float innerColour[4];				// Premultiplied
+			float outerColour[4];				// Premultiplied
+			int image;
+			int type;
+		};
+
+		// Vertex ranges for one path
+		struct PathRange
+		{
+			int fillOffset;
+			int fillCount;
+			int strokeOffset;
+			int strokeCount;
+		};
+
+		// Recorded draw call
+		struct Call
+		{
+			enum class Type { Fill, ConvexFill, Stroke, Triangles };
+
+			Type type;
+			Shader shader;
+			int pathOffset;
+			int pathCount;
+			int triangleOffset;
+			int triangleCount;
+			float bounds[4];
+		};
+
+		// CPU texture
+		struct Texture
+		{
+			int id;
+			int type;
+			int width;
+			int height;
+			int flags;
+			std::vector<unsigned char> data;
+		};
+
+	private:
+
+		int width;										// Framebuffer width in pixels
+		int height;										// Framebuffer height in pixels
+		int threadCount;								// Number of horizontal bands rasterized in parallel
+		std::vector<unsigned char> pixels;				// RGBA framebuffer, top row first
+
+		// Recorded frame
+		std::vector<Call> calls;
+		std::vector<PathRange> paths;
+		std::vector<NVGvertex> vertices;
+
+		// Textures
+		std::vector<Texture> textures;
+		int nextTextureId = 1;
+
+		// Per band nonzero winding buffers for concave fills
+		std::vector<std::vector<int>> windingBuffers;
+
+		// Band workers, started by the first flush and kept for later frames. Each worker owns one band,
+		// the last band is rasterized by the flushing thread.
+		std::vector<std::thread> workers;
+		std::mutex workMutex;
+		std::condition_variable workReady;				// A flush has bands for the workers
+		std::condition_variable workDone;				// Every worker band of the flush is finished
+		unsigned long workGeneration = 0;				// Incremented by each parallel flush
+		int workBands = 0;								// Bands in the current flush
+		int workBandHeight = 0;
+		int workPending = 0;							// Worker bands not yet finished
+		bool stopping = false;
+
+		// Wait for flushes and rasterize this worker's band of each
+		void workerLoop(int aBand, unsigned long aGeneration);
+
+		// Find a texture by id
+		Texture* findTexture(int aId);
+
+		// Convert NanoVG paint and scissor state to a shader
+		bool convertPaint(Shader& aShader, NVGpaint* aPaint, NVGscissor* aScissor, float aFringe);
+
+		// Rasterize all recorded calls within rows [aTop, aBottom)
+		void rasterizeBand(int aBand, int aTop, int aBottom);
+		void rasterizeCall(const Call& aCall, int aTop, int aBottom, std::vector<int>& aWinding);
+
+		// Shade a pixel and blend it into the framebuffer
+		void shadePixel(const Shader& aShader, const Texture* aTexture, int aX, int aY, float aU, float aV);
+
+		// NanoVG render callbacks
+		static int renderCreate(void* aUserPtr);
+		static int renderCreateTexture(void* aUserPtr, int aType, int aWidth, int aHeight, int aImageFlags, const unsigned char* aData);
+		static int renderDeleteTexture(void* aUserPtr, int aImage);
+		static int renderUpdateTexture(void* aUserPtr, int aImage, int aX, int aY, int aWidth, int aHeight, const unsigned char* aData);
+		static int renderGetTextureSize(void* aUserPtr, int aImage, int* aWidth, int* aHeight);
+		static void renderViewport(void* aUserPtr, float aWidth, float aHeight, float aDevicePixelRatio);
+		static void renderCancel(void* aUserPtr);
+		static void renderFlush(void* aUserPtr);
+		static void renderFill(void* aUserPtr, NVGpaint* aPaint, NVGcompositeOperationState aCompositeOperation, NVGscissor* aScissor, float aFringe, const float* aBounds, const NVGpath* aPaths, int aPathCount);
+		static void renderStroke(void* aUserPtr, NVGpaint* aPaint, NVGcompositeOperationState aCompositeOperation, NVGscissor* aScissor, float aFringe, float aStrokeWidth, const NVGpath* aPaths, int aPathCount);
+		static void renderTriangles(void* aUserPtr, NVGpaint* aPaint, NVGcompositeOperationState aCompositeOperation, NVGscissor* aScissor, const NVGvertex* aVertices, int aVertexCount, float aFringe);
+		static void renderDelete(void* aUserPtr);
+
+	public:
+
+		// Constructor, a thread count of 0 uses one band per hardware thread
+		SoftwareRenderer(int aWidth, int aHeight, int aThreadCount = 0);
+		~SoftwareRenderer();
+
+		SoftwareRenderer(const SoftwareRenderer&) = delete;
+		SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+		// Create a NanoVG context drawing into this renderer. Delete with nvgDeleteInternal.
+		NVGcontext* createContext();
+
+		// Resize the framebuffer, contents are cleared
+		void resize(int aWidth, int aHeight);
+
+		// Clear the whole framebuffer, or an area of it
+		void clear(const Colour& aColour);
+		void clear(const Rect& aRect, const Colour& aColour);
+
+		// Getters
+		int getWidth() const;
+		int getHeight() const;
+		int getThreadCount() const;
+		const unsigned char* getPixels() const;
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_SOFTWARE_RENDERER_H
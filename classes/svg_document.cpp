@@ -0,0 +1,1051 @@
+#ifndef LEMUR_SVG_DOCUMENT_CPP
+#define LEMUR_SVG_DOCUMENT_CPP
+
+/**************************************************************************************
+* Lemur:        SVG Document Class                                                    *
+*-------------------------------------------------------------------------------------*
+* Filename:     SvgDocument.cpp                                                       *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   An SVG file parsed into filled and stroked paths, which can be drawn at any       *
+*   size to a NanoVG context.                                                         *
+***************************************************************************************/
+
+
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "pugixml.hpp"
+#include "svg_document.h"
+
+
+namespace Lemur
+{
+	namespace
+	{
+		const float PI = 3.14159265358979f;
+		const float KAPPA = 0.5522847493f;		// Control point distance for a quarter circle bezier
+
+		bool isSeparator(char aChar)
+		{
+			return aChar == ' ' || aChar == '\t' || aChar == '\n' || aChar == '\r' || aChar == ',';
+		}
+
+		const char* skipSeparators(const char* aText)
+		{
+			while (*aText != 0 && isSeparator(*aText))
+				aText++;
+
+			return aText;
+		}
+
+		// Read the next number in a list, returning false at the end of it
+		bool readNumber(const char*& aText, float& aValue)
+		{
+			aText = skipSeparators(aText);
+
+			char* end = nullptr;
+			aValue = strtof(aText, &end);
+			if (end == aText)
+				return false;
+
+			aText = end;
+			return true;
+		}
+
+		bool readNumbers(const char*& aText, float* aValues, int aCount)
+		{
+			for (int i = 0; i < aCount; i++)
+				if (!readNumber(aText, aValues[i]))
+					return false;
+
+			return true;
+		}
+
+		// Arc flags may be written without separators, as in "a5 5 0 011 1"
+		bool readFlag(const char*& aText, float& aValue)
+		{
+			aText = skipSeparators(aText);
+			if (*aText != '0' && *aText != '1')
+				return false;
+
+			aValue = *aText == '1' ? 1.0f : 0.0f;
+			aText++;
+			return true;
+		}
+
+		std::string trim(const std::string& aText)
+		{
+			size_t start = aText.find_first_not_of(" \t\r\n");
+			if (start == std::string::npos)
+				return std::string();
+
+			size_t end = aText.find_last_not_of(" \t\r\n");
+			return aText.substr(start, end - start + 1);
+		}
+
+		// Read a length in user units, ignoring units. Percentages are not supported.
+		bool readLength(const char* aText, float& aValue)
+		{
+			char* end = nullptr;
+			aValue = strtof(aText, &end);
+			return end != aText && *end != '%';
+		}
+
+		float attributeLength(const pugi::xml_node& aNode, const char* aName, float aDefault = 0)
+		{
+			float value = aDefault;
+			pugi::xml_attribute attribute = aNode.attribute(aName);
+			if (attribute && !readLength(attribute.value(), value))
+				value = aDefault;
+
+			return value;
+		}
+
+		// aResult = aParent * aLocal, so aLocal is applied first
+		void multiplyTransform(float* aResult, const float* aParent, const float* aLocal)
+		{
+			float result[6];
+			result[0] = aParent[0] * aLocal[0] + aParent[2] * aLocal[1];
+			result[1] = aParent[1] * aLocal[0] + aParent[3] * aLocal[1];
+			result[2] = aParent[0] * aLocal[2] + aParent[2] * aLocal[3];
+			result[3] = aParent[1] * aLocal[2] + aParent[3] * aLocal[3];
+			result[4] = aParent[0] * aLocal[4] + aParent[2] * aLocal[5] + aParent[4];
+			result[5] = aParent[1] * aLocal[4] + aParent[3] * aLocal[5] + aParent[5];
+			memcpy(aResult, result, sizeof(result));
+		}
+	}
+
+	//--- Path building ---//
+
+	void SvgDocument::moveTo(std::vector<Subpath>& aSubpaths, float aX, float aY)
+	{
+		aSubpaths.emplace_back();
+		Subpath& subpath = aSubpaths.back();
+		subpath.commands.insert(subpath.commands.end(), { static_cast<float>(MOVE_TO), aX, aY });
+		subpath.bounds[0] = subpath.bounds[2] = aX;
+		subpath.bounds[1] = subpath.bounds[3] = aY;
+	}
+
+	void SvgDocument::lineTo(std::vector<Subpath>& aSubpaths, float aX, float aY)
+	{
+		if (aSubpaths.empty())
+			moveTo(aSubpaths, 0, 0);
+
+		Subpath& subpath = aSubpaths.back();
+		subpath.commands.insert(subpath.commands.end(), { static_cast<float>(LINE_TO), aX, aY });
+		subpath.bounds[0] = std::min(subpath.bounds[0], aX);
+		subpath.bounds[1] = std::min(subpath.bounds[1], aY);
+		subpath.bounds[2] = std::max(subpath.bounds[2], aX);
+		subpath.bounds[3] = std::max(subpath.bounds[3], aY);
+	}
+
+	void SvgDocument::bezierTo(std::vector<Subpath>& aSubpaths, float aC1x, float aC1y, float aC2x, float aC2y, float aX, float aY)
+	{
+		if (aSubpaths.empty())
+			moveTo(aSubpaths, 0, 0);
+
+		// Control points keep the curve inside their hull, so they bound it
+		Subpath& subpath = aSubpaths.back();
+		subpath.commands.insert(subpath.commands.end(), { static_cast<float>(BEZIER_TO), aC1x, aC1y, aC2x, aC2y, aX, aY });
+		subpath.bounds[0] = std::min({ subpath.bounds[0], aC1x, aC2x, aX });
+		subpath.bounds[1] = std::min({ subpath.bounds[1], aC1y, aC2y, aY });
+		subpath.bounds[2] = std::max({ subpath.bounds[2], aC1x, aC2x, aX });
+		subpath.bounds[3] = std::max({ subpath.bounds[3], aC1y, aC2y, aY });
+	}
+
+	void SvgDocument::arcTo(std::vector<Subpath>& aSubpaths, float aX1, float aY1, float aRx, float aRy, float aAngle, bool aLargeArc, bool aSweep, float aX2, float aY2)
+	{
+		// Endpoint to centre parameterisation, from the SVG implementation notes
+		aRx = fabsf(aRx);
+		aRy = fabsf(aRy);
+
+		if (aRx == 0 || aRy == 0 || (aX1 == aX2 && aY1 == aY2))
+		{
+			lineTo(aSubpaths, aX2, aY2);
+			return;
+		}
+
+		float cosPhi = cosf(aAngle * PI / 180.0f);
+		float sinPhi = sinf(aAngle * PI / 180.0f);
+		float dx = (aX1 - aX2) / 2;
+		float dy = (aY1 - aY2) / 2;
+		float x1p = cosPhi * dx + sinPhi * dy;
+		float y1p = -sinPhi * dx + cosPhi * dy;
+
+		// Grow radii too small to reach the end point
+		float lambda = (x1p * x1p) / (aRx * aRx) + (y1p * y1p) / (aRy * aRy);
+		if (lambda > 1)
+		{
+			aRx *= sqrtf(lambda);
+			aRy *= sqrtf(lambda);
+		}
+
+		float numerator = aRx * aRx * aRy * aRy - aRx * aRx * y1p * y1p - aRy * aRy * x1p * x1p;
+		float denominator = aRx * aRx * y1p * y1p + aRy * aRy * x1p * x1p;
+		float coefficient = denominator > 0 ? sqrtf(std::max(0.0f, numerator / denominator)) : 0;
+		if (aLargeArc == aSweep)
+			coefficient = -coefficient;
+
+		float cxp = coefficient * aRx * y1p / aRy;
+		float cyp = -coefficient * aRy * x1p / aRx;
+		float cx = cosPhi * cxp - sinPhi * cyp + (aX1 + aX2) / 2;
+		float cy = sinPhi * cxp + cosPhi * cyp + (aY1 + aY2) / 2;
+
+		float ux = (x1p - cxp) / aRx;
+		float uy = (y1p - cyp) / aRy;
+		float vx = (-x1p - cxp) / aRx;
+		float vy = (-y1p - cyp) / aRy;
+		float startAngle = atan2f(uy, ux);
+		float sweepAngle = atan2f(ux * vy - uy * vx, ux * vx + uy * vy);
+
+		if (!aSweep && sweepAngle > 0)
+			sweepAngle -= 2 * PI;
+		else if (aSweep && sweepAngle < 0)
+			sweepAngle += 2 * PI;
+
+		// One bezier per quarter turn or less
+		int segments = std::max(1, static_cast<int>(ceilf(fabsf(sweepAngle) / (PI / 2) - 0.001f)));
+		float step = sweepAngle / segments;
+		float handle = 4.0f / 3.0f * tanf(step / 4);
+
+		auto point = [&](float aT, float& aX, float& aY)
+		{
+			aX = cx + aRx * cosf(aT) * cosPhi - aRy * sinf(aT) * sinPhi;
+			aY = cy + aRx * cosf(aT) * sinPhi + aRy * sinf(aT) * cosPhi;
+		};
+
+		auto tangent = [&](float aT, float& aX, float& aY)
+		{
+			aX = -aRx * sinf(aT) * cosPhi - aRy * cosf(aT) * sinPhi;
+			aY = -aRx * sinf(aT) * sinPhi + aRy * cosf(aT) * cosPhi;
+		};
+
+		for (int i = 0; i < segments; i++)
+		{
+			float t0 = startAngle + i * step;
+			float t1 = t0 + step;
+			float x0, y0, x1, y1, tx0, ty0, tx1, ty1;
+			point(t0, x0, y0);
+			point(t1, x1, y1);
+			tangent(t0, tx0, ty0);
+			tangent(t1, tx1, ty1);
+
+			// Land exactly on the end point
+			if (i == segments - 1)
+			{
+				x1 = aX2;
+				y1 = aY2;
+			}
+
+			bezierTo(aSubpaths, x0 + handle * tx0, y0 + handle * ty0, x1 - handle * tx1, y1 - handle * ty1, x1, y1);
+		}
+	}
+
+	void SvgDocument::closePath(std::vector<Subpath>& aSubpaths)
+	{
+		if (!aSubpaths.empty())
+			aSubpaths.back().commands.push_back(static_cast<float>(CLOSE));
+	}
+
+	void SvgDocument::addEllipse(std::vector<Subpath>& aSubpaths, float aCx, float aCy, float aRx, float aRy)
+	{
+		if (aRx <= 0 || aRy <= 0)
+			return;
+
+		float kx = aRx * KAPPA;
+		float ky = aRy * KAPPA;
+
+		moveTo(aSubpaths, aCx + aRx, aCy);
+		bezierTo(aSubpaths, aCx + aRx, aCy + ky, aCx + kx, aCy + aRy, aCx, aCy + aRy);
+		bezierTo(aSubpaths, aCx - kx, aCy + aRy, aCx - aRx, aCy + ky, aCx - aRx, aCy);
+		bezierTo(aSubpaths, aCx - aRx, aCy - ky, aCx - kx, aCy - aRy, aCx, aCy - aRy);
+		bezierTo(aSubpaths, aCx + kx, aCy - aRy, aCx + aRx, aCy - ky, aCx + aRx, aCy);
+		closePath(aSubpaths);
+	}
+
+	void SvgDocument::addRect(std::vector<Subpath>& aSubpaths, float aX, float aY, float aWidth, float aHeight, float aRx, float aRy)
+	{
+		if (aWidth <= 0 || aHeight <= 0)
+			return;
+
+		aRx = std::clamp(aRx, 0.0f, aWidth / 2);
+		aRy = std::clamp(aRy, 0.0f, aHeight / 2);
+
+		if (aRx == 0 || aRy == 0)
+		{
+			moveTo(aSubpaths, aX, aY);
+			lineTo(aSubpaths, aX + aWidth, aY);
+			lineTo(aSubpaths, aX + aWidth, aY + aHeight);
+			lineTo(aSubpaths, aX, aY + aHeight);
+			closePath(aSubpaths);
+			return;
+		}
+
+		float kx = aRx * (1 - KAPPA);
+		float ky = aRy * (1 - KAPPA);
+		float right = aX + aWidth;
+		float bottom = aY + aHeight;
+
+		moveTo(aSubpaths, aX + aRx, aY);
+		lineTo(aSubpaths, right - aRx, aY);
+		bezierTo(aSubpaths, right - kx, aY, right, aY + ky, right, aY + aRy);
+		lineTo(aSubpaths, right, bottom - aRy);
+		bezierTo(aSubpaths, right, bottom - ky, right - kx, bottom, right - aRx, bottom);
+		lineTo(aSubpaths, aX + aRx, bottom);
+		bezierTo(aSubpaths, aX + kx, bottom, aX, bottom - ky, aX, bottom - aRy);
+		lineTo(aSubpaths, aX, aY + aRy);
+		bezierTo(aSubpaths, aX, aY + ky, aX + kx, aY, aX + aRx, aY);
+		closePath(aSubpaths);
+	}
+
+	//--- Geometry parsing ---//
+
+	void SvgDocument::parsePathData(const char* aData, std::vector<Subpath>& aSubpaths)
+	{
+		const char* text = aData;
+		char command = 0;
+		char previous = 0;
+		float x = 0;
+		float y = 0;
+		float startX = 0;
+		float startY = 0;
+		float controlX = 0;		// Last control point, reflected by S and T
+		float controlY = 0;
+
+		while (true)
+		{
+			text = skipSeparators(text);
+			if (*text == 0)
+				break;
+
+			if (isalpha(static_cast<unsigned char>(*text)) && *text != 'e' && *text != 'E')
+				command = *text++;
+			else if (command == 0)
+				break;
+
+			bool relative = islower(static_cast<unsigned char>(command)) != 0;
+			float originX = relative ? x : 0;
+			float originY = relative ? y : 0;
+			char upper = static_cast<char>(toupper(static_cast<unsigned char>(command)));
+			float v[7];
+
+			switch (upper)
+			{
+			case 'M':
+				if (!readNumbers(text, v, 2))
+					return;
+
+				x = startX = originX + v[0];
+				y = startY = originY + v[1];
+				moveTo(aSubpaths, x, y);
+
+				// Further pairs are lines
+				command = relative ? 'l' : 'L';
+				break;
+
+			case 'L':
+				if (!readNumbers(text, v, 2))
+					return;
+
+				x = originX + v[0];
+				y = originY + v[1];
+				lineTo(aSubpaths, x, y);
+				break;
+
+			case 'H':
+				if (!readNumbers(text, v, 1))
+					return;
+
+				x = originX + v[0];
+				lineTo(aSubpaths, x, y);
+				break;
+
+			case 'V':
+				if (!readNumbers(text, v, 1))
+					return;
+
+				y = originY + v[0];
+				lineTo(aSubpaths, x, y);
+				break;
+
+			case 'C':
+				if (!readNumbers(text, v, 6))
+					return;
+
+				controlX = originX + v[2];
+				controlY = originY + v[3];
+				x = originX + v[4];
+				y = originY + v[5];
+				bezierTo(aSubpaths, originX + v[0], originY + v[1], controlX, controlY, x, y);
+				break;
+
+			case 'S':
+			{
+				if (!readNumbers(text, v, 4))
+					return;
+
+				bool follows = previous == 'C' || previous == 'S';
+				float c1x = follows ? 2 * x - controlX : x;
+				float c1y = follows ? 2 * y - controlY : y;
+				controlX = originX + v[0];
+				controlY = originY + v[1];
+				x = originX + v[2];
+				y = originY + v[3];
+				bezierTo(aSubpaths, c1x, c1y, controlX, controlY, x, y);
+				break;
+			}
+
+			case 'Q':
+			case 'T':
+			{
+				float qx;
+				float qy;
+
+				if (upper == 'Q')
+				{
+					if (!readNumbers(text, v, 4))
+						return;
+
+					qx = originX + v[0];
+					qy = originY + v[1];
+					v[0] = v[2];
+					v[1] = v[3];
+				}
+				else
+				{
+					if (!readNumbers(text, v, 2))
+						return;
+
+					bool follows = previous == 'Q' || previous == 'T';
+					qx = follows ? 2 * x - controlX : x;
+					qy = follows ? 2 * y - controlY : y;
+				}
+
+				// Raise the quadratic to a cubic
+				float endX = originX + v[0];
+				float endY = originY + v[1];
+				bezierTo(aSubpaths, x + 2.0f / 3.0f * (qx - x), y + 2.0f / 3.0f * (qy - y),
+					endX + 2.0f / 3.0f * (qx - endX), endY + 2.0f / 3.0f * (qy - endY), endX, endY);
+
+				controlX = qx;
+				controlY = qy;
+				x = endX;
+				y = endY;
+				break;
+			}
+
+			case 'A':
+			{
+				if (!readNumbers(text, v, 3) || !readFlag(text, v[3]) || !readFlag(text, v[4]) || !readNumbers(text, v + 5, 2))
+					return;
+
+				float endX = originX + v[5];
+				float endY = originY + v[6];
+				arcTo(aSubpaths, x, y, v[0], v[1], v[2], v[3] != 0, v[4] != 0, endX, endY);
+				x = endX;
+				y = endY;
+				break;
+			}
+
+			case 'Z':
+				closePath(aSubpaths);
+				x = startX;
+				y = startY;
+
+				// A new subpath after a close starts at the close point
+				command = 0;
+				break;
+
+			default:
+				return;
+			}
+
+			previous = upper;
+
+			if (command == 0)
+			{
+				text = skipSeparators(text);
+				if (*text != 0 && !isalpha(static_cast<unsigned char>(*text)))
+					return;
+
+				if (*text != 0 && toupper(static_cast<unsigned char>(*text)) != 'M')
+				{
+					// Commands other than move continue from the closed subpath's start
+					moveTo(aSubpaths, x, y);
+				}
+			}
+		}
+	}
+
+	void SvgDocument::parsePoints(const char* aData, bool aClose, std::vector<Subpath>& aSubpaths)
+	{
+		const char* text = aData;
+		float point[2];
+		bool first = true;
+
+		while (readNumbers(text, point, 2))
+		{
+			if (first)
+				moveTo(aSubpaths, point[0], point[1]);
+			else
+				lineTo(aSubpaths, point[0], point[1]);
+
+			first = false;
+		}
+
+		if (aClose && !first)
+			closePath(aSubpaths);
+	}
+
+	void SvgDocument::parseTransform(const char* aData, float* aTransform)
+	{
+		const char* text = aData;
+
+		while (true)
+		{
+			text = skipSeparators(text);
+			if (*text == 0)
+				return;
+
+			const char* nameStart = text;
+			while (isalpha(static_cast<unsigned char>(*text)))
+				text++;
+
+			std::string name(nameStart, text - nameStart);
+
+			text = skipSeparators(text);
+			if (*text != '(')
+				return;
+			text++;
+
+			float v[6];
+			int count = 0;
+			while (count < 6 && readNumber(text, v[count]))
+				count++;
+
+			text = skipSeparators(text);
+			if (*text != ')')
+				return;
+			text++;
+
+			float local[6] = { 1, 0, 0, 1, 0, 0 };
+
+			if (name == "matrix" && count == 6)
+			{
+				memcpy(local, v, sizeof(local));
+			}
+			else if (name == "translate" && count >= 1)
+			{
+				local[4] = v[0];
+				local[5] = count > 1 ? v[1] : 0;
+			}
+			else if (name == "scale" && count >= 1)
+			{
+				local[0] = v[0];
+				local[3] = count > 1 ? v[1] : v[0];
+			}
+			else if (name == "rotate" && count >= 1)
+			{
+				float cosAngle = cosf(v[0] * PI / 180.0f);
+				float sinAngle = sinf(v[0] * PI / 180.0f);
+				float cx = count >= 3 ? v[1] : 0;
+				float cy = count >= 3 ? v[2] : 0;
+
+				// About (cx, cy): translate(cx, cy) rotate(a) translate(-cx, -cy)
+				local[0] = cosAngle;
+				local[1] = sinAngle;
+				local[2] = -sinAngle;
+				local[3] = cosAngle;
+				local[4] = cx - cosAngle * cx + sinAngle * cy;
+				local[5] = cy - sinAngle * cx - cosAngle * cy;
+			}
+			else if (name == "skewX" && count >= 1)
+			{
+				local[2] = tanf(v[0] * PI / 180.0f);
+			}
+			else if (name == "skewY" && count >= 1)
+			{
+				local[1] = tanf(v[0] * PI / 180.0f);
+			}
+
+			multiplyTransform(aTransform, aTransform, local);
+		}
+	}
+
+	bool SvgDocument::parseColour(const std::string& aValue, NVGcolor& aColour, bool& aNone)
+	{
+		std::string value = trim(aValue);
+		aNone = false;
+
+		if (value == "none" || value == "transparent")
+		{
+			aNone = true;
+			return true;
+		}
+
+		if (!value.empty() && value[0] == '#')
+		{
+			std::string hex = value.substr(1);
+			if (hex.size() == 3)
+				hex = { hex[0], hex[0], hex[1], hex[1], hex[2], hex[2] };
+
+			if (hex.size() != 6)
+				return false;
+
+			char* end = nullptr;
+			unsigned long rgb = strtoul(hex.c_str(), &end, 16);
+			if (*end != 0)
+				return false;
+
+			aColour = nvgRGB((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF);
+			return true;
+		}
+
+		if (value.compare(0, 4, "rgb(") == 0)
+		{
+			const char* text = value.c_str() + 4;
+			float channels[3];
+
+			for (int i = 0; i < 3; i++)
+			{
+				if (!readNumber(text, channels[i]))
+					return false;
+
+				text = skipSeparators(text);
+				if (*text == '%')
+				{
+					channels[i] *= 2.55f;
+					text++;
+				}
+			}
+
+			aColour = nvgRGB(
+				static_cast<unsigned char>(std::clamp(channels[0], 0.0f, 255.0f)),
+				static_cast<unsigned char>(std::clamp(channels[1], 0.0f, 255.0f)),
+				static_cast<unsigned char>(std::clamp(channels[2], 0.0f, 255.0f)));
+			return true;
+		}
+
+		// Basic keywords
+		static const struct { const char* name; unsigned char r, g, b; } NAMED[] =
+		{
+			{ "black", 0, 0, 0 },
+			{ "white", 255, 255, 255 },
+			{ "red", 255, 0, 0 },
+			{ "green", 0, 128, 0 },
+			{ "blue", 0, 0, 255 },
+			{ "yellow", 255, 255, 0 },
+			{ "gray", 128, 128, 128 },
+			{ "grey", 128, 128, 128 },
+			{ "currentColor", 0, 0, 0 },
+		};
+
+		for (const auto& named : NAMED)
+		{
+			if (value == named.name)
+			{
+				aColour = nvgRGB(named.r, named.g, named.b);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//--- Element parsing ---//
+
+	void SvgDocument::applyStyleProperty(const std::string& aName, const std::string& aValue, Style& aStyle)
+	{
+		std::string value = trim(aValue);
+		if (value.empty() || value == "inherit")
+			return;
+
+		float number = 0;
+		bool none = false;
+
+		if (aName == "fill")
+		{
+			// Gradients and patterns are unsupported and leave the shape unfilled
+			NVGcolor colour = aStyle.fill;
+			bool parsed = parseColour(value, colour, none);
+			aStyle.hasFill = parsed && !none;
+			if (aStyle.hasFill)
+				aStyle.fill = colour;
+		}
+		else if (aName == "stroke")
+		{
+			NVGcolor colour = aStyle.stroke;
+			bool parsed = parseColour(value, colour, none);
+			aStyle.hasStroke = parsed && !none;
+			if (aStyle.hasStroke)
+				aStyle.stroke = colour;
+		}
+		else if (aName == "fill-opacity" && readLength(value.c_str(), number))
+			aStyle.fillOpacity = std::clamp(number, 0.0f, 1.0f);
+		else if (aName == "stroke-opacity" && readLength(value.c_str(), number))
+			aStyle.strokeOpacity = std::clamp(number, 0.0f, 1.0f);
+		else if (aName == "opacity" && readLength(value.c_str(), number))
+			aStyle.opacity *= std::clamp(number, 0.0f, 1.0f);
+		else if (aName == "stroke-width" && readLength(value.c_str(), number))
+			aStyle.strokeWidth = std::max(0.0f, number);
+		else if (aName == "stroke-miterlimit" && readLength(value.c_str(), number))
+			aStyle.miterLimit = std::max(1.0f, number);
+		else if (aName == "fill-rule")
+			aStyle.evenOdd = value == "evenodd";
+		else if (aName == "stroke-linecap")
+			aStyle.lineCap = value == "round" ? NVG_ROUND : value == "square" ? NVG_SQUARE : NVG_BUTT;
+		else if (aName == "stroke-linejoin")
+			aStyle.lineJoin = value == "round" ? NVG_ROUND : value == "bevel" ? NVG_BEVEL : NVG_MITER;
+		else if (aName == "display")
+			aStyle.visible = aStyle.visible && value != "none";
+		else if (aName == "visibility")
+			aStyle.visible = aStyle.visible && value != "hidden" && value != "collapse";
+	}
+
+	void SvgDocument::parseStyle(const pugi::xml_node& aNode, Style& aStyle)
+	{
+		// Presentation attributes, then the style attribute which overrides them
+		for (const pugi::xml_attribute& attribute : aNode.attributes())
+			applyStyleProperty(attribute.name(), attribute.value(), aStyle);
+
+		std::string style = aNode.attribute("style").value();
+		size_t start = 0;
+
+		while (start < style.size())
+		{
+			size_t end = style.find(';', start);
+			if (end == std::string::npos)
+				end = style.size();
+
+			std::string declaration = style.substr(start, end - start);
+			size_t colon = declaration.find(':');
+			if (colon != std::string::npos)
+				applyStyleProperty(trim(declaration.substr(0, colon)), declaration.substr(colon + 1), aStyle);
+
+			start = end + 1;
+		}
+
+		pugi::xml_attribute transform = aNode.attribute("transform");
+		if (transform)
+			parseTransform(transform.value(), aStyle.transform);
+	}
+
+	void SvgDocument::addShape(std::vector<Subpath>&& aSubpaths, const Style& aStyle)
+	{
+		if (aSubpaths.empty() || (!aStyle.hasFill && !aStyle.hasStroke))
+			return;
+
+		findHoles(aSubpaths, aStyle.evenOdd);
+
+		Shape shape;
+		shape.subpaths = std::move(aSubpaths);
+		memcpy(shape.transform, aStyle.transform, sizeof(shape.transform));
+		shape.fill = aStyle.fill;
+		shape.fill.a *= aStyle.fillOpacity * aStyle.opacity;
+		shape.stroke = aStyle.stroke;
+		shape.stroke.a *= aStyle.strokeOpacity * aStyle.opacity;
+		shape.hasFill = aStyle.hasFill && shape.fill.a > 0;
+		shape.hasStroke = aStyle.hasStroke && shape.stroke.a > 0 && aStyle.strokeWidth > 0;
+		shape.strokeWidth = aStyle.strokeWidth;
+		shape.miterLimit = aStyle.miterLimit;
+		shape.lineCap = aStyle.lineCap;
+		shape.lineJoin = aStyle.lineJoin;
+
+		if (shape.hasFill || shape.hasStroke)
+			shapes.push_back(std::move(shape));
+	}
+
+	void SvgDocument::parseElement(const pugi::xml_node& aNode, Style aStyle)
+	{
+		if (aNode.type() != pugi::node_element)
+			return;
+
+		std::string name = aNode.name();
+
+		// Elements drawn only by reference, or not at all
+		if (name == "defs" || name == "clipPath" || name == "mask" || name == "symbol" || name == "marker"
+			|| name == "linearGradient" || name == "radialGradient" || name == "pattern" || name == "style"
+			|| name == "title" || name == "desc" || name == "metadata")
+			return;
+
+		parseStyle(aNode, aStyle);
+		if (!aStyle.visible)
+			return;
+
+		std::vector<Subpath> subpaths;
+
+		if (name == "g" || name == "svg" || name == "a" || name == "switch")
+		{
+			for (const pugi::xml_node& child : aNode.children())
+				parseElement(child, aStyle);
+		}
+		else if (name == "path")
+		{
+			parsePathData(aNode.attribute("d").value(), subpaths);
+		}
+		else if (name == "rect")
+		{
+			float rx = attributeLength(aNode, "rx", -1);
+			float ry = attributeLength(aNode, "ry", -1);
+			if (rx < 0)
+				rx = std::max(ry, 0.0f);
+			if (ry < 0)
+				ry = rx;
+
+			addRect(subpaths, attributeLength(aNode, "x"), attributeLength(aNode, "y"),
+				attributeLength(aNode, "width"), attributeLength(aNode, "height"), rx, ry);
+		}
+		else if (name == "circle")
+		{
+			float r = attributeLength(aNode, "r");
+			addEllipse(subpaths, attributeLength(aNode, "cx"), attributeLength(aNode, "cy"), r, r);
+		}
+		else if (name == "ellipse")
+		{
+			addEllipse(subpaths, attributeLength(aNode, "cx"), attributeLength(aNode, "cy"),
+				attributeLength(aNode, "rx"), attributeLength(aNode, "ry"));
+		}
+		else if (name == "line")
+		{
+			// Lines are never filled
+			aStyle.hasFill = false;
+			moveTo(subpaths, attributeLength(aNode, "x1"), attributeLength(aNode, "y1"));
+			lineTo(subpaths, attributeLength(aNode, "x2"), attributeLength(aNode, "y2"));
+		}
+		else if (name == "polyline" || name == "polygon")
+		{
+			parsePoints(aNode.attribute("points").value(), name == "polygon", subpaths);
+		}
+
+		addShape(std::move(subpaths), aStyle);
+	}
+
+	void SvgDocument::findHoles(std::vector<Subpath>& aSubpaths, bool aEvenOdd)
+	{
+		if (aSubpaths.size() < 2)
+			return;
+
+		// Signed area of each outline, from its on-curve points
+		for (Subpath& subpath : aSubpaths)
+		{
+			float firstX = 0, firstY = 0, lastX = 0, lastY = 0;
+			float area = 0;
+			size_t i = 0;
+
+			while (i < subpath.commands.size())
+			{
+				int command = static_cast<int>(subpath.commands[i]);
+				float x = lastX, y = lastY;
+
+				if (command == MOVE_TO || command == LINE_TO)
+				{
+					x = subpath.commands[i + 1];
+					y = subpath.commands[i + 2];
+					i += 3;
+				}
+				else if (command == BEZIER_TO)
+				{
+					x = subpath.commands[i + 5];
+					y = subpath.commands[i + 6];
+					i += 7;
+				}
+				else
+				{
+					i++;
+					continue;
+				}
+
+				if (command == MOVE_TO)
+				{
+					firstX = x;
+					firstY = y;
+				}
+				else
+					area += lastX * y - x * lastY;
+
+				lastX = x;
+				lastY = y;
+			}
+
+			area += lastX * firstY - firstX * lastY;
+			subpath.area = area / 2;
+		}
+
+		// A subpath is a hole when the winding around it would cancel to zero under the fill rule
+		for (size_t i = 0; i < aSubpaths.size(); i++)
+		{
+			const float* inner = aSubpaths[i].bounds;
+			float innerSize = (inner[2] - inner[0]) * (inner[3] - inner[1]);
+			int containers = 0;
+			int winding = 0;
+
+			for (size_t j = 0; j < aSubpaths.size(); j++)
+			{
+				if (j == i)
+					continue;
+
+				const float* outer = aSubpaths[j].bounds;
+				float outerSize = (outer[2] - outer[0]) * (outer[3] - outer[1]);
+				bool contains = outer[0] <= inner[0] && outer[1] <= inner[1] && outer[2] >= inner[2] && outer[3] >= inner[3];
+
+				// Identical bounds nest in document order
+				if (contains && (outerSize > innerSize || j < i))
+				{
+					containers++;
+					winding += aSubpaths[j].area >= 0 ? 1 : -1;
+				}
+			}
+
+			if (aEvenOdd)
+				aSubpaths[i].hole = containers % 2 == 1;
+			else
+				aSubpaths[i].hole = winding != 0 && winding + (aSubpaths[i].area >= 0 ? 1 : -1) == 0;
+		}
+	}
+
+	//--- Public ---//
+
+	bool SvgDocument::loadFromFile(const char* aFilePath)
+	{
+		pugi::xml_document document;
+		if (!document.load_file(aFilePath))
+			return false;
+
+		pugi::xml_node root = document.child("svg");
+		if (!root)
+			return false;
+
+		// The viewBox maps to the drawn rect, falling back to the absolute size
+		float width = attributeLength(root, "width");
+		float height = attributeLength(root, "height");
+		float box[4] = { 0, 0, width, height };
+
+		const char* text = root.attribute("viewBox").value();
+		if (!readNumbers(text, box, 4))
+		{
+			box[0] = box[1] = 0;
+			box[2] = width;
+			box[3] = height;
+		}
+
+		if (box[2] <= 0 || box[3] <= 0)
+			return false;
+
+		shapes.clear();
+		memcpy(viewBox, box, sizeof(viewBox));
+		filePath = aFilePath;
+
+		Style style;
+		parseStyle(root, style);
+
+		if (style.visible)
+			for (const pugi::xml_node& child : root.children())
+				parseElement(child, style);
+
+		return true;
+	}
+
+	const std::string& SvgDocument::getFilePath() const
+	{
+		return filePath;
+	}
+
+	float SvgDocument::getWidth() const
+	{
+		return viewBox[2];
+	}
+
+	float SvgDocument::getHeight() const
+	{
+		return viewBox[3];
+	}
+
+	bool SvgDocument::isEmpty() const
+	{
+		return shapes.empty() || viewBox[2] <= 0 || viewBox[3] <= 0;
+	}
+
+	void SvgDocument::draw(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight) const
+	{
+		if (aContext == nullptr || isEmpty())
+			return;
+
+		// Fit the viewBox inside the rect, keeping its aspect ratio
+		float scale = std::min(aWidth / viewBox[2], aHeight / viewBox[3]);
+
+		nvgSave(aContext);
+		nvgTranslate(aContext, aX + (aWidth - viewBox[2] * scale) / 2, aY + (aHeight - viewBox[3] * scale) / 2);
+		nvgScale(aContext, scale, scale);
+		nvgTranslate(aContext, -viewBox[0], -viewBox[1]);
+
+		for (const Shape& shape : shapes)
+		{
+			nvgSave(aContext);
+			nvgTransform(aContext, shape.transform[0], shape.transform[1], shape.transform[2], shape.transform[3], shape.transform[4], shape.transform[5]);
+			nvgBeginPath(aContext);
+
+			for (const Subpath& subpath : shape.subpaths)
+			{
+				const std::vector<float>& commands = subpath.commands;
+				size_t i = 0;
+
+				while (i < commands.size())
+				{
+					switch (static_cast<int>(commands[i]))
+					{
+					case MOVE_TO:
+						nvgMoveTo(aContext, commands[i + 1], commands[i + 2]);
+						i += 3;
+						break;
+					case LINE_TO:
+						nvgLineTo(aContext, commands[i + 1], commands[i + 2]);
+						i += 3;
+						break;
+					case BEZIER_TO:
+						nvgBezierTo(aContext, commands[i + 1], commands[i + 2], commands[i + 3], commands[i + 4], commands[i + 5], commands[i + 6]);
+						i += 7;
+						break;
+					default:
+						nvgClosePath(aContext);
+						i++;
+						break;
+					}
+				}
+
+				// Applies to the subpath just added
+				if (subpath.hole)
+					nvgPathWinding(aContext, NVG_HOLE);
+			}
+
+			if (shape.hasFill)
+			{
+				nvgFillColor(aContext, shape.fill);
+				nvgFill(aContext);
+			}
+
+			if (shape.hasStroke)
+			{
+				nvgStrokeColor(aContext, shape.stroke);
+				nvgStrokeWidth(aContext, shape.strokeWidth);
+				nvgLineCap(aContext, shape.lineCap);
+				nvgLineJoin(aContext, shape.lineJoin);
+				nvgMiterLimit(aContext, shape.miterLimit);
+				nvgStroke(aContext);
+			}
+
+			nvgRestore(aContext);
+		}
+
+		nvgRestore(aContext);
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_SVG_DOCUMENT_CPP
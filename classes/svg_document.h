@@ -0,0 +1,141 @@
+#ifndef LEMUR_SVG_DOCUMENT_H
+#define LEMUR_SVG_DOCUMENT_H
+
+/**************************************************************************************
+* Lemur:        SVG Document Class                                                    *
+*-------------------------------------------------------------------------------------*
+* Filename:     SvgDocument.h                                                         *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   An SVG file parsed into filled and stroked paths, which can be drawn at any       *
+*   size to a NanoVG context.                                                         *
+*                                                                                     *
+* Notes:                                                                              *
+*   Supports the subset used by icons: svg, g, path, rect, circle, ellipse, line,     *
+*   polyline and polygon, with transforms, solid colours and opacity. Gradients,     *
+*   text, clipping and masks are ignored. NanoVG fills by winding direction, so      *
+*   holes are found by containment and winding when the file is parsed.              *
+***************************************************************************************/
+
+
+
+#include <string>
+#include <vector>
+#include "nanovg.h"
+
+
+namespace pugi
+{
+	class xml_node;
+}
+
+namespace Lemur
+{
+	class SvgDocument
+	{
+	private:
+
+		// Path commands, stored inline with their points
+		enum Command
+		{
+			MOVE_TO = 0,		// x, y
+			LINE_TO = 1,		// x, y
+			BEZIER_TO = 2,		// c1x, c1y, c2x, c2y, x, y
+			CLOSE = 3
+		};
+
+		// One subpath, starting with a move
+		struct Subpath
+		{
+			std::vector<float> commands;
+			float bounds[4] = { 1e30f, 1e30f, -1e30f, -1e30f };	// Bounds of the points [xmin, ymin, xmax, ymax]
+			float area = 0;										// Signed area of the points, for winding
+			bool hole = false;									// Cut out of the subpaths containing it
+		};
+
+		// Paint state, inherited from parent elements
+		struct Style
+		{
+			NVGcolor fill = nvgRGBA(0, 0, 0, 255);
+			NVGcolor stroke = nvgRGBA(0, 0, 0, 255);
+			bool hasFill = true;
+			bool hasStroke = false;
+			float fillOpacity = 1;
+			float strokeOpacity = 1;
+			float opacity = 1;
+			float strokeWidth = 1;
+			float miterLimit = 4;
+			int lineCap = NVG_BUTT;
+			int lineJoin = NVG_MITER;
+			bool evenOdd = false;
+			bool visible = true;
+			float transform[6] = { 1, 0, 0, 1, 0, 0 };
+		};
+
+		// A filled and/or stroked element
+		struct Shape
+		{
+			std::vector<Subpath> subpaths;
+			float transform[6];
+			NVGcolor fill;
+			NVGcolor stroke;
+			bool hasFill;
+			bool hasStroke;
+			float strokeWidth;
+			float miterLimit;
+			int lineCap;
+			int lineJoin;
+		};
+
+		float viewBox[4] = { 0, 0, 0, 0 };		// [x, y, width, height]
+		std::vector<Shape> shapes;
+		std::string filePath;
+
+		// Element parsing
+		void parseElement(const pugi::xml_node& aNode, Style aStyle);
+		void parseStyle(const pugi::xml_node& aNode, Style& aStyle);
+		void applyStyleProperty(const std::string& aName, const std::string& aValue, Style& aStyle);
+		void addShape(std::vector<Subpath>&& aSubpaths, const Style& aStyle);
+
+		// Geometry parsing
+		static void parsePathData(const char* aData, std::vector<Subpath>& aSubpaths);
+		static void parsePoints(const char* aData, bool aClose, std::vector<Subpath>& aSubpaths);
+		static void parseTransform(const char* aData, float* aTransform);
+		static bool parseColour(const std::string& aValue, NVGcolor& aColour, bool& aNone);
+
+		// Path building, tracking the bounds of each subpath
+		static void moveTo(std::vector<Subpath>& aSubpaths, float aX, float aY);
+		static void lineTo(std::vector<Subpath>& aSubpaths, float aX, float aY);
+		static void bezierTo(std::vector<Subpath>& aSubpaths, float aC1x, float aC1y, float aC2x, float aC2y, float aX, float aY);
+		static void arcTo(std::vector<Subpath>& aSubpaths, float aX1, float aY1, float aRx, float aRy, float aAngle, bool aLargeArc, bool aSweep, float aX2, float aY2);
+		static void closePath(std::vector<Subpath>& aSubpaths);
+
+		// Add an ellipse or rounded rect as bezier segments
+		static void addEllipse(std::vector<Subpath>& aSubpaths, float aCx, float aCy, float aRx, float aRy);
+		static void addRect(std::vector<Subpath>& aSubpaths, float aX, float aY, float aWidth, float aHeight, float aRx, float aRy);
+
+		// Mark subpaths that NanoVG should cut out, following the fill rule
+		static void findHoles(std::vector<Subpath>& aSubpaths, bool aEvenOdd);
+
+	public:
+
+		// Parse a file, replacing any document already loaded. Returns false, keeping the
+		// current document, if it is missing or has no svg root.
+		bool loadFromFile(const char* aFilePath);
+		const std::string& getFilePath() const;
+
+		// Size of the document in user units, from its viewBox or width and height
+		float getWidth() const;
+		float getHeight() const;
+		bool isEmpty() const;
+
+		// Draw the document scaled to fill a rect
+		void draw(NVGcontext* aContext, float aX, float aY, float aWidth, float aHeight) const;
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_SVG_DOCUMENT_H
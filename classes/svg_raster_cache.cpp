@@ -0,0 +1,203 @@
+#ifndef LEMUR_SVG_RASTER_CACHE_CPP
+#define LEMUR_SVG_RASTER_CACHE_CPP
+
+/**************************************************************************************
+* Lemur:        SVG Raster Cache Class                                                *
+*-------------------------------------------------------------------------------------*
+* Filename:     SvgRasterCache.cpp                                                    *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Rasterizes SVG documents at the exact pixel size they are drawn at, keeping the   *
+*   textures in a least recently used cache so each size is only rasterized once.     *
+***************************************************************************************/
+
+
+
+#include <algorithm>
+#include <cmath>
+#include "svg_raster_cache.h"
+
+
+namespace Lemur
+{
+	SvgRasterCache::~SvgRasterCache()
+	{
+		// Textures belong to the window's context, which frees them when it is deleted
+		if (rasterContext != nullptr)
+			nvgDeleteInternal(rasterContext);
+	}
+
+	bool SvgRasterCache::rasterize(const SvgDocument* aDocument, int aPixelWidth, int aPixelHeight)
+	{
+		int sampleWidth = aPixelWidth * SUPERSAMPLE;
+		int sampleHeight = aPixelHeight * SUPERSAMPLE;
+
+		// One band, rasters are small and the window may be rendering on the other threads
+		if (renderer == nullptr)
+		{
+			renderer = std::make_unique<SoftwareRenderer>(sampleWidth, sampleHeight, 1);
+			rasterContext = renderer->createContext();
+		}
+		else
+		{
+			renderer->resize(sampleWidth, sampleHeight);
+		}
+
+		if (rasterContext == nullptr)
+			return false;
+
+		nvgBeginFrame(rasterContext, static_cast<float>(sampleWidth), static_cast<float>(sampleHeight), 1.0f);
+		aDocument->draw(rasterContext, 0, 0, static_cast<float>(sampleWidth), static_cast<float>(sampleHeight));
+		nvgEndFrame(rasterContext);
+
+		// Box filter the samples, staying premultiplied
+		const unsigned char* samples = renderer->getPixels();
+		const int sampleCount = SUPERSAMPLE * SUPERSAMPLE;
+		pixels.resize(static_cast<size_t>(aPixelWidth) * aPixelHeight * 4);
+
+		for (int y = 0; y < aPixelHeight; y++)
+		{
+			for (int x = 0; x < aPixelWidth; x++)
+			{
+				int sum[4] = { 0, 0, 0, 0 };
+
+				for (int sy = 0; sy < SUPERSAMPLE; sy++)
+				{
+					const unsigned char* sample = samples + (static_cast<size_t>(y * SUPERSAMPLE + sy) * sampleWidth + x * SUPERSAMPLE) * 4;
+					for (int sx = 0; sx < SUPERSAMPLE * 4; sx += 4)
+					{
+						sum[0] += sample[sx];
+						sum[1] += sample[sx + 1];
+						sum[2] += sample[sx + 2];
+						sum[3] += sample[sx + 3];
+					}
+				}
+
+				unsigned char* pixel = &pixels[(static_cast<size_t>(y) * aPixelWidth + x) * 4];
+				for (int i = 0; i < 4; i++)
+					pixel[i] = static_cast<unsigned char>((sum[i] + sampleCount / 2) / sampleCount);
+			}
+		}
+
+		return true;
+	}
+
+	void SvgRasterCache::evict(NVGcontext* aContext)
+	{
+		// Rasters fetched this frame may still be drawn, so the cache can run over budget
+		auto it = entries.end();
+		while (memoryUsage > budget && it != entries.begin())
+		{
+			it--;
+			if (it->lastUsed == frame)
+				break;
+
+			nvgDeleteImage(aContext, it->image->getId());
+			memoryUsage -= it->bytes;
+			index.erase(it->key);
+			it = entries.erase(it);
+		}
+	}
+
+	Image* SvgRasterCache::get(NVGcontext* aContext, const SvgDocument* aDocument, int aWidth, int aHeight, float aDevicePixelRatio)
+	{
+		if (aContext == nullptr || aDocument == nullptr || aDocument->isEmpty() || aWidth <= 0 || aHeight <= 0)
+			return nullptr;
+
+		int maxSize = MAX_PIXEL_SIZE;
+		int pixelWidth = std::clamp(static_cast<int>(std::lround(aWidth * aDevicePixelRatio)), 1, maxSize);
+		int pixelHeight = std::clamp(static_cast<int>(std::lround(aHeight * aDevicePixelRatio)), 1, maxSize);
+		Key key{ aDocument, pixelWidth, pixelHeight };
+
+		auto found = index.find(key);
+		if (found != index.end())
+		{
+			// Move to the front
+			entries.splice(entries.begin(), entries, found->second);
+			found->second->lastUsed = frame;
+			return found->second->image.get();
+		}
+
+		if (!rasterize(aDocument, pixelWidth, pixelHeight))
+			return nullptr;
+
+		int id = nvgCreateImageRGBA(aContext, pixelWidth, pixelHeight, NVG_IMAGE_PREMULTIPLIED, pixels.data());
+		if (id == 0)
+			return nullptr;
+
+		Entry entry;
+		entry.key = key;
+		entry.image = std::make_unique<Image>(aWidth, aHeight, 1.0f, nullptr, id);
+		entry.bytes = pixels.size();
+		entry.lastUsed = frame;
+
+		entries.push_front(std::move(entry));
+		index[key] = entries.begin();
+		memoryUsage += pixels.size();
+
+		evict(aContext);
+
+		return entries.front().image.get();
+	}
+
+	void SvgRasterCache::nextFrame()
+	{
+		frame++;
+	}
+
+	void SvgRasterCache::remove(NVGcontext* aContext, const SvgDocument* aDocument)
+	{
+		for (auto it = entries.begin(); it != entries.end();)
+		{
+			if (it->key.document != aDocument)
+			{
+				it++;
+				continue;
+			}
+
+			if (aContext != nullptr)
+				nvgDeleteImage(aContext, it->image->getId());
+
+			memoryUsage -= it->bytes;
+			index.erase(it->key);
+			it = entries.erase(it);
+		}
+	}
+
+	void SvgRasterCache::clear(NVGcontext* aContext)
+	{
+		if (aContext != nullptr)
+			for (Entry& entry : entries)
+				nvgDeleteImage(aContext, entry.image->getId());
+
+		entries.clear();
+		index.clear();
+		memoryUsage = 0;
+	}
+
+	void SvgRasterCache::setBudget(size_t aBytes)
+	{
+		budget = aBytes;
+	}
+
+	size_t SvgRasterCache::getBudget() const
+	{
+		return budget;
+	}
+
+	size_t SvgRasterCache::getMemoryUsage() const
+	{
+		return memoryUsage;
+	}
+
+	int SvgRasterCache::getCount() const
+	{
+		return static_cast<int>(entries.size());
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_SVG_RASTER_CACHE_CPP
@@ -0,0 +1,124 @@
+#ifndef LEMUR_SVG_RASTER_CACHE_H
+#define LEMUR_SVG_RASTER_CACHE_H
+
+/**************************************************************************************
+* Lemur:        SVG Raster Cache Class                                                *
+*-------------------------------------------------------------------------------------*
+* Filename:     SvgRasterCache.h                                                      *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Rasterizes SVG documents at the exact pixel size they are drawn at, keeping the   *
+*   textures in a least recently used cache so each size is only rasterized once.     *
+*                                                                                     *
+* Notes:                                                                              *
+*   Documents are drawn with the software renderer at SUPERSAMPLE times the size      *
+*   and box filtered down, as it has no anti-aliasing. Rasters own their texture,     *
+*   rather than sharing an atlas page, so they can be freed when evicted.             *
+***************************************************************************************/
+
+
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "nanovg.h"
+#include "image.h"
+#include "svg_document.h"
+#include "software_renderer.h"
+
+
+namespace Lemur
+{
+	class SvgRasterCache
+	{
+	public:
+
+		// Cache limits
+		static const int SUPERSAMPLE = 4;							// Samples per pixel along each axis
+		static const int MAX_PIXEL_SIZE = 1024;						// Largest raster along either axis
+		static const size_t DEFAULT_BUDGET = 16 * 1024 * 1024;		// Texture bytes kept before evicting
+
+	private:
+
+		// A document at one pixel size
+		struct Key
+		{
+			const SvgDocument* document;
+			int pixelWidth;
+			int pixelHeight;
+
+			bool operator==(const Key& aOther) const
+			{
+				return document == aOther.document && pixelWidth == aOther.pixelWidth && pixelHeight == aOther.pixelHeight;
+			}
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const Key& aKey) const
+			{
+				size_t hash = std::hash<const void*>()(aKey.document);
+				hash ^= std::hash<int>()(aKey.pixelWidth) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				hash ^= std::hash<int>()(aKey.pixelHeight) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				return hash;
+			}
+		};
+
+		struct Entry
+		{
+			Key key;
+			std::unique_ptr<Image> image;		// Sized in points, with the raster as its texture
+			size_t bytes;						// Texture size
+			unsigned long lastUsed;				// Frame the raster was last fetched in
+		};
+
+		// Most recently used first
+		std::list<Entry> entries;
+		std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+
+		size_t budget = DEFAULT_BUDGET;
+		size_t memoryUsage = 0;
+		unsigned long frame = 0;
+
+		// Offscreen renderer, created with the first raster
+		std::unique_ptr<SoftwareRenderer> renderer;
+		NVGcontext* rasterContext = nullptr;
+		std::vector<unsigned char> pixels;
+
+		// Draw a document into premultiplied RGBA pixels
+		bool rasterize(const SvgDocument* aDocument, int aPixelWidth, int aPixelHeight);
+
+		// Free least recently used rasters not fetched this frame until within budget
+		void evict(NVGcontext* aContext);
+
+	public:
+
+		SvgRasterCache() = default;
+		SvgRasterCache(const SvgRasterCache&) = delete;
+		SvgRasterCache& operator=(const SvgRasterCache&) = delete;
+		~SvgRasterCache();
+
+		// Get a document rasterized for a rect in points on a display with the given pixel ratio.
+		// The image is valid until the next frame starts, so fetch it each time it is drawn.
+		Image* get(NVGcontext* aContext, const SvgDocument* aDocument, int aWidth, int aHeight, float aDevicePixelRatio);
+
+		// Start a new frame, letting rasters not fetched since be evicted
+		void nextFrame();
+
+		// Free every raster of a document, or all of them
+		void remove(NVGcontext* aContext, const SvgDocument* aDocument);
+		void clear(NVGcontext* aContext);
+
+		// Memory budget in texture bytes
+		void setBudget(size_t aBytes);
+		size_t getBudget() const;
+		size_t getMemoryUsage() const;
+		int getCount() const;
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_SVG_RASTER_CACHE_H
@@ -41,6 +41,16 @@ namespace Lemur
 
 	}
 
+	void* Tab::operator new(size_t aSize)
+	{
+		return ComponentArena::allocate<Tab>(aSize);
+	}
+
+	void Tab::operator delete(void* aPointer, size_t aSize)
+	{
+		ComponentArena::deallocate<Tab>(aPointer, aSize);
+	}
+
 	void Tab::setText(std::string aText)
 	{
 		text = aText;
@@ -50,24 +60,15 @@ namespace Lemur
 
 	void Tab::recalculateSize(NVGcontext* aContext)
 	{
-		// Use nanovg to calculate text width
-		float bounds[4];
-
-		// Static cast properties
-		float buttonX = button->getWidth();
-		float buttonY = button->getHeight();
-
-		nvgSave(aContext);
-
-		nvgReset(aContext);
-		nvgTextBounds(aContext, buttonX, buttonY, button->text.c_str(), nullptr, bounds);
+		// Measure with NanoVG's default font and size, as the header has always been sized
+		std::shared_ptr<const TextLayout> layout = TextCache::get(aContext, 0, MEASURE_FONT_SIZE, 0, button->text.c_str());
+		if (layout == nullptr)
+			return;
 
 		int padding = ((TabView*)parent)->PADDING;
-		int newSize = (bounds[2] - bounds[0]) + padding; // Where bounds[2]-[0] is the width of the text
+		int newSize = layout->getWidth() + padding; // Width of the text's ink bounds
 		button->setWidth(newSize);
 
-		nvgRestore(aContext);
-
 		// Reset flag
 		resizeFlag = false;
 	}
@@ -93,7 +94,7 @@ namespace Lemur
 
 		// Draw tab panel is tab is active (enabled)
 		if (enabled)
-			panel->onFrame(aContext);
+			panel->invokeOnFrame(aContext);
 	}
 
 
@@ -115,6 +116,9 @@ namespace Lemur
 		panel->setLocation(0, ((TabView*)parent)->HEADER_HEIGHT);
 		panel->setSize(parent->getWidth(), parent->getHeight() - ((TabView*)parent)->HEADER_HEIGHT);
 		panel->backColour = Colour::BACKGROUND2;
+
+		// Tab has moved to a new parent, refresh cached screen bounds
+		updateScreenRect();
 	}
 
 
@@ -149,11 +153,21 @@ namespace Lemur
 		}
 	}
 
+	void* TabView::operator new(size_t aSize)
+	{
+		return ComponentArena::allocate<TabView>(aSize);
+	}
+
+	void TabView::operator delete(void* aPointer, size_t aSize)
+	{
+		ComponentArena::deallocate<TabView>(aPointer, aSize);
+	}
+
 
 	void TabView::onFrame(NVGcontext* aContext)
 	{			
 		// Update states
-		for (std::shared_ptr<Component> component : childComponents)
+		for (std::shared_ptr<Component>& component : childComponents)
 		{
 			if (Tab* tab = static_cast<Tab*>(component.get()))
 			{
@@ -251,23 +265,29 @@ namespace Lemur
 		return -1;
 	}
 
-	void TabView::addTab(std::string aText)
+	Tab* TabView::addTab(std::string aText)
 	{
 		// Add tab and associated tab button
 		Tab* tab = new Tab(aText);
 
-		// Set tab's parent
+		// Insert into vector
+		addChildControl(tab);
+
+		// Set tab's parent, inheriting header properties
 		tab->setParent(this);
 
-		// Insert into vector
-		childComponents.push_back(std::shared_ptr<Component>(tab));
+		invalidate();
+
+		return tab;
 	}
 
 		
 	void TabView::removeTab(int aIndex)
 	{
 		// Remove from vector
-		childComponents.erase(childComponents.begin() + aIndex);
+		detachChild(aIndex);
+
+		invalidate();
 	}
 
 	void TabView::setActiveTab(int aIndex)
@@ -296,16 +316,19 @@ namespace Lemur
 			if (i == aIndex)
 			{
 				tab->enabled = true;
-				tab->button->backColour = Colour::BACKGROUND2;
-				tab->button->foreColour = Colour::PRIMARY;
+				tab->button->setBackColour(Colour::BACKGROUND2);
+				tab->button->setForeColour(Colour::PRIMARY);
 			}
 			else
 			{
 				tab->enabled = false;
-				tab->button->backColour = Colour::BACKGROUND1;
-				tab->button->foreColour = Colour::WHITE;
+				tab->button->setBackColour(Colour::BACKGROUND1);
+				tab->button->setForeColour(Colour::WHITE);
 			}
 		}
+
+		// Tab panels have been swapped, redraw the whole view
+		invalidate();
 	}
 		
 } // namespace OpenDraft
@@ -19,6 +19,7 @@
 #include "core.h"
 #include "component.h"
 #include "draw.h"
+#include "text_cache.h"
 #include "button.h"
 #include "Panel.h"
 #include "Input.h"
@@ -30,6 +31,7 @@ namespace Lemur
 	{
 	protected:
 		bool resizeFlag = true; // Flag to recalculate size on text change
+		const float MEASURE_FONT_SIZE = 16; // NanoVG's default font size, used to size the header
 
 	public:
 		Button* button;
@@ -38,6 +40,10 @@ namespace Lemur
 		Tab(std::string aText);
 		~Tab();
 
+		// Allocated from this class's own arena pool
+		static void* operator new(size_t aSize);
+		static void operator delete(void* aPointer, size_t aSize);
+
 		void setText(std::string aText);
 		void recalculateSize(NVGcontext* aContext);
 		void addPanelChildControl(Component* aControl);
@@ -66,6 +72,10 @@ namespace Lemur
 		TabView(int aX = 0, int aY = 0, int aWidth = 400, int aHeight = 600);
 		~TabView();
 
+		// Allocated from this class's own arena pool
+		static void* operator new(size_t aSize);
+		static void operator delete(void* aPointer, size_t aSize);
+
 		void onFrame(NVGcontext* aContext) override;
 		void actionEvents(InputMap* aInput) override;
 
@@ -73,7 +83,7 @@ namespace Lemur
 		Tab* getActiveTab();
 		Tab* getTab(int aIndex);
 		int getIndexOfTab(Tab* aTab);
-		void addTab(std::string aText);
+		Tab* addTab(std::string aText);
 		void removeTab(int aIndex);
 		void setActiveTab(int aIndex);
 
@@ -0,0 +1,205 @@
+#ifndef LEMUR_TEXT_CACHE_CPP
+#define LEMUR_TEXT_CACHE_CPP
+
+/**************************************************************************************
+* Lemur:        Text Layout Cache Class                                               *
+*-------------------------------------------------------------------------------------*
+* Filename:     TextCache.cpp                                                         *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Shared cache of measured text runs. Each layout holds glyph positions, the        *
+*   advance and bounds of a string, so components can measure and align text         *
+*   without re-shaping it every frame.                                                *
+***************************************************************************************/
+
+
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include "text_cache.h"
+
+
+namespace Lemur
+{
+	//
+	// Text Layout
+	//
+
+	float TextLayout::getCaretX(int aByteIndex) const
+	{
+		if (aByteIndex <= 0)
+			return 0;
+
+		// First glyph starting at or after the index
+		auto glyph = std::lower_bound(glyphs.begin(), glyphs.end(), aByteIndex,
+			[](const Glyph& aGlyph, int aIndex) { return aGlyph.byteOffset < aIndex; });
+
+		if (glyph == glyphs.end())
+			return advance;
+
+		return glyph->x;
+	}
+
+	float TextLayout::getWidth() const
+	{
+		return bounds[2] - bounds[0];
+	}
+
+	size_t TextLayout::getMemoryUsage() const
+	{
+		return sizeof(TextLayout) + text.capacity() + glyphs.capacity() * sizeof(Glyph);
+	}
+
+
+	//
+	// Text Cache
+	//
+
+	std::list<TextCache::Entry> TextCache::entries;
+	std::unordered_map<TextCache::Key, std::list<TextCache::Entry>::iterator, TextCache::KeyHash> TextCache::index;
+	size_t TextCache::memoryUsage = 0;
+	size_t TextCache::budget = TextCache::DEFAULT_BUDGET;
+
+	size_t TextCache::KeyHash::operator()(const Key& aKey) const
+	{
+		size_t hash = aKey.hash;
+		hash ^= std::hash<void*>()(aKey.context) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<int>()(aKey.font) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<float>()(aKey.size) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<float>()(aKey.letterSpacing) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+
+	size_t TextCache::hashText(const char* aText)
+	{
+		// FNV-1a
+		size_t hash = 14695981039346656037ull;
+		for (const unsigned char* c = reinterpret_cast<const unsigned char*>(aText); *c != '\0'; c++)
+		{
+			hash ^= *c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	std::shared_ptr<const TextLayout> TextCache::measure(NVGcontext* aContext, int aFont, float aSize, float aLetterSpacing, const char* aText)
+	{
+		std::shared_ptr<TextLayout> layout = std::make_shared<TextLayout>();
+		layout->text = aText;
+		layout->font = aFont;
+		layout->size = aSize;
+		layout->letterSpacing = aLetterSpacing;
+
+		// Measure untransformed, so the layout is valid wherever it is drawn
+		nvgSave(aContext);
+		nvgReset(aContext);
+		nvgFontFaceId(aContext, aFont);
+		nvgFontSize(aContext, aSize);
+		nvgTextLetterSpacing(aContext, aLetterSpacing);
+		nvgTextAlign(aContext, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
+
+		const char* start = layout->text.c_str();
+		const char* end = start + layout->text.size();
+
+		layout->advance = nvgTextBounds(aContext, 0, 0, start, end, layout->bounds);
+
+		// There is at most one glyph per byte
+		std::vector<NVGglyphPosition> positions(layout->text.size());
+		int count = positions.empty() ? 0 : nvgTextGlyphPositions(aContext, 0, 0, start, end, positions.data(), static_cast<int>(positions.size()));
+
+		layout->glyphs.reserve(count);
+		for (int i = 0; i < count; i++)
+		{
+			TextLayout::Glyph glyph;
+			glyph.byteOffset = static_cast<int>(positions[i].str - start);
+			glyph.x = positions[i].x;
+			glyph.minX = positions[i].minx;
+			glyph.maxX = positions[i].maxx;
+			layout->glyphs.push_back(glyph);
+		}
+
+		nvgRestore(aContext);
+
+		return layout;
+	}
+
+	void TextCache::trim()
+	{
+		// Always keep the most recent layout, even if it alone exceeds the budget
+		while (memoryUsage > budget && entries.size() > 1)
+		{
+			Entry& oldest = entries.back();
+			memoryUsage -= oldest.bytes;
+			index.erase(oldest.key);
+			entries.pop_back();
+		}
+	}
+
+	std::shared_ptr<const TextLayout> TextCache::get(NVGcontext* aContext, int aFont, float aSize, float aLetterSpacing, const char* aText)
+	{
+		if (aContext == nullptr || aFont < 0 || aText == nullptr)
+			return nullptr;
+
+		Key key = { aContext, aFont, aSize, aLetterSpacing, hashText(aText) };
+
+		auto found = index.find(key);
+		if (found != index.end())
+		{
+			std::list<Entry>::iterator entry = found->second;
+
+			// Hit, move to the front of the LRU list
+			if (entry->layout->text == aText)
+			{
+				entries.splice(entries.begin(), entries, entry);
+				return entry->layout;
+			}
+
+			// Hash collision, replace the older layout
+			memoryUsage -= entry->bytes;
+			entries.erase(entry);
+			index.erase(found);
+		}
+
+		// Miss, measure and insert at the front
+		std::shared_ptr<const TextLayout> layout = measure(aContext, aFont, aSize, aLetterSpacing, aText);
+
+		size_t bytes = layout->getMemoryUsage();
+		entries.push_front(Entry{ key, layout, bytes });
+		index[key] = entries.begin();
+		memoryUsage += bytes;
+
+		trim();
+
+		return layout;
+	}
+
+	void TextCache::setBudget(size_t aBytes)
+	{
+		budget = aBytes;
+		trim();
+	}
+
+	size_t TextCache::getBudget()
+	{
+		return budget;
+	}
+
+	size_t TextCache::getMemoryUsage()
+	{
+		return memoryUsage;
+	}
+
+	void TextCache::clear()
+	{
+		entries.clear();
+		index.clear();
+		memoryUsage = 0;
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_TEXT_CACHE_CPP
@@ -0,0 +1,128 @@
+#ifndef LEMUR_TEXT_CACHE_H
+#define LEMUR_TEXT_CACHE_H
+
+/**************************************************************************************
+* Lemur:        Text Layout Cache Class                                               *
+*-------------------------------------------------------------------------------------*
+* Filename:     TextCache.h                                                           *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Shared cache of measured text runs. Each layout holds glyph positions, the        *
+*   advance and bounds of a string, so components can measure and align text         *
+*   without re-shaping it every frame.                                                *
+*                                                                                     *
+* Notes:                                                                              *
+*   Layouts are keyed by context, font, size, letter spacing and string, so a         *
+*   change to any of these misses the cache. Least recently used layouts are evicted  *
+*   once the memory budget is exceeded.                                               *
+***************************************************************************************/
+
+
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "nanovg.h"
+
+
+namespace Lemur
+{
+	// Measured layout of a single line of text, relative to a left and vertically middle aligned origin
+	struct TextLayout
+	{
+		// Position of a glyph
+		struct Glyph
+		{
+			int byteOffset;		// Offset of the glyph's first byte in the string
+			float x;			// Pen position of the glyph
+			float minX;			// Left edge of the glyph
+			float maxX;			// Right edge of the glyph
+		};
+
+		std::string text;					// Measured string
+		int font = -1;						// NanoVG font id
+		float size = 0;						// Font size
+		float letterSpacing = 0;			// Letter spacing
+		float advance = 0;					// Pen advance of the whole string
+		float bounds[4] = { 0,0,0,0 };		// Ink bounds [xmin, ymin, xmax, ymax]
+		std::vector<Glyph> glyphs;			// Glyphs in string order
+
+		// Get the pen position before a byte index, indices past the end give the full advance
+		float getCaretX(int aByteIndex) const;
+
+		// Get the width of the ink bounds
+		float getWidth() const;
+
+		// Approximate memory held by the layout
+		size_t getMemoryUsage() const;
+	};
+
+
+	class TextCache
+	{
+	private:
+
+		// Cache limits
+		static const size_t DEFAULT_BUDGET = 1024 * 1024;	// Bytes of layouts kept
+
+		// Identifies a layout, the string is compared on lookup to resolve hash collisions
+		struct Key
+		{
+			NVGcontext* context;
+			int font;
+			float size;
+			float letterSpacing;
+			size_t hash;
+
+			bool operator==(const Key& aOther) const = default;
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const Key& aKey) const;
+		};
+
+		// Cached layout, most recently used first
+		struct Entry
+		{
+			Key key;
+			std::shared_ptr<const TextLayout> layout;
+			size_t bytes;
+		};
+
+		static std::list<Entry> entries;
+		static std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+		static size_t memoryUsage;
+		static size_t budget;
+
+		// Hash a string without copying it
+		static size_t hashText(const char* aText);
+
+		// Measure a string with NanoVG
+		static std::shared_ptr<const TextLayout> measure(NVGcontext* aContext, int aFont, float aSize, float aLetterSpacing, const char* aText);
+
+		// Evict least recently used layouts until the cache fits its budget
+		static void trim();
+
+	public:
+
+		// Get the layout of a string, measuring it on a miss. Returns nullptr if the font is not loaded.
+		static std::shared_ptr<const TextLayout> get(NVGcontext* aContext, int aFont, float aSize, float aLetterSpacing, const char* aText);
+
+		// Memory budget in bytes
+		static void setBudget(size_t aBytes);
+		static size_t getBudget();
+		static size_t getMemoryUsage();
+
+		// Drop every layout, for instance when a font is replaced
+		static void clear();
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_TEXT_CACHE_H
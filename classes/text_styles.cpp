@@ -0,0 +1,85 @@
+#ifndef LEMUR_TEXT_STYLES_CPP
+#define LEMUR_TEXT_STYLES_CPP
+
+/**************************************************************************************
+* Lemur:        Text Style Registry Class                                             *
+*-------------------------------------------------------------------------------------*
+* Filename:     TextStyles.cpp                                                        *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Fonts by name, and the text styles components draw with. Names are resolved to   *
+*   Font objects once, when a style or font is set, so drawing text uses the font's  *
+*   NanoVG id without comparing any strings.                                          *
+***************************************************************************************/
+
+
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "text_styles.h"
+
+
+namespace Lemur
+{
+	Draw::TextStyle* TextStyles::getStyles()
+	{
+		static Font* font = getFont(DEFAULT_FONT);
+
+		static Draw::TextStyle styles[static_cast<int>(Id::Count)] =
+		{
+			{ 12, font, Colour::BLACK, Align(Align::CENTRE | Align::MIDDLE) },			// Button
+			{ 14, font, Colour::BLACK, Align(Align::LEFT | Align::MIDDLE) },			// Label
+			{ 12, font, Colour::BLACK, Align(Align::LEFT | Align::MIDDLE) },			// Textbox
+			{ 12, font, Colour(255, 255, 255, 255), Align(Align::LEFT | Align::MIDDLE) }	// ProfilerOverlay
+		};
+
+		return styles;
+	}
+
+	const Draw::TextStyle& TextStyles::get(Id aId)
+	{
+		return getStyles()[static_cast<int>(aId)];
+	}
+
+	void TextStyles::set(Id aId, const Draw::TextStyle& aStyle)
+	{
+		getStyles()[static_cast<int>(aId)] = aStyle;
+	}
+
+	Font* TextStyles::getFont(const char* aName)
+	{
+		if (aName == nullptr)
+			return nullptr;
+
+		// Fonts live as long as the application, so styles can hold them by pointer
+		static std::unordered_map<std::string, std::unique_ptr<Font>> fonts;
+
+		auto found = fonts.find(aName);
+		if (found != fonts.end())
+			return found->second.get();
+
+		auto inserted = fonts.emplace(aName, nullptr).first;
+		inserted->second.reset(new Font(inserted->first.c_str(), nullptr, -1));
+		return inserted->second.get();
+	}
+
+	std::vector<float> TextStyles::getSizes(const Font* aFont)
+	{
+		std::vector<float> sizes;
+		const Draw::TextStyle* styles = getStyles();
+
+		for (int i = 0; i < static_cast<int>(Id::Count); i++)
+			if (styles[i].font == aFont && std::find(sizes.begin(), sizes.end(), static_cast<float>(styles[i].size)) == sizes.end())
+				sizes.push_back(static_cast<float>(styles[i].size));
+
+		return sizes;
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_TEXT_STYLES_CPP
@@ -0,0 +1,72 @@
+#ifndef LEMUR_TEXT_STYLES_H
+#define LEMUR_TEXT_STYLES_H
+
+/**************************************************************************************
+* Lemur:        Text Style Registry Class                                             *
+*-------------------------------------------------------------------------------------*
+* Filename:     TextStyles.h                                                          *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   Fonts by name, and the text styles components draw with. Names are resolved to   *
+*   Font objects once, when a style or font is set, so drawing text uses the font's  *
+*   NanoVG id without comparing any strings.                                          *
+*                                                                                     *
+* Notes:                                                                              *
+*   A font can be referenced before it is imported. Its Font is created unloaded and  *
+*   the resource manager loads into the same object, so styles holding it pick up     *
+*   the font, and any later reload, without being resolved again.                     *
+***************************************************************************************/
+
+
+
+#include <cstdint>
+#include <vector>
+#include "draw.h"
+#include "font.h"
+
+
+namespace Lemur
+{
+	class TextStyles
+	{
+	public:
+
+		// Styles of the built-in components, indexed directly
+		enum class Id : uint8_t
+		{
+			Button = 0,
+			Label,
+			Textbox,
+			ProfilerOverlay,
+			Count
+		};
+
+		// Font used by the built-in styles
+		static constexpr const char* DEFAULT_FONT = "sans";
+
+	private:
+
+		// Built-in styles, set to their defaults on first use
+		static Draw::TextStyle* getStyles();
+
+	public:
+
+		// Get a style to draw with, components copy it to change the size or colour
+		static const Draw::TextStyle& get(Id aId);
+
+		// Change a built-in style, affecting components drawn after the change
+		static void set(Id aId, const Draw::TextStyle& aStyle);
+
+		// Get the font with a name, creating it unloaded if it hasn't been imported yet
+		static Font* getFont(const char* aName);
+
+		// Sizes the built-in styles draw a font at, for warming up its glyphs
+		static std::vector<float> getSizes(const Font* aFont);
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_TEXT_STYLES_H
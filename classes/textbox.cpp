@@ -15,7 +15,11 @@
 
 
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include "textbox.h"
+#include "text_styles.h"
 
 
 namespace Lemur
@@ -25,15 +29,13 @@ namespace Lemur
 	{
 		text = "";
 		cursorIndex = 0;
-		cursorBlinkTimer = 0;
+		cursorVisible = false;
+		nextCursorBlink = 0;
 		foreColour = Colour::BLACK;
 		backColour = Colour::WHITE;
 
 		// Set default text style
-		textStyle.font = "sans";
-		textStyle.size = 12.f;
-		textStyle.align = Align(Align::LEFT | Align::MIDDLE);
-		textStyle.colour = Colour::BLACK;
+		textStyle = TextStyles::get(TextStyles::Id::Textbox);
 	}
 
 	Textbox::Textbox(int aX, int aY, int aWidth, int aHeight, std::string aText)
@@ -46,13 +48,11 @@ namespace Lemur
 		backColour = Colour::WHITE;
 		text = aText;
 		cursorIndex = 0;
-		cursorBlinkTimer = 0;
+		cursorVisible = false;
+		nextCursorBlink = 0;
 
 		// Set default text style
-		textStyle.font = "sans";
-		textStyle.size = 12.f;
-		textStyle.align = Align(Align::LEFT | Align::MIDDLE);
-		textStyle.colour = Colour::BLACK;
+		textStyle = TextStyles::get(TextStyles::Id::Textbox);
 	}
 
 	Textbox::Textbox(Vector2 aLocation, std::string aText)
@@ -63,13 +63,21 @@ namespace Lemur
 		backColour = Colour::WHITE;
 		text = aText;
 		cursorIndex = 0;
-		cursorBlinkTimer = 0;
+		cursorVisible = false;
+		nextCursorBlink = 0;
 
 		// Set default text style
-		textStyle.font = "sans";
-		textStyle.size = 12.f;
-		textStyle.align = Align(Align::LEFT | Align::MIDDLE);
-		textStyle.colour = Colour::BLACK;
+		textStyle = TextStyles::get(TextStyles::Id::Textbox);
+	}
+
+	void* Textbox::operator new(size_t aSize)
+	{
+		return ComponentArena::allocate<Textbox>(aSize);
+	}
+
+	void Textbox::operator delete(void* aPointer, size_t aSize)
+	{
+		ComponentArena::deallocate<Textbox>(aPointer, aSize);
 	}
 
 
@@ -95,6 +103,7 @@ namespace Lemur
 	void Textbox::setFontSize(float aSize)
 	{
 		textStyle.size = aSize;
+		invalidateCaretPositions();
 	}
 	
 	// Text Style
@@ -104,16 +113,19 @@ namespace Lemur
 		textStyle.size = aStyle->size;
 		textStyle.align = aStyle->align;
 		textStyle.colour = aStyle->colour;
+		invalidateCaretPositions();
 	}
 
 	// Font
 	const char* Textbox::getFont()
 	{
-		return textStyle.font;
+		return textStyle.font != nullptr ? textStyle.font->getName() : nullptr;
 	}
 	void Textbox::setFont(const char* aFont)
 	{
-		textStyle.font = aFont;
+		// Resolved once here, so drawing and measuring use the font id
+		textStyle.font = TextStyles::getFont(aFont);
+		invalidateCaretPositions();
 	}
 	
 	// Text Horizontal Alignment
@@ -138,47 +150,183 @@ namespace Lemur
 
 
 
-	int Textbox::calculateCursorPosition(NVGcontext* aContext, int aIndex, const Draw::TextStyle* aStyle)
+	// Text
+	void Textbox::setText(std::string aText)
+	{
+		Component::setText(aText);
+
+		if (cursorIndex > static_cast<int>(text.length()))
+			cursorIndex = static_cast<int>(text.length());
+
+		invalidateCaretPositions();
+	}
+
+
+
+	//
+	// Caret positions
+	//
+
+	void Textbox::recordEdit(int aIndex, int aInserted, int aRemoved)
+	{
+		pendingEdits.push_back({ aIndex, aInserted, aRemoved });
+	}
+
+	void Textbox::invalidateCaretPositions()
+	{
+		caretPositionsValid = false;
+		pendingEdits.clear();
+	}
+
+	void Textbox::updateCaretPositions(NVGcontext* aContext)
+	{
+		// A single edit is patched in place. Several edits in one frame are rare, and patching them
+		// one by one would need the text as it was between them, so rebuild instead.
+		if (caretPositionsValid && pendingEdits.size() == 1)
+		{
+			patchCaretPositions(aContext, pendingEdits.front());
+
+			// Check the patch against measuring the whole text
+			assert(!caretPositionsValid || checkCaretPositions(aContext));
+		}
+		else if (!caretPositionsValid || !pendingEdits.empty())
+			caretPositionsValid = false;
+
+		pendingEdits.clear();
+
+		// Text was changed without going through setText
+		if (caretPositions.size() != text.length() + 1)
+			caretPositionsValid = false;
+
+		if (!caretPositionsValid)
+			rebuildCaretPositions(aContext);
+	}
+
+	void Textbox::rebuildCaretPositions(NVGcontext* aContext)
+	{
+		measureRun(aContext, 0, static_cast<int>(text.length()), caretPositions);
+
+		// Measure again once the font has loaded
+		caretPositionsValid = textStyle.font != nullptr && textStyle.font->isLoaded();
+	}
+
+	void Textbox::patchCaretPositions(NVGcontext* aContext, const TextEdit& aEdit)
 	{
-		// Use nanovg to calculate text width
-		float bounds[4];
+		int length = static_cast<int>(text.length());
+		int oldLength = length - aEdit.inserted + aEdit.removed;
+
+		if (static_cast<int>(caretPositions.size()) != oldLength + 1 || aEdit.index > length)
+		{
+			caretPositionsValid = false;
+			return;
+		}
+
+		// Glyph positions exclude kerning with the previous glyph, which lands on the next one.
+		// Measuring from the character before the edit lets its unchanged position anchor the run,
+		// and measuring one character past the edit picks up the kerning into the unchanged tail.
+		// Both ends are whole characters, as a run starting or ending inside a UTF-8 sequence
+		// would measure a broken glyph.
+		int start = getPreviousCharacter(aEdit.index);
+		int end = getNextCharacter(aEdit.index + aEdit.inserted);
+
+		std::vector<float> run;
+		measureRun(aContext, start, end, run);
+
+		float base = (aEdit.index > 0) ? caretPositions[aEdit.index] - run[aEdit.index - start] : 0;
 
-		// Static cast properties
-		float textboxX = getWidth();
-		float textboxY = getHeight();
+		// Tail positions only move by the change in width of the edited run
+		int oldEnd = end - aEdit.inserted + aEdit.removed;
+		float shift = (base + run[end - start]) - caretPositions[oldEnd];
 
-		// Get characters of text property up to aIndex
-		std::string subText = text.substr(0, aIndex);
+		std::vector<float> positions(length + 1);
+		for (int i = 0; i < aEdit.index; i++)
+			positions[i] = caretPositions[i];
+
+		for (int i = aEdit.index; i <= end; i++)
+			positions[i] = base + run[i - start];
+
+		for (int i = end + 1; i <= length; i++)
+			positions[i] = caretPositions[i - aEdit.inserted + aEdit.removed] + shift;
+
+		caretPositions.swap(positions);
+	}
+
+	bool Textbox::checkCaretPositions(NVGcontext* aContext)
+	{
+		std::vector<float> positions;
+		measureRun(aContext, 0, static_cast<int>(text.length()), positions);
+
+		for (size_t i = 0; i < positions.size(); i++)
+		{
+			if (i >= caretPositions.size() || std::abs(positions[i] - caretPositions[i]) > 0.01f)
+				return false;
+		}
+
+		return positions.size() == caretPositions.size();
+	}
+
+	void Textbox::measureRun(NVGcontext* aContext, int aStart, int aEnd, std::vector<float>& aPositions)
+	{
+		const char* start = text.c_str() + aStart;
+		const char* end = text.c_str() + aEnd;
+		int bytes = aEnd - aStart;
 
 		nvgSave(aContext);
 		nvgReset(aContext);
-		nvgFontSize(aContext, aStyle->size);
-		nvgFontFace(aContext, aStyle->font);
-		nvgFontBlur(aContext, 0);
-		
-		if (aStyle->align.getAlign() & Align::CENTRE)
-			nvgTextAlign(aContext, NVG_ALIGN_CENTER | NVG_ALIGN_MIDDLE);
-		else if (aStyle->align.getAlign() & Align::RIGHT)
-			nvgTextAlign(aContext, NVG_ALIGN_RIGHT | NVG_ALIGN_MIDDLE);
-		else
-			nvgTextAlign(aContext, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
+		nvgFontSize(aContext, textStyle.size);
+		nvgFontFaceId(aContext, textStyle.font != nullptr ? textStyle.font->getId() : -1);
+		nvgTextAlign(aContext, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
 
-		nvgTextBounds(aContext, textboxX, textboxY, subText.c_str(), nullptr, bounds);
+		float advance = nvgTextBounds(aContext, 0, 0, start, end, nullptr);
 
-		int cursorX = bounds[2]-bounds[0];
+		// There is at most one glyph per byte
+		if (static_cast<int>(glyphBuffer.size()) < bytes)
+			glyphBuffer.resize(bytes);
 
-		// If text ends with a space, add a space to the end of the cursor
-		if (text.length() > 0)
-			if (text[aIndex - 1] == ' ')
-			{
-				int charWidth = static_cast<int>(aStyle->size/3);
-				cursorX += charWidth;
-			}
+		int count = (bytes > 0) ? nvgTextGlyphPositions(aContext, 0, 0, start, end, glyphBuffer.data(), bytes) : 0;
 
 		nvgRestore(aContext);
 
-		return cursorX;
+		// Bytes within a multi-byte character take the position of the next glyph
+		aPositions.assign(bytes + 1, -1.0f);
+		aPositions[bytes] = advance;
+
+		for (int i = 0; i < count; i++)
+			aPositions[glyphBuffer[i].str - start] = glyphBuffer[i].x;
+
+		for (int i = bytes - 1; i >= 0; i--)
+			if (aPositions[i] < 0)
+				aPositions[i] = aPositions[i + 1];
+	}
+
+	float Textbox::getCaretX(int aIndex) const
+	{
+		if (caretPositions.empty())
+			return 0;
+
+		if (aIndex < 0)
+			aIndex = 0;
+		if (aIndex >= static_cast<int>(caretPositions.size()))
+			aIndex = static_cast<int>(caretPositions.size()) - 1;
+
+		return caretPositions[aIndex];
+	}
+
+	int Textbox::getCaretIndex(float aX) const
+	{
+		if (caretPositions.empty())
+			return 0;
+
+		// First caret at or right of the point, then pick the nearer of it and the one before
+		auto next = std::lower_bound(caretPositions.begin(), caretPositions.end(), aX);
+		if (next == caretPositions.end())
+			return static_cast<int>(caretPositions.size()) - 1;
 
+		int index = static_cast<int>(next - caretPositions.begin());
+		if (index > 0 && aX - caretPositions[index - 1] < *next - aX)
+			index--;
+
+		return index;
 	}
 
 
@@ -188,10 +336,6 @@ namespace Lemur
 		if (aContext == nullptr)
 			return;
 
-		// If cursor timer is 0, reset it. Multiply by 2, half time is on and half off
-		if (cursorBlinkTimer < 1)
-			cursorBlinkTimer = CURSOR_BLINK_FRAME_COUNT*2;
-
 		// Static cast parameters to int
 		int w = static_cast<int>(size.x);
 		int h = static_cast<int>(size.y);
@@ -201,15 +345,15 @@ namespace Lemur
 		Draw::Rect(aContext, x, y, w, h, backColour);
 		Draw::Text(aContext, x - (w/2), y +2, w, h, &textStyle, text.c_str());
 
-		// if cursorBlinkTimer is less than half the time, draw the cursor
-		if (cursorBlinkTimer < CURSOR_BLINK_FRAME_COUNT)
+		// Bring caret positions up to date with this frame's edits
+		updateCaretPositions(aContext);
+
+		// Draw the cursor during the visible half of the blink
+		if (cursorVisible)
 		{
-			int cursorX = calculateCursorPosition(aContext, cursorIndex, &textStyle) + x;
+			int cursorX = static_cast<int>(getCaretX(cursorIndex)) + x;
 			Draw::Line(aContext, cursorX, y, cursorX, y + h, 2, Colour::RED);
 		}
-
-		// Decrement cursor timer
-		cursorBlinkTimer--;
 	}
 
 
@@ -217,112 +361,191 @@ namespace Lemur
 
 	void Textbox::actionEvents(InputMap* aInput)
 	{
-		bool wasShifted = aInput->keys[GLFW_KEY_LEFT_SHIFT].isDown() || aInput->keys[GLFW_KEY_RIGHT_SHIFT].isDown();
-		bool caps = (wasShifted || aInput->capsLock);
-		
-
-		// Helper function to insert a character at the cursor index
-		auto insertCharacter = [&](char character) {
-			text.insert(cursorIndex, 1, character);
-			cursorIndex++;
-		};
-
-		// Numeric keys
-		for (int key = GLFW_KEY_0; key <= GLFW_KEY_9; key++) {
-			if (aInput->keys[key].isPressDown()) {
-				char character = static_cast<char>(key);
-				insertCharacter(character);
-			}
-		}
+		// Click to focus and place the cursor, caret positions are relative to the textbox's left edge
+		if (mouseOver && aInput->mouse.leftButton.isPressDown())
+		{
+			focus();
+
+			if (caretPositionsValid && pendingEdits.empty())
+			{
+				int index = getCaretIndex(static_cast<float>(aInput->mouse.position.x) - screenRect.x);
+
+				// Bytes within a character share the next character's position
+				while (index < static_cast<int>(text.length()) && (static_cast<unsigned char>(text[index]) & 0xC0) == 0x80)
+					index++;
 
-		// Alphabets (supports lowercase and uppercase)
-		for (int key = GLFW_KEY_A; key <= GLFW_KEY_Z; key++) {
-			if (aInput->keys[key].isPressDown()) {
-				char character = wasShifted? static_cast<char>(key) : std::tolower(static_cast<char>(key));
-				insertCharacter(character);
+				cursorIndex = index;
+				restartCursorBlink();
 			}
 		}
 
-		// Special characters with Shift key support
-		if (aInput->keys[GLFW_KEY_MINUS].isPressDown()) {
-			insertCharacter(wasShifted? '_' : '-');
-		}
+		if (!focused)
+			return;
 
-		if (aInput->keys[GLFW_KEY_EQUAL].isPressDown()) {
-			insertCharacter(wasShifted? '+' : '=');
-		}
+		double now = glfwGetTime();
 
-		if (aInput->keys[GLFW_KEY_LEFT_BRACKET].isPressDown()) {
-			insertCharacter(wasShifted? '{' : '[');
+		// Toggle the cursor once the blink interval has elapsed
+		if (now >= nextCursorBlink)
+		{
+			cursorVisible = !cursorVisible;
+			nextCursorBlink = now + CURSOR_BLINK_INTERVAL;
+			invalidate();
 		}
 
-		if (aInput->keys[GLFW_KEY_RIGHT_BRACKET].isPressDown()) {
-			insertCharacter(wasShifted? '}' : ']');
-		}
+		// Wake the event loop for the next blink
+		requestWakeUp(nextCursorBlink);
+	}
 
-		if (aInput->keys[GLFW_KEY_BACKSLASH].isPressDown()) {
-			insertCharacter(wasShifted? '~' : '#');
-		}
+	void Textbox::focusChanged(bool aFocused)
+	{
+		// Only the focused textbox blinks, so only it needs frame events
+		setReceivesFrameEvents(aFocused);
+		cursorVisible = false;
 
-		if (aInput->keys[GLFW_KEY_SEMICOLON].isPressDown()) {
-			insertCharacter(wasShifted? ':' : ';');
-		}
+		if (aFocused)
+			restartCursorBlink();
 
-		if (aInput->keys[GLFW_KEY_APOSTROPHE].isPressDown()) {
-			insertCharacter(wasShifted? '@' : '\'');
-		}
+		invalidate();
+	}
 
-		if (aInput->keys[GLFW_KEY_GRAVE_ACCENT].isPressDown()) {
-			insertCharacter(wasShifted? '' : '`');
-		}
+	void Textbox::keyboardEvent(const InputEvent& aEvent)
+	{
+		int lastCursorIndex = cursorIndex;
+		size_t lastLength = text.length();
 
-		if (aInput->keys[GLFW_KEY_COMMA].isPressDown()) {
-			insertCharacter(wasShifted? '<' : ',');
+		// Characters arrive with shift, caps lock, keyboard layout and key repeat already applied
+		if (aEvent.type == InputEvent::Type::Char)
+		{
+			insertCodepoint(aEvent.codepoint);
 		}
-
-		if (aInput->keys[GLFW_KEY_PERIOD].isPressDown()) {
-			insertCharacter(wasShifted? '>' : '.');
+		else if (aEvent.action == GLFW_PRESS || aEvent.action == GLFW_REPEAT)
+		{
+			switch (aEvent.key)
+			{
+			case GLFW_KEY_BACKSPACE:
+				if (cursorIndex > 0)
+				{
+					int previous = getPreviousCharacter(cursorIndex);
+					eraseText(previous, cursorIndex - previous);
+					cursorIndex = previous;
+				}
+				break;
+
+			case GLFW_KEY_DELETE:
+				if (cursorIndex < static_cast<int>(text.length()))
+					eraseText(cursorIndex, getNextCharacter(cursorIndex) - cursorIndex);
+				break;
+
+			case GLFW_KEY_LEFT:
+				cursorIndex = getPreviousCharacter(cursorIndex);
+				break;
+
+			case GLFW_KEY_RIGHT:
+				cursorIndex = getNextCharacter(cursorIndex);
+				break;
+
+			case GLFW_KEY_HOME:
+				cursorIndex = 0;
+				break;
+
+			case GLFW_KEY_END:
+				cursorIndex = static_cast<int>(text.length());
+				break;
+			}
 		}
 
-		if (aInput->keys[GLFW_KEY_SLASH].isPressDown()) {
-			insertCharacter(wasShifted? '?' : '/');
-		}
+		// On edit, show the cursor and restart the blink
+		if (cursorIndex != lastCursorIndex || text.length() != lastLength)
+			restartCursorBlink();
+	}
 
+	void Textbox::insertCodepoint(uint32_t aCodepoint)
+	{
+		// Encode as UTF-8, which NanoVG draws and measures
+		char bytes[4];
+		int count;
 
-		// Common special characters
-		if (aInput->keys[GLFW_KEY_SPACE].isPressDown()) {
-			insertCharacter(' ');
+		if (aCodepoint < 0x80)
+		{
+			bytes[0] = static_cast<char>(aCodepoint);
+			count = 1;
 		}
-
-		if (aInput->keys[GLFW_KEY_BACKSPACE].isPressDown()) {
-			if (cursorIndex > 0) {
-				text.erase(cursorIndex - 1, 1);
-				cursorIndex--;
-			}
+		else if (aCodepoint < 0x800)
+		{
+			bytes[0] = static_cast<char>(0xC0 | (aCodepoint >> 6));
+			bytes[1] = static_cast<char>(0x80 | (aCodepoint & 0x3F));
+			count = 2;
 		}
-
-		if (aInput->keys[GLFW_KEY_DELETE].isPressDown()) {
-			if (cursorIndex < text.length()) {
-				text.erase(cursorIndex, 1);
-			}
+		else if (aCodepoint < 0x10000)
+		{
+			bytes[0] = static_cast<char>(0xE0 | (aCodepoint >> 12));
+			bytes[1] = static_cast<char>(0x80 | ((aCodepoint >> 6) & 0x3F));
+			bytes[2] = static_cast<char>(0x80 | (aCodepoint & 0x3F));
+			count = 3;
 		}
-
-		if (aInput->keys[GLFW_KEY_LEFT].isPressDown()) {
-			if (cursorIndex > 0) {
-				cursorIndex--;
-			}
+		else if (aCodepoint < 0x110000)
+		{
+			bytes[0] = static_cast<char>(0xF0 | (aCodepoint >> 18));
+			bytes[1] = static_cast<char>(0x80 | ((aCodepoint >> 12) & 0x3F));
+			bytes[2] = static_cast<char>(0x80 | ((aCodepoint >> 6) & 0x3F));
+			bytes[3] = static_cast<char>(0x80 | (aCodepoint & 0x3F));
+			count = 4;
 		}
-
-		if (aInput->keys[GLFW_KEY_RIGHT].isPressDown()) {
-			if (cursorIndex < text.length()) {
-				cursorIndex++;
-			}
+		else
+		{
+			return;
 		}
+
+		text.insert(cursorIndex, bytes, count);
+		recordEdit(cursorIndex, count, 0);
+		cursorIndex += count;
 	}
 
+	void Textbox::eraseText(int aIndex, int aLength)
+	{
+		if (aLength <= 0)
+			return;
+
+		text.erase(aIndex, aLength);
+		recordEdit(aIndex, 0, aLength);
+	}
+
+	int Textbox::getPreviousCharacter(int aIndex) const
+	{
+		if (aIndex <= 0)
+			return 0;
+
+		// Step back over continuation bytes to the lead byte
+		aIndex--;
+		while (aIndex > 0 && (static_cast<unsigned char>(text[aIndex]) & 0xC0) == 0x80)
+			aIndex--;
+
+		return aIndex;
+	}
+
+	int Textbox::getNextCharacter(int aIndex) const
+	{
+		int length = static_cast<int>(text.length());
+		if (aIndex >= length)
+			return length;
+
+		aIndex++;
+		while (aIndex < length && (static_cast<unsigned char>(text[aIndex]) & 0xC0) == 0x80)
+			aIndex++;
 
+		return aIndex;
+	}
 
+	void Textbox::restartCursorBlink()
+	{
+		if (!focused)
+			return;
 
+		cursorVisible = true;
+		nextCursorBlink = glfwGetTime() + CURSOR_BLINK_INTERVAL;
+		invalidate();
+		requestWakeUp(nextCursorBlink);
+	}
 
 }
 
@@ -16,6 +16,7 @@
 
 
 #include <unordered_map>
+#include <vector>
 #include "core.h"
 #include "component.h"
 #include "draw.h"
@@ -27,18 +28,47 @@ namespace Lemur
 	{
 	protected:
 		// Constants
-		const int CURSOR_BLINK_FRAME_COUNT = 25;
+		const double CURSOR_BLINK_INTERVAL = 0.5;	// Seconds the cursor is shown or hidden for
 
 		// Properties
 		bool isActive;
 		int cursorIndex;
-		int cursorBlinkTimer;
+		bool cursorVisible;
+		double nextCursorBlink;
 
 		Draw::TextStyle textStyle;
 
+		// An edit to the text, made in actionEvents
+		struct TextEdit
+		{
+			int index;			// Byte index of the edit
+			int inserted;		// Bytes inserted at the index
+			int removed;		// Bytes removed from the index
+		};
+
+		// Caret positions, the pen x before each byte of text and after its last byte. Edits are
+		// queued in actionEvents and patched in onFrame, where a NanoVG context is available.
+		std::vector<float> caretPositions;
+		std::vector<TextEdit> pendingEdits;
+		bool caretPositionsValid = false;
+		std::vector<NVGglyphPosition> glyphBuffer;	// Scratch buffer for measuring
+
 
 		// Protected Methods
-		int calculateCursorPosition(NVGcontext* aContext, int aIndex, const Draw::TextStyle* aStyle);
+		void recordEdit(int aIndex, int aInserted, int aRemoved);
+		void invalidateCaretPositions();
+		void updateCaretPositions(NVGcontext* aContext);
+		void rebuildCaretPositions(NVGcontext* aContext);
+		void patchCaretPositions(NVGcontext* aContext, const TextEdit& aEdit);
+		bool checkCaretPositions(NVGcontext* aContext);		// Debug builds assert patches match a full measure
+		void measureRun(NVGcontext* aContext, int aStart, int aEnd, std::vector<float>& aPositions);
+
+		// Editing, with the cursor kept on UTF-8 character boundaries
+		void insertCodepoint(uint32_t aCodepoint);
+		void eraseText(int aIndex, int aLength);
+		int getPreviousCharacter(int aIndex) const;
+		int getNextCharacter(int aIndex) const;
+		void restartCursorBlink();
 
 
 	public:
@@ -46,6 +76,10 @@ namespace Lemur
 		Textbox(int aX, int aY, int aWidth, int aHeight, std::string aText);
 		Textbox(Vector2 aLocation, std::string aText);
 
+		// Allocated from this class's own arena pool
+		static void* operator new(size_t aSize);
+		static void operator delete(void* aPointer, size_t aSize);
+
 
 		// Getters and Setters
 		bool getActive();
@@ -59,6 +93,11 @@ namespace Lemur
 		void setAlign(Align aAlign);
 		Colour getColour();
 		void setColour(Colour aColour);
+		virtual void setText(std::string aText) override;
+
+		// Caret lookups, valid once the textbox has been drawn
+		float getCaretX(int aIndex) const;		// Pen x before a byte index, relative to the text origin
+		int getCaretIndex(float aX) const;		// Nearest caret index to an x relative to the text origin
 
 
 
@@ -66,6 +105,8 @@ namespace Lemur
 		// Virtual method overrides
 		virtual void onFrame(NVGcontext* aContext) override;
 		virtual void actionEvents(InputMap* aInput) override;
+		virtual void focusChanged(bool aFocused) override;
+		virtual void keyboardEvent(const InputEvent& aEvent) override;
 
 	};
 
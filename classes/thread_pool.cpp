@@ -0,0 +1,107 @@
+#ifndef LEMUR_THREAD_POOL_CPP
+#define LEMUR_THREAD_POOL_CPP
+
+/**************************************************************************************
+* Lemur:        Worker Thread Pool Class                                              *
+*-------------------------------------------------------------------------------------*
+* Filename:     ThreadPool.cpp                                                        *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   A fixed set of worker threads running queued jobs in submission order, for work  *
+*   such as decoding files that should not block the render thread.                   *
+***************************************************************************************/
+
+
+
+#include "thread_pool.h"
+
+
+namespace Lemur
+{
+	ThreadPool::ThreadPool(int aThreadCount)
+	{
+		threadCount = aThreadCount;
+
+		if (threadCount <= 0)
+		{
+			int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+			threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		shutdown();
+	}
+
+	void ThreadPool::shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+			jobs.clear();
+		}
+
+		condition.notify_all();
+
+		for (std::thread& worker : workers)
+			if (worker.joinable())
+				worker.join();
+	}
+
+	void ThreadPool::workerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> job;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+				if (stopping)
+					return;
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			job();
+		}
+	}
+
+	void ThreadPool::submit(std::function<void()> aJob)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (stopping)
+				return;
+
+			jobs.push_back(std::move(aJob));
+
+			// Start the workers with the first job
+			if (workers.empty())
+				for (int i = 0; i < threadCount; i++)
+					workers.emplace_back(&ThreadPool::workerLoop, this);
+		}
+
+		condition.notify_one();
+	}
+
+	size_t ThreadPool::getQueuedCount()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return jobs.size();
+	}
+
+	int ThreadPool::getThreadCount() const
+	{
+		return threadCount;
+	}
+
+} // namespace Lemur
+
+#endif // !LEMUR_THREAD_POOL_CPP
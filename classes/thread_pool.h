@@ -0,0 +1,70 @@
+#ifndef LEMUR_THREAD_POOL_H
+#define LEMUR_THREAD_POOL_H
+
+/**************************************************************************************
+* Lemur:        Worker Thread Pool Class                                              *
+*-------------------------------------------------------------------------------------*
+* Filename:     ThreadPool.h                                                          *
+* Contributors: James Hodgkins                                                        *
+* Date:         21 March 2024                                                         *
+* Copyright:    2024 Lemur. GPLv3                                                    *
+*-------------------------------------------------------------------------------------*
+* Description:                                                                        *
+*   A fixed set of worker threads running queued jobs in submission order, for work  *
+*   such as decoding files that should not block the render thread.                   *
+*                                                                                     *
+* Notes:                                                                              *
+*   Workers are started on the first submit. Destroying the pool waits for jobs that  *
+*   are running and discards those still queued.                                      *
+***************************************************************************************/
+
+
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace Lemur
+{
+	class ThreadPool
+	{
+	private:
+		int threadCount;
+		std::vector<std::thread> workers;
+		std::deque<std::function<void()>> jobs;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool stopping = false;
+
+		// Run jobs until the pool is destroyed
+		void workerLoop();
+
+	public:
+
+		// Thread count of 0 uses one less than the hardware threads, leaving one for rendering
+		ThreadPool(int aThreadCount = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Queue a job to run on a worker thread
+		void submit(std::function<void()> aJob);
+
+		// Discard queued jobs and wait for running ones. Later submits are ignored.
+		void shutdown();
+
+		// Number of jobs waiting for a worker
+		size_t getQueuedCount();
+
+		// Number of worker threads, started or not
+		int getThreadCount() const;
+	};
+
+} // namespace Lemur
+
+#endif // !LEMUR_THREAD_POOL_H
@@ -23,17 +23,23 @@
 #ifndef NANOVG_GL3_IMPLEMENTATION
 	#define NANOVG_GL3_IMPLEMENTATION	// Use GL3.
 	#include "nanovg_gl.h"				// Include nanovg opengl3 implementation
+	#include "nanovg_gl_utils.h"		// Include nanovg framebuffer utilities
 #endif
 
 
 #include "window.h"
 #include "application.h"
+#include "text_styles.h"
 
 
 namespace Lemur
 {
 	void Window::updateProperties()
 	{
+		// Offscreen windows are only resized through setSize
+		if (offscreen)
+			return;
+
 		int width = 0, height = 0;
 		glfwGetWindowSize(glfwHandle, &width, &height);
 		setSize(width, height);
@@ -44,12 +50,22 @@ namespace Lemur
 		// To be overridden by derived classes
 	}
 
-	Window::Window(int aWidth, int aHeight, const char* aTitle)
+	Window::Window(int aWidth, int aHeight, const char* aTitle, bool aOffscreen)
 	{
+		resourceManager = nullptr;
 		setSize(aWidth, aHeight);
 		input = InputMap();
 		text = aTitle;
 
+		// Offscreen windows draw the same Component tree into a CPU buffer
+		if (aOffscreen)
+		{
+			offscreen = true;
+			softwareRenderer = new SoftwareRenderer(aWidth, aHeight);
+			context = softwareRenderer->createContext();
+			return;
+		}
+
 		// Initialize GLFW
 		if (!glfwInit())
 			return;
@@ -74,6 +90,9 @@ namespace Lemur
 			return;
 		}
 
+		// Framebuffers are available for layered components
+		LayerCache::setSupported(true);
+
 		// Bind this instance of GrWindow to the glfw window instance for static callbacks
 		glfwSetWindowUserPointer(glfwHandle, this);
 
@@ -82,6 +101,7 @@ namespace Lemur
 		glfwSetMouseButtonCallback(glfwHandle, mouseClickEventCallback);
 		glfwSetScrollCallback(glfwHandle, mouseScrollEventCallback);
 		glfwSetKeyCallback(glfwHandle, keyEventCallback);
+		glfwSetCharCallback(glfwHandle, charEventCallback);
 		glfwSetWindowSizeCallback(glfwHandle, windowResizeCallback);
 		glfwSetCursorEnterCallback(glfwHandle, cursorEnterEventCallback);
 
@@ -96,9 +116,12 @@ namespace Lemur
 	{
 		Window* windowInstance = static_cast<Window*>(glfwGetWindowUserPointer(aWindow));
 		if (windowInstance) {
-			// Access the instance and store the mouse position
-			windowInstance->input.mouse.position.x = static_cast<int>(aPositionX);
-			windowInstance->input.mouse.position.y = static_cast<int>(aPositionY);
+			InputEvent event;
+			event.type = InputEvent::Type::MouseMove;
+			event.x = aPositionX;
+			event.y = aPositionY;
+			event.time = glfwGetTime();
+			windowInstance->postInputEvent(event);
 		}
 	}
 
@@ -116,28 +139,13 @@ namespace Lemur
 	{
 		Window* windowInstance = static_cast<Window*>(glfwGetWindowUserPointer(aWindow));
 		if (windowInstance) {
-			switch (aButton) {
-			case 0:
-				if (aAction == GLFW_PRESS)
-					windowInstance->input.mouse.leftButton.changeState(true);
-				if (aAction == GLFW_RELEASE)
-					windowInstance->input.mouse.leftButton.changeState(false);
-				break;
-
-			case 1:
-				if (aAction == GLFW_PRESS)
-					windowInstance->input.mouse.rightButton.changeState(true);
-				if (aAction == GLFW_RELEASE)
-					windowInstance->input.mouse.rightButton.changeState(false);
-				break;
-
-			case 2:
-				if (aAction == GLFW_PRESS)
-					windowInstance->input.mouse.middleButton.changeState(true);
-				if (aAction == GLFW_RELEASE)
-					windowInstance->input.mouse.middleButton.changeState(false);
-				break;
-			}
+			InputEvent event;
+			event.type = InputEvent::Type::MouseButton;
+			event.key = aButton;
+			event.action = aAction;
+			event.mods = aMods;
+			event.time = glfwGetTime();
+			windowInstance->postInputEvent(event);
 		}
 	}
 
@@ -146,8 +154,12 @@ namespace Lemur
 	{
 		Window* windowInstance = static_cast<Window*>(glfwGetWindowUserPointer(aWindow));
 		if (windowInstance) {
-			// Access the instance and store the mouse scroll offset
-			windowInstance->input.mouse.scroll = static_cast<int>(aOffsetY);
+			InputEvent event;
+			event.type = InputEvent::Type::Scroll;
+			event.x = aOffsetX;
+			event.y = aOffsetY;
+			event.time = glfwGetTime();
+			windowInstance->postInputEvent(event);
 		}
 	}
 
@@ -155,26 +167,26 @@ namespace Lemur
 	{
 		Window* windowInstance = static_cast<Window*>(glfwGetWindowUserPointer(aWindow));
 		if (windowInstance) {
-			InputMap* map = &windowInstance->input;
-
-			if (map->keys.find(aKey) == map->keys.end())
-				return;
-
-			// Change button state to down
-			if (aAction == GLFW_PRESS)
-				map->keys[aKey].changeState(true);
-
-			// Change button state to up
-			if (aAction == GLFW_RELEASE)
-				map->keys[aKey].changeState(false);
-
-
-			if (aMods & GLFW_MOD_CAPS_LOCK)
-				map->capsLock = true;
-			else
-				map->capsLock = false;
-				
+			InputEvent event;
+			event.type = InputEvent::Type::Key;
+			event.key = aKey;
+			event.scancode = aScancode;
+			event.action = aAction;
+			event.mods = aMods;
+			event.time = glfwGetTime();
+			windowInstance->postInputEvent(event);
+		}
+	}
 
+	void Window::charEventCallback(GLFWwindow* aWindow, unsigned int aCodepoint)
+	{
+		Window* windowInstance = static_cast<Window*>(glfwGetWindowUserPointer(aWindow));
+		if (windowInstance) {
+			InputEvent event;
+			event.type = InputEvent::Type::Char;
+			event.codepoint = aCodepoint;
+			event.time = glfwGetTime();
+			windowInstance->postInputEvent(event);
 		}
 	}
 
@@ -193,9 +205,17 @@ namespace Lemur
 	{
 		size.x = aWidth;
 		size.y = aHeight;
+		updateScreenSize();
+
+		// Contents will be laid out again, redraw everything
+		invalidateLayout();
+		invalidateAll();
 
 		if (glfwHandle)
 			glfwSetWindowSize(glfwHandle, aWidth, aHeight);
+
+		if (softwareRenderer)
+			softwareRenderer->resize(aWidth, aHeight);
 	}
 
 	float Window::getWidth()
@@ -210,12 +230,16 @@ namespace Lemur
 
 	bool Window::isRunning()
 	{
+		if (offscreen)
+			return running;
+
 		return !glfwWindowShouldClose(glfwHandle);
 	}
 
 	void Window::makeCurrentContext()
 	{
-		glfwMakeContextCurrent(glfwHandle);
+		if (glfwHandle)
+			glfwMakeContextCurrent(glfwHandle);
 	}
 
 	NVGcontext* Window::getContext()
@@ -223,43 +247,422 @@ namespace Lemur
 		return context;
 	}
 
+	bool Window::isOffscreen() const
+	{
+		return offscreen;
+	}
+
+	SoftwareRenderer* Window::getSoftwareRenderer()
+	{
+		return softwareRenderer;
+	}
+
 	void Window::resetContext()
 	{
+		// Resolve layout once, after this frame's events and before anything is drawn
+		if (layoutPending)
+		{
+			Profiler::Scope scope("Layout", "layout");
+			layoutPending = false;
+			LayoutEngine::run(this);
+		}
+
 		// If the context is not null, reset it
 		if (context != nullptr)
 		{
+			// Cast window size
+			float w = getWidth();
+			float h = getHeight();
+			Rect windowRect(0, 0, w, h);
+
+			// Upload resources decoded since the last frame. Any component may show them, so redraw everything.
+			if (resourceManager != nullptr && resourceManager->processUploads(context) > 0)
+				invalidateAll();
+
+			// The overlay graph changes every frame
+			if (profilerOverlay)
+				invalidateRect(getProfilerOverlayRect());
+
+			// The back buffer's contents are undefined after a swap, and drivers may keep any number of
+			// buffers, so frames are drawn into a frame buffer that keeps the last frame's pixels.
+			// Without one, each frame that draws anything redraws all of it.
+			if (!offscreen)
+			{
+				updateFrameBuffer(static_cast<int>(w), static_cast<int>(h));
+				if (frameBuffer == nullptr && !damageRegion.isEmpty())
+					fullRedraw = true;
+			}
+
+			// Work out the area to redraw
+			Rect frameRegion = fullRedraw ? windowRect : damageRegion.intersection(windowRect);
+			damageRegion = Rect();
+			fullRedraw = false;
+
+			// Nothing changed, skip the frame
+			skipFrame = frameRegion.isEmpty();
+			if (skipFrame)
+				return;
+
+			// Clip this frame's drawing to the damaged area
+			drawClip = frameRegion;
+
 			nvgReset(context);
 
+			if (offscreen)
+			{
+				// Clear the damaged area of the CPU buffer, there is no back buffer to swap
+				softwareRenderer->clear(frameRegion, Colour(backColour.getRed(), backColour.getGreen(), backColour.getBlue(), 255));
+
+				nvgBeginFrame(context, w, h, 1);
+				Draw::BeginFrame(context);
+				return;
+			}
+
+			// Bring layers on screen up to date before the window's frame begins
+			LayerCache::renderLayers(context, static_cast<int>(w), static_cast<int>(h));
+
+			// Draw into the frame buffer, or the back buffer if there is none
+			nvgluBindFramebuffer(frameBuffer);
+
 			glClearColor(
 				backColour.getRedNorm(),
 				backColour.getGreenNorm(),
 				backColour.getBlueNorm(),
 				1.0f);
 
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+			// Only clear the damaged area, glScissor works bottom up
+			int clipX = static_cast<int>(Math::floor(frameRegion.x));
+			int clipY = static_cast<int>(Math::floor(frameRegion.y));
+			int clipW = static_cast<int>(Math::ceil(frameRegion.getRight())) - clipX;
+			int clipH = static_cast<int>(Math::ceil(frameRegion.getBottom())) - clipY;
 
-			// Cast window size
-			float w = getWidth();
-			float h = getHeight();
+			glEnable(GL_SCISSOR_TEST);
+			glScissor(clipX, static_cast<int>(h) - (clipY + clipH), clipW, clipH);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+			glDisable(GL_SCISSOR_TEST);
 
 			glViewport(0, 0, w, h);
 
 			nvgBeginFrame(context, w, h, 1);
+			Draw::BeginFrame(context);
 		}
 	}
 
+	void Window::updateFrameBuffer(int aWidth, int aHeight)
+	{
+		if (aWidth == frameBufferWidth && aHeight == frameBufferHeight)
+			return;
+
+		frameBufferWidth = aWidth;
+		frameBufferHeight = aHeight;
+
+		if (frameBuffer != nullptr)
+			nvgluDeleteFramebuffer(frameBuffer);
+		frameBuffer = nullptr;
+
+		// Without framebuffer support this stays null, and frames are drawn straight to the back buffer
+		if (aWidth > 0 && aHeight > 0)
+			frameBuffer = nvgluCreateFramebuffer(context, aWidth, aHeight, 0);
+
+		// A new buffer holds nothing yet
+		fullRedraw = true;
+	}
+
 	Vector2 Window::getRelativeLocation()
 	{
 		return Vector2(0, 0);
 	}
 
+	void Window::invalidateRect(const Rect& aRect)
+	{
+		damageRegion = damageRegion.united(aRect);
+	}
+
+	void Window::invalidateAll()
+	{
+		fullRedraw = true;
+	}
+
+	void Window::scheduleWakeUp(double aTime)
+	{
+		if (nextWakeUp < 0 || aTime < nextWakeUp)
+			nextWakeUp = aTime;
+	}
+
+	void Window::scheduleLayout()
+	{
+		layoutPending = true;
+	}
+
+	void Window::requestFocus(Component* aComponent)
+	{
+		if (focusedComponent == aComponent)
+			return;
+
+		Component* previous = focusedComponent;
+		focusedComponent = aComponent;
+
+		if (previous != nullptr)
+		{
+			previous->focused = false;
+			previous->focusChanged(false);
+		}
+
+		if (aComponent != nullptr)
+		{
+			aComponent->focused = true;
+			aComponent->focusChanged(true);
+		}
+	}
+
+	void Window::releaseFocus(Component* aSubtree)
+	{
+		for (Component* control = focusedComponent; control != nullptr; control = control->getParent())
+		{
+			if (control == aSubtree)
+			{
+				requestFocus(nullptr);
+				return;
+			}
+		}
+	}
+
+	Component* Window::getFocusedComponent() const
+	{
+		return focusedComponent;
+	}
+
+	bool Window::postInputEvent(const InputEvent& aEvent)
+	{
+		return inputQueue.push(aEvent);
+	}
+
+	void Window::processInputQueue()
+	{
+		bool buttonChanged = false;
+
+		while (const InputEvent* event = inputQueue.front())
+		{
+			switch (event->type)
+			{
+			case InputEvent::Type::Key:
+				input.mods = event->mods;
+				input.capsLock = (event->mods & GLFW_MOD_CAPS_LOCK) != 0;
+
+				if (event->key >= 0 && event->key < InputMap::KEY_COUNT && event->action != GLFW_REPEAT)
+					input.keys[event->key].changeState(event->action == GLFW_PRESS);
+
+				// Toggle the profiler overlay
+				if (event->key == GLFW_KEY_F12 && event->action == GLFW_PRESS)
+					setProfilerOverlay(!profilerOverlay);
+				else if (focusedComponent != nullptr)
+					focusedComponent->keyboardEvent(*event);
+				break;
+
+			case InputEvent::Type::Char:
+				if (focusedComponent != nullptr)
+					focusedComponent->keyboardEvent(*event);
+				break;
+
+			case InputEvent::Type::MouseButton:
+			{
+				// Components see one press per button each frame, a second click waits for the next
+				KeyInput* button = input.getMouseButton(event->key);
+				if (button != nullptr && event->action == GLFW_PRESS && button->isPressDown())
+					return;
+
+				if (button != nullptr)
+					button->changeState(event->action == GLFW_PRESS);
+
+				buttonChanged = true;
+				break;
+			}
+
+			case InputEvent::Type::MouseMove:
+				// Components read clicks at the mouse position, so keep it where the button changed
+				if (buttonChanged)
+					return;
+
+				input.mouse.position.x = static_cast<int>(event->x);
+				input.mouse.position.y = static_cast<int>(event->y);
+
+				// Offscreen windows have no cursor enter events, the mouse is over them while inside
+				if (offscreen)
+					mouseOver = event->x >= 0 && event->y >= 0 && event->x < getWidth() && event->y < getHeight();
+				break;
+
+			case InputEvent::Type::Scroll:
+				input.mouse.scroll += static_cast<int>(event->y);
+				break;
+			}
+
+			inputQueue.pop();
+		}
+	}
+
+	void Window::waitEvents()
+	{
+		// Offscreen windows are driven by the caller, there are no events to wait for
+		if (offscreen)
+			return;
+
+		// Something is waiting to be laid out or drawn, or input was left for the next frame, don't block
+		if (hasDamage() || layoutPending || !inputQueue.isEmpty())
+		{
+			glfwPollEvents();
+			return;
+		}
+
+		// Nothing scheduled, sleep until the next input event
+		if (nextWakeUp < 0)
+		{
+			glfwWaitEvents();
+			return;
+		}
+
+		// Sleep until the next input event or the earliest wake up
+		double timeout = nextWakeUp - glfwGetTime();
+		if (timeout > 0)
+			glfwWaitEventsTimeout(timeout);
+		else
+			glfwPollEvents();
+	}
+
+	void Window::postWakeUp()
+	{
+		if (!offscreen)
+			glfwPostEmptyEvent();
+	}
+
+	bool Window::hasDamage() const
+	{
+		return fullRedraw || !damageRegion.isEmpty();
+	}
+
+	void Window::setProfilerOverlay(bool aShow)
+	{
+		if (profilerOverlay == aShow)
+			return;
+
+		profilerOverlay = aShow;
+		if (aShow)
+			Profiler::setEnabled(true);
+
+		invalidateRect(getProfilerOverlayRect());
+	}
+
+	bool Window::isProfilerOverlayShown() const
+	{
+		return profilerOverlay;
+	}
+
+	Rect Window::getProfilerOverlayRect() const
+	{
+		const float overlayWidth = 300;
+		const float overlayHeight = 138;
+		const float margin = 10;
+
+		return Rect(static_cast<float>(size.x) - overlayWidth - margin, margin, overlayWidth, overlayHeight);
+	}
+
+	void Window::drawProfilerOverlay(NVGcontext* aContext)
+	{
+		profilerHistory.resize(OVERLAY_FRAMES);
+		int count = Profiler::getFrameHistory(profilerHistory.data(), OVERLAY_FRAMES);
+
+		Rect area = getProfilerOverlayRect();
+		const double budget = 1000000000.0 / 60.0;		// 16.7ms frame budget in nanoseconds
+
+		Draw::Scissor(aContext, area.x, area.y, area.width, area.height);
+		Draw::Rect(aContext, area.x, area.y, area.width, area.height, Colour(0, 0, 0, 200));
+
+		// Frame time bars, the graph is twice the budget high
+		float graphTop = area.y + 66;
+		float graphHeight = area.getBottom() - 4 - graphTop;
+		float barWidth = area.width / OVERLAY_FRAMES;
+		float graphLeft = area.getRight() - count * barWidth;
+
+		for (int i = 0; i < count; i++)
+		{
+			double fraction = profilerHistory[i].total / (budget * 2);
+			float barHeight = static_cast<float>((fraction > 1 ? 1 : fraction) * graphHeight);
+			Colour barColour = (profilerHistory[i].total > budget) ? Colour(230, 70, 60, 255) : Colour(80, 200, 120, 255);
+
+			Draw::Rect(aContext, graphLeft + i * barWidth, graphTop + graphHeight - barHeight, barWidth, barHeight, barColour);
+		}
+
+		// Budget line
+		float budgetY = graphTop + graphHeight / 2;
+		Draw::Line(aContext, area.x, budgetY, area.getRight(), budgetY, 1, Colour(255, 255, 255, 120));
+
+		if (count == 0)
+			return;
+
+		// Latest frame statistics and slowest component
+		const Profiler::FrameRecord& last = profilerHistory[count - 1];
+		char line[128];
+
+		const Draw::TextStyle& overlayTextStyle = TextStyles::get(TextStyles::Id::ProfilerOverlay);
+
+		snprintf(line, sizeof(line), "%.2f ms  %d calls  %d paths  %d verts",
+			last.total / 1000000.0, last.draw.renderCalls, last.draw.paths, last.draw.vertices);
+		Draw::Text(aContext, area.x + 6, area.y + 4, area.width - 12, 18, &overlayTextStyle, line);
+
+		if (last.hotspots[0].self > 0)
+		{
+			snprintf(line, sizeof(line), "Slowest: %s (%s) %.2f ms",
+				last.hotspots[0].name, last.hotspots[0].category, last.hotspots[0].self / 1000000.0);
+			Draw::Text(aContext, area.x + 6, area.y + 22, area.width - 12, 18, &overlayTextStyle, line);
+		}
+
+		// Glyph atlas, a hit rate below 100% or any rasterizing means text is being cached
+		double hitRate = last.draw.glyphLookups > 0 ? 100.0 * last.draw.glyphHits / last.draw.glyphLookups : 100.0;
+		snprintf(line, sizeof(line), "Glyphs: %.1f%% hits  %d rasterized  %d pages %.0f%% full",
+			hitRate, last.draw.glyphsRasterized, last.draw.atlasPages, last.draw.atlasOccupancy * 100.0);
+		Draw::Text(aContext, area.x + 6, area.y + 40, area.width - 12, 18, &overlayTextStyle, line);
+	}
+
+	unsigned long Window::getFramesDrawn() const
+	{
+		return framesDrawn;
+	}
+
+	unsigned long Window::getFramesSkipped() const
+	{
+		return framesSkipped;
+	}
+
 	void Window::close()
 	{
+		childComponents.clear();
+
+		if (offscreen)
+		{
+			running = false;
+
+			if (context != nullptr)
+			{
+				Draw::RemoveRenderHooks(context);
+				nvgDeleteInternal(context);
+			}
+			context = nullptr;
+
+			delete softwareRenderer;
+			softwareRenderer = nullptr;
+			return;
+		}
+
+		LayerCache::clear();
+		LayerCache::setSupported(false);
+
+		if (frameBuffer != nullptr)
+			nvgluDeleteFramebuffer(frameBuffer);
+		frameBuffer = nullptr;
+
 		glfwDestroyWindow(glfwHandle);
 		glfwTerminate();
 
-		childComponents.clear();
-
+		Draw::RemoveRenderHooks(context);
 		nvgDeleteGL3(context);
 	}
 
@@ -270,7 +673,8 @@ namespace Lemur
 
 	void Window::onFrame(NVGcontext* context)
 	{
-		glfwPollEvents();
+		if (!offscreen)
+			glfwPollEvents();
 	}
 
 	void Window::endFrame()
@@ -278,15 +682,52 @@ namespace Lemur
 		if (context == nullptr)
 			return;
 
+		// Nothing to redraw, keep the current buffers and sleep until there is something to do
+		if (skipFrame)
+		{
+			framesSkipped++;
+
+			// Idle time is not frame time
+			Profiler::discardFrame();
+
+			closeEvents();
+
+			waitEvents();
+			return;
+		}
+
 		// Draw child UI Components
 		drawChildComponents(context);
 
+		if (profilerOverlay)
+			drawProfilerOverlay(context);
+
+		// Submit the last pending batch
+		Draw::EndFrame(context);
+
 		nvgEndFrame(context);
 
 		closeEvents();
 
-		glfwPollEvents();
-		glfwSwapBuffers(glfwHandle);
+		if (!offscreen)
+		{
+			// Copy the whole frame buffer, as the back buffer holds nothing worth keeping
+			if (frameBuffer != nullptr)
+			{
+				int w = static_cast<int>(getWidth());
+				int h = static_cast<int>(getHeight());
+
+				nvgluBindFramebuffer(nullptr);
+				glBindFramebuffer(GL_READ_FRAMEBUFFER, frameBuffer->fbo);
+				glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+				nvgluBindFramebuffer(nullptr);
+			}
+
+			glfwPollEvents();
+			glfwSwapBuffers(glfwHandle);
+		}
+
+		framesDrawn++;
 	}
 
 	void Window::actionEvents(InputMap* aInput)
@@ -296,6 +737,8 @@ namespace Lemur
 
 	void Window::triggerEventsChain()
 	{
+		processInputQueue();
+
 		// Get mouse position from input
 		int mousePosX = static_cast<int>(input.mouse.position.x);
 		int mousePosY = static_cast<int>(input.mouse.position.y);
@@ -330,25 +773,20 @@ namespace Lemur
 
 
 
-		for (std::shared_ptr<Component> control : childComponents)
-		{
-			control->processEvents(&input);
-		}
+		// Wake up requests are renewed each frame by the components that need them
+		nextWakeUp = -1;
 
-		Application* app = Application::getInstance();
+		// Process the children the mouse or frame events can affect
+		processChildEvents(&input);
+
+		// Clicking away from the focused component takes its focus
+		if (focusedComponent != nullptr && input.mouse.leftButton.isPressDown() && !focusedComponent->isMouseOver())
+			requestFocus(nullptr);
 	}
 
 	void Window::closeEvents()
 	{
-		input.mouse.leftButton.changeState(input.mouse.leftButton.isDown());
-		input.mouse.middleButton.changeState(input.mouse.middleButton.isDown());
-		input.mouse.rightButton.changeState(input.mouse.rightButton.isDown());
-		input.mouse.scroll = 0;
-
-		for (auto& pair : input.keys) {
-			int key = pair.first;
-			input.keys[key].changeState(input.keys[key].isDown());
-		}
+		input.endFrame();
 
 	}
 } // namespace Lemur
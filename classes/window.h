@@ -21,18 +21,77 @@
 #include <GLFW/glfw3.h>
 
 #include "Component.h"
+#include "software_renderer.h"
+#include "profiler.h"
+#include "input_queue.h"
+
+
+struct NVGLUframebuffer;
 
 namespace Lemur
 {
+	class HotReload;
+
 	class Window : public Component
 	{
 	protected:
 		GLFWwindow* glfwHandle = nullptr;       // Handle to the GLFW window
 		struct NVGcontext* context = nullptr;   // NanoVG context
 
+		// Offscreen rendering
+		bool offscreen = false;                 // Render into a CPU buffer instead of a GLFW window
+		bool running = true;                    // Offscreen window has not been closed
+		SoftwareRenderer* softwareRenderer = nullptr; // CPU render target when offscreen
+
+		// Redraw state
+		Rect damageRegion;                      // Area invalidated since the last drawn frame
+		NVGLUframebuffer* frameBuffer = nullptr; // Keeps the window's pixels between frames, copied to the back buffer
+		int frameBufferWidth = 0;               // Size the frame buffer was created at
+		int frameBufferHeight = 0;
+		bool fullRedraw = true;                 // Redraw the whole window on the next frame
+		bool skipFrame = false;                 // Nothing to draw for the current frame
+		unsigned long framesDrawn = 0;          // Number of frames rendered
+		unsigned long framesSkipped = 0;        // Number of frames skipped as nothing changed
+		double nextWakeUp = -1;                 // Earliest wake up requested by a component, -1 for none
+		bool layoutPending = true;              // Lay out the tree before the next frame
+
+		// Input
+		InputQueue inputQueue;                  // Events received since the last frame
+		Component* focusedComponent = nullptr;  // Receives key and character events
+
+		// Profiler overlay
+		static const int OVERLAY_FRAMES = 120;  // Frames shown in the overlay graph
+		bool profilerOverlay = false;           // Draw the profiler overlay over the UI
+		std::vector<Profiler::FrameRecord> profilerHistory; // Frames copied from the profiler for drawing
+
+		// Get the screen area of the profiler overlay
+		Rect getProfilerOverlayRect() const;
+
+		// Draw the frame time graph and statistics
+		void drawProfilerOverlay(NVGcontext* aContext);
+
 		// Update properties following initialization or resize
 		void updateProperties();
 
+		// Create or resize the frame buffer to match the window
+		void updateFrameBuffer(int aWidth, int aHeight);
+
+		// Accumulate damage into the window's redraw region
+		void invalidateRect(const Rect& aRect) override;
+
+		// Keep the earliest requested wake up
+		void scheduleWakeUp(double aTime) override;
+
+		// Lay out the tree once before the next frame, however many components asked
+		void scheduleLayout() override;
+
+		// Hold the focused component, dropping it when its subtree is removed
+		void requestFocus(Component* aComponent) override;
+		void releaseFocus(Component* aSubtree) override;
+
+		// Apply queued events to the input map, sending key and character events to the focused component
+		void processInputQueue();
+
 		// Load required resources
 		void loadResources();
 
@@ -40,10 +99,11 @@ namespace Lemur
 	public:
 
 		InputMap input;                       // Input map for storing user input
+		HotReload* hotReload = nullptr;       // Reloads edited layouts and resources, in debug builds
 
 
-		// Constructor
-		Window(int aWidth, int aHeight, const char* aTitle);
+		// Constructor, offscreen windows render on the CPU without GLFW or OpenGL
+		Window(int aWidth, int aHeight, const char* aTitle, bool aOffscreen = false);
 
 		// Set the window size
 		void setSize(int aWidth, int aHeight);
@@ -61,12 +121,43 @@ namespace Lemur
 		// Get the NanoVG context
 		NVGcontext* getContext();
 
+		// Offscreen rendering
+		bool isOffscreen() const;
+		SoftwareRenderer* getSoftwareRenderer();
+
 		// Reset the NanoVG context
 		void resetContext();
 
 		// Returns 0,0 as window will always be at the root of the Component tree
 		Vector2 getRelativeLocation();
 
+		// Force the whole window to be redrawn on the next frame
+		void invalidateAll();
+
+		// Check if any part of the window needs to be redrawn
+		bool hasDamage() const;
+
+		// Process pending events, blocking until the next event or wake up if the window is idle
+		void waitEvents();
+
+		// Wake a waiting event loop, safe to call from any thread
+		void postWakeUp();
+
+		// Queue an input event for the next frame, as the GLFW callbacks do. Offscreen windows
+		// are driven this way. Events must come from one thread at a time.
+		bool postInputEvent(const InputEvent& aEvent);
+
+		// Get the component receiving keyboard events, or null
+		Component* getFocusedComponent() const;
+
+		// Show or hide the profiler overlay (toggled with F12). Showing it enables the profiler.
+		void setProfilerOverlay(bool aShow);
+		bool isProfilerOverlayShown() const;
+
+		// Frame counters
+		unsigned long getFramesDrawn() const;
+		unsigned long getFramesSkipped() const;
+
 		// Close the window and clean up resources
 		void close();
 
@@ -101,6 +192,9 @@ namespace Lemur
 		// Callback function for key events
 		static void keyEventCallback(GLFWwindow* aWindow, int aKey, int aScancode, int aAction, int aMods);
 
+		// Callback function for text entry, with repeats and Unicode characters already resolved
+		static void charEventCallback(GLFWwindow* aWindow, unsigned int aCodepoint);
+
 		// Callback function for cursor entering/leaving window
 		static void cursorEnterEventCallback(GLFWwindow* aWindow, int aEntered);
 
@@ -19,6 +19,9 @@
 #include "window_main.h"
 #include "application.h"
 #include "components.h"
+#include "layout_loader.h"
+#include "hot_reload.h"
+#include "text_styles.h"
 
 
 namespace Lemur
@@ -27,12 +30,22 @@ namespace Lemur
 	// Load required resources
 	void MainWindow::loadResources()
 	{
-		resourceManager->importFontFromFile(context, "sans", "..\\resources\\fonts\\OpenSans.ttf");
-
+		// Rasterize the glyphs the built-in styles draw once the font loads, rather than in the first frames
+		resourceManager->importFontAsync("sans", "..\\resources\\fonts\\OpenSans.ttf", [this](Font* aFont)
+		{
+			if (!aFont->isLoaded())
+				return;
+
+			ResourceManager::WarmUpStats warmUp = resourceManager->warmUpFont(getContext(), aFont,
+				TextStyles::getSizes(aFont), ResourceManager::CharacterSet::Latin1);
+
+			std::cout << "Glyph warm-up: " << warmUp.glyphs << " glyphs in " << warmUp.rasterizeTime + warmUp.uploadTime
+				<< " ms (rasterize " << warmUp.rasterizeTime << " ms, upload " << warmUp.uploadTime << " ms)" << std::endl;
+		});
 	}
 
 
-	MainWindow::MainWindow(int aWidth, int aHeight, const char* aTitle) : Window(aWidth, aHeight, aTitle) {}
+	MainWindow::MainWindow(int aWidth, int aHeight, const char* aTitle, bool aOffscreen) : Window(aWidth, aHeight, aTitle, aOffscreen) {}
 
 	MainWindow::~MainWindow() = default;
 
@@ -45,37 +58,15 @@ namespace Lemur
 		backColour.setRGB(31, 39, 48);
 
 
-		// Create a new UI Panel Component
-		Panel* panel1 = new Panel(50, 50, 140, 200);
-		panel1->setName("My Panel 1");
-		panel1->backColour = Colour(255, 255, 0, 255);
-		addChildControl(panel1);
-		panel1->setAnchor(Anchor::Direction::Left, true);
-		panel1->setAnchor(Anchor::Direction::Right,true);
-
-		// Create second panel
-		Panel* panel2 = new Panel(50, 120, 80, 70);
-		panel2->setName("My Panel 2");
-		panel2->backColour = Colour(255, 0, 255, 255);
-		//panel2->setAnchor(Anchor::Direction::Left, true);
-		panel2->setAnchor(Anchor::Direction::Right, true);
-		panel1->addChildControl(panel2);
-
-		// Create a new UI Component
-		Button* btn1 = new Button(10, 10, 100, 50, "Button 1");
-		btn1->setName("My Button 1");
-		panel1->addChildControl(btn1);
-
-		// Create a new UI Component
-		Button* btn2 = new Button(120, 10, 100, 50, "Button 2");
-		btn1->setName("My Button 2");
-		panel1->addChildControl(btn2);
-
-		// Create a new UI Component
-		Button* btn3 = new Button(10, 10, 100, 50, "Button 3");
-		btn3->setName("My Button 3");
-		panel2->addChildControl(btn3);
+		// Build the UI from its layout file, using the compiled cache while it is up to date
+		const char* layoutPath = "..\\resources\\layouts\\main_window.xml";
+		const char* cachePath = "..\\resources\\layouts\\main_window.lmlc";
+
+		bool loaded = hotReload != nullptr ? hotReload->loadLayout(this, layoutPath, cachePath, resourceManager)
+			: LayoutLoader::load(this, layoutPath, cachePath, resourceManager);
 
+		if (!loaded)
+			std::cout << "Failed to load layout: " << LayoutLoader::getLastError() << std::endl;
 	}
 
 
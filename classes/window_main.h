@@ -32,7 +32,7 @@ namespace Lemur
 	public:
 
 		// Constructor
-		MainWindow(int aWidth, int aHeight, const char* aTitle);
+		MainWindow(int aWidth, int aHeight, const char* aTitle, bool aOffscreen = false);
 
 		// Destructor
 		~MainWindow() override;
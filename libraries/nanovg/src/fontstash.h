@@ -19,6 +19,10 @@
 #ifndef FONS_H
 #define FONS_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define FONS_INVALID -1
 
 enum FONSflags {
@@ -57,6 +61,12 @@ enum FONSerrorCode {
 struct FONSparams {
 	int width, height;
 	unsigned char flags;
+	// Atlas pages the stash may use, up to FONS_MAX_PAGES. With more than one page, a glyph that
+	// doesn't fit goes on a new page, each twice the size of the last up to maxPageSize, and once
+	// all pages are full the coldest page not drawn from this frame is evicted. Glyphs may then be
+	// on any page, see FONStextIter.page. 0 or 1 keeps a single page, reporting FONS_ATLAS_FULL.
+	int maxPages;
+	int maxPageSize;
 	void* userPtr;
 	int (*renderCreate)(void* uptr, int width, int height);
 	int (*renderResize)(void* uptr, int width, int height);
@@ -84,9 +94,38 @@ struct FONStextIter {
 	const char* end;
 	unsigned int utf8state;
 	int bitmapOption;
+	int page;				// Atlas page of the last glyph's quad, -1 if it has no bitmap
 };
 typedef struct FONStextIter FONStextIter;
 
+// Glyph cache counters, totals since the stash was created apart from the pages.
+struct FONSatlasStats {
+	int lookups;			// Glyph bitmaps requested
+	int hits;				// Requests found in the atlas
+	int rasterized;			// Glyphs rasterized into the atlas
+	int evictions;			// Pages evicted to make room
+	int evictedGlyphs;		// Glyphs dropped by evictions
+	int npages;				// Pages in use
+	int usedArea;			// Pixels covered by glyphs, over all pages
+	int totalArea;			// Pixels of all pages
+};
+typedef struct FONSatlasStats FONSatlasStats;
+
+// A glyph rasterized outside the atlas, for warming it up. Filled by fonsPrepareGlyph.
+struct FONSstagedGlyph {
+	int font;				// Font the glyph is cached under
+	int renderFont;			// Font holding the glyph, the font itself or a fallback
+	unsigned int codepoint;
+	short isize, iblur;
+	int index;				// Glyph index in the render font
+	float scale;
+	int advance;
+	int xoff, yoff;			// Offset of the bitmap from the pen position
+	int width, height;		// Bitmap size, including padding for the blur
+	unsigned char* data;	// width*height bytes, allocated by the caller
+};
+typedef struct FONSstagedGlyph FONSstagedGlyph;
+
 typedef struct FONScontext FONScontext;
 
 // Constructor and destructor.
@@ -100,6 +139,19 @@ void fonsGetAtlasSize(FONScontext* s, int* width, int* height);
 int fonsExpandAtlas(FONScontext* s, int width, int height);
 // Resets the whole stash.
 int fonsResetAtlas(FONScontext* stash, int width, int height);
+// Starts a frame. Pages drawn from in the previous frame may be evicted again.
+void fonsBeginFrame(FONScontext* s);
+// Returns glyph cache counters.
+void fonsGetAtlasStats(FONScontext* s, FONSatlasStats* stats);
+
+// Warm up the atlas in three steps, so the rasterizing can be spread over threads. Prepare each
+// glyph, returning 0 if it is already in the atlas. Rasterize them into bitmaps the caller
+// allocates, which only reads the fonts so may run on several threads at once, as long as the
+// stash isn't changed meanwhile (with FONS_USE_FREETYPE, one thread at a time). Then add the
+// bitmaps, returning 0 once the atlas is full. Prepare and add aren't thread safe.
+int fonsPrepareGlyph(FONScontext* s, int font, unsigned int codepoint, float size, float blur, FONSstagedGlyph* bitmap);
+void fonsRasterizeGlyph(FONScontext* s, FONSstagedGlyph* bitmap);
+int fonsAddGlyphBitmap(FONScontext* s, const FONSstagedGlyph* bitmap);
 
 // Add fonts
 int fonsAddFont(FONScontext* s, const char* name, const char* path, int fontIndex);
@@ -131,13 +183,22 @@ void fonsVertMetrics(FONScontext* s, float* ascender, float* descender, float* l
 int fonsTextIterInit(FONScontext* stash, FONStextIter* iter, float x, float y, const char* str, const char* end, int bitmapOption);
 int fonsTextIterNext(FONScontext* stash, FONStextIter* iter, struct FONSquad* quad);
 
-// Pull texture changes
+// Pull texture changes, of the first page
 const unsigned char* fonsGetTextureData(FONScontext* stash, int* width, int* height);
 int fonsValidateTexture(FONScontext* s, int* dirty);
 
+// Pull texture changes of each page
+int fonsGetPageCount(FONScontext* s);
+const unsigned char* fonsGetPageData(FONScontext* s, int page, int* width, int* height);
+int fonsValidatePage(FONScontext* s, int page, int* dirty);
+
 // Draws the stash texture for debugging
 void fonsDrawDebug(FONScontext* s, float x, float y);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // FONTSTASH_H
 
 
@@ -145,6 +206,28 @@ void fonsDrawDebug(FONScontext* s, float x, float y);
 
 #define FONS_NOTUSED(v)  (void)sizeof(v)
 
+// SIMD blur kernels, disabled by defining FONS_NO_SIMD. SSE2 and NEON are used when the target
+// always has them, AVX2 is compiled alongside SSE2 and picked at runtime if the CPU supports it.
+#ifndef FONS_NO_SIMD
+#	if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define FONS_SSE2
+#		include <emmintrin.h>
+#		if defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__)
+#			define FONS_AVX2
+#			include <immintrin.h>
+#			ifdef _MSC_VER
+#				include <intrin.h>
+#				define FONS_AVX2_TARGET
+#			else
+#				define FONS_AVX2_TARGET __attribute__((target("avx2")))
+#			endif
+#		endif
+#	elif defined(__ARM_NEON) || defined(_M_ARM64)
+#		define FONS_NEON
+#		include <arm_neon.h>
+#	endif
+#endif
+
 #ifdef FONS_USE_FREETYPE
 
 #include <ft2build.h>
@@ -198,6 +281,12 @@ typedef struct FONSttFontImpl FONSttFontImpl;
 #ifndef FONS_MAX_FALLBACKS
 #	define FONS_MAX_FALLBACKS 20
 #endif
+#ifndef FONS_MAX_PAGES
+#	define FONS_MAX_PAGES 8
+#endif
+#ifndef FONS_WARM_FRAMES
+#	define FONS_WARM_FRAMES 60
+#endif
 
 static unsigned int fons__hashint(unsigned int a)
 {
@@ -228,6 +317,8 @@ struct FONSglyph
 	short size, blur;
 	short x0,y0,x1,y1;
 	short xadv,xoff,yoff;
+	short page;			// Atlas page holding the bitmap, -1 if it has none
+	int lastUsed;		// Frame the glyph was last drawn
 };
 typedef struct FONSglyph FONSglyph;
 
@@ -275,14 +366,28 @@ struct FONSatlas
 };
 typedef struct FONSatlas FONSatlas;
 
-struct FONScontext
+struct FONSpage
 {
-	FONSparams params;
-	float itw,ith;
+	FONSatlas* atlas;
 	unsigned char* texData;
+	int width, height;
+	float itw,ith;
 	int dirtyRect[4];
+	int lastUsed;		// Frame a glyph on the page was last drawn
+	int usedArea;
+	int nglyphs;
+};
+typedef struct FONSpage FONSpage;
+
+struct FONScontext
+{
+	FONSparams params;
+	FONSpage pages[FONS_MAX_PAGES];
+	int npages;
+	int maxPages;
+	int frame;
+	FONSatlasStats stats;
 	FONSfont** fonts;
-	FONSatlas* atlas;
 	int cfonts;
 	int nfonts;
 	float verts[FONS_VERTEX_COUNT*2];
@@ -467,6 +572,10 @@ static void* fons__tmpalloc(size_t size, void* up)
 	unsigned char* ptr;
 	FONScontext* stash = (FONScontext*)up;
 
+	// Glyphs rasterized off the stash's thread allocate from the heap, see fonsRasterizeGlyph().
+	if (stash == NULL)
+		return malloc(size);
+
 	// 16-byte align the returned pointer
 	size = (size + 0xf) & ~0xf;
 
@@ -482,9 +591,9 @@ static void* fons__tmpalloc(size_t size, void* up)
 
 static void fons__tmpfree(void* ptr, void* up)
 {
-	(void)ptr;
-	(void)up;
-	// empty
+	// Scratch memory is reset per glyph, only heap allocations are freed
+	if (up == NULL)
+		free(ptr);
 }
 
 #endif // STB_TRUETYPE_IMPLEMENTATION
@@ -710,25 +819,71 @@ static int fons__atlasAddRect(FONSatlas* atlas, int rw, int rh, int* rx, int* ry
 	return 1;
 }
 
+static void fons__resetDirtyRect(FONSpage* page)
+{
+	page->dirtyRect[0] = page->width;
+	page->dirtyRect[1] = page->height;
+	page->dirtyRect[2] = 0;
+	page->dirtyRect[3] = 0;
+}
+
+static void fons__addDirtyRect(FONSpage* page, int x0, int y0, int x1, int y1)
+{
+	page->dirtyRect[0] = fons__mini(page->dirtyRect[0], x0);
+	page->dirtyRect[1] = fons__mini(page->dirtyRect[1], y0);
+	page->dirtyRect[2] = fons__maxi(page->dirtyRect[2], x1);
+	page->dirtyRect[3] = fons__maxi(page->dirtyRect[3], y1);
+}
+
+static void fons__setPageSize(FONSpage* page, int w, int h)
+{
+	page->width = w;
+	page->height = h;
+	page->itw = 1.0f/w;
+	page->ith = 1.0f/h;
+}
+
+static void fons__freePage(FONSpage* page)
+{
+	if (page->atlas) fons__deleteAtlas(page->atlas);
+	if (page->texData) free(page->texData);
+	memset(page, 0, sizeof(FONSpage));
+}
+
+static int fons__initPage(FONSpage* page, int w, int h)
+{
+	memset(page, 0, sizeof(FONSpage));
+	page->atlas = fons__allocAtlas(w, h, FONS_INIT_ATLAS_NODES);
+	if (page->atlas == NULL) goto error;
+	page->texData = (unsigned char*)malloc(w * h);
+	if (page->texData == NULL) goto error;
+	memset(page->texData, 0, w * h);
+	fons__setPageSize(page, w, h);
+	fons__resetDirtyRect(page);
+	return 1;
+
+error:
+	fons__freePage(page);
+	return 0;
+}
+
 static void fons__addWhiteRect(FONScontext* stash, int w, int h)
 {
 	int x, y, gx, gy;
 	unsigned char* dst;
-	if (fons__atlasAddRect(stash->atlas, w, h, &gx, &gy) == 0)
+	FONSpage* page = &stash->pages[0];
+	if (fons__atlasAddRect(page->atlas, w, h, &gx, &gy) == 0)
 		return;
 
 	// Rasterize
-	dst = &stash->texData[gx + gy * stash->params.width];
+	dst = &page->texData[gx + gy * page->width];
 	for (y = 0; y < h; y++) {
 		for (x = 0; x < w; x++)
 			dst[x] = 0xff;
-		dst += stash->params.width;
+		dst += page->width;
 	}
 
-	stash->dirtyRect[0] = fons__mini(stash->dirtyRect[0], gx);
-	stash->dirtyRect[1] = fons__mini(stash->dirtyRect[1], gy);
-	stash->dirtyRect[2] = fons__maxi(stash->dirtyRect[2], gx+w);
-	stash->dirtyRect[3] = fons__maxi(stash->dirtyRect[3], gy+h);
+	fons__addDirtyRect(page, gx, gy, gx+w, gy+h);
 }
 
 FONScontext* fonsCreateInternal(FONSparams* params)
@@ -754,8 +909,13 @@ FONScontext* fonsCreateInternal(FONSparams* params)
 			goto error;
 	}
 
-	stash->atlas = fons__allocAtlas(stash->params.width, stash->params.height, FONS_INIT_ATLAS_NODES);
-	if (stash->atlas == NULL) goto error;
+	// Create the first page of the cache.
+	if (!fons__initPage(&stash->pages[0], stash->params.width, stash->params.height)) goto error;
+	stash->npages = 1;
+	stash->maxPages = fons__maxi(1, fons__mini(stash->params.maxPages, FONS_MAX_PAGES));
+	if (stash->params.maxPageSize < stash->params.width || stash->params.maxPageSize < stash->params.height)
+		stash->params.maxPageSize = fons__maxi(stash->params.width, stash->params.height);
+	stash->frame = 1;
 
 	// Allocate space for fonts.
 	stash->fonts = (FONSfont**)malloc(sizeof(FONSfont*) * FONS_INIT_FONTS);
@@ -764,18 +924,6 @@ FONScontext* fonsCreateInternal(FONSparams* params)
 	stash->cfonts = FONS_INIT_FONTS;
 	stash->nfonts = 0;
 
-	// Create texture for the cache.
-	stash->itw = 1.0f/stash->params.width;
-	stash->ith = 1.0f/stash->params.height;
-	stash->texData = (unsigned char*)malloc(stash->params.width * stash->params.height);
-	if (stash->texData == NULL) goto error;
-	memset(stash->texData, 0, stash->params.width * stash->params.height);
-
-	stash->dirtyRect[0] = stash->params.width;
-	stash->dirtyRect[1] = stash->params.height;
-	stash->dirtyRect[2] = 0;
-	stash->dirtyRect[3] = 0;
-
 	// Add white rect at 0,0 for debug drawing.
 	fons__addWhiteRect(stash, 2,2);
 
@@ -988,7 +1136,8 @@ error:
 int fonsGetFontByName(FONScontext* s, const char* name)
 {
 	int i;
-	for (i = 0; i < s->nfonts; i++) {
+	// Newest first, so a font added again under the same name replaces the old one
+	for (i = s->nfonts - 1; i >= 0; i--) {
 		if (strcmp(s->fonts[i]->name, name) == 0)
 			return i;
 	}
@@ -1013,7 +1162,21 @@ static FONSglyph* fons__allocGlyph(FONSfont* font)
 #define APREC 16
 #define ZPREC 7
 
-static void fons__blurCols(unsigned char* dst, int w, int h, int dstStride, int alpha)
+// The blur runs a one pole filter forward and back along each row and column. The filter is serial
+// along its direction, so the SIMD kernels filter neighbouring columns together, one lane each, and
+// rows are filtered as columns of a transposed strip. Lanes hold z in 16 bits, which fits as
+// z <= 255 << ZPREC, and alpha * d >> APREC is found from the high half of a 16 bit multiply:
+// with alpha >= 1 << 15 stored as alpha - (1 << 16), it is mulhi(alpha, d) + d. This gives the same
+// bits as the scalar code.
+
+enum FONSsimdLevel {
+	FONS_SIMD_NONE = 0,
+	FONS_SIMD_SSE2 = 1,
+	FONS_SIMD_NEON = 2,
+	FONS_SIMD_AVX2 = 3,
+};
+
+static void fons__blurColsScalar(unsigned char* dst, int w, int h, int dstStride, int alpha)
 {
 	int x, y;
 	for (y = 0; y < h; y++) {
@@ -1033,7 +1196,7 @@ static void fons__blurCols(unsigned char* dst, int w, int h, int dstStride, int
 	}
 }
 
-static void fons__blurRows(unsigned char* dst, int w, int h, int dstStride, int alpha)
+static void fons__blurRowsScalar(unsigned char* dst, int w, int h, int dstStride, int alpha)
 {
 	int x, y;
 	for (x = 0; x < w; x++) {
@@ -1053,11 +1216,218 @@ static void fons__blurRows(unsigned char* dst, int w, int h, int dstStride, int
 	}
 }
 
+#ifdef FONS_SSE2
+// Filters columns 8 at a time, returning how many were done
+static int fons__blurRowsSSE2(unsigned char* dst, int w, int h, int dstStride, int alpha)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i a = _mm_set1_epi16((short)(alpha >= (1<<15) ? alpha - (1<<APREC) : alpha));
+	const __m128i dmask = _mm_set1_epi16(alpha >= (1<<15) ? -1 : 0);
+	int x, y, n = w & ~7;
+	for (x = 0; x < n; x += 8) {
+		unsigned char* col = dst + x;
+		__m128i z = zero; // force zero border
+		for (y = 1; y < h; y++) {
+			__m128i* p = (__m128i*)&col[y*dstStride];
+			__m128i d = _mm_sub_epi16(_mm_slli_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(p), zero), ZPREC), z);
+			z = _mm_add_epi16(z, _mm_add_epi16(_mm_mulhi_epi16(a, d), _mm_and_si128(d, dmask)));
+			_mm_storel_epi64(p, _mm_packus_epi16(_mm_srli_epi16(z, ZPREC), zero));
+		}
+		_mm_storel_epi64((__m128i*)&col[(h-1)*dstStride], zero); // force zero border
+		z = zero;
+		for (y = h-2; y >= 0; y--) {
+			__m128i* p = (__m128i*)&col[y*dstStride];
+			__m128i d = _mm_sub_epi16(_mm_slli_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(p), zero), ZPREC), z);
+			z = _mm_add_epi16(z, _mm_add_epi16(_mm_mulhi_epi16(a, d), _mm_and_si128(d, dmask)));
+			_mm_storel_epi64(p, _mm_packus_epi16(_mm_srli_epi16(z, ZPREC), zero));
+		}
+		_mm_storel_epi64((__m128i*)col, zero); // force zero border
+	}
+	return n;
+}
+#endif
 
+#ifdef FONS_AVX2
+// Filters columns 16 at a time, returning how many were done
+FONS_AVX2_TARGET static int fons__blurRowsAVX2(unsigned char* dst, int w, int h, int dstStride, int alpha)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i a = _mm256_set1_epi16((short)(alpha >= (1<<15) ? alpha - (1<<APREC) : alpha));
+	const __m256i dmask = _mm256_set1_epi16(alpha >= (1<<15) ? -1 : 0);
+	int x, y, n = w & ~15;
+	for (x = 0; x < n; x += 16) {
+		unsigned char* col = dst + x;
+		__m256i z = zero, v; // force zero border
+		for (y = 1; y < h; y++) {
+			__m128i* p = (__m128i*)&col[y*dstStride];
+			__m256i d = _mm256_sub_epi16(_mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(p)), ZPREC), z);
+			z = _mm256_add_epi16(z, _mm256_add_epi16(_mm256_mulhi_epi16(a, d), _mm256_and_si256(d, dmask)));
+			v = _mm256_srli_epi16(z, ZPREC);
+			_mm_storeu_si128(p, _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+		}
+		_mm_storeu_si128((__m128i*)&col[(h-1)*dstStride], _mm_setzero_si128()); // force zero border
+		z = zero;
+		for (y = h-2; y >= 0; y--) {
+			__m128i* p = (__m128i*)&col[y*dstStride];
+			__m256i d = _mm256_sub_epi16(_mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(p)), ZPREC), z);
+			z = _mm256_add_epi16(z, _mm256_add_epi16(_mm256_mulhi_epi16(a, d), _mm256_and_si256(d, dmask)));
+			v = _mm256_srli_epi16(z, ZPREC);
+			_mm_storeu_si128(p, _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+		}
+		_mm_storeu_si128((__m128i*)col, _mm_setzero_si128()); // force zero border
+	}
+	return n;
+}
+
+static int fons__cpuHasAVX2(void)
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return 0;
+	// The OS must save the AVX registers
+	__cpuid(info, 1);
+	if ((info[2] & (1<<27)) == 0 || (info[2] & (1<<28)) == 0 || (_xgetbv(0) & 6) != 6)
+		return 0;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1<<5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef FONS_NEON
+// Filters columns 8 at a time, returning how many were done
+static int fons__blurRowsNEON(unsigned char* dst, int w, int h, int dstStride, int alpha)
+{
+	const int16x8_t zero = vdupq_n_s16(0);
+	const int16x4_t a = vdup_n_s16((short)(alpha >= (1<<15) ? alpha - (1<<APREC) : alpha));
+	const int16x8_t dmask = vdupq_n_s16(alpha >= (1<<15) ? -1 : 0);
+	int x, y, n = w & ~7;
+	for (x = 0; x < n; x += 8) {
+		unsigned char* col = dst + x;
+		int16x8_t z = zero, d, m; // force zero border
+		for (y = 1; y < h; y++) {
+			unsigned char* p = &col[y*dstStride];
+			d = vsubq_s16(vshlq_n_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p))), ZPREC), z);
+			m = vcombine_s16(vshrn_n_s32(vmull_s16(a, vget_low_s16(d)), APREC), vshrn_n_s32(vmull_s16(a, vget_high_s16(d)), APREC));
+			z = vaddq_s16(z, vaddq_s16(m, vandq_s16(d, dmask)));
+			vst1_u8(p, vqmovun_s16(vshrq_n_s16(z, ZPREC)));
+		}
+		vst1_u8(&col[(h-1)*dstStride], vdup_n_u8(0)); // force zero border
+		z = zero;
+		for (y = h-2; y >= 0; y--) {
+			unsigned char* p = &col[y*dstStride];
+			d = vsubq_s16(vshlq_n_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p))), ZPREC), z);
+			m = vcombine_s16(vshrn_n_s32(vmull_s16(a, vget_low_s16(d)), APREC), vshrn_n_s32(vmull_s16(a, vget_high_s16(d)), APREC));
+			z = vaddq_s16(z, vaddq_s16(m, vandq_s16(d, dmask)));
+			vst1_u8(p, vqmovun_s16(vshrq_n_s16(z, ZPREC)));
+		}
+		vst1_u8(col, vdup_n_u8(0)); // force zero border
+	}
+	return n;
+}
+#endif
+
+static int fons__simdLevel(void)
+{
+	// Detection always gives the same answer, so threads racing to store it is harmless
+	static int level = -1;
+	if (level < 0) {
+#if defined(FONS_AVX2)
+		level = fons__cpuHasAVX2() ? FONS_SIMD_AVX2 : FONS_SIMD_SSE2;
+#elif defined(FONS_SSE2)
+		level = FONS_SIMD_SSE2;
+#elif defined(FONS_NEON)
+		level = FONS_SIMD_NEON;
+#else
+		level = FONS_SIMD_NONE;
+#endif
+	}
+	return level;
+}
+
+// Number of columns the kernel at a SIMD level filters together
+static int fons__simdLanes(int level)
+{
+	switch (level) {
+	case FONS_SIMD_SSE2: return 8;
+	case FONS_SIMD_NEON: return 8;
+	case FONS_SIMD_AVX2: return 16;
+	default: return 1;
+	}
+}
+
+// Level used for what is left over when a kernel's lanes don't divide the bitmap
+static int fons__simdFallback(int level)
+{
+	return level == FONS_SIMD_AVX2 ? FONS_SIMD_SSE2 : FONS_SIMD_NONE;
+}
+
+static void fons__blurRowsLevel(unsigned char* dst, int w, int h, int dstStride, int alpha, int level)
+{
+	int n = 0;
+	switch (level) {
+#ifdef FONS_SSE2
+	case FONS_SIMD_SSE2: n = fons__blurRowsSSE2(dst, w, h, dstStride, alpha); break;
+#endif
+#ifdef FONS_AVX2
+	case FONS_SIMD_AVX2: n = fons__blurRowsAVX2(dst, w, h, dstStride, alpha); break;
+#endif
+#ifdef FONS_NEON
+	case FONS_SIMD_NEON: n = fons__blurRowsNEON(dst, w, h, dstStride, alpha); break;
+#endif
+	default:
+		fons__blurRowsScalar(dst, w, h, dstStride, alpha);
+		return;
+	}
+	if (n < w)
+		fons__blurRowsLevel(dst + n, w - n, h, dstStride, alpha, fons__simdFallback(level));
+}
+
+// Filters rows as columns of a transposed strip, one row per lane. tmp holds lanes * w bytes.
+static void fons__blurColsLevel(unsigned char* dst, int w, int h, int dstStride, int alpha, int level, unsigned char* tmp)
+{
+	int lanes = fons__simdLanes(level);
+	int x, y, i;
+	if (tmp == NULL || lanes == 1) {
+		fons__blurColsScalar(dst, w, h, dstStride, alpha);
+		return;
+	}
+	for (y = 0; y + lanes <= h; y += lanes) {
+		unsigned char* row = &dst[y*dstStride];
+		for (i = 0; i < lanes; i++)
+			for (x = 0; x < w; x++)
+				tmp[x*lanes + i] = row[i*dstStride + x];
+		fons__blurRowsLevel(tmp, lanes, w, lanes, alpha, level);
+		for (i = 0; i < lanes; i++)
+			for (x = 0; x < w; x++)
+				row[i*dstStride + x] = tmp[x*lanes + i];
+	}
+	if (y < h)
+		fons__blurColsLevel(dst + y*dstStride, w, h - y, dstStride, alpha, fons__simdFallback(level), tmp);
+}
+
+static void fons__blurCols(unsigned char* dst, int w, int h, int dstStride, int alpha, unsigned char* tmp)
+{
+	fons__blurColsLevel(dst, w, h, dstStride, alpha, fons__simdLevel(), tmp);
+}
+
+static void fons__blurRows(unsigned char* dst, int w, int h, int dstStride, int alpha)
+{
+	fons__blurRowsLevel(dst, w, h, dstStride, alpha, fons__simdLevel());
+}
+
+// May be called from several threads at once, when glyphs are rasterized in parallel
 static void fons__blur(FONScontext* stash, unsigned char* dst, int w, int h, int dstStride, int blur)
 {
 	int alpha;
 	float sigma;
+	unsigned char* tmp = NULL;
+	int lanes = fons__simdLanes(fons__simdLevel());
 	(void)stash;
 
 	if (blur < 1)
@@ -1065,26 +1435,215 @@ static void fons__blur(FONScontext* stash, unsigned char* dst, int w, int h, int
 	// Calculate the alpha such that 90% of the kernel is within the radius. (Kernel extends to infinity)
 	sigma = (float)blur * 0.57735f; // 1 / sqrt(3)
 	alpha = (int)((1<<APREC) * (1.0f - expf(-2.3f / (sigma+1.0f))));
+	// Strip for filtering rows, the scalar path is used if it can't be allocated
+	if (lanes > 1)
+		tmp = (unsigned char*)malloc(lanes * w);
 	fons__blurRows(dst, w, h, dstStride, alpha);
-	fons__blurCols(dst, w, h, dstStride, alpha);
+	fons__blurCols(dst, w, h, dstStride, alpha, tmp);
 	fons__blurRows(dst, w, h, dstStride, alpha);
-	fons__blurCols(dst, w, h, dstStride, alpha);
+	fons__blurCols(dst, w, h, dstStride, alpha, tmp);
+	free(tmp);
 //	fons__blurrows(dst, w, h, dstStride, alpha);
 //	fons__blurcols(dst, w, h, dstStride, alpha);
 }
 
+static FONSglyph* fons__findGlyph(FONSfont* font, unsigned int codepoint, short isize, short iblur)
+{
+	int i = font->lut[fons__hashint(codepoint) & (FONS_HASH_LUT_SIZE-1)];
+	while (i != -1) {
+		if (font->glyphs[i].codepoint == codepoint && font->glyphs[i].size == isize && font->glyphs[i].blur == iblur)
+			return &font->glyphs[i];
+		i = font->glyphs[i].next;
+	}
+	return NULL;
+}
+
+static void fons__touchGlyph(FONScontext* stash, FONSglyph* glyph)
+{
+	glyph->lastUsed = stash->frame;
+	stash->pages[glyph->page].lastUsed = stash->frame;
+}
+
+// Finds the page to evict. Of the pages not drawn from this frame, picks the one with the least
+// of its area taken by glyphs drawn in the last FONS_WARM_FRAMES, then the one drawn from longest ago.
+static int fons__coldestPage(FONScontext* stash)
+{
+	float warm[FONS_MAX_PAGES];
+	int i, j, best = -1;
+
+	for (i = 0; i < stash->npages; i++)
+		warm[i] = 0;
+	for (i = 0; i < stash->nfonts; i++) {
+		FONSfont* font = stash->fonts[i];
+		for (j = 0; j < font->nglyphs; j++) {
+			FONSglyph* glyph = &font->glyphs[j];
+			if (glyph->page >= 0 && stash->frame - glyph->lastUsed < FONS_WARM_FRAMES)
+				warm[glyph->page] += (float)((glyph->x1-glyph->x0) * (glyph->y1-glyph->y0));
+		}
+	}
+
+	for (i = 0; i < stash->npages; i++) {
+		FONSpage* page = &stash->pages[i];
+		// Quads drawn this frame may not have reached the renderer yet.
+		if (page->lastUsed == stash->frame)
+			continue;
+		warm[i] /= (float)(page->width * page->height);
+		if (best == -1 || warm[i] < warm[best] || (warm[i] == warm[best] && page->lastUsed < stash->pages[best].lastUsed))
+			best = i;
+	}
+	return best;
+}
+
+// Drops the glyphs of a page and clears it for reuse. Glyphs on other pages keep their bitmaps.
+static void fons__evictPage(FONScontext* stash, int p)
+{
+	int i, j, k;
+	FONSpage* page = &stash->pages[p];
+
+	for (i = 0; i < stash->nfonts; i++) {
+		FONSfont* font = stash->fonts[i];
+		for (j = k = 0; j < font->nglyphs; j++) {
+			if (font->glyphs[j].page != p)
+				font->glyphs[k++] = font->glyphs[j];
+		}
+		if (k == font->nglyphs)
+			continue;
+		stash->stats.evictedGlyphs += font->nglyphs - k;
+		font->nglyphs = k;
+
+		// Rebuild the lookup, newest first in each chain as when the glyphs were added.
+		for (j = 0; j < FONS_HASH_LUT_SIZE; j++)
+			font->lut[j] = -1;
+		for (j = 0; j < font->nglyphs; j++) {
+			unsigned int h = fons__hashint(font->glyphs[j].codepoint) & (FONS_HASH_LUT_SIZE-1);
+			font->glyphs[j].next = font->lut[h];
+			font->lut[h] = j;
+		}
+	}
+
+	fons__atlasReset(page->atlas, page->width, page->height);
+	memset(page->texData, 0, page->width * page->height);
+	fons__resetDirtyRect(page);
+	page->lastUsed = 0;
+	page->usedArea = 0;
+	page->nglyphs = 0;
+	stash->stats.evictions++;
+
+	// Add white rect at 0,0 for debug drawing.
+	if (p == 0)
+		fons__addWhiteRect(stash, 2,2);
+}
+
+// Finds a spot for a glyph bitmap. With more than one page allowed, a page is added when all
+// are full, or once at the limit the coldest page is evicted. Returns the page, or -1 if full.
+static int fons__allocGlyphRect(FONScontext* stash, int w, int h, int* x, int* y)
+{
+	int i;
+
+	for (i = 0; i < stash->npages; i++) {
+		if (fons__atlasAddRect(stash->pages[i].atlas, w, h, x, y))
+			return i;
+	}
+
+	if (stash->maxPages > 1 && w <= stash->params.maxPageSize && h <= stash->params.maxPageSize) {
+		if (stash->npages < stash->maxPages) {
+			// Each page is twice the size of the last.
+			FONSpage* last = &stash->pages[stash->npages-1];
+			int pw = last->width, ph = last->height;
+			if (pw > ph)
+				ph *= 2;
+			else
+				pw *= 2;
+			pw = fons__mini(pw, stash->params.maxPageSize);
+			ph = fons__mini(ph, stash->params.maxPageSize);
+			if (fons__initPage(&stash->pages[stash->npages], pw, ph)) {
+				i = stash->npages++;
+				if (fons__atlasAddRect(stash->pages[i].atlas, w, h, x, y))
+					return i;
+			}
+		}
+		i = fons__coldestPage(stash);
+		if (i != -1) {
+			fons__evictPage(stash, i);
+			if (fons__atlasAddRect(stash->pages[i].atlas, w, h, x, y))
+				return i;
+		}
+	}
+
+	if (stash->handleError != NULL) {
+		// Atlas is full, let the user to resize the atlas (or not), and try again.
+		stash->handleError(stash->errorUptr, FONS_ATLAS_FULL, 0);
+		if (fons__atlasAddRect(stash->pages[0].atlas, w, h, x, y))
+			return 0;
+	}
+	return -1;
+}
+
+// Finds a code point's glyph index in a font or its fallbacks, and the font it was found in.
+static int fons__getGlyphIndex(FONScontext* stash, FONSfont* font, unsigned int codepoint, int* renderFont)
+{
+	int i, g = fons__tt_getGlyphIndex(&font->font, codepoint);
+	// Try to find the glyph in fallback fonts.
+	if (g == 0) {
+		for (i = 0; i < font->nfallbacks; ++i) {
+			FONSfont* fallbackFont = stash->fonts[font->fallbacks[i]];
+			int fallbackIndex = fons__tt_getGlyphIndex(&fallbackFont->font, codepoint);
+			if (fallbackIndex != 0) {
+				*renderFont = font->fallbacks[i];
+				return fallbackIndex;
+			}
+		}
+		// It is possible that we did not find a fallback glyph.
+		// In that case the glyph index 'g' is 0, and we'll proceed below and cache empty glyph.
+	}
+	return g;
+}
+
+static FONSglyph* fons__addGlyph(FONSfont* font, unsigned int codepoint, short isize, short iblur)
+{
+	unsigned int h = fons__hashint(codepoint) & (FONS_HASH_LUT_SIZE-1);
+	FONSglyph* glyph = fons__allocGlyph(font);
+	if (glyph == NULL) return NULL;
+	glyph->codepoint = codepoint;
+	glyph->size = isize;
+	glyph->blur = iblur;
+
+	// Insert char to hash lookup.
+	glyph->next = font->lut[h];
+	font->lut[h] = font->nglyphs-1;
+	return glyph;
+}
+
+// Clears the border of a rasterized glyph and blurs it.
+static void fons__finishGlyphBitmap(FONScontext* stash, unsigned char* dst, int gw, int gh, int stride, int iblur)
+{
+	int y;
+
+	// Make sure there is one pixel empty border.
+	memset(dst, 0, gw);
+	memset(dst + (gh-1)*stride, 0, gw);
+	for (y = 1; y < gh-1; y++) {
+		dst[y*stride] = 0;
+		dst[gw-1 + y*stride] = 0;
+	}
+
+	// Blur
+	if (iblur > 0)
+		fons__blur(stash, dst, gw, gh, stride, iblur);
+}
+
 static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned int codepoint,
 								 short isize, short iblur, int bitmapOption)
 {
-	int i, g, advance, lsb, x0, y0, x1, y1, gw, gh, gx, gy, x, y;
+	int g, advance, lsb, x0, y0, x1, y1, gw, gh, gx, gy;
 	float scale;
 	FONSglyph* glyph = NULL;
-	unsigned int h;
+	FONSpage* page;
 	float size = isize/10.0f;
-	int pad, added;
-	unsigned char* bdst;
+	int pad, p = -1;
 	unsigned char* dst;
-	FONSfont* renderFont = font;
+	FONSfont* renderFont;
+	int renderIndex = -1;
 
 	if (isize < 2) return NULL;
 	if (iblur > 20) iblur = 20;
@@ -1094,36 +1653,23 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	stash->nscratch = 0;
 
 	// Find code point and size.
-	h = fons__hashint(codepoint) & (FONS_HASH_LUT_SIZE-1);
-	i = font->lut[h];
-	while (i != -1) {
-		if (font->glyphs[i].codepoint == codepoint && font->glyphs[i].size == isize && font->glyphs[i].blur == iblur) {
-			glyph = &font->glyphs[i];
-			if (bitmapOption == FONS_GLYPH_BITMAP_OPTIONAL || (glyph->x0 >= 0 && glyph->y0 >= 0)) {
-			  return glyph;
-			}
-			// At this point, glyph exists but the bitmap data is not yet created.
-			break;
+	glyph = fons__findGlyph(font, codepoint, isize, iblur);
+	if (bitmapOption == FONS_GLYPH_BITMAP_REQUIRED)
+		stash->stats.lookups++;
+	if (glyph != NULL) {
+		if (bitmapOption == FONS_GLYPH_BITMAP_OPTIONAL)
+			return glyph;
+		if (glyph->page >= 0) {
+			stash->stats.hits++;
+			fons__touchGlyph(stash, glyph);
+			return glyph;
 		}
-		i = font->glyphs[i].next;
+		// At this point, glyph exists but the bitmap data is not yet created.
 	}
 
 	// Create a new glyph or rasterize bitmap data for a cached glyph.
-	g = fons__tt_getGlyphIndex(&font->font, codepoint);
-	// Try to find the glyph in fallback fonts.
-	if (g == 0) {
-		for (i = 0; i < font->nfallbacks; ++i) {
-			FONSfont* fallbackFont = stash->fonts[font->fallbacks[i]];
-			int fallbackIndex = fons__tt_getGlyphIndex(&fallbackFont->font, codepoint);
-			if (fallbackIndex != 0) {
-				g = fallbackIndex;
-				renderFont = fallbackFont;
-				break;
-			}
-		}
-		// It is possible that we did not find a fallback glyph.
-		// In that case the glyph index 'g' is 0, and we'll proceed below and cache empty glyph.
-	}
+	g = fons__getGlyphIndex(stash, font, codepoint, &renderIndex);
+	renderFont = renderIndex >= 0 ? stash->fonts[renderIndex] : font;
 	scale = fons__tt_getPixelHeightScale(&renderFont->font, size);
 	fons__tt_buildGlyphBitmap(&renderFont->font, g, size, scale, &advance, &lsb, &x0, &y0, &x1, &y1);
 	gw = x1-x0 + pad*2;
@@ -1131,14 +1677,13 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 
 	// Determines the spot to draw glyph in the atlas.
 	if (bitmapOption == FONS_GLYPH_BITMAP_REQUIRED) {
+		int evictions = stash->stats.evictions;
 		// Find free spot for the rect in the atlas
-		added = fons__atlasAddRect(stash->atlas, gw, gh, &gx, &gy);
-		if (added == 0 && stash->handleError != NULL) {
-			// Atlas is full, let the user to resize the atlas (or not), and try again.
-			stash->handleError(stash->errorUptr, FONS_ATLAS_FULL, 0);
-			added = fons__atlasAddRect(stash->atlas, gw, gh, &gx, &gy);
-		}
-		if (added == 0) return NULL;
+		p = fons__allocGlyphRect(stash, gw, gh, &gx, &gy);
+		if (p == -1) return NULL;
+		// Evicting a page moves the remaining glyphs.
+		if (glyph != NULL && stash->stats.evictions != evictions)
+			glyph = fons__findGlyph(font, codepoint, isize, iblur);
 	} else {
 		// Negative coordinate indicates there is no bitmap data created.
 		gx = -1;
@@ -1146,17 +1691,8 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	}
 
 	// Init glyph.
-	if (glyph == NULL) {
-		glyph = fons__allocGlyph(font);
-		glyph->codepoint = codepoint;
-		glyph->size = isize;
-		glyph->blur = iblur;
-		glyph->next = 0;
-
-		// Insert char to hash lookup.
-		glyph->next = font->lut[h];
-		font->lut[h] = font->nglyphs-1;
-	}
+	if (glyph == NULL)
+		glyph = fons__addGlyph(font, codepoint, isize, iblur);
 	glyph->index = g;
 	glyph->x0 = (short)gx;
 	glyph->y0 = (short)gy;
@@ -1165,47 +1701,37 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	glyph->xadv = (short)(scale * advance * 10.0f);
 	glyph->xoff = (short)(x0 - pad);
 	glyph->yoff = (short)(y0 - pad);
+	glyph->page = (short)p;
+	glyph->lastUsed = 0;
 
 	if (bitmapOption == FONS_GLYPH_BITMAP_OPTIONAL) {
 		return glyph;
 	}
 
-	// Rasterize
-	dst = &stash->texData[(glyph->x0+pad) + (glyph->y0+pad) * stash->params.width];
-	fons__tt_renderGlyphBitmap(&renderFont->font, dst, gw-pad*2,gh-pad*2, stash->params.width, scale, scale, g);
+	page = &stash->pages[p];
+	page->usedArea += gw*gh;
+	page->nglyphs++;
+	stash->stats.rasterized++;
+	fons__touchGlyph(stash, glyph);
 
-	// Make sure there is one pixel empty border.
-	dst = &stash->texData[glyph->x0 + glyph->y0 * stash->params.width];
-	for (y = 0; y < gh; y++) {
-		dst[y*stash->params.width] = 0;
-		dst[gw-1 + y*stash->params.width] = 0;
-	}
-	for (x = 0; x < gw; x++) {
-		dst[x] = 0;
-		dst[x + (gh-1)*stash->params.width] = 0;
-	}
+	// Rasterize
+	dst = &page->texData[(glyph->x0+pad) + (glyph->y0+pad) * page->width];
+	fons__tt_renderGlyphBitmap(&renderFont->font, dst, gw-pad*2,gh-pad*2, page->width, scale, scale, g);
 
 	// Debug code to color the glyph background
-/*	unsigned char* fdst = &stash->texData[glyph->x0 + glyph->y0 * stash->params.width];
+/*	unsigned char* fdst = &page->texData[glyph->x0 + glyph->y0 * page->width];
 	for (y = 0; y < gh; y++) {
 		for (x = 0; x < gw; x++) {
-			int a = (int)fdst[x+y*stash->params.width] + 20;
+			int a = (int)fdst[x+y*page->width] + 20;
 			if (a > 255) a = 255;
-			fdst[x+y*stash->params.width] = a;
+			fdst[x+y*page->width] = a;
 		}
 	}*/
 
-	// Blur
-	if (iblur > 0) {
-		stash->nscratch = 0;
-		bdst = &stash->texData[glyph->x0 + glyph->y0 * stash->params.width];
-		fons__blur(stash, bdst, gw, gh, stash->params.width, iblur);
-	}
+	stash->nscratch = 0;
+	fons__finishGlyphBitmap(stash, &page->texData[glyph->x0 + glyph->y0 * page->width], gw, gh, page->width, iblur);
 
-	stash->dirtyRect[0] = fons__mini(stash->dirtyRect[0], glyph->x0);
-	stash->dirtyRect[1] = fons__mini(stash->dirtyRect[1], glyph->y0);
-	stash->dirtyRect[2] = fons__maxi(stash->dirtyRect[2], glyph->x1);
-	stash->dirtyRect[3] = fons__maxi(stash->dirtyRect[3], glyph->y1);
+	fons__addDirtyRect(page, glyph->x0, glyph->y0, glyph->x1, glyph->y1);
 
 	return glyph;
 }
@@ -1215,6 +1741,7 @@ static void fons__getQuad(FONScontext* stash, FONSfont* font,
 						   float scale, float spacing, float* x, float* y, FONSquad* q)
 {
 	float rx,ry,xoff,yoff,x0,y0,x1,y1;
+	FONSpage* page = &stash->pages[glyph->page >= 0 ? glyph->page : 0];
 
 	if (prevGlyphIndex != -1) {
 		float adv = fons__tt_getGlyphKernAdvance(&font->font, prevGlyphIndex, glyph->index) * scale;
@@ -1240,10 +1767,10 @@ static void fons__getQuad(FONScontext* stash, FONSfont* font,
 		q->x1 = rx + x1 - x0;
 		q->y1 = ry + y1 - y0;
 
-		q->s0 = x0 * stash->itw;
-		q->t0 = y0 * stash->ith;
-		q->s1 = x1 * stash->itw;
-		q->t1 = y1 * stash->ith;
+		q->s0 = x0 * page->itw;
+		q->t0 = y0 * page->ith;
+		q->s1 = x1 * page->itw;
+		q->t1 = y1 * page->ith;
 	} else {
 		rx = floorf(*x + xoff);
 		ry = floorf(*y - yoff);
@@ -1253,10 +1780,10 @@ static void fons__getQuad(FONScontext* stash, FONSfont* font,
 		q->x1 = rx + x1 - x0;
 		q->y1 = ry - y1 + y0;
 
-		q->s0 = x0 * stash->itw;
-		q->t0 = y0 * stash->ith;
-		q->s1 = x1 * stash->itw;
-		q->t1 = y1 * stash->ith;
+		q->s0 = x0 * page->itw;
+		q->t0 = y0 * page->ith;
+		q->s1 = x1 * page->itw;
+		q->t1 = y1 * page->ith;
 	}
 
 	*x += (int)(glyph->xadv / 10.0f + 0.5f);
@@ -1264,15 +1791,13 @@ static void fons__getQuad(FONScontext* stash, FONSfont* font,
 
 static void fons__flush(FONScontext* stash)
 {
-	// Flush texture
-	if (stash->dirtyRect[0] < stash->dirtyRect[2] && stash->dirtyRect[1] < stash->dirtyRect[3]) {
+	// Flush texture, the render callbacks only have the first page
+	FONSpage* page = &stash->pages[0];
+	if (page->dirtyRect[0] < page->dirtyRect[2] && page->dirtyRect[1] < page->dirtyRect[3]) {
 		if (stash->params.renderUpdate != NULL)
-			stash->params.renderUpdate(stash->params.userPtr, stash->dirtyRect, stash->texData);
+			stash->params.renderUpdate(stash->params.userPtr, page->dirtyRect, page->texData);
 		// Reset dirty rect
-		stash->dirtyRect[0] = stash->params.width;
-		stash->dirtyRect[1] = stash->params.height;
-		stash->dirtyRect[2] = 0;
-		stash->dirtyRect[3] = 0;
+		fons__resetDirtyRect(page);
 	}
 
 	// Flush triangles
@@ -1425,6 +1950,7 @@ int fonsTextIterInit(FONScontext* stash, FONStextIter* iter,
 	iter->codepoint = 0;
 	iter->prevGlyphIndex = -1;
 	iter->bitmapOption = bitmapOption;
+	iter->page = -1;
 
 	return 1;
 }
@@ -1450,6 +1976,7 @@ int fonsTextIterNext(FONScontext* stash, FONStextIter* iter, FONSquad* quad)
 		if (glyph != NULL)
 			fons__getQuad(stash, iter->font, iter->prevGlyphIndex, glyph, iter->scale, iter->spacing, &iter->nextx, &iter->nexty, quad);
 		iter->prevGlyphIndex = glyph != NULL ? glyph->index : -1;
+		iter->page = glyph != NULL ? glyph->page : -1;
 		break;
 	}
 	iter->next = str;
@@ -1460,6 +1987,7 @@ int fonsTextIterNext(FONScontext* stash, FONStextIter* iter, FONSquad* quad)
 void fonsDrawDebug(FONScontext* stash, float x, float y)
 {
 	int i;
+	FONSatlas* atlas = stash->pages[0].atlas;
 	int w = stash->params.width;
 	int h = stash->params.height;
 	float u = w == 0 ? 0 : (1.0f / w);
@@ -1487,8 +2015,8 @@ void fonsDrawDebug(FONScontext* stash, float x, float y)
 	fons__vertex(stash, x+w, y+h, 1, 1, 0xffffffff);
 
 	// Drawbug draw atlas
-	for (i = 0; i < stash->atlas->nnodes; i++) {
-		FONSatlasNode* n = &stash->atlas->nodes[i];
+	for (i = 0; i < atlas->nnodes; i++) {
+		FONSatlasNode* n = &atlas->nodes[i];
 
 		if (stash->nverts+6 > FONS_VERTEX_COUNT)
 			fons__flush(stash);
@@ -1628,30 +2156,170 @@ void fonsLineBounds(FONScontext* stash, float y, float* miny, float* maxy)
 
 const unsigned char* fonsGetTextureData(FONScontext* stash, int* width, int* height)
 {
+	return fonsGetPageData(stash, 0, width, height);
+}
+
+int fonsValidateTexture(FONScontext* stash, int* dirty)
+{
+	return fonsValidatePage(stash, 0, dirty);
+}
+
+int fonsGetPageCount(FONScontext* stash)
+{
+	return stash->npages;
+}
+
+const unsigned char* fonsGetPageData(FONScontext* stash, int page, int* width, int* height)
+{
+	if (page < 0 || page >= stash->npages) return NULL;
 	if (width != NULL)
-		*width = stash->params.width;
+		*width = stash->pages[page].width;
 	if (height != NULL)
-		*height = stash->params.height;
-	return stash->texData;
+		*height = stash->pages[page].height;
+	return stash->pages[page].texData;
 }
 
-int fonsValidateTexture(FONScontext* stash, int* dirty)
+int fonsValidatePage(FONScontext* stash, int page, int* dirty)
 {
-	if (stash->dirtyRect[0] < stash->dirtyRect[2] && stash->dirtyRect[1] < stash->dirtyRect[3]) {
-		dirty[0] = stash->dirtyRect[0];
-		dirty[1] = stash->dirtyRect[1];
-		dirty[2] = stash->dirtyRect[2];
-		dirty[3] = stash->dirtyRect[3];
+	FONSpage* p;
+	if (page < 0 || page >= stash->npages) return 0;
+	p = &stash->pages[page];
+	if (p->dirtyRect[0] < p->dirtyRect[2] && p->dirtyRect[1] < p->dirtyRect[3]) {
+		dirty[0] = p->dirtyRect[0];
+		dirty[1] = p->dirtyRect[1];
+		dirty[2] = p->dirtyRect[2];
+		dirty[3] = p->dirtyRect[3];
 		// Reset dirty rect
-		stash->dirtyRect[0] = stash->params.width;
-		stash->dirtyRect[1] = stash->params.height;
-		stash->dirtyRect[2] = 0;
-		stash->dirtyRect[3] = 0;
+		fons__resetDirtyRect(p);
 		return 1;
 	}
 	return 0;
 }
 
+void fonsBeginFrame(FONScontext* stash)
+{
+	if (stash == NULL) return;
+	stash->frame++;
+}
+
+void fonsGetAtlasStats(FONScontext* stash, FONSatlasStats* stats)
+{
+	int i;
+	if (stash == NULL) return;
+	*stats = stash->stats;
+	stats->npages = stash->npages;
+	stats->usedArea = 0;
+	stats->totalArea = 0;
+	for (i = 0; i < stash->npages; i++) {
+		stats->usedArea += stash->pages[i].usedArea;
+		stats->totalArea += stash->pages[i].width * stash->pages[i].height;
+	}
+}
+
+int fonsPrepareGlyph(FONScontext* stash, int font, unsigned int codepoint, float size, float blur, FONSstagedGlyph* bitmap)
+{
+	FONSfont* f;
+	FONSfont* renderFont;
+	FONSglyph* glyph;
+	short isize = (short)(size*10.0f);
+	short iblur = (short)blur;
+	int lsb, x0, y0, x1, y1, pad;
+
+	if (stash == NULL || font < 0 || font >= stash->nfonts) return 0;
+	f = stash->fonts[font];
+	if (f->data == NULL) return 0;
+	if (isize < 2) return 0;
+	if (iblur > 20) iblur = 20;
+	pad = iblur+2;
+
+	glyph = fons__findGlyph(f, codepoint, isize, iblur);
+	if (glyph != NULL && glyph->page >= 0)
+		return 0;
+
+	memset(bitmap, 0, sizeof(FONSstagedGlyph));
+	bitmap->font = font;
+	bitmap->renderFont = font;
+	bitmap->codepoint = codepoint;
+	bitmap->isize = isize;
+	bitmap->iblur = iblur;
+	bitmap->index = fons__getGlyphIndex(stash, f, codepoint, &bitmap->renderFont);
+	renderFont = stash->fonts[bitmap->renderFont];
+
+	// Same measurements as fons__getGlyph, so the glyph is as if drawn
+	bitmap->scale = fons__tt_getPixelHeightScale(&renderFont->font, isize/10.0f);
+	fons__tt_buildGlyphBitmap(&renderFont->font, bitmap->index, isize/10.0f, bitmap->scale, &bitmap->advance, &lsb, &x0, &y0, &x1, &y1);
+	bitmap->xoff = x0 - pad;
+	bitmap->yoff = y0 - pad;
+	bitmap->width = x1-x0 + pad*2;
+	bitmap->height = y1-y0 + pad*2;
+	return 1;
+}
+
+void fonsRasterizeGlyph(FONScontext* stash, FONSstagedGlyph* bitmap)
+{
+	int pad = bitmap->iblur+2;
+	FONSttFontImpl font = stash->fonts[bitmap->renderFont]->font;
+
+#ifdef FONS_USE_FREETYPE
+	{
+		// FreeType renders into the face's glyph slot when the glyph is loaded
+		int advance, lsb, x0, y0, x1, y1;
+		fons__tt_buildGlyphBitmap(&font, bitmap->index, bitmap->isize/10.0f, bitmap->scale, &advance, &lsb, &x0, &y0, &x1, &y1);
+	}
+#else
+	// Allocate from the heap rather than the stash's scratch buffer, which threads would share
+	font.font.userdata = NULL;
+#endif
+
+	memset(bitmap->data, 0, bitmap->width * bitmap->height);
+	fons__tt_renderGlyphBitmap(&font, &bitmap->data[pad + pad * bitmap->width], bitmap->width-pad*2, bitmap->height-pad*2,
+		bitmap->width, bitmap->scale, bitmap->scale, bitmap->index);
+	fons__finishGlyphBitmap(stash, bitmap->data, bitmap->width, bitmap->height, bitmap->width, bitmap->iblur);
+}
+
+int fonsAddGlyphBitmap(FONScontext* stash, const FONSstagedGlyph* bitmap)
+{
+	FONSfont* font = stash->fonts[bitmap->font];
+	FONSglyph* glyph = fons__findGlyph(font, bitmap->codepoint, bitmap->isize, bitmap->iblur);
+	FONSpage* page;
+	int y, p, gx, gy, evictions = stash->stats.evictions;
+
+	// Drawn since it was prepared
+	if (glyph != NULL && glyph->page >= 0)
+		return 1;
+
+	p = fons__allocGlyphRect(stash, bitmap->width, bitmap->height, &gx, &gy);
+	if (p == -1) return 0;
+	// Evicting a page moves the remaining glyphs.
+	if (glyph != NULL && stash->stats.evictions != evictions)
+		glyph = fons__findGlyph(font, bitmap->codepoint, bitmap->isize, bitmap->iblur);
+	if (glyph == NULL)
+		glyph = fons__addGlyph(font, bitmap->codepoint, bitmap->isize, bitmap->iblur);
+	if (glyph == NULL) return 0;
+
+	glyph->index = bitmap->index;
+	glyph->x0 = (short)gx;
+	glyph->y0 = (short)gy;
+	glyph->x1 = (short)(gx+bitmap->width);
+	glyph->y1 = (short)(gy+bitmap->height);
+	glyph->xadv = (short)(bitmap->scale * bitmap->advance * 10.0f);
+	glyph->xoff = (short)bitmap->xoff;
+	glyph->yoff = (short)bitmap->yoff;
+	glyph->page = (short)p;
+
+	// Kept through this frame, so later glyphs of the batch can't evict it
+	page = &stash->pages[p];
+	page->usedArea += bitmap->width * bitmap->height;
+	page->nglyphs++;
+	fons__touchGlyph(stash, glyph);
+
+	for (y = 0; y < bitmap->height; y++)
+		memcpy(&page->texData[gx + (gy+y) * page->width], &bitmap->data[y * bitmap->width], bitmap->width);
+	fons__addDirtyRect(page, glyph->x0, glyph->y0, glyph->x1, glyph->y1);
+
+	return 1;
+}
+
 void fonsDeleteInternal(FONScontext* stash)
 {
 	int i;
@@ -1663,9 +2331,9 @@ void fonsDeleteInternal(FONScontext* stash)
 	for (i = 0; i < stash->nfonts; ++i)
 		fons__freeFont(stash->fonts[i]);
 
-	if (stash->atlas) fons__deleteAtlas(stash->atlas);
+	for (i = 0; i < stash->npages; ++i)
+		fons__freePage(&stash->pages[i]);
 	if (stash->fonts) free(stash->fonts);
-	if (stash->texData) free(stash->texData);
 	if (stash->scratch) free(stash->scratch);
 	fons__tt_done(stash);
 	free(stash);
@@ -1689,7 +2357,9 @@ int fonsExpandAtlas(FONScontext* stash, int width, int height)
 {
 	int i, maxy = 0;
 	unsigned char* data = NULL;
+	FONSpage* page;
 	if (stash == NULL) return 0;
+	page = &stash->pages[0];
 
 	width = fons__maxi(width, stash->params.width);
 	height = fons__maxi(height, stash->params.height);
@@ -1711,7 +2381,7 @@ int fonsExpandAtlas(FONScontext* stash, int width, int height)
 		return 0;
 	for (i = 0; i < stash->params.height; i++) {
 		unsigned char* dst = &data[i*width];
-		unsigned char* src = &stash->texData[i*stash->params.width];
+		unsigned char* src = &page->texData[i*stash->params.width];
 		memcpy(dst, src, stash->params.width);
 		if (width > stash->params.width)
 			memset(dst+stash->params.width, 0, width - stash->params.width);
@@ -1719,24 +2389,23 @@ int fonsExpandAtlas(FONScontext* stash, int width, int height)
 	if (height > stash->params.height)
 		memset(&data[stash->params.height * width], 0, (height - stash->params.height) * width);
 
-	free(stash->texData);
-	stash->texData = data;
+	free(page->texData);
+	page->texData = data;
 
 	// Increase atlas size
-	fons__atlasExpand(stash->atlas, width, height);
+	fons__atlasExpand(page->atlas, width, height);
 
 	// Add existing data as dirty.
-	for (i = 0; i < stash->atlas->nnodes; i++)
-		maxy = fons__maxi(maxy, stash->atlas->nodes[i].y);
-	stash->dirtyRect[0] = 0;
-	stash->dirtyRect[1] = 0;
-	stash->dirtyRect[2] = stash->params.width;
-	stash->dirtyRect[3] = maxy;
+	for (i = 0; i < page->atlas->nnodes; i++)
+		maxy = fons__maxi(maxy, page->atlas->nodes[i].y);
+	page->dirtyRect[0] = 0;
+	page->dirtyRect[1] = 0;
+	page->dirtyRect[2] = stash->params.width;
+	page->dirtyRect[3] = maxy;
 
 	stash->params.width = width;
 	stash->params.height = height;
-	stash->itw = 1.0f/stash->params.width;
-	stash->ith = 1.0f/stash->params.height;
+	fons__setPageSize(page, width, height);
 
 	return 1;
 }
@@ -1744,7 +2413,9 @@ int fonsExpandAtlas(FONScontext* stash, int width, int height)
 int fonsResetAtlas(FONScontext* stash, int width, int height)
 {
 	int i, j;
+	FONSpage* page;
 	if (stash == NULL) return 0;
+	page = &stash->pages[0];
 
 	// Flush pending glyphs.
 	fons__flush(stash);
@@ -1755,19 +2426,23 @@ int fonsResetAtlas(FONScontext* stash, int width, int height)
 			return 0;
 	}
 
-	// Reset atlas
-	fons__atlasReset(stash->atlas, width, height);
+	// Reset atlas, back to a single page
+	for (i = 1; i < stash->npages; i++)
+		fons__freePage(&stash->pages[i]);
+	stash->npages = 1;
+	fons__atlasReset(page->atlas, width, height);
 
 	// Clear texture data.
-	stash->texData = (unsigned char*)realloc(stash->texData, width * height);
-	if (stash->texData == NULL) return 0;
-	memset(stash->texData, 0, width * height);
+	page->texData = (unsigned char*)realloc(page->texData, width * height);
+	if (page->texData == NULL) return 0;
+	memset(page->texData, 0, width * height);
+	fons__setPageSize(page, width, height);
+	page->lastUsed = 0;
+	page->usedArea = 0;
+	page->nglyphs = 0;
 
 	// Reset dirty rect
-	stash->dirtyRect[0] = width;
-	stash->dirtyRect[1] = height;
-	stash->dirtyRect[2] = 0;
-	stash->dirtyRect[3] = 0;
+	fons__resetDirtyRect(page);
 
 	// Reset cached glyphs
 	for (i = 0; i < stash->nfonts; i++) {
@@ -1779,8 +2454,6 @@ int fonsResetAtlas(FONScontext* stash, int width, int height)
 
 	stash->params.width = width;
 	stash->params.height = height;
-	stash->itw = 1.0f/stash->params.width;
-	stash->ith = 1.0f/stash->params.height;
 
 	// Add white rect at 0,0 for debug drawing.
 	fons__addWhiteRect(stash, 2,2);
@@ -39,9 +39,21 @@
 #pragma warning(disable: 4706)  // assignment within conditional expression
 #endif
 
+// SIMD path processing, disabled by defining NVG_NO_SIMD. Points are 2D, so four lanes hold two
+// points, or a point and its extrusion, and SSE2 or AArch64 NEON is enough.
+#ifndef NVG_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NVG_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define NVG_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
 #define NVG_INIT_FONTIMAGE_SIZE  512
 #define NVG_MAX_FONTIMAGE_SIZE   2048
-#define NVG_MAX_FONTIMAGES       4
+#define NVG_MAX_FONTIMAGES       8	// Glyph atlas pages, the coldest is evicted when all are full
 
 #define NVG_INIT_COMMANDS_SIZE 256
 #define NVG_INIT_POINTS_SIZE 128
@@ -132,7 +144,6 @@ struct NVGcontext {
 	float devicePxRatio;
 	struct FONScontext* fs;
 	int fontImages[NVG_MAX_FONTIMAGES];
-	int fontImageIdx;
 	int drawCallCount;
 	int fillTriCount;
 	int strokeTriCount;
@@ -168,6 +179,59 @@ static float nvg__normalize(float *x, float* y)
 	return d;
 }
 
+// Four float vectors. Each operation rounds as the scalar code does, so results match it exactly.
+#if defined(NVG_SSE2)
+#define NVG_SIMD
+typedef __m128 NVGvec4;
+static NVGvec4 nvg__v4set(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+static NVGvec4 nvg__v4load(const float* p) { return _mm_loadu_ps(p); }
+static NVGvec4 nvg__v4load2(const float* p, const float* q) { return _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)p), (const __m64*)q); }
+static void nvg__v4store(float* p, NVGvec4 v) { _mm_storeu_ps(p, v); }
+static void nvg__v4store2(float* p, float* q, NVGvec4 v) { _mm_storel_pi((__m64*)p, v); _mm_storeh_pi((__m64*)q, v); }
+static float nvg__v4get0(NVGvec4 v) { return _mm_cvtss_f32(v); }
+static float nvg__v4get2(NVGvec4 v) { return _mm_cvtss_f32(_mm_movehl_ps(v, v)); }
+static NVGvec4 nvg__v4add(NVGvec4 a, NVGvec4 b) { return _mm_add_ps(a, b); }
+static NVGvec4 nvg__v4sub(NVGvec4 a, NVGvec4 b) { return _mm_sub_ps(a, b); }
+static NVGvec4 nvg__v4mul(NVGvec4 a, NVGvec4 b) { return _mm_mul_ps(a, b); }
+static NVGvec4 nvg__v4div(NVGvec4 a, NVGvec4 b) { return _mm_div_ps(a, b); }
+static NVGvec4 nvg__v4sqrt(NVGvec4 a) { return _mm_sqrt_ps(a); }
+static NVGvec4 nvg__v4min(NVGvec4 a, NVGvec4 b) { return _mm_min_ps(a, b); }
+static NVGvec4 nvg__v4max(NVGvec4 a, NVGvec4 b) { return _mm_max_ps(a, b); }
+static NVGvec4 nvg__v4lo(NVGvec4 a, NVGvec4 b) { return _mm_movelh_ps(a, b); }				// a0 a1 b0 b1
+static NVGvec4 nvg__v4hi(NVGvec4 a, NVGvec4 b) { return _mm_movehl_ps(b, a); }				// a2 a3 b2 b3
+static NVGvec4 nvg__v4even(NVGvec4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2,2,0,0)); }	// a0 a0 a2 a2
+static NVGvec4 nvg__v4odd(NVGvec4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3,3,1,1)); }	// a1 a1 a3 a3
+static NVGvec4 nvg__v4swap(NVGvec4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2,3,0,1)); }	// a1 a0 a3 a2
+static NVGvec4 nvg__v4selectGt(NVGvec4 a, NVGvec4 b, NVGvec4 c, NVGvec4 d)					// a > b ? c : d
+{
+	NVGvec4 m = _mm_cmpgt_ps(a, b);
+	return _mm_or_ps(_mm_and_ps(m, c), _mm_andnot_ps(m, d));
+}
+#elif defined(NVG_NEON)
+#define NVG_SIMD
+typedef float32x4_t NVGvec4;
+static NVGvec4 nvg__v4set(float a, float b, float c, float d) { float v[4] = { a, b, c, d }; return vld1q_f32(v); }
+static NVGvec4 nvg__v4load(const float* p) { return vld1q_f32(p); }
+static NVGvec4 nvg__v4load2(const float* p, const float* q) { return vcombine_f32(vld1_f32(p), vld1_f32(q)); }
+static void nvg__v4store(float* p, NVGvec4 v) { vst1q_f32(p, v); }
+static void nvg__v4store2(float* p, float* q, NVGvec4 v) { vst1_f32(p, vget_low_f32(v)); vst1_f32(q, vget_high_f32(v)); }
+static float nvg__v4get0(NVGvec4 v) { return vgetq_lane_f32(v, 0); }
+static float nvg__v4get2(NVGvec4 v) { return vgetq_lane_f32(v, 2); }
+static NVGvec4 nvg__v4add(NVGvec4 a, NVGvec4 b) { return vaddq_f32(a, b); }
+static NVGvec4 nvg__v4sub(NVGvec4 a, NVGvec4 b) { return vsubq_f32(a, b); }
+static NVGvec4 nvg__v4mul(NVGvec4 a, NVGvec4 b) { return vmulq_f32(a, b); }
+static NVGvec4 nvg__v4div(NVGvec4 a, NVGvec4 b) { return vdivq_f32(a, b); }
+static NVGvec4 nvg__v4sqrt(NVGvec4 a) { return vsqrtq_f32(a); }
+static NVGvec4 nvg__v4min(NVGvec4 a, NVGvec4 b) { return vminq_f32(a, b); }
+static NVGvec4 nvg__v4max(NVGvec4 a, NVGvec4 b) { return vmaxq_f32(a, b); }
+static NVGvec4 nvg__v4lo(NVGvec4 a, NVGvec4 b) { return vcombine_f32(vget_low_f32(a), vget_low_f32(b)); }
+static NVGvec4 nvg__v4hi(NVGvec4 a, NVGvec4 b) { return vcombine_f32(vget_high_f32(a), vget_high_f32(b)); }
+static NVGvec4 nvg__v4even(NVGvec4 a) { return vtrn1q_f32(a, a); }
+static NVGvec4 nvg__v4odd(NVGvec4 a) { return vtrn2q_f32(a, a); }
+static NVGvec4 nvg__v4swap(NVGvec4 a) { return vrev64q_f32(a); }
+static NVGvec4 nvg__v4selectGt(NVGvec4 a, NVGvec4 b, NVGvec4 c, NVGvec4 d) { return vbslq_f32(vcgtq_f32(a, b), c, d); }
+#endif
+
 
 static void nvg__deletePathCache(NVGpathCache* c)
 {
@@ -323,6 +387,8 @@ NVGcontext* nvgCreateInternal(NVGparams* params)
 	fontParams.width = NVG_INIT_FONTIMAGE_SIZE;
 	fontParams.height = NVG_INIT_FONTIMAGE_SIZE;
 	fontParams.flags = FONS_ZERO_TOPLEFT;
+	fontParams.maxPages = NVG_MAX_FONTIMAGES;
+	fontParams.maxPageSize = NVG_MAX_FONTIMAGE_SIZE;
 	fontParams.renderCreate = NULL;
 	fontParams.renderUpdate = NULL;
 	fontParams.renderDraw = NULL;
@@ -334,7 +400,6 @@ NVGcontext* nvgCreateInternal(NVGparams* params)
 	// Create font texture
 	ctx->fontImages[0] = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, fontParams.width, fontParams.height, 0, NULL);
 	if (ctx->fontImages[0] == 0) goto error;
-	ctx->fontImageIdx = 0;
 
 	return ctx;
 
@@ -383,6 +448,9 @@ void nvgBeginFrame(NVGcontext* ctx, float windowWidth, float windowHeight, float
 
 	nvg__setDevicePixelRatio(ctx, devicePixelRatio);
 
+	// Glyph pages drawn from last frame may be evicted again
+	fonsBeginFrame(ctx->fs);
+
 	ctx->params.renderViewport(ctx->params.userPtr, windowWidth, windowHeight, devicePixelRatio);
 
 	ctx->drawCallCount = 0;
@@ -399,31 +467,6 @@ void nvgCancelFrame(NVGcontext* ctx)
 void nvgEndFrame(NVGcontext* ctx)
 {
 	ctx->params.renderFlush(ctx->params.userPtr);
-	if (ctx->fontImageIdx != 0) {
-		int fontImage = ctx->fontImages[ctx->fontImageIdx];
-		ctx->fontImages[ctx->fontImageIdx] = 0;
-		int i, j, iw, ih;
-		// delete images that smaller than current one
-		if (fontImage == 0)
-			return;
-		nvgImageSize(ctx, fontImage, &iw, &ih);
-		for (i = j = 0; i < ctx->fontImageIdx; i++) {
-			if (ctx->fontImages[i] != 0) {
-				int nw, nh;
-				int image = ctx->fontImages[i];
-				ctx->fontImages[i] = 0;
-				nvgImageSize(ctx, image, &nw, &nh);
-				if (nw < iw || nh < ih)
-					nvgDeleteImage(ctx, image);
-				else
-					ctx->fontImages[j++] = image;
-			}
-		}
-		// make current font image to first
-		ctx->fontImages[j] = ctx->fontImages[0];
-		ctx->fontImages[0] = fontImage;
-		ctx->fontImageIdx = 0;
-	}
 }
 
 NVGcolor nvgRGB(unsigned char r, unsigned char g, unsigned char b)
@@ -608,6 +651,23 @@ void nvgTransformPoint(float* dx, float* dy, const float* t, float sx, float sy)
 	*dy = sx*t[1] + sy*t[3] + t[5];
 }
 
+// Transforms consecutive x,y pairs in place
+static void nvg__transformPoints(float* pts, int npts, const float* t)
+{
+	int i = 0;
+#ifdef NVG_SIMD
+	NVGvec4 tx = nvg__v4set(t[0], t[1], t[0], t[1]);
+	NVGvec4 ty = nvg__v4set(t[2], t[3], t[2], t[3]);
+	NVGvec4 to = nvg__v4set(t[4], t[5], t[4], t[5]);
+	for (; i+1 < npts; i += 2) {
+		NVGvec4 p = nvg__v4load(&pts[i*2]);
+		nvg__v4store(&pts[i*2], nvg__v4add(nvg__v4add(nvg__v4mul(nvg__v4even(p), tx), nvg__v4mul(nvg__v4odd(p), ty)), to));
+	}
+#endif
+	for (; i < npts; i++)
+		nvgTransformPoint(&pts[i*2], &pts[i*2+1], t, pts[i*2], pts[i*2+1]);
+}
+
 float nvgDegToRad(float deg)
 {
 	return deg / 180.0f * NVG_PI;
@@ -1112,9 +1172,7 @@ static void nvg__appendCommands(NVGcontext* ctx, float* vals, int nvals)
 			i += 3;
 			break;
 		case NVG_BEZIERTO:
-			nvgTransformPoint(&vals[i+1],&vals[i+2], state->xform, vals[i+1],vals[i+2]);
-			nvgTransformPoint(&vals[i+3],&vals[i+4], state->xform, vals[i+3],vals[i+4]);
-			nvgTransformPoint(&vals[i+5],&vals[i+6], state->xform, vals[i+5],vals[i+6]);
+			nvg__transformPoints(&vals[i+1], 3, state->xform);
 			i += 7;
 			break;
 		case NVG_CLOSE:
@@ -1173,6 +1231,20 @@ static NVGpoint* nvg__lastPoint(NVGcontext* ctx)
 	return NULL;
 }
 
+// Makes room for more points, so adding them won't reallocate
+static int nvg__reservePoints(NVGcontext* ctx, int npoints)
+{
+	if (ctx->cache->npoints+npoints > ctx->cache->cpoints) {
+		NVGpoint* points;
+		int cpoints = ctx->cache->npoints+npoints + ctx->cache->cpoints/2;
+		points = (NVGpoint*)realloc(ctx->cache->points, sizeof(NVGpoint)*cpoints);
+		if (points == NULL) return 0;
+		ctx->cache->points = points;
+		ctx->cache->cpoints = cpoints;
+	}
+	return 1;
+}
+
 static void nvg__addPoint(NVGcontext* ctx, float x, float y, int flags)
 {
 	NVGpath* path = nvg__lastPath(ctx);
@@ -1187,14 +1259,7 @@ static void nvg__addPoint(NVGcontext* ctx, float x, float y, int flags)
 		}
 	}
 
-	if (ctx->cache->npoints+1 > ctx->cache->cpoints) {
-		NVGpoint* points;
-		int cpoints = ctx->cache->npoints+1 + ctx->cache->cpoints/2;
-		points = (NVGpoint*)realloc(ctx->cache->points, sizeof(NVGpoint)*cpoints);
-		if (points == NULL) return;
-		ctx->cache->points = points;
-		ctx->cache->cpoints = cpoints;
-	}
+	if (!nvg__reservePoints(ctx, 1)) return;
 
 	pt = &ctx->cache->points[ctx->cache->npoints];
 	memset(pt, 0, sizeof(*pt));
@@ -1279,53 +1344,78 @@ static void nvg__polyReverse(NVGpoint* pts, int npts)
 
 static void nvg__vset(NVGvertex* vtx, float x, float y, float u, float v)
 {
+#ifdef NVG_SIMD
+	nvg__v4store(&vtx->x, nvg__v4set(x, y, u, v));
+#else
 	vtx->x = x;
 	vtx->y = y;
 	vtx->u = u;
 	vtx->v = v;
+#endif
 }
 
+// Sets the two vertices of a join without a bevel, lw along the extrusion and rw against it
+static NVGvertex* nvg__vsetJoin(NVGvertex* dst, NVGpoint* p, float lw, float rw, float lu, float ru)
+{
+#ifdef NVG_SIMD
+	NVGvec4 pos = nvg__v4load2(&p->x, &p->x);
+	NVGvec4 dm = nvg__v4load2(&p->dmx, &p->dmx);
+	NVGvec4 xy = nvg__v4add(pos, nvg__v4mul(dm, nvg__v4set(lw, lw, -rw, -rw)));
+	NVGvec4 uv = nvg__v4set(lu, 1, ru, 1);
+	nvg__v4store(&dst[0].x, nvg__v4lo(xy, uv));
+	nvg__v4store(&dst[1].x, nvg__v4hi(xy, uv));
+#else
+	nvg__vset(&dst[0], p->x + (p->dmx * lw), p->y + (p->dmy * lw), lu,1);
+	nvg__vset(&dst[1], p->x - (p->dmx * rw), p->y - (p->dmy * rw), ru,1);
+#endif
+	return dst + 2;
+}
+
+#define NVG_MAX_BEZIER_SEGMENTS 1024
+
+// Flattens a cubic bezier with forward differencing, over enough equal steps in t to keep within
+// the tessellation tolerance. The bound on the step count is Wang's formula.
 static void nvg__tesselateBezier(NVGcontext* ctx,
 								 float x1, float y1, float x2, float y2,
 								 float x3, float y3, float x4, float y4,
-								 int level, int type)
+								 int type)
 {
-	float x12,y12,x23,y23,x34,y34,x123,y123,x234,y234,x1234,y1234;
-	float dx,dy,d2,d3;
-
-	if (level > 10) return;
-
-	x12 = (x1+x2)*0.5f;
-	y12 = (y1+y2)*0.5f;
-	x23 = (x2+x3)*0.5f;
-	y23 = (y2+y3)*0.5f;
-	x34 = (x3+x4)*0.5f;
-	y34 = (y3+y4)*0.5f;
-	x123 = (x12+x23)*0.5f;
-	y123 = (y12+y23)*0.5f;
+	float ddx = nvg__maxf(nvg__absf(x1 - 2*x2 + x3), nvg__absf(x2 - 2*x3 + x4));
+	float ddy = nvg__maxf(nvg__absf(y1 - 2*y2 + y3), nvg__absf(y2 - 2*y3 + y4));
+	float tol = nvg__sqrtf(ctx->tessTol) * 0.75f;	// Distance allowed from the curve
+	float ax, ay, bx, by, cx, cy, h, h2, h3;
+	int i, n;
 
-	dx = x4 - x1;
-	dy = y4 - y1;
-	d2 = nvg__absf(((x2 - x4) * dy - (y2 - y4) * dx));
-	d3 = nvg__absf(((x3 - x4) * dy - (y3 - y4) * dx));
+	n = (int)ceilf(nvg__sqrtf(0.75f * nvg__sqrtf(ddx*ddx + ddy*ddy) / tol));
+	n = nvg__clampi(n, 1, NVG_MAX_BEZIER_SEGMENTS);
+	if (!nvg__reservePoints(ctx, n)) return;
+
+	// Polynomial coefficients, p(t) = a t^3 + b t^2 + c t + p1
+	ax = -x1 + 3*(x2 - x3) + x4;
+	ay = -y1 + 3*(y2 - y3) + y4;
+	bx = 3*(x1 - 2*x2 + x3);
+	by = 3*(y1 - 2*y2 + y3);
+	cx = 3*(x2 - x1);
+	cy = 3*(y2 - y1);
+	h = 1.0f / (float)n;
+	h2 = h*h;
+	h3 = h2*h;
 
-	if ((d2 + d3)*(d2 + d3) < ctx->tessTol * (dx*dx + dy*dy)) {
-		nvg__addPoint(ctx, x4, y4, type);
-		return;
+	{
+		float px = x1, py = y1;
+		float dx = ax*h3 + bx*h2 + cx*h, dy = ay*h3 + by*h2 + cy*h;
+		float d2x = 6*ax*h3 + 2*bx*h2, d2y = 6*ay*h3 + 2*by*h2;
+		float d3x = 6*ax*h3, d3y = 6*ay*h3;
+		for (i = 1; i < n; i++) {
+			px += dx; py += dy;
+			dx += d2x; dy += d2y;
+			d2x += d3x; d2y += d3y;
+			nvg__addPoint(ctx, px, py, 0);
+		}
 	}
 
-/*	if (nvg__absf(x1+x3-x2-x2) + nvg__absf(y1+y3-y2-y2) + nvg__absf(x2+x4-x3-x3) + nvg__absf(y2+y4-y3-y3) < ctx->tessTol) {
-		nvg__addPoint(ctx, x4, y4, type);
-		return;
-	}*/
-
-	x234 = (x23+x34)*0.5f;
-	y234 = (y23+y34)*0.5f;
-	x1234 = (x123+x234)*0.5f;
-	y1234 = (y123+y234)*0.5f;
-
-	nvg__tesselateBezier(ctx, x1,y1, x12,y12, x123,y123, x1234,y1234, level+1, 0);
-	nvg__tesselateBezier(ctx, x1234,y1234, x234,y234, x34,y34, x4,y4, level+1, type);
+	// End exactly on the last point, whatever error the differences gathered
+	nvg__addPoint(ctx, x4, y4, type);
 }
 
 static void nvg__flattenPaths(NVGcontext* ctx)
@@ -1368,7 +1458,7 @@ static void nvg__flattenPaths(NVGcontext* ctx)
 				cp1 = &ctx->commands[i+1];
 				cp2 = &ctx->commands[i+3];
 				p = &ctx->commands[i+5];
-				nvg__tesselateBezier(ctx, last->x,last->y, cp1[0],cp1[1], cp2[0],cp2[1], p[0],p[1], 0, NVG_PT_CORNER);
+				nvg__tesselateBezier(ctx, last->x,last->y, cp1[0],cp1[1], cp2[0],cp2[1], p[0],p[1], NVG_PT_CORNER);
 			}
 			i += 7;
 			break;
@@ -1411,7 +1501,45 @@ static void nvg__flattenPaths(NVGcontext* ctx)
 				nvg__polyReverse(pts, path->count);
 		}
 
-		for(i = 0; i < path->count; i++) {
+		i = 0;
+#ifdef NVG_SIMD
+		// Two segments at a time, after the closing segment from the last point back to the first.
+		// The scalar loop below finishes any segment left over.
+		if (path->count > 2) {
+			NVGvec4 bmin, bmax;
+			NVGvec4 eps = nvg__v4set(1e-6f, 1e-6f, 1e-6f, 1e-6f);
+			NVGvec4 one = nvg__v4set(1.0f, 1.0f, 1.0f, 1.0f);
+			float bounds[4];
+			int k;
+			p0->dx = p1->x - p0->x;
+			p0->dy = p1->y - p0->y;
+			p0->len = nvg__normalize(&p0->dx, &p0->dy);
+			bmin = nvg__v4set(nvg__minf(cache->bounds[0], p0->x), nvg__minf(cache->bounds[1], p0->y), p0->x, p0->y);
+			bmax = nvg__v4set(nvg__maxf(cache->bounds[2], p0->x), nvg__maxf(cache->bounds[3], p0->y), p0->x, p0->y);
+			for (k = 0; k+2 < path->count; k += 2) {
+				NVGvec4 a = nvg__v4load2(&pts[k].x, &pts[k+1].x);
+				NVGvec4 d = nvg__v4sub(nvg__v4load2(&pts[k+1].x, &pts[k+2].x), a);
+				NVGvec4 sq = nvg__v4mul(d, d);
+				NVGvec4 len = nvg__v4sqrt(nvg__v4add(sq, nvg__v4swap(sq)));
+				d = nvg__v4selectGt(len, eps, nvg__v4mul(d, nvg__v4div(one, len)), d);
+				nvg__v4store2(&pts[k].dx, &pts[k+1].dx, d);
+				pts[k].len = nvg__v4get0(len);
+				pts[k+1].len = nvg__v4get2(len);
+				bmin = nvg__v4min(bmin, a);
+				bmax = nvg__v4max(bmax, a);
+			}
+			nvg__v4store(bounds, nvg__v4min(bmin, nvg__v4hi(bmin, bmin)));
+			cache->bounds[0] = bounds[0];
+			cache->bounds[1] = bounds[1];
+			nvg__v4store(bounds, nvg__v4max(bmax, nvg__v4hi(bmax, bmax)));
+			cache->bounds[2] = bounds[0];
+			cache->bounds[3] = bounds[1];
+			p0 = &pts[k];
+			p1 = &pts[k+1];
+			i = k+1;
+		}
+#endif
+		for(; i < path->count; i++) {
 			// Calculate segment direction and length
 			p0->dx = p1->x - p0->x;
 			p0->dy = p1->y - p0->y;
@@ -1820,8 +1948,7 @@ static int nvg__expandStroke(NVGcontext* ctx, float w, float fringe, int lineCap
 					dst = nvg__bevelJoin(dst, p0, p1, w, w, u0, u1, aa);
 				}
 			} else {
-				nvg__vset(dst, p1->x + (p1->dmx * w), p1->y + (p1->dmy * w), u0,1); dst++;
-				nvg__vset(dst, p1->x - (p1->dmx * w), p1->y - (p1->dmy * w), u1,1); dst++;
+				dst = nvg__vsetJoin(dst, p1, w, w, u0, u1);
 			}
 			p0 = p1++;
 		}
@@ -1950,8 +2077,7 @@ static int nvg__expandFill(NVGcontext* ctx, float w, int lineJoin, float miterLi
 				if ((p1->flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0) {
 					dst = nvg__bevelJoin(dst, p0, p1, lw, rw, lu, ru, ctx->fringeWidth);
 				} else {
-					nvg__vset(dst, p1->x + (p1->dmx * lw), p1->y + (p1->dmy * lw), lu,1); dst++;
-					nvg__vset(dst, p1->x - (p1->dmx * rw), p1->y - (p1->dmy * rw), ru,1); dst++;
+					dst = nvg__vsetJoin(dst, p1, lw, rw, lu, ru);
 				}
 				p0 = p1++;
 			}
@@ -2401,53 +2527,37 @@ static float nvg__getFontScale(NVGstate* state)
 static void nvg__flushTextTexture(NVGcontext* ctx)
 {
 	int dirty[4];
-
-	if (fonsValidateTexture(ctx->fs, dirty)) {
-		int fontImage = ctx->fontImages[ctx->fontImageIdx];
-		// Update texture
-		if (fontImage != 0) {
-			int iw, ih;
-			const unsigned char* data = fonsGetTextureData(ctx->fs, &iw, &ih);
+	int i, npages = fonsGetPageCount(ctx->fs);
+
+	for (i = 0; i < npages && i < NVG_MAX_FONTIMAGES; i++) {
+		int iw = 0, ih = 0;
+		const unsigned char* data;
+		if (!fonsValidatePage(ctx->fs, i, dirty))
+			continue;
+		data = fonsGetPageData(ctx->fs, i, &iw, &ih);
+		// Pages added since the last flush get their texture here
+		if (ctx->fontImages[i] == 0)
+			ctx->fontImages[i] = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, iw, ih, 0, NULL);
+		// Update the changed rect of the texture
+		if (ctx->fontImages[i] != 0) {
 			int x = dirty[0];
 			int y = dirty[1];
 			int w = dirty[2] - dirty[0];
 			int h = dirty[3] - dirty[1];
-			ctx->params.renderUpdateTexture(ctx->params.userPtr, fontImage, x,y, w,h, data);
+			ctx->params.renderUpdateTexture(ctx->params.userPtr, ctx->fontImages[i], x,y, w,h, data);
 		}
 	}
 }
 
-static int nvg__allocTextAtlas(NVGcontext* ctx)
-{
-	int iw, ih;
-	nvg__flushTextTexture(ctx);
-	if (ctx->fontImageIdx >= NVG_MAX_FONTIMAGES-1)
-		return 0;
-	// if next fontImage already have a texture
-	if (ctx->fontImages[ctx->fontImageIdx+1] != 0)
-		nvgImageSize(ctx, ctx->fontImages[ctx->fontImageIdx+1], &iw, &ih);
-	else { // calculate the new font image size and create it.
-		nvgImageSize(ctx, ctx->fontImages[ctx->fontImageIdx], &iw, &ih);
-		if (iw > ih)
-			ih *= 2;
-		else
-			iw *= 2;
-		if (iw > NVG_MAX_FONTIMAGE_SIZE || ih > NVG_MAX_FONTIMAGE_SIZE)
-			iw = ih = NVG_MAX_FONTIMAGE_SIZE;
-		ctx->fontImages[ctx->fontImageIdx+1] = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, iw, ih, 0, NULL);
-	}
-	++ctx->fontImageIdx;
-	fonsResetAtlas(ctx->fs, iw, ih);
-	return 1;
-}
-
-static void nvg__renderText(NVGcontext* ctx, NVGvertex* verts, int nverts)
+static void nvg__renderText(NVGcontext* ctx, NVGvertex* verts, int nverts, int page)
 {
 	NVGstate* state = nvg__getState(ctx);
 	NVGpaint paint = state->fill;
 
+	if (nverts == 0) return;
+
 	// Render triangles.
-	paint.image = ctx->fontImages[ctx->fontImageIdx];
+	paint.image = ctx->fontImages[page];
 
 	// Apply global alpha
 	paint.innerColor.a *= state->alpha;
@@ -2468,7 +2578,7 @@ static int nvg__isTransformFlipped(const float *xform)
 float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char* end)
 {
 	NVGstate* state = nvg__getState(ctx);
-	FONStextIter iter, prevIter;
+	FONStextIter iter;
 	FONSquad q;
 	NVGvertex* verts;
 	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
@@ -2476,6 +2586,7 @@ float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char*
 	int cverts = 0;
 	int nverts = 0;
 	int isFlipped = nvg__isTransformFlipped(state->xform);
+	int page = 0;
 
 	if (end == NULL)
 		end = string + strlen(string);
@@ -2493,22 +2604,16 @@ float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char*
 	if (verts == NULL) return x;
 
 	fonsTextIterInit(ctx->fs, &iter, x*scale, y*scale, string, end, FONS_GLYPH_BITMAP_REQUIRED);
-	prevIter = iter;
 	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
 		float c[4*2];
-		if (iter.prevGlyphIndex == -1) { // can not retrieve glyph?
-			if (nverts != 0) {
-				nvg__renderText(ctx, verts, nverts);
-				nverts = 0;
-			}
-			if (!nvg__allocTextAtlas(ctx))
-				break; // no memory :(
-			iter = prevIter;
-			fonsTextIterNext(ctx->fs, &iter, &q); // try again
-			if (iter.prevGlyphIndex == -1) // still can not find glyph?
-				break;
+		if (iter.page < 0 || iter.page >= NVG_MAX_FONTIMAGES) // can not retrieve glyph?
+			continue;
+		if (iter.page != page) { // glyphs on another atlas page draw with its texture
+			nvg__flushTextTexture(ctx);
+			nvg__renderText(ctx, verts, nverts, page);
+			nverts = 0;
+			page = iter.page;
 		}
-		prevIter = iter;
 		if(isFlipped) {
 			float tmp;
 
@@ -2534,7 +2639,7 @@ float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char*
 	// TODO: add back-end bit to do this just once per frame.
 	nvg__flushTextTexture(ctx);
 
-	nvg__renderText(ctx, verts, nverts);
+	nvg__renderText(ctx, verts, nverts, page);
 
 	return iter.nextx / scale;
 }
@@ -2577,7 +2682,7 @@ int nvgTextGlyphPositions(NVGcontext* ctx, float x, float y, const char* string,
 	NVGstate* state = nvg__getState(ctx);
 	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
 	float invscale = 1.0f / scale;
-	FONStextIter iter, prevIter;
+	FONStextIter iter;
 	FONSquad q;
 	int npos = 0;
 
@@ -2596,13 +2701,7 @@ int nvgTextGlyphPositions(NVGcontext* ctx, float x, float y, const char* string,
 	fonsSetFont(ctx->fs, state->fontId);
 
 	fonsTextIterInit(ctx->fs, &iter, x*scale, y*scale, string, end, FONS_GLYPH_BITMAP_OPTIONAL);
-	prevIter = iter;
 	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
-		if (iter.prevGlyphIndex < 0 && nvg__allocTextAtlas(ctx)) { // can not retrieve glyph?
-			iter = prevIter;
-			fonsTextIterNext(ctx->fs, &iter, &q); // try again
-		}
-		prevIter = iter;
 		positions[npos].str = iter.str;
 		positions[npos].x = iter.x * invscale;
 		positions[npos].minx = nvg__minf(iter.x, q.x0) * invscale;
@@ -2627,7 +2726,7 @@ int nvgTextBreakLines(NVGcontext* ctx, const char* string, const char* end, floa
 	NVGstate* state = nvg__getState(ctx);
 	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
 	float invscale = 1.0f / scale;
-	FONStextIter iter, prevIter;
+	FONStextIter iter;
 	FONSquad q;
 	int nrows = 0;
 	float rowStartX = 0;
@@ -2662,13 +2761,7 @@ int nvgTextBreakLines(NVGcontext* ctx, const char* string, const char* end, floa
 	breakRowWidth *= scale;
 
 	fonsTextIterInit(ctx->fs, &iter, 0, 0, string, end, FONS_GLYPH_BITMAP_OPTIONAL);
-	prevIter = iter;
 	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
-		if (iter.prevGlyphIndex < 0 && nvg__allocTextAtlas(ctx)) { // can not retrieve glyph?
-			iter = prevIter;
-			fonsTextIterNext(ctx->fs, &iter, &q); // try again
-		}
-		prevIter = iter;
 		switch (iter.codepoint) {
 			case 9:			// \t
 			case 11:		// \v
@@ -2924,6 +3017,30 @@ void nvgTextBoxBounds(NVGcontext* ctx, float x, float y, float breakRowWidth, co
 	}
 }
 
+void nvgTextAtlasStats(NVGcontext* ctx, NVGtextAtlasStats* stats)
+{
+	FONSatlasStats fstats;
+	fonsGetAtlasStats(ctx->fs, &fstats);
+	stats->lookups = fstats.lookups;
+	stats->hits = fstats.hits;
+	stats->rasterized = fstats.rasterized;
+	stats->evictions = fstats.evictions;
+	stats->evictedGlyphs = fstats.evictedGlyphs;
+	stats->pages = fstats.npages;
+	stats->usedArea = fstats.usedArea;
+	stats->totalArea = fstats.totalArea;
+}
+
+struct FONScontext* nvgFontStash(NVGcontext* ctx)
+{
+	return ctx->fs;
+}
+
+void nvgFlushTextAtlas(NVGcontext* ctx)
+{
+	nvg__flushTextTexture(ctx);
+}
+
 void nvgTextMetrics(NVGcontext* ctx, float* ascender, float* descender, float* lineh)
 {
 	NVGstate* state = nvg__getState(ctx);
@@ -135,6 +135,18 @@ struct NVGtextRow {
 };
 typedef struct NVGtextRow NVGtextRow;
 
+struct NVGtextAtlasStats {
+	int lookups;		// Glyph bitmaps requested by drawn text, since the context was created.
+	int hits;			// Requests found in the glyph atlas.
+	int rasterized;		// Glyphs rasterized into the atlas.
+	int evictions;		// Atlas pages evicted to make room for new glyphs.
+	int evictedGlyphs;	// Glyphs dropped by the evictions.
+	int pages;			// Atlas pages in use.
+	int usedArea;		// Pixels of the pages covered by glyphs.
+	int totalArea;		// Pixels of all pages.
+};
+typedef struct NVGtextAtlasStats NVGtextAtlasStats;
+
 enum NVGimageFlags {
     NVG_IMAGE_GENERATE_MIPMAPS	= 1<<0,     // Generate mipmaps during creation of the image.
 	NVG_IMAGE_REPEATX			= 1<<1,		// Repeat image in X direction.
@@ -619,6 +631,16 @@ int nvgTextGlyphPositions(NVGcontext* ctx, float x, float y, const char* string,
 // Measured values are returned in local coordinate space.
 void nvgTextMetrics(NVGcontext* ctx, float* ascender, float* descender, float* lineh);
 
+// Returns the glyph atlas counters. Counts are totals, take the difference between two calls for a frame.
+void nvgTextAtlasStats(NVGcontext* ctx, NVGtextAtlasStats* stats);
+
+// Returns the font stash, to warm up the glyph atlas with fonsPrepareGlyph() and related calls.
+// Glyph sizes are in pixels, as drawn with an identity transform and a device pixel ratio of 1.
+struct FONScontext* nvgFontStash(NVGcontext* ctx);
+
+// Uploads glyphs added to the atlas since text was last drawn.
+void nvgFlushTextAtlas(NVGcontext* ctx);
+
 // Breaks the specified text into lines. If end is specified only the sub-string will be used.
 // White space is stripped at the beginning of the rows, the text is split at word boundaries or when new-line characters are encountered.
 // Words longer than the max width are slit at nearest character (i.e. no hyphenation).
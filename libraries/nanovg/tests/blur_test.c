@@ -0,0 +1,148 @@
+//
+// Checks the SIMD glyph blur in fontstash.h against the scalar passes, then times it.
+//
+// Build and run from this directory:
+//   cc -O2 -I../src blur_test.c -o blur_test -lm && ./blur_test
+//
+// Define FONS_NO_SIMD to check the scalar dispatch on its own. Returns non-zero on a mismatch.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define FONTSTASH_IMPLEMENTATION
+#include "fontstash.h"
+
+#define TEST_CASES 20000
+#define BENCH_PIXELS 4000000
+
+static unsigned int rngState = 1;
+
+static unsigned int rng(void)
+{
+	rngState = rngState * 1664525u + 1013904223u;
+	return rngState >> 8;
+}
+
+static int blurAlpha(int blur)
+{
+	float sigma = (float)blur * 0.57735f;
+	return (int)((1<<APREC) * (1.0f - expf(-2.3f / (sigma+1.0f))));
+}
+
+// The blur as it was before the SIMD kernels
+static void blurScalar(unsigned char* dst, int w, int h, int stride, int blur)
+{
+	int alpha = blurAlpha(blur);
+	fons__blurRowsScalar(dst, w, h, stride, alpha);
+	fons__blurColsScalar(dst, w, h, stride, alpha);
+	fons__blurRowsScalar(dst, w, h, stride, alpha);
+	fons__blurColsScalar(dst, w, h, stride, alpha);
+}
+
+static void blurLevel(unsigned char* dst, int w, int h, int stride, int blur, int level)
+{
+	int alpha = blurAlpha(blur);
+	unsigned char* tmp = (unsigned char*)malloc(fons__simdLanes(level) * w);
+	fons__blurRowsLevel(dst, w, h, stride, alpha, level);
+	fons__blurColsLevel(dst, w, h, stride, alpha, level, tmp);
+	fons__blurRowsLevel(dst, w, h, stride, alpha, level);
+	fons__blurColsLevel(dst, w, h, stride, alpha, level, tmp);
+	free(tmp);
+}
+
+static void fillGlyph(unsigned char* data, int w, int h, int stride)
+{
+	int x, y;
+	memset(data, 0, stride * h);
+	for (y = 0; y < h; y++)
+		for (x = 0; x < w; x++)
+			data[y*stride + x] = (rng() % 3 == 0) ? 255 : (unsigned char)rng();
+}
+
+static const char* levelName(int level)
+{
+	switch (level) {
+	case FONS_SIMD_SSE2: return "SSE2";
+	case FONS_SIMD_NEON: return "NEON";
+	case FONS_SIMD_AVX2: return "AVX2";
+	default: return "scalar";
+	}
+}
+
+int main(void)
+{
+	int levels[4], nlevels = 0;
+	int detected = fons__simdLevel();
+	int sizes[] = { 24, 96, 192 };
+	int i, j, failures = 0;
+
+	// Every level this build and CPU can run, plus the dispatch used by fons__blur
+	levels[nlevels++] = FONS_SIMD_NONE;
+	if (detected == FONS_SIMD_AVX2)
+		levels[nlevels++] = FONS_SIMD_SSE2;
+	if (detected != FONS_SIMD_NONE)
+		levels[nlevels++] = detected;
+
+	printf("Detected: %s\n", levelName(detected));
+
+	for (i = 0; i < TEST_CASES; i++) {
+		int w = 1 + rng() % 200;
+		int h = 1 + rng() % 200;
+		int stride = w + rng() % 24;
+		int blur = 1 + rng() % 20;
+		unsigned char* source = (unsigned char*)malloc(stride * h);
+		unsigned char* expected = (unsigned char*)malloc(stride * h);
+		unsigned char* actual = (unsigned char*)malloc(stride * h);
+
+		fillGlyph(source, w, h, stride);
+		memcpy(expected, source, stride * h);
+		blurScalar(expected, w, h, stride, blur);
+
+		memcpy(actual, source, stride * h);
+		fons__blur(NULL, actual, w, h, stride, blur);
+		if (memcmp(expected, actual, stride * h) != 0) {
+			if (failures++ < 10)
+				printf("Mismatch: fons__blur %dx%d stride %d blur %d\n", w, h, stride, blur);
+		}
+
+		for (j = 1; j < nlevels; j++) {
+			memcpy(actual, source, stride * h);
+			blurLevel(actual, w, h, stride, blur, levels[j]);
+			if (memcmp(expected, actual, stride * h) != 0) {
+				if (failures++ < 10)
+					printf("Mismatch: %s %dx%d stride %d blur %d\n", levelName(levels[j]), w, h, stride, blur);
+			}
+		}
+
+		free(source);
+		free(expected);
+		free(actual);
+	}
+
+	printf("Bit exactness: %d cases, %d mismatches\n", TEST_CASES, failures);
+
+	// Time a blur of radius 4 over glyphs of each size
+	for (i = 0; i < 3; i++) {
+		int size = sizes[i];
+		int reps = BENCH_PIXELS / (size * size);
+		unsigned char* data = (unsigned char*)malloc(size * size);
+		fillGlyph(data, size, size, size);
+
+		printf("%3dx%-3d", size, size);
+		for (j = 0; j < nlevels; j++) {
+			clock_t start = clock();
+			int r;
+			for (r = 0; r < reps; r++)
+				blurLevel(data, size, size, size, 4, levels[j]);
+			printf("  %s %8.2f us", levelName(levels[j]), (double)(clock() - start) / CLOCKS_PER_SEC / reps * 1e6);
+		}
+		printf("\n");
+		free(data);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+//
+// Measures path flattening and stroke expansion on a scene of 10k rounded rects, in vertices per
+// second, with a renderer that only collects the vertices. Also checks that a SIMD build and an
+// NVG_NO_SIMD build produce identical vertices.
+//
+// Build and run from this directory:
+//   cc -O2 -I../src path_bench.c ../src/nanovg.c -o path_bench -lm
+//   cc -O2 -DNVG_NO_SIMD -I../src path_bench.c ../src/nanovg.c -o path_bench_scalar -lm
+//   ./path_bench_scalar --write scalar.bin && ./path_bench --compare scalar.bin
+//
+// With no arguments it only runs the benchmark. --compare returns non-zero on a mismatch.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nanovg.h"
+
+#define SCENE_RECTS 10000
+#define BENCH_FRAMES 20
+
+static NVGvertex* collected = NULL;
+static int ncollected = 0;
+static int ccollected = 0;
+static int collecting = 0;
+static long long vertexCount = 0;
+
+static void collect(const NVGvertex* verts, int nverts)
+{
+	vertexCount += nverts;
+	if (!collecting || nverts <= 0)
+		return;
+	if (ncollected + nverts > ccollected) {
+		ccollected = (ncollected + nverts) * 2;
+		collected = (NVGvertex*)realloc(collected, sizeof(NVGvertex) * ccollected);
+	}
+	memcpy(&collected[ncollected], verts, sizeof(NVGvertex) * nverts);
+	ncollected += nverts;
+}
+
+static int renderCreate(void* uptr) { (void)uptr; return 1; }
+static int renderCreateTexture(void* uptr, int type, int w, int h, int imageFlags, const unsigned char* data) { (void)uptr; (void)type; (void)w; (void)h; (void)imageFlags; (void)data; return 1; }
+static int renderDeleteTexture(void* uptr, int image) { (void)uptr; (void)image; return 1; }
+static int renderUpdateTexture(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data) { (void)uptr; (void)image; (void)x; (void)y; (void)w; (void)h; (void)data; return 1; }
+static int renderGetTextureSize(void* uptr, int image, int* w, int* h) { (void)uptr; (void)image; *w = 512; *h = 512; return 1; }
+static void renderViewport(void* uptr, float width, float height, float devicePixelRatio) { (void)uptr; (void)width; (void)height; (void)devicePixelRatio; }
+static void renderCancel(void* uptr) { (void)uptr; }
+static void renderFlush(void* uptr) { (void)uptr; }
+static void renderDelete(void* uptr) { (void)uptr; }
+
+static void renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor,
+					   float fringe, const float* bounds, const NVGpath* paths, int npaths)
+{
+	int i;
+	(void)uptr; (void)paint; (void)compositeOperation; (void)scissor; (void)fringe; (void)bounds;
+	for (i = 0; i < npaths; i++) {
+		collect(paths[i].fill, paths[i].nfill);
+		collect(paths[i].stroke, paths[i].nstroke);
+	}
+}
+
+static void renderStroke(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor,
+						 float fringe, float strokeWidth, const NVGpath* paths, int npaths)
+{
+	int i;
+	(void)uptr; (void)paint; (void)compositeOperation; (void)scissor; (void)fringe; (void)strokeWidth;
+	for (i = 0; i < npaths; i++)
+		collect(paths[i].stroke, paths[i].nstroke);
+}
+
+static void renderTriangles(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor,
+							const NVGvertex* verts, int nverts, float fringe)
+{
+	(void)uptr; (void)paint; (void)compositeOperation; (void)scissor; (void)fringe;
+	collect(verts, nverts);
+}
+
+// Filled and outlined rounded rects, as buttons draw them, with a few open curves for the caps
+static void drawScene(NVGcontext* vg, float devicePixelRatio)
+{
+	int i;
+	unsigned int seed = 7;
+
+	nvgBeginFrame(vg, 1920, 1080, devicePixelRatio);
+	for (i = 0; i < SCENE_RECTS; i++) {
+		float x, y, w, h, r;
+		seed = seed * 1664525u + 1013904223u; x = (float)((seed >> 8) % 1800) + ((seed >> 4) & 1) * 0.5f;
+		seed = seed * 1664525u + 1013904223u; y = (float)((seed >> 8) % 1000);
+		seed = seed * 1664525u + 1013904223u; w = 20.0f + (float)((seed >> 8) % 200);
+		seed = seed * 1664525u + 1013904223u; h = 16.0f + (float)((seed >> 8) % 40);
+		seed = seed * 1664525u + 1013904223u; r = 2.0f + (float)((seed >> 8) % 10);
+
+		nvgBeginPath(vg);
+		nvgRoundedRect(vg, x, y, w, h, r);
+		nvgFillColor(vg, nvgRGBA(200, 200, 200, 255));
+		nvgFill(vg);
+
+		nvgBeginPath(vg);
+		nvgRoundedRect(vg, x + 0.5f, y + 0.5f, w - 1, h - 1, r);
+		nvgStrokeWidth(vg, 1.0f + (float)(i % 3));
+		nvgLineJoin(vg, (i % 7 == 0) ? NVG_ROUND : NVG_MITER);
+		nvgStrokeColor(vg, nvgRGBA(0, 0, 0, 255));
+		nvgStroke(vg);
+
+		if (i % 50 == 0) {
+			nvgBeginPath(vg);
+			nvgMoveTo(vg, x, y);
+			nvgBezierTo(vg, x + w, y - h*3, x - w, y + h*4, x + w*2, y + h);
+			nvgLineCap(vg, (i % 100 == 0) ? NVG_BUTT : NVG_ROUND);
+			nvgStroke(vg);
+		}
+	}
+	nvgEndFrame(vg);
+}
+
+// Collects the vertices of the scene at two device pixel ratios
+static void collectScene(NVGcontext* vg)
+{
+	ncollected = 0;
+	collecting = 1;
+	drawScene(vg, 1.0f);
+	drawScene(vg, 2.0f);
+	collecting = 0;
+}
+
+static int writeVertices(const char* path)
+{
+	FILE* file = fopen(path, "wb");
+	if (file == NULL) {
+		printf("Can't write %s\n", path);
+		return 1;
+	}
+	fwrite(&ncollected, sizeof(int), 1, file);
+	fwrite(collected, sizeof(NVGvertex), ncollected, file);
+	fclose(file);
+	printf("Wrote %d vertices to %s\n", ncollected, path);
+	return 0;
+}
+
+static int compareVertices(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	NVGvertex* expected;
+	int count = 0, i;
+
+	if (file == NULL || fread(&count, sizeof(int), 1, file) != 1) {
+		printf("Can't read %s\n", path);
+		if (file != NULL) fclose(file);
+		return 1;
+	}
+	expected = (NVGvertex*)malloc(sizeof(NVGvertex) * (count > 0 ? count : 1));
+	if (fread(expected, sizeof(NVGvertex), count, file) != (size_t)count) {
+		printf("%s is truncated\n", path);
+		fclose(file);
+		free(expected);
+		return 1;
+	}
+	fclose(file);
+
+	if (count != ncollected) {
+		printf("Mismatch: %d vertices, %s has %d\n", ncollected, path, count);
+		free(expected);
+		return 1;
+	}
+	for (i = 0; i < count; i++) {
+		if (memcmp(&expected[i], &collected[i], sizeof(NVGvertex)) != 0) {
+			printf("Mismatch at vertex %d: (%.9g %.9g %g %g), %s has (%.9g %.9g %g %g)\n", i,
+				collected[i].x, collected[i].y, collected[i].u, collected[i].v,
+				path, expected[i].x, expected[i].y, expected[i].u, expected[i].v);
+			free(expected);
+			return 1;
+		}
+	}
+	printf("Identical: %d vertices match %s\n", count, path);
+	free(expected);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	NVGparams params;
+	NVGcontext* vg;
+	int i, result = 0;
+
+	memset(&params, 0, sizeof(params));
+	params.edgeAntiAlias = 1;
+	params.renderCreate = renderCreate;
+	params.renderCreateTexture = renderCreateTexture;
+	params.renderDeleteTexture = renderDeleteTexture;
+	params.renderUpdateTexture = renderUpdateTexture;
+	params.renderGetTextureSize = renderGetTextureSize;
+	params.renderViewport = renderViewport;
+	params.renderCancel = renderCancel;
+	params.renderFlush = renderFlush;
+	params.renderFill = renderFill;
+	params.renderStroke = renderStroke;
+	params.renderTriangles = renderTriangles;
+	params.renderDelete = renderDelete;
+
+	vg = nvgCreateInternal(&params);
+	if (vg == NULL) {
+		printf("Can't create the context\n");
+		return 1;
+	}
+
+#ifdef NVG_NO_SIMD
+	printf("Build: NVG_NO_SIMD\n");
+#else
+	printf("Build: SIMD where available\n");
+#endif
+
+	if (argc > 2 && strcmp(argv[1], "--write") == 0) {
+		collectScene(vg);
+		result = writeVertices(argv[2]);
+	} else if (argc > 2 && strcmp(argv[1], "--compare") == 0) {
+		collectScene(vg);
+		result = compareVertices(argv[2]);
+	} else {
+		float ratios[] = { 1.0f, 2.0f };
+		for (i = 0; i < 2; i++) {
+			double best = 1e30;
+			long long frameVerts;
+			int f;
+
+			vertexCount = 0;
+			drawScene(vg, ratios[i]);
+			frameVerts = vertexCount;
+
+			// Best of single frames, as other work on the machine only ever adds time
+			for (f = 0; f < BENCH_FRAMES; f++) {
+				clock_t start = clock();
+				double seconds;
+				drawScene(vg, ratios[i]);
+				seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+				if (seconds < best) best = seconds;
+			}
+
+			printf("%d rounded rects at ratio %.0f: %lld vertices, %.2f ms, %.1f M vertices/s\n",
+				SCENE_RECTS, ratios[i], frameVerts, best * 1000.0, (double)frameVerts / best / 1e6);
+		}
+	}
+
+	nvgDeleteInternal(vg);
+	free(collected);
+	return result;
+}
@@ -0,0 +1,166 @@
+//
+// Component arena benchmark. Builds a tree of 50k widgets, walks it as a frame's draw pass does, and
+// tears it down, reporting the best time of each. The draw pass runs through a NanoVG context with a
+// renderer that discards everything, so the time is the tree walk and path building, not pixels.
+//
+// Build as described in offscreen_scene.h, then a second time with LEMUR_NO_ARENA defined (/D with
+// MSVC), which allocates every component from the heap. Run both from this directory and compare.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "components.h"
+#include "component_arena.h"
+
+static const int WIDGETS = 50000;
+static const int GROUPS = 250;				// Panels directly under the root, each holding a share of the widgets
+static const int GROUP_COLUMNS = 25;
+static const int ROUNDS = 5;
+static const int FRAMES = 20;
+
+static const int WIDTH = 1280;
+static const int HEIGHT = 720;
+
+// Sets the draw clip, as Window does at the start of a frame
+struct FrameClip : Lemur::Panel
+{
+	static void set(const Lemur::Rect& aRect) { drawClip = aRect; }
+};
+
+// NanoVG renderer that accepts and discards everything
+static int renderCreate(void*) { return 1; }
+static int renderCreateTexture(void*, int, int, int, int, const unsigned char*) { return 1; }
+static int renderDeleteTexture(void*, int) { return 1; }
+static int renderUpdateTexture(void*, int, int, int, int, int, const unsigned char*) { return 1; }
+static int renderGetTextureSize(void*, int, int* w, int* h) { *w = 512; *h = 512; return 1; }
+static void renderViewport(void*, float, float, float) {}
+static void renderCancel(void*) {}
+static void renderFlush(void*) {}
+static void renderFill(void*, NVGpaint*, NVGcompositeOperationState, NVGscissor*, float, const float*, const NVGpath*, int) {}
+static void renderStroke(void*, NVGpaint*, NVGcompositeOperationState, NVGscissor*, float, float, const NVGpath*, int) {}
+static void renderTriangles(void*, NVGpaint*, NVGcompositeOperationState, NVGscissor*, const NVGvertex*, int, float) {}
+static void renderDelete(void*) {}
+
+static NVGcontext* createNullContext()
+{
+	NVGparams params;
+	memset(&params, 0, sizeof(params));
+	params.edgeAntiAlias = 1;
+	params.renderCreate = renderCreate;
+	params.renderCreateTexture = renderCreateTexture;
+	params.renderDeleteTexture = renderDeleteTexture;
+	params.renderUpdateTexture = renderUpdateTexture;
+	params.renderGetTextureSize = renderGetTextureSize;
+	params.renderViewport = renderViewport;
+	params.renderCancel = renderCancel;
+	params.renderFlush = renderFlush;
+	params.renderFill = renderFill;
+	params.renderStroke = renderStroke;
+	params.renderTriangles = renderTriangles;
+	params.renderDelete = renderDelete;
+	return nvgCreateInternal(&params);
+}
+
+// A grid of panels filling the window, each filled with small buttons, labels and panels
+static Lemur::Panel* buildTree()
+{
+	using namespace Lemur;
+
+	Panel* root = new Panel(0, 0, WIDTH, HEIGHT);
+
+	int groupWidth = WIDTH / GROUP_COLUMNS;
+	int groupHeight = HEIGHT / (GROUPS / GROUP_COLUMNS);
+	int perGroup = WIDGETS / GROUPS - 1;
+
+	for (int g = 0; g < GROUPS; g++)
+	{
+		Panel* group = new Panel((g % GROUP_COLUMNS) * groupWidth, (g / GROUP_COLUMNS) * groupHeight, groupWidth, groupHeight);
+		root->addChildControl(group);
+
+		for (int i = 0; i < perGroup; i++)
+		{
+			int x = (i % 10) * 5;
+			int y = (i / 10) * 3;
+
+			Component* widget;
+			if (i % 3 == 0)
+				widget = new Button(x, y, 4, 2, "B");
+			else if (i % 3 == 1)
+				widget = new Label(x, y, 4, 2, "L");
+			else
+				widget = new Panel(x, y, 4, 2);
+
+			group->addChildControl(widget);
+		}
+	}
+
+	return root;
+}
+
+static double milliseconds(std::chrono::steady_clock::time_point aStart)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - aStart).count();
+}
+
+int main()
+{
+	using namespace Lemur;
+
+	NVGcontext* context = createNullContext();
+	if (context == nullptr)
+	{
+		printf("Can't create the context\n");
+		return 1;
+	}
+
+#ifdef LEMUR_NO_ARENA
+	printf("Build: LEMUR_NO_ARENA, components from the heap\n");
+#else
+	printf("Build: component arena\n");
+#endif
+
+	double bestBuild = 1e30;
+	double bestFrame = 1e30;
+	double bestTeardown = 1e30;
+
+	for (int round = 0; round < ROUNDS; round++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		Panel* root = buildTree();
+		bestBuild = std::min(bestBuild, milliseconds(start));
+
+		if (round == 0)
+		{
+			ComponentArena::Stats stats = ComponentArena::getStats();
+			printf("%zu pooled blocks (components and their control blocks), %zu from the heap, %zu chunks, %.1f MB reserved\n",
+				stats.liveBlocks, stats.heapBlocks, stats.chunks, stats.reservedBytes / (1024.0 * 1024.0));
+		}
+
+		// Whole window damaged, so every widget is visited and drawn
+		for (int frame = 0; frame < FRAMES; frame++)
+		{
+			start = std::chrono::steady_clock::now();
+			FrameClip::set(Rect(0, 0, WIDTH, HEIGHT));
+			nvgBeginFrame(context, WIDTH, HEIGHT, 1);
+			Draw::BeginFrame(context);
+			root->drawChildComponents(context);
+			Draw::EndFrame(context);
+			nvgEndFrame(context);
+			bestFrame = std::min(bestFrame, milliseconds(start));
+		}
+
+		start = std::chrono::steady_clock::now();
+		delete root;
+		bestTeardown = std::min(bestTeardown, milliseconds(start));
+	}
+
+	printf("%d widgets, best of %d rounds: build %.2f ms, draw pass %.2f ms, teardown %.2f ms\n",
+		WIDGETS, ROUNDS, bestBuild, bestFrame, bestTeardown);
+
+	Draw::RemoveRenderHooks(context);
+	nvgDeleteInternal(context);
+	return 0;
+}
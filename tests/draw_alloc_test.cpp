@@ -0,0 +1,117 @@
+//
+// Allocation test of steady-state frames. Replaces the global operator new to count heap allocations,
+// then runs the scene from offscreen_scene.h through full redraws and hovers along the toolbar. Once
+// the caches and containers have grown on a first pass, repeating the same frames must not allocate.
+//
+// Build as described in offscreen_scene.h and run from this directory. Returns non-zero if a
+// repeated frame allocates.
+//
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "offscreen_scene.h"
+
+static const int PASSES = 3;
+
+static std::atomic<bool> counting(false);
+static std::atomic<int> allocations(0);
+
+void* operator new(size_t aSize)
+{
+	if (counting)
+		allocations++;
+
+	void* pointer = malloc(aSize != 0 ? aSize : 1);
+	if (pointer == nullptr)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void* operator new[](size_t aSize)
+{
+	return operator new(aSize);
+}
+
+void operator delete(void* aPointer) noexcept
+{
+	free(aPointer);
+}
+
+void operator delete[](void* aPointer) noexcept
+{
+	free(aPointer);
+}
+
+void operator delete(void* aPointer, size_t) noexcept
+{
+	free(aPointer);
+}
+
+void operator delete[](void* aPointer, size_t) noexcept
+{
+	free(aPointer);
+}
+
+// Full redraws, then the mouse along the toolbar, redrawing the buttons entered and left.
+// Returns the number of frames which allocated.
+static int runPass(Lemur::Window& aWindow, bool aCount, const char* aPass)
+{
+	int allocatingFrames = 0;
+
+	auto frame = [&](const char* aStep)
+	{
+		allocations = 0;
+		counting = aCount;
+		Scene::runFrame(aWindow);
+		counting = false;
+
+		if (allocations > 0)
+		{
+			printf("%s, %s: %d allocations\n", aPass, aStep, allocations.load());
+			allocatingFrames++;
+		}
+	};
+
+	for (int i = 0; i < 5; i++)
+	{
+		aWindow.invalidateAll();
+		frame("full redraw");
+	}
+
+	for (int x = 10; x < Scene::WIDTH; x += 45)
+	{
+		Scene::moveMouse(aWindow, x, 20);
+		frame("toolbar hover");
+	}
+
+	// Nothing changed
+	frame("idle");
+
+	return allocatingFrames;
+}
+
+int main()
+{
+	using namespace Lemur;
+
+	Window* window = new Window(Scene::WIDTH, Scene::HEIGHT, "Allocation test", true);
+	ResourceManager resources;
+	if (!Scene::loadFont(*window, resources))
+		return 1;
+
+	Scene::build(*window);
+
+	// Lay out, fill the caches and grow the containers
+	runPass(*window, false, "Warm up");
+
+	int allocatingFrames = 0;
+	for (int pass = 0; pass < PASSES; pass++)
+		allocatingFrames += runPass(*window, true, ("Pass " + std::to_string(pass + 1)).c_str());
+
+	printf("%d repeated passes, %d frames allocated\n", PASSES, allocatingFrames);
+
+	window->close();
+	delete window;
+	return allocatingFrames > 0 ? 1 : 0;
+}
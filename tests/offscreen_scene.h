@@ -0,0 +1,203 @@
+//
+// Shared by the tests and benchmarks in this directory. Builds a UI like the application's in an
+// offscreen Window, and runs frames the way Application::update does.
+//
+// The tests are standalone programs, built with every source in classes/ except main.cpp, plus
+// nanovg.c and pugixml.cpp, and linked with GLFW and GLEW like the application. With MSVC, from
+// this directory:
+//   cl /std:c++20 /O2 /EHsc /DNDEBUG /I.. /I..\classes /I..\libraries\glew\include /I..\libraries\glfw\includes
+//      /I..\libraries\nanovg\src /I..\libraries\pugixml\src <test>.cpp ..\classes\*.cpp ..\libraries\nanovg\src\nanovg.c
+//      ..\libraries\pugixml\src\pugixml.cpp /link ..\libraries\glfw\libs\glfw\glfw3.lib ..\libraries\glew\lib\glew32s.lib
+//      opengl32.lib user32.lib gdi32.lib shell32.lib
+// Run them from this directory, which finds the resources at ../resources.
+//
+
+#ifndef LEMUR_TESTS_OFFSCREEN_SCENE_H
+#define LEMUR_TESTS_OFFSCREEN_SCENE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "components.h"
+#include "resource_manager.h"
+#include "text_styles.h"
+
+namespace Scene
+{
+	static const int WIDTH = 1280;
+	static const int HEIGHT = 720;
+	static const int LIST_ROWS = 1000;
+
+	// Load the font the built-in text styles use. Returns false if the file isn't found.
+	inline bool loadFont(Lemur::Window& aWindow, Lemur::ResourceManager& aResources)
+	{
+		aWindow.resourceManager = &aResources;
+
+		Lemur::Font* font = aResources.importFontFromFile(aWindow.getContext(), Lemur::TextStyles::DEFAULT_FONT, "../resources/fonts/OpenSans.ttf");
+		if (font == nullptr || !font->isLoaded())
+		{
+			printf("Can't load ../resources/fonts/OpenSans.ttf, run from the tests directory\n");
+			return false;
+		}
+
+		return true;
+	}
+
+	// A toolbar, a tab view of labelled fields and buttons, and a long list
+	inline void build(Lemur::Window& aWindow)
+	{
+		using namespace Lemur;
+
+		Panel* toolbar = new Panel(0, 0, WIDTH, 40);
+		toolbar->setBackColour(Colour(45, 55, 66, 255));
+		aWindow.addChildControl(toolbar);
+
+		for (int i = 0; i < 16; i++)
+			toolbar->addChildControl(new Button(6 + i * 78, 6, 72, 28, "Tool " + std::to_string(i + 1)));
+
+		TabView* tabs = new TabView(8, 48, 860, 664);
+		aWindow.addChildControl(tabs);
+
+		for (int t = 0; t < 3; t++)
+		{
+			Tab* tab = tabs->addTab("Page " + std::to_string(t + 1));
+
+			for (int row = 0; row < 18; row++)
+			{
+				for (int column = 0; column < 3; column++)
+				{
+					int x = 12 + column * 280;
+					int y = 12 + row * 34;
+					tab->addPanelChildControl(new Label(x, y, 90, 26, "Field " + std::to_string(row * 3 + column + 1)));
+
+					if ((row + column) % 3 == 0)
+						tab->addPanelChildControl(new Button(x + 96, y, 160, 26, "Action"));
+					else
+						tab->addPanelChildControl(new Textbox(x + 96, y, 160, 26, "Value " + std::to_string(row * column)));
+				}
+			}
+		}
+
+		ListView* list = new ListView(876, 48, 396, 664);
+		ListDataSource source;
+		source.getRowCount = []() { return LIST_ROWS; };
+		source.bindRow = [](int aRow, Component* aWidget) { aWidget->setText("Entry " + std::to_string(aRow)); };
+		list->setDataSource(source);
+		aWindow.addChildControl(list);
+	}
+
+	// One frame, as Application::update runs it
+	inline void runFrame(Lemur::Window& aWindow)
+	{
+		aWindow.triggerEventsChain();
+		aWindow.resetContext();
+		aWindow.onFrame(aWindow.getContext());
+		aWindow.endFrame();
+	}
+
+	// Move the mouse to a point for the next frame
+	inline void moveMouse(Lemur::Window& aWindow, double aX, double aY)
+	{
+		Lemur::InputEvent event;
+		event.type = Lemur::InputEvent::Type::MouseMove;
+		event.x = aX;
+		event.y = aY;
+		event.time = 0;
+		aWindow.postInputEvent(event);
+	}
+
+	// Press or release the left button, where the mouse is, for the next frame
+	inline void mouseButton(Lemur::Window& aWindow, int aAction)
+	{
+		Lemur::InputEvent event;
+		event.type = Lemur::InputEvent::Type::MouseButton;
+		event.key = GLFW_MOUSE_BUTTON_LEFT;
+		event.action = aAction;
+		aWindow.postInputEvent(event);
+	}
+
+	// Press and release the left button at a point, over the next two frames
+	inline void click(Lemur::Window& aWindow, double aX, double aY)
+	{
+		moveMouse(aWindow, aX, aY);
+		mouseButton(aWindow, GLFW_PRESS);
+		runFrame(aWindow);
+		mouseButton(aWindow, GLFW_RELEASE);
+		runFrame(aWindow);
+	}
+
+	// Scroll the wheel by steps at a point, negative scrolls down
+	inline void scroll(Lemur::Window& aWindow, double aX, double aY, double aSteps)
+	{
+		moveMouse(aWindow, aX, aY);
+
+		Lemur::InputEvent event;
+		event.type = Lemur::InputEvent::Type::Scroll;
+		event.y = aSteps;
+		aWindow.postInputEvent(event);
+	}
+
+	// Count pixels whose channels differ by more than a tolerance, and the largest difference
+	inline int countDifferences(const unsigned char* aA, const unsigned char* aB, int aWidth, int aHeight, int aTolerance, int* aLargest = nullptr)
+	{
+		int count = 0;
+		int largest = 0;
+
+		for (int i = 0; i < aWidth * aHeight; i++)
+		{
+			int difference = 0;
+			for (int c = 0; c < 4; c++)
+			{
+				int d = aA[i * 4 + c] - aB[i * 4 + c];
+				difference = std::max(difference, d < 0 ? -d : d);
+			}
+
+			largest = std::max(largest, difference);
+			if (difference > aTolerance)
+				count++;
+		}
+
+		if (aLargest != nullptr)
+			*aLargest = largest;
+		return count;
+	}
+
+	// Save and load RGBA pixels as a binary PAM image, which most image viewers open
+	inline bool writeImage(const char* aPath, const unsigned char* aPixels, int aWidth, int aHeight)
+	{
+		FILE* file = fopen(aPath, "wb");
+		if (file == nullptr)
+			return false;
+
+		fprintf(file, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", aWidth, aHeight);
+		fwrite(aPixels, 4, static_cast<size_t>(aWidth) * aHeight, file);
+		fclose(file);
+		return true;
+	}
+
+	inline bool readImage(const char* aPath, std::vector<unsigned char>& aPixels, int& aWidth, int& aHeight)
+	{
+		FILE* file = fopen(aPath, "rb");
+		if (file == nullptr)
+			return false;
+
+		bool read = fscanf(file, "P7 WIDTH %d HEIGHT %d DEPTH 4 MAXVAL 255 TUPLTYPE RGB_ALPHA ENDHDR", &aWidth, &aHeight) == 2 && fgetc(file) == '\n';
+		if (read)
+		{
+			aPixels.resize(static_cast<size_t>(aWidth) * aHeight * 4);
+			read = fread(aPixels.data(), 4, static_cast<size_t>(aWidth) * aHeight, file) == static_cast<size_t>(aWidth) * aHeight;
+		}
+
+		fclose(file);
+		return read;
+	}
+
+	inline double milliseconds(std::chrono::steady_clock::time_point aStart)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - aStart).count();
+	}
+}
+
+#endif // !LEMUR_TESTS_OFFSCREEN_SCENE_H
@@ -0,0 +1,179 @@
+//
+// Event processing benchmark for cached screen bounds. Builds a 10k-node tree of nested panels 20 deep
+// and moves the mouse across it each frame, reporting the median time of:
+//   before   every node hit-tested, its offset found by walking the parent chain, as processEvents did
+//   after    the same, reading the offset from the node's cached screen bounds
+//   events   Component::processEvents on the tree, as the window runs it now
+// Also checks the walked and cached offsets of every node agree. Returns non-zero if not.
+//
+// Build as described in offscreen_scene.h and run from this directory.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "components.h"
+
+static const int CHAINS = 500;				// Columns of nested panels under the root
+static const int DEPTH = 20;
+static const int CHAIN_COLUMNS = 25;
+static const int FRAMES = 200;
+
+static const int WIDTH = 1280;
+static const int HEIGHT = 720;
+
+// Each node and its parent's index, parents first
+struct Tree
+{
+	Lemur::Panel* root;
+	std::vector<Lemur::Component*> nodes;
+	std::vector<int> parents;
+};
+
+static Tree buildTree()
+{
+	using namespace Lemur;
+
+	Tree tree;
+	tree.root = new Panel(0, 0, WIDTH, HEIGHT);
+	tree.nodes.push_back(tree.root);
+	tree.parents.push_back(-1);
+
+	int cellWidth = WIDTH / CHAIN_COLUMNS;
+	int cellHeight = HEIGHT / (CHAINS / CHAIN_COLUMNS);
+
+	for (int c = 0; c < CHAINS; c++)
+	{
+		Component* parent = tree.root;
+		int parentIndex = 0;
+		int x = (c % CHAIN_COLUMNS) * cellWidth;
+		int y = (c / CHAIN_COLUMNS) * cellHeight;
+
+		for (int d = 0; d < DEPTH; d++)
+		{
+			Panel* panel = new Panel(x, y, cellWidth - d * 2, cellHeight - d);
+			parent->addChildControl(panel);
+
+			tree.nodes.push_back(panel);
+			tree.parents.push_back(parentIndex);
+
+			parent = panel;
+			parentIndex = static_cast<int>(tree.nodes.size()) - 1;
+			x = 1;
+			y = 1;
+		}
+	}
+
+	return tree;
+}
+
+// Offset found by summing locations up the parent chain
+static Lemur::Vector2 walkOffset(const Lemur::Component* aComponent)
+{
+	Lemur::Vector2 result;
+	if (aComponent->getParent() != nullptr)
+	{
+		Lemur::Vector2 parentOffset = walkOffset(aComponent->getParent());
+		result.x = parentOffset.x + aComponent->getLocation().x;
+		result.y = parentOffset.y + aComponent->getLocation().y;
+	}
+	return result;
+}
+
+// Hit test every node against the mouse, a node is only over if its parent is, as processEvents does.
+// Returns the number of nodes under the mouse.
+static int hitTest(const Tree& aTree, int aMouseX, int aMouseY, bool aWalkParents, std::vector<char>& aOver)
+{
+	int count = 0;
+
+	for (size_t i = 0; i < aTree.nodes.size(); i++)
+	{
+		const Lemur::Component* node = aTree.nodes[i];
+		Lemur::Vector2 offset = aWalkParents ? walkOffset(node) : node->getOffset();
+
+		int left = static_cast<int>(offset.x);
+		int top = static_cast<int>(offset.y);
+		int right = left + node->getWidth();
+		int bottom = top + node->getHeight();
+
+		bool over = (aTree.parents[i] < 0 || aOver[aTree.parents[i]])
+			&& aMouseX >= left && aMouseX <= right && aMouseY >= top && aMouseY <= bottom;
+
+		aOver[i] = over;
+		count += over;
+	}
+
+	return count;
+}
+
+static double median(std::vector<double>& aTimes)
+{
+	std::sort(aTimes.begin(), aTimes.end());
+	return aTimes[aTimes.size() / 2];
+}
+
+static double milliseconds(std::chrono::steady_clock::time_point aStart)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - aStart).count();
+}
+
+int main()
+{
+	using namespace Lemur;
+
+	Tree tree = buildTree();
+
+	// Move a chain after building, so the check below covers bounds pushed down by a change
+	tree.nodes[1]->setLocation(5, 7);
+
+	// The cached bounds have to match the walk for the comparison to mean anything
+	int mismatches = 0;
+	for (const Component* node : tree.nodes)
+	{
+		Vector2 walked = walkOffset(node);
+		Vector2 cached = node->getOffset();
+		if (walked.x != cached.x || walked.y != cached.y)
+			mismatches++;
+	}
+
+	std::vector<char> over(tree.nodes.size());
+	std::vector<double> before;
+	std::vector<double> after;
+	std::vector<double> events;
+	InputMap input;
+
+	for (int frame = 0; frame < FRAMES; frame++)
+	{
+		int mouseX = (frame * 37) % WIDTH;
+		int mouseY = (frame * 23) % HEIGHT;
+
+		auto start = std::chrono::steady_clock::now();
+		int walkedHits = hitTest(tree, mouseX, mouseY, true, over);
+		before.push_back(milliseconds(start));
+
+		start = std::chrono::steady_clock::now();
+		int cachedHits = hitTest(tree, mouseX, mouseY, false, over);
+		after.push_back(milliseconds(start));
+
+		if (walkedHits != cachedHits)
+			mismatches++;
+
+		input.mouse.position.x = mouseX;
+		input.mouse.position.y = mouseY;
+		start = std::chrono::steady_clock::now();
+		tree.root->processEvents(&input);
+		events.push_back(milliseconds(start));
+	}
+
+	printf("%d nodes, %d deep, median of %d frames\n", static_cast<int>(tree.nodes.size()), DEPTH, FRAMES);
+	printf("before  %8.3f ms  hit test, offsets by walking parents\n", median(before));
+	printf("after   %8.3f ms  hit test, cached offsets\n", median(after));
+	printf("events  %8.3f ms  processEvents\n", median(events));
+
+	if (mismatches > 0)
+		printf("Cached offsets disagree with the parent walk: %d mismatches\n", mismatches);
+
+	delete tree.root;
+	return mismatches > 0 ? 1 : 0;
+}
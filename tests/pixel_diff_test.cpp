@@ -0,0 +1,152 @@
+//
+// Pixel diff test of the offscreen Window. Runs the scene from offscreen_scene.h through hovers,
+// clicks and scrolls, each redrawing only the damaged area, and checks every frame matches the
+// same state redrawn in full. Optionally compares the full redraw with a reference image, to
+// catch rendering changes between builds.
+//
+// Build as described in offscreen_scene.h. Run from this directory:
+//   pixel_diff_test                        Check partial redraws against a full redraw
+//   pixel_diff_test --write ref.pam        Also save the full redraw as a reference
+//   pixel_diff_test --compare ref.pam      Also compare the full redraw with a reference
+//
+// Returns non-zero on a mismatch.
+//
+
+#include <cstring>
+#include "offscreen_scene.h"
+
+// Channel difference allowed against a reference, for floating point differences between compilers
+static const int REFERENCE_TOLERANCE = 2;
+
+static std::vector<unsigned char> copyPixels(Lemur::Window& aWindow)
+{
+	const unsigned char* pixels = aWindow.getSoftwareRenderer()->getPixels();
+	return std::vector<unsigned char>(pixels, pixels + Scene::WIDTH * Scene::HEIGHT * 4);
+}
+
+static int checkedFrames = 0;
+static int failedFrames = 0;
+
+// Run a frame, which redraws only the damaged area, and check it matches the same state redrawn in
+// full. Checked after every frame, so a later larger redraw can't paint over a missed area.
+static void runCheckedFrame(Lemur::Window& aWindow, const char* aStep)
+{
+	unsigned long drawn = aWindow.getFramesDrawn();
+	Scene::runFrame(aWindow);
+	if (aWindow.getFramesDrawn() == drawn)
+		return;
+
+	std::vector<unsigned char> partial = copyPixels(aWindow);
+	aWindow.invalidateAll();
+	Scene::runFrame(aWindow);
+	const unsigned char* full = aWindow.getSoftwareRenderer()->getPixels();
+	checkedFrames++;
+
+	int largest = 0;
+	int differences = Scene::countDifferences(partial.data(), full, Scene::WIDTH, Scene::HEIGHT, 0, &largest);
+	if (differences == 0)
+		return;
+
+	printf("%s: %d pixels differ from a full redraw, largest channel difference %d\n", aStep, differences, largest);
+	if (failedFrames++ == 0)
+	{
+		Scene::writeImage("partial.pam", partial.data(), Scene::WIDTH, Scene::HEIGHT);
+		Scene::writeImage("full.pam", full, Scene::WIDTH, Scene::HEIGHT);
+		printf("Wrote partial.pam and full.pam\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace Lemur;
+
+	Window* window = new Window(Scene::WIDTH, Scene::HEIGHT, "Pixel diff test", true);
+	ResourceManager resources;
+	if (!Scene::loadFont(*window, resources))
+		return 1;
+
+	Scene::build(*window);
+	Scene::runFrame(*window);
+
+	// Hover along the toolbar, switch tabs, scroll the list and hover the fields
+	for (int x = 10; x < Scene::WIDTH; x += 45)
+	{
+		Scene::moveMouse(*window, x, 20);
+		runCheckedFrame(*window, "Toolbar hover");
+	}
+
+	Scene::moveMouse(*window, 150, 60);
+	runCheckedFrame(*window, "Tab hover");
+	Scene::mouseButton(*window, GLFW_PRESS);
+	runCheckedFrame(*window, "Tab press");
+	Scene::mouseButton(*window, GLFW_RELEASE);
+	runCheckedFrame(*window, "Tab switch");
+
+	for (int i = 0; i < 6; i++)
+	{
+		Scene::scroll(*window, 1000, 300, -2);
+		runCheckedFrame(*window, "List scroll");
+	}
+
+	for (int y = 90; y < 700; y += 23)
+	{
+		Scene::moveMouse(*window, 200, y);
+		runCheckedFrame(*window, "Field hover");
+	}
+
+	// End over a toolbar button, so the reference has a hover in the picture
+	Scene::moveMouse(*window, 280, 20);
+	runCheckedFrame(*window, "Toolbar hover");
+
+	printf("%d partial frames checked against a full redraw, %d differ\n", checkedFrames, failedFrames);
+	int status = failedFrames > 0 || checkedFrames == 0 ? 1 : 0;
+
+	window->invalidateAll();
+	Scene::runFrame(*window);
+	std::vector<unsigned char> full = copyPixels(*window);
+	int largest = 0;
+	int differences = 0;
+
+	if (argc > 2 && strcmp(argv[1], "--write") == 0)
+	{
+		if (Scene::writeImage(argv[2], full.data(), Scene::WIDTH, Scene::HEIGHT))
+			printf("Wrote %s\n", argv[2]);
+		else
+		{
+			printf("Can't write %s\n", argv[2]);
+			status = 1;
+		}
+	}
+	else if (argc > 2 && strcmp(argv[1], "--compare") == 0)
+	{
+		std::vector<unsigned char> reference;
+		int width = 0;
+		int height = 0;
+
+		if (!Scene::readImage(argv[2], reference, width, height))
+		{
+			printf("Can't read %s\n", argv[2]);
+			status = 1;
+		}
+		else if (width != Scene::WIDTH || height != Scene::HEIGHT)
+		{
+			printf("%s is %dx%d, expected %dx%d\n", argv[2], width, height, Scene::WIDTH, Scene::HEIGHT);
+			status = 1;
+		}
+		else
+		{
+			differences = Scene::countDifferences(full.data(), reference.data(), width, height, REFERENCE_TOLERANCE, &largest);
+			printf("Full redraw against %s: %d pixels differ, largest channel difference %d\n", argv[2], differences, largest);
+			if (differences > 0)
+			{
+				Scene::writeImage("full.pam", full.data(), Scene::WIDTH, Scene::HEIGHT);
+				printf("Wrote full.pam\n");
+				status = 1;
+			}
+		}
+	}
+
+	window->close();
+	delete window;
+	return status;
+}
@@ -0,0 +1,140 @@
+//
+// Frame time benchmark of the offscreen Window and software renderer. Draws the scene from
+// offscreen_scene.h fully redrawn, with the mouse moving over the toolbar (partial redraws), and
+// idle, and reports the median time of each.
+//
+// Build as described in offscreen_scene.h. Run from this directory:
+//   render_bench                        Report frame times
+//   render_bench --write base.txt       Also save them as a baseline
+//   render_bench --compare base.txt     Return non-zero if a median is over 20% slower than the baseline
+//
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "offscreen_scene.h"
+
+static const int FRAMES = 60;
+static const double TOLERANCE = 1.2;
+
+struct Result
+{
+	const char* name;
+	double median;		// Milliseconds
+	double best;
+};
+
+static Result measure(const char* aName, std::vector<double>& aTimes)
+{
+	std::sort(aTimes.begin(), aTimes.end());
+	return Result{ aName, aTimes[aTimes.size() / 2], aTimes.front() };
+}
+
+int main(int argc, char** argv)
+{
+	using namespace Lemur;
+
+	Window* window = new Window(Scene::WIDTH, Scene::HEIGHT, "Render benchmark", true);
+	ResourceManager resources;
+	if (!Scene::loadFont(*window, resources))
+		return 1;
+
+	Scene::build(*window);
+
+	// Lay out, fill the glyph atlas and start the band workers
+	for (int i = 0; i < 5; i++)
+	{
+		window->invalidateAll();
+		Scene::runFrame(*window);
+	}
+
+	std::vector<Result> results;
+	std::vector<double> times;
+
+	// Whole window redrawn every frame
+	for (int i = 0; i < FRAMES; i++)
+	{
+		window->invalidateAll();
+		auto start = std::chrono::steady_clock::now();
+		Scene::runFrame(*window);
+		times.push_back(Scene::milliseconds(start));
+	}
+	results.push_back(measure("full", times));
+
+	// Hovering along the toolbar redraws the buttons entered and left
+	times.clear();
+	for (int i = 0; i < FRAMES; i++)
+	{
+		Scene::moveMouse(*window, 10 + (i * 37) % (Scene::WIDTH - 20), 20);
+		auto start = std::chrono::steady_clock::now();
+		Scene::runFrame(*window);
+		times.push_back(Scene::milliseconds(start));
+	}
+	results.push_back(measure("hover", times));
+
+	// Nothing changed, the frame is skipped
+	times.clear();
+	for (int i = 0; i < FRAMES; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		Scene::runFrame(*window);
+		times.push_back(Scene::milliseconds(start));
+	}
+	results.push_back(measure("idle", times));
+
+	printf("%dx%d, %d render threads, %d frames each\n", Scene::WIDTH, Scene::HEIGHT,
+		window->getSoftwareRenderer()->getThreadCount(), FRAMES);
+	for (const Result& result : results)
+		printf("%-6s median %8.3f ms, best %8.3f ms\n", result.name, result.median, result.best);
+
+	int status = 0;
+	if (argc > 2 && strcmp(argv[1], "--write") == 0)
+	{
+		FILE* file = fopen(argv[2], "w");
+		if (file == nullptr)
+		{
+			printf("Can't write %s\n", argv[2]);
+			status = 1;
+		}
+		else
+		{
+			for (const Result& result : results)
+				fprintf(file, "%s %f\n", result.name, result.median);
+			fclose(file);
+			printf("Wrote %s\n", argv[2]);
+		}
+	}
+	else if (argc > 2 && strcmp(argv[1], "--compare") == 0)
+	{
+		FILE* file = fopen(argv[2], "r");
+		if (file == nullptr)
+		{
+			printf("Can't read %s\n", argv[2]);
+			status = 1;
+		}
+		else
+		{
+			char name[32];
+			double baseline;
+			while (fscanf(file, "%31s %lf", name, &baseline) == 2)
+			{
+				for (const Result& result : results)
+				{
+					// Idle frames take microseconds, too little to compare reliably
+					if (strcmp(result.name, name) != 0 || strcmp(name, "idle") == 0)
+						continue;
+
+					bool slower = result.median > baseline * TOLERANCE;
+					printf("%-6s %8.3f ms, baseline %8.3f ms%s\n", name, result.median, baseline, slower ? "  REGRESSION" : "");
+					if (slower)
+						status = 1;
+				}
+			}
+			fclose(file);
+		}
+	}
+
+	window->close();
+	delete window;
+	return status;
+}
@@ -0,0 +1,95 @@
+//
+// SVG icon test. Rasterizes resources/icons/save.svg through the SVG raster cache at the size of its
+// PNG export, draws both side by side in an offscreen Window, and compares the pixels. The exporter
+// anti-aliases edges differently, so channels may differ a little along edges, but the shapes must
+// match.
+//
+// Build as described in offscreen_scene.h. Run from this directory:
+//   svg_icon_test                  Compare the raster with save.png
+//   svg_icon_test --write dir      Also save both as PAM images in a directory, to look at
+//
+// Returns non-zero on a mismatch.
+//
+
+#include <cstring>
+#include "offscreen_scene.h"
+
+static const int ICON_SIZE = 32;			// Size of save.png
+
+// Channel difference counted as a mismatch, and how much of the icon may mismatch along edges
+static const int TOLERANCE = 48;
+static const double MAX_MISMATCHED = 0.02;
+static const double MAX_MEAN_DIFFERENCE = 4.0;
+
+int main(int argc, char** argv)
+{
+	using namespace Lemur;
+
+	Window* window = new Window(ICON_SIZE * 2, ICON_SIZE, "SVG icon test", true);
+	ResourceManager resources;
+	window->resourceManager = &resources;
+	NVGcontext* context = window->getContext();
+
+	if (resources.importSvgFromFile("save.svg", "../resources/icons/save.svg") == nullptr)
+	{
+		printf("Can't load ../resources/icons/save.svg, run from the tests directory\n");
+		return 1;
+	}
+
+	Image* svg = resources.getSvgImage(context, "save.svg", ICON_SIZE, ICON_SIZE);
+	Image* png = resources.importImageFromFile(context, ICON_SIZE, ICON_SIZE, "save.png", "../resources/icons/save.png");
+	if (svg == nullptr || png == nullptr || png->getId() == 0)
+	{
+		printf("Can't load the save icon\n");
+		return 1;
+	}
+
+	// Raster on the left, export on the right, over the window's background
+	window->invalidateAll();
+	window->resetContext();
+	Draw::ResourceImage(context, 0, 0, ICON_SIZE, ICON_SIZE, svg);
+	Draw::ResourceImage(context, ICON_SIZE, 0, ICON_SIZE, ICON_SIZE, png);
+	window->endFrame();
+
+	// Split the frame into the two icons
+	const unsigned char* pixels = window->getSoftwareRenderer()->getPixels();
+	std::vector<unsigned char> raster(ICON_SIZE * ICON_SIZE * 4);
+	std::vector<unsigned char> exported(ICON_SIZE * ICON_SIZE * 4);
+	for (int y = 0; y < ICON_SIZE; y++)
+	{
+		const unsigned char* row = pixels + y * ICON_SIZE * 2 * 4;
+		memcpy(&raster[y * ICON_SIZE * 4], row, ICON_SIZE * 4);
+		memcpy(&exported[y * ICON_SIZE * 4], row + ICON_SIZE * 4, ICON_SIZE * 4);
+	}
+
+	long total = 0;
+	for (size_t i = 0; i < raster.size(); i++)
+		total += raster[i] > exported[i] ? raster[i] - exported[i] : exported[i] - raster[i];
+
+	int largest = 0;
+	int mismatched = Scene::countDifferences(raster.data(), exported.data(), ICON_SIZE, ICON_SIZE, TOLERANCE, &largest);
+	double mismatchedShare = static_cast<double>(mismatched) / (ICON_SIZE * ICON_SIZE);
+	double meanDifference = static_cast<double>(total) / raster.size();
+
+	printf("save.svg at %dx%d against save.png: %d pixels differ by more than %d (%.1f%%), mean channel difference %.2f, largest %d\n",
+		ICON_SIZE, ICON_SIZE, mismatched, TOLERANCE, mismatchedShare * 100, meanDifference, largest);
+
+	int status = 0;
+	if (mismatchedShare > MAX_MISMATCHED || meanDifference > MAX_MEAN_DIFFERENCE)
+	{
+		printf("The raster doesn't match the export\n");
+		status = 1;
+	}
+
+	if (argc > 2 && strcmp(argv[1], "--write") == 0)
+	{
+		std::string directory = argv[2];
+		Scene::writeImage((directory + "/save_svg.pam").c_str(), raster.data(), ICON_SIZE, ICON_SIZE);
+		Scene::writeImage((directory + "/save_png.pam").c_str(), exported.data(), ICON_SIZE, ICON_SIZE);
+		printf("Wrote save_svg.pam and save_png.pam to %s\n", argv[2]);
+	}
+
+	window->close();
+	delete window;
+	return status;
+}